@@ -26,6 +26,8 @@
 
 #include <steam_api.h>
 
+#include "vapor_lock_profiler.h"
+
 //-----------------------------------------------------------------------------
 // Purpose: Callback event data structure
 // Uses RAII wrapper for safer memory management while maintaining performance
@@ -111,6 +113,10 @@ public:
     bool PostCallback(int iCallback, void *pvCallbackData, size_t cubCallbackData);
     bool PostCallback(int iCallback, void *pvCallbackData, size_t cubCallbackData, CallbackEvent_t::CallbackType callbackType);
     SteamAPICall_t PostCallResult(void *pvCallbackData, size_t cubCallbackData, bool bIOFailure = false);
+
+    // Asynchronous APIs hand out the handle first and post the result when the work completes
+    SteamAPICall_t AllocateAPICall();
+    bool PostCallResult(SteamAPICall_t hAPICall, void *pvCallbackData, size_t cubCallbackData, bool bIOFailure = false);
     
     //-----------------------------------------------------------------------------
     // Utility API (Testing/Debugging)
@@ -141,7 +147,7 @@ private:
     std::unordered_map<int, std::vector<CCallbackBase*>> m_serverCallbacks;
     std::unordered_map<SteamAPICall_t, CCallbackBase*> m_callResults;
     std::queue<CallbackEvent_t> m_eventQueue;
-    std::mutex m_mutex;
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("CCallbackMgr::m_mutex");
 };
 
 #endif // VAPORCORE_CALLBACK_MGR_H
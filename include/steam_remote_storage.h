@@ -25,6 +25,8 @@
 #include <isteamremotestorage013.h>
 
 #include "vapor_file_storage.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_chunk_store.h"
 
 //-----------------------------------------------------------------------------
 // Purpose: Functions for accessing, reading and writing files stored remotely 
@@ -213,6 +215,15 @@ public:
 	STEAM_CALL_RESULT( RemoteStorageDownloadUGCResult_t )
 	SteamAPICall_t UGCDownloadToLocation( UGCHandle_t hContent, const char *pchLocation, uint32 unPriority ) override;
 
+    //-----------------------------------------------------------------------------
+    // VaporCore extensions (exported through vapor_extensions.h)
+    //-----------------------------------------------------------------------------
+    bool OpenFileView( const char *pchFile, VaporCore::FileStorage::FileView &view );
+    bool GetFileVersions( const char *pchFile, std::vector<VaporCore::FileStorage::FileVersion> &versions );
+    bool RestoreFileVersion( const char *pchFile, uint32 unVersion );
+    bool ListFiles( const char *pchPrefix, std::vector<std::string> &files );
+    bool SyncCloud();
+
 private:
     // Private constructor and destructor for singleton
     CSteamRemoteStorage();
@@ -229,6 +240,60 @@ private:
     
     // File storage backend
     VaporCore::FileStorage m_fileStorage;
+
+    // Sync against the [Cloud] remote, with the per-file cloud state
+    VaporCore::CloudSync m_cloudSync;
+
+    // File names of open write streams, their close counts as a write
+    std::unordered_map<UGCFileWriteStreamHandle_t, std::string> m_streamFiles;
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Result of a FileReadAsync call, kept until the game collects it
+    // with FileReadAsyncComplete
+    //-----------------------------------------------------------------------------
+    struct AsyncRead
+    {
+        std::vector<uint8> m_data;
+        bool m_bComplete = false;
+        bool m_bSuccess = false;
+    };
+
+    // Outstanding FileReadAsync calls by call handle, filled in from AsyncIO threads
+    std::unordered_map<SteamAPICall_t, AsyncRead> m_asyncReads;
+    VaporCore::Mutex m_asyncReadsMutex VAPORCORE_MUTEX_NAME("CSteamRemoteStorage::m_asyncReadsMutex");
+
+    //-----------------------------------------------------------------------------
+    // Purpose: UGC content opened by UGCDownload, from the shared chunk store.
+    // The download reads the content through once on an AsyncIO thread (warming
+    // the chunks, counting progress) and keeps its first window. UGCRead then
+    // serves reads from a read-ahead window that grows while the reads stay
+    // sequential, so small chunked reads do not each go to the chunk files
+    //-----------------------------------------------------------------------------
+    struct UGCContent
+    {
+        // Set by the download before m_bComplete
+        VaporCore::ChunkManifest m_manifest;
+        std::shared_ptr<VaporCore::ChunkStore> m_pStore;
+
+        std::atomic<uint64> m_cubDownloaded{ 0 };
+        std::atomic<uint64> m_cubExpected{ 0 };
+        std::atomic<bool> m_bComplete{ false };
+
+        // Read position and window, under m_ugcMutex
+        uint64 m_unNextOffset = 0;
+        std::vector<uint8> m_readAhead;
+        uint64 m_unReadAheadOffset = 0;
+        size_t m_cubReadAheadWindow = 0;
+    };
+
+    // Read the content into place (and into pchLocation if given), updating progress
+    static EResult DownloadUGC(UGCHandle_t hContent, UGCContent& content, const std::string& location);
+    SteamAPICall_t StartUGCDownload(UGCHandle_t hContent, const char *pchLocation);
+    int32 ReadUGC(UGCContent& content, void *pvData, int32 cubDataToRead, uint64 unOffset);
+
+    // Downloaded or downloading UGC by handle, until read to the end or closed
+    std::unordered_map<UGCHandle_t, std::shared_ptr<UGCContent>> m_ugcContents;
+    VaporCore::Mutex m_ugcMutex VAPORCORE_MUTEX_NAME("CSteamRemoteStorage::m_ugcMutex");
 };
 
 #endif // VAPORCORE_STEAM_REMOTE_STORAGE_H
@@ -22,6 +22,9 @@
 #include <isteamuserstats009.h>
 #include <isteamuserstats010.h>
 
+#include "vapor_user_stats.h"
+#include "vapor_leaderboard.h"
+
 //-----------------------------------------------------------------------------
 // Purpose: Functions for accessing stats, achievements, and leaderboard information
 //-----------------------------------------------------------------------------
@@ -280,6 +283,16 @@ private:
     // Delete copy constructor and assignment operator
     CSteamUserStats(const CSteamUserStats&) = delete;
     CSteamUserStats& operator=(const CSteamUserStats&) = delete;
+
+    // Stats and achievements of the current user
+    VaporCore::UserStats m_userStats;
+
+    // Leaderboards created by the game this session
+    VaporCore::Leaderboards m_leaderboards;
+
+    // Post a LeaderboardScoresDownloaded_t for rows just read
+    SteamAPICall_t PostDownloadResult(SteamLeaderboard_t hSteamLeaderboard, bool bSuccess,
+                                      std::vector<VaporCore::Leaderboards::Row>&& rows);
 };
 
 #endif // VAPORCORE_STEAM_USER_STATS_H
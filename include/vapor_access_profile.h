@@ -0,0 +1,53 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Per-file read frequency remembered across runs
+ */
+
+#ifndef VAPORCORE_ACCESS_PROFILE_H
+#define VAPORCORE_ACCESS_PROFILE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <unordered_map>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+// Name of the profile inside the storage directory
+static constexpr const char* ACCESS_PROFILE_FILENAME = "storage.vcprofile";
+
+//-----------------------------------------------------------------------------
+// Purpose: How often each file of a storage directory gets read. Save() folds
+// the reads of this run into the scores of earlier runs, halving those, so
+// files the game stopped reading fade out after a few runs. Not synchronized,
+// FileStorage calls it under its own mutex.
+//-----------------------------------------------------------------------------
+class AccessProfile
+{
+public:
+    explicit AccessProfile(const std::string& directory);
+
+    // Scores of earlier runs, a missing or damaged profile is an empty one
+    void Load();
+    bool Save();
+
+    void RecordRead(const std::string& name);
+    uint32 GetScore(const std::string& name) const;
+
+private:
+    std::string m_sPath;
+    std::unordered_map<std::string, uint32> m_scores;   // From earlier runs
+    std::unordered_map<std::string, uint32> m_reads;    // This run
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_ACCESS_PROFILE_H
@@ -0,0 +1,92 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Asynchronous file I/O engine (io_uring on Linux, worker threads elsewhere)
+ */
+
+#ifndef VAPORCORE_ASYNC_IO_H
+#define VAPORCORE_ASYNC_IO_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <steam_api.h>
+
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Process-wide engine behind the asynchronous storage APIs.
+// Positioned reads are submitted to an io_uring instance when the kernel
+// provides one, so any number of them can be in flight without a thread each;
+// everything else (and every read when io_uring is unavailable) runs on a
+// small pool of worker threads. Completions are invoked on engine threads and
+// must not block for long.
+//-----------------------------------------------------------------------------
+class AsyncIO
+{
+public:
+    // bSuccess is false when the file could not be opened or read; data holds the bytes read
+    using ReadCompletion = std::function<void(bool bSuccess, std::vector<uint8>&& data)>;
+
+    static AsyncIO& GetInstance();
+
+    // Read up to cubToRead bytes at unOffset. Reading at or past the end succeeds with no data.
+    // After Shutdown() the completion runs right away, unsuccessfully
+    void ReadAt(const std::string& path, uint64 unOffset, uint32 cubToRead, ReadCompletion completion);
+
+    // Run a task on the worker pool. Tasks posted with the same key never run
+    // concurrently and start in submission order. False once Shutdown() has
+    // stopped the worker of the key: the task is dropped and the caller has to
+    // finish (or fail) whatever it stood for, knowing that no earlier task with
+    // that key is still queued or running
+    [[nodiscard]] bool Post(uint64 unKey, std::function<void()> task);
+
+    // Complete all queued tasks and in-flight reads, then stop the engine threads
+    // for good; tasks run meanwhile may still post follow-up work
+    void Shutdown();
+
+    [[nodiscard]] bool IsUsingIoUring() const noexcept { return m_bIoUring.load(); }
+
+private:
+    AsyncIO();
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    struct Worker;
+    struct Ring;
+
+    // Start the worker pool and the ring if needed, unless shut down (callers hold m_mutex)
+    void Start();
+    void WorkerThread(Worker* pWorker);
+
+    // Blocking positioned read used by the worker pool
+    static bool ReadAtBlocking(const std::string& path, uint64 unOffset, uint32 cubToRead, std::vector<uint8>& data);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::unique_ptr<Ring> m_pRing;
+    std::atomic<uint32> m_unNextWorker;
+    std::atomic<bool> m_bIoUring;
+    bool m_bStarted;
+    bool m_bShutdown;                   // Set once the pool stops, nothing restarts it
+
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("AsyncIO::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_ASYNC_IO_H
@@ -50,12 +50,13 @@
 // VaporCore callback manager
 #include "vapor_logger.h"
 #include "vapor_config.h"
+#include "vapor_lock_profiler.h"
 
 // Global synchronization for thread-safe operations
-extern std::recursive_mutex g_GlobalMutex;
+extern VaporCore::RecursiveMutex g_GlobalMutex;
 
 // Utility macros for thread-safe operations (global scope)
-#define VAPORCORE_LOCK_GUARD() std::lock_guard<std::recursive_mutex> lock(g_GlobalMutex)
+#define VAPORCORE_LOCK_GUARD() VAPORCORE_SCOPED_LOCK(g_GlobalMutex)
 #define VAPORCORE_LOCK() g_GlobalMutex.lock()
 #define VAPORCORE_UNLOCK() g_GlobalMutex.unlock()
 
@@ -0,0 +1,179 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Content-addressed, deduplicating chunk store
+ */
+
+#ifndef VAPORCORE_CHUNK_STORE_H
+#define VAPORCORE_CHUNK_STORE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_file_io.h"
+#include "vapor_hash.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Default location of the shared store, [Storage] chunk_store_dir overrides it
+static constexpr const char* DEFAULT_CHUNK_STORE_DIRECTORY = "./vaporcore_chunks";
+
+// Chunks are named by the 128-bit hash of their contents
+using ChunkId = Hash128;
+
+struct ChunkIdHasher
+{
+    size_t operator()(const ChunkId& id) const noexcept { return static_cast<size_t>(id.m_unLow); }
+};
+
+// Root key of shared UGC content by handle
+inline std::string GetUGCRootKey(uint64 hContent)
+{
+    char key[24];
+    snprintf(key, sizeof(key), "ugc_%016llx", static_cast<unsigned long long>(hContent));
+    return key;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Logical file as a list of chunks. Very small or escaped contents
+// are kept inline instead. Serialized, a manifest is what a deduplicated
+// storage keeps in place of the file.
+//-----------------------------------------------------------------------------
+struct ChunkManifest
+{
+    struct Chunk
+    {
+        ChunkId m_id;
+        uint32 m_cubSize = 0;
+    };
+
+    uint64 m_unSize = 0;            // Logical size
+    std::vector<Chunk> m_chunks;
+    std::vector<uint8> m_inline;    // Contents held by the manifest itself
+
+    void Serialize(std::vector<uint8>& data) const;
+    static bool Parse(const void* pData, size_t cubData, ChunkManifest& manifest);
+
+    // Size of the fixed header at the start of a serialized manifest
+    static size_t HeaderSize();
+
+    // Check a serialized header against the total stored size, and get the logical size
+    static bool ParseHeader(const void* pHeader, size_t cubHeader, uint64 unStoredSize, uint64& unSize);
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: Content-addressed store of reference counted chunks. Files are
+// cut at content-defined boundaries (gear rolling hash), so an insertion
+// only changes the chunks around it, and every distinct chunk is written
+// once however many files contain it. Reference count changes go to an
+// append-only log that is replayed and compacted on open; a chunk file is
+// deleted once nothing references it. Every storage directory, UGC handle
+// and workshop item of the process shares one store per directory.
+//-----------------------------------------------------------------------------
+class ChunkStore
+{
+public:
+    // Shared instance for a directory, created on first use; null if it cannot be opened
+    static std::shared_ptr<ChunkStore> Open(const std::string& directory);
+
+    // The store configured by [Storage] chunk_store_dir
+    static std::shared_ptr<ChunkStore> OpenDefault();
+
+    ~ChunkStore();
+
+    // Chunk and store the data, referencing every chunk once. Chunks already in the
+    // store are not written again
+    bool Store(const void* pData, size_t cubData, ChunkManifest& manifest);
+
+    // Reference the chunks of an existing manifest once more, or drop one reference
+    bool AddRef(const ChunkManifest& manifest);
+    void Release(const ChunkManifest& manifest);
+
+    // Read up to cubMax bytes at unOffset of the logical file, returns the bytes read or -1
+    int64 Read(const ChunkManifest& manifest, uint64 unOffset, void* pBuffer, size_t cubMax);
+
+    // Named manifests, for content that lives outside any storage directory
+    // (shared UGC). Replacing or deleting one releases its chunks
+    bool PutRoot(const std::string& key, const ChunkManifest& manifest);
+    bool GetRoot(const std::string& key, ChunkManifest& manifest);
+    bool DeleteRoot(const std::string& key);
+
+    struct Stats
+    {
+        uint64 m_cChunks = 0;
+        uint64 m_cubStored = 0;         // Bytes in chunk files
+        uint64 m_cubLogicalWritten = 0; // Bytes passed to Store() since open
+        uint64 m_cubWritten = 0;        // Bytes of new chunks written since open
+    };
+    Stats GetStats() const;
+
+private:
+    explicit ChunkStore(const std::string& directory);
+
+    bool Load();
+
+    //-----------------------------------------------------------------------------
+    // Purpose: In-memory state of a chunk. A chunk is inserted before its file
+    // is written; other writers wait while m_bWriting is set, and claim it
+    // again if it ends up neither writing nor written (the write failed).
+    // m_nRefs counts references as soon as they are taken, m_nLoggedRefs only
+    // what the log holds, which is what a compacted log may record.
+    //-----------------------------------------------------------------------------
+    struct ChunkEntry
+    {
+        int64 m_nRefs = 0;
+        int64 m_nLoggedRefs = 0;
+        uint32 m_cubSize = 0;
+        bool m_bWriting = false;
+        bool m_bWritten = false;
+    };
+
+    struct RefDelta
+    {
+        ChunkId m_id;
+        int32 m_nDelta;
+        uint32 m_cubSize;
+    };
+
+    std::string GetChunkPath(const ChunkId& id) const;
+    std::string GetRootPath(const std::string& key) const;
+
+    // Log reference count changes, synced before returning (callers hold m_mutex)
+    bool AppendRefs(const std::vector<RefDelta>& deltas);
+
+    // Rewrite the log as one record per logged chunk (callers hold m_mutex)
+    bool CompactRefLog();
+
+    // Apply -1 to each chunk and delete the ones left unreferenced
+    void ReleaseChunks(const std::vector<ChunkManifest::Chunk>& chunks);
+
+private:
+    std::string m_sDirectory;
+
+    std::unordered_map<ChunkId, ChunkEntry, ChunkIdHasher> m_chunks;
+    RandomAccessFile m_refLog;
+    uint64 m_cRefRecords;
+
+    Stats m_stats;
+
+    std::condition_variable_any m_writtenCondition;     // A chunk file finished (or failed) writing
+    mutable VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("ChunkStore::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_CHUNK_STORE_H
@@ -0,0 +1,218 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Steam Cloud emulation by syncing saves against a remote directory
+ */
+
+#ifndef VAPORCORE_CLOUD_SYNC_H
+#define VAPORCORE_CLOUD_SYNC_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <shared_mutex>
+#include <unordered_map>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_file_storage.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Name of the sync state inside the storage directory
+static constexpr const char* CLOUD_SYNC_STATE_FILENAME = "storage.vcsync";
+
+// Directory inside the storage directory for local copies that lost a conflict
+// while version history was off, as <name>.<unix time>
+static constexpr const char* CLOUD_SYNC_CONFLICT_DIRECTORY = ".vcconflicts";
+
+//-----------------------------------------------------------------------------
+// Purpose: Steam Cloud stand-in. The "cloud" is a directory shared between
+// machines ([Cloud] remote_directory, e.g. an NFS mount), holding a manifest of
+// the files of each app and user plus their contents as a full object followed
+// by a short chain of deltas. Every version carries a version vector (a counter
+// per machine), so a pass can tell a remote change from a local one and both
+// from a conflict. The remote only stores data: a push makes its delta against
+// the block signature stored with the previous version, rsync style, so neither
+// side needs the other's copy. One pass runs in the background at startup, one
+// per SyncNow() and one at Shutdown(); passes on different machines are
+// serialized by a lock directory in the remote.
+//
+// Per file it also keeps what the Steam API exposes: whether the file is
+// forgotten (kept locally, removed from the cloud) and the platforms it syncs to.
+//-----------------------------------------------------------------------------
+class CloudSync
+{
+public:
+    explicit CloudSync(FileStorage& storage);
+    ~CloudSync();
+
+    CloudSync(const CloudSync&) = delete;
+    CloudSync& operator=(const CloudSync&) = delete;
+
+    // Start the background thread with a first pass
+    void Start();
+
+    // Run a last pass and stop the thread; the state still answers queries after
+    void Shutdown();
+
+    // Shutdown() every live CloudSync (called from SteamAPI_Shutdown)
+    static void ShutdownAll();
+
+    // Run a pass on the background thread and wait for it; false if the thread
+    // is not running (never started, or shut down)
+    bool SyncNow();
+
+    // A write through the API persists a forgotten file again
+    void OnFileWritten(const std::string& filename);
+
+    // Held shared around every write through the API, so a pull can compare the
+    // local copy and replace it without the game writing in between. Unlike the
+    // global lock it may be held while a write waits for the journal
+    std::shared_lock<std::shared_mutex> LockLocalWrites();
+
+    // Steam API state, by file name as the game passes it
+    bool IsPersisted(const std::string& filename);
+    bool Forget(const std::string& filename);
+    bool SetPlatforms(const std::string& filename, uint32 unPlatforms);
+    uint32 GetPlatforms(const std::string& filename);
+
+    // With cloud disabled for the app, passes leave the remote alone
+    void SetCloudEnabled(bool bEnabled);
+
+private:
+    // Counter per machine id
+    using VersionVector = std::map<uint64, uint64>;
+
+    enum EVersionOrder {
+        k_EVersionEqual,
+        k_EVersionBefore,       // First happened before the second
+        k_EVersionAfter,
+        k_EVersionConcurrent
+    };
+
+    // [Cloud] conflict_policy: which side wins when both changed a file
+    enum EConflictPolicy {
+        k_EConflictNewest,      // Later modification time
+        k_EConflictLocal,
+        k_EConflictRemote
+    };
+
+    // Local view of a file: the version last synced, plus the API settings
+    struct SyncedFile
+    {
+        VersionVector m_versions;
+        uint64 m_unHash = 0;            // Contents as of the last sync
+        uint64 m_unSize = 0;
+        uint64 m_unRemoteSeq = 0;       // Remote object of that version, 0 for none
+        bool m_bExists = false;
+        bool m_bForgotten = false;
+        uint32 m_unPlatforms = k_ERemoteStoragePlatformAll;
+    };
+
+    // Manifest entry, the current version of a file in the remote
+    struct RemoteFile
+    {
+        VersionVector m_versions;
+        uint64 m_unSeq = 0;             // Object of this version
+        uint64 m_unFullSeq = 0;         // Full object the delta chain up to m_unSeq starts at
+        uint64 m_unHash = 0;
+        uint64 m_unSize = 0;
+        int64 m_nTimestamp = 0;
+        uint32 m_unPlatforms = k_ERemoteStoragePlatformAll;
+        bool m_bDeleted = false;
+    };
+
+    using Manifest = std::map<std::string, RemoteFile>;
+
+    // Local contents of a file at the start of its sync
+    struct LocalFile
+    {
+        std::vector<uint8> m_data;
+        uint64 m_unHash = 0;
+        bool m_bExists = false;
+    };
+
+    struct SyncStats
+    {
+        uint32 m_cPushed = 0;
+        uint32 m_cPulled = 0;
+        uint32 m_cDeltas = 0;           // Transfers made as deltas
+        uint32 m_cConflicts = 0;
+        uint64 m_cubSent = 0;           // Object bytes written to the remote
+        uint64 m_cubReceived = 0;       // Object bytes read from it
+    };
+
+    // One pass, on the sync thread
+    void SyncThread();
+    void RunSync();
+    bool SyncFile(const std::string& name, Manifest& manifest, SyncStats& stats);
+
+    bool Push(const std::string& name, const LocalFile& local, const VersionVector& versions, Manifest& manifest,
+              SyncStats& stats);
+    bool Pull(const std::string& name, const LocalFile& local, const RemoteFile& remote, SyncStats& stats);
+    bool ReadRemoteVersion(const std::string& name, const LocalFile& local, const RemoteFile& remote,
+                           std::vector<uint8>& data, SyncStats& stats);
+
+    // Set aside the local contents a pull replaced, when no version history keeps them
+    void SaveConflictCopy(const std::string& name, const LocalFile& local);
+
+    // Record the version now on both sides, keeping the API settings
+    void MarkSynced(const std::string& name, const VersionVector& versions, uint64 unHash, uint64 unSize,
+                    uint64 unRemoteSeq, bool bExists);
+
+    static EVersionOrder CompareVersions(const VersionVector& a, const VersionVector& b);
+    static VersionVector MergeVersions(const VersionVector& a, const VersionVector& b);
+
+    // Local state, under m_mutex
+    void LoadState();
+    bool SaveState();
+    SyncedFile* FindFile(const std::string& filename, std::string& normalized);
+
+    // Remote directory
+    bool LockRemote();
+    void UnlockRemote();
+    bool LoadManifest(Manifest& manifest);
+    bool WriteManifest(const Manifest& manifest);
+    std::string ObjectDirectory(const std::string& name) const;
+    std::string ObjectPath(const std::string& name, uint64 unSeq, const char* pchExtension) const;
+
+private:
+    FileStorage& m_storage;
+    std::string m_sStatePath;
+    std::string m_sRemoteDirectory;     // Empty: no remote configured
+    EConflictPolicy m_eConflictPolicy;
+    uint64 m_unMachineId;
+
+    std::unordered_map<std::string, SyncedFile> m_files;
+    bool m_bCloudEnabled;
+
+    // Paths removed once the manifest no longer references them
+    std::vector<std::string> m_garbage;
+
+    std::thread m_syncThread;
+    bool m_bSyncRequested;
+    bool m_bStop;
+    bool m_bRunning;
+    uint64 m_cPassesStarted;
+    uint64 m_cPassesDone;
+    std::condition_variable_any m_syncCondition;    // Pass requested or stop requested
+    std::condition_variable_any m_doneCondition;    // Pass finished
+
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("CloudSync::m_mutex");
+    std::shared_mutex m_localWriteMutex;    // Exclusive while a pull applies a file
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_CLOUD_SYNC_H
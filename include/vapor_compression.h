@@ -0,0 +1,74 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Block compression for stored files
+ */
+
+#ifndef VAPORCORE_COMPRESSION_H
+#define VAPORCORE_COMPRESSION_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+// Codecs recorded in the stored file header
+enum ECompressionCodec : uint8 {
+    k_ECompressionCodecNone = 0,    // Stored as is, behind a header
+    k_ECompressionCodecLZ = 1       // LZ77 block, LZ4-style sequence layout
+};
+
+// Policy values for the [Compression] section
+static constexpr const char* COMPRESSION_CODEC_NONE = "none";
+static constexpr const char* COMPRESSION_CODEC_LZ = "lz";
+
+//-----------------------------------------------------------------------------
+// Purpose: Header in front of an encoded stored file. Files without it are
+// stored verbatim; m_unCheck makes a verbatim file that happens to start
+// with the magic practically impossible to mistake for an encoded one.
+//-----------------------------------------------------------------------------
+struct StoredFileHeader
+{
+    uint32 m_unMagic;
+    uint8 m_unCodec;
+    uint8 m_unVersion;
+    uint16 m_unCheck;
+    uint64 m_unOriginalSize;
+};
+
+static_assert(sizeof(StoredFileHeader) == 16, "Stored file header layout changed");
+
+// Raw LZ block codec. Compress returns the compressed size, or 0 if the output
+// does not fit in cubDst; Decompress succeeds only if it produces exactly cubDst bytes
+size_t LZCompressBound(size_t cubSrc);
+size_t LZCompress(const uint8* pSrc, size_t cubSrc, uint8* pDst, size_t cubDst);
+bool LZDecompress(const uint8* pSrc, size_t cubSrc, uint8* pDst, size_t cubDst);
+
+// Parse a codec name from the configuration, false if unknown
+bool ParseCompressionCodec(const std::string& name, ECompressionCodec& codec);
+
+// Encode data as a stored file with the codec. False if that would not save
+// space, the data is then best stored verbatim (see NeedsStoredFileHeader())
+bool EncodeStoredFile(ECompressionCodec codec, const void* pData, size_t cubData, std::vector<uint8>& encoded);
+
+// Verbatim data that could be mistaken for an encoded file must be stored with a header
+bool NeedsStoredFileHeader(const void* pData, size_t cubData);
+
+// True if the stored bytes start with a valid header
+bool ReadStoredFileHeader(const void* pStored, size_t cubStored, StoredFileHeader& header);
+
+// Decode a stored file into up to cubMax bytes; returns the bytes produced or -1
+int64 DecodeStoredFile(const void* pStored, size_t cubStored, void* pBuffer, size_t cubMax);
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_COMPRESSION_H
@@ -16,23 +16,73 @@
 #endif
 
 #include <string>
-#include <map>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <functional>
 #include <steam_api.h>
 
+#include "vapor_lock_profiler.h"
+
 namespace VaporCore {
 
 // Default configuration filename
-static const char* const DEFAULT_CONFIG_FILENAME = "vaporcore.ini";
+static constexpr const char* DEFAULT_CONFIG_FILENAME = "vaporcore.ini";
+
+// Compiled cache written next to the configuration file ("vaporcore.ini.cache")
+static constexpr const char* CONFIG_CACHE_EXTENSION = ".cache";
 
 // Configuration section names
-static const char* const CONFIG_SECTION_STEAM = "Steam";
+static constexpr const char* CONFIG_SECTION_STEAM = "Steam";
+static constexpr const char* CONFIG_SECTION_VAPORCORE = "VaporCore";
+static constexpr const char* CONFIG_SECTION_STORAGE = "Storage";
+static constexpr const char* CONFIG_SECTION_COMPRESSION = "Compression";
+static constexpr const char* CONFIG_SECTION_CLOUD = "Cloud";
+static constexpr const char* CONFIG_SECTION_STATS = "Stats";
 
 // Steam section keys
-static const char* const CONFIG_KEY_STEAM_APP_ID = "app_id";
-static const char* const CONFIG_KEY_STEAM_STEAM_ID = "steam_id";
-static const char* const CONFIG_KEY_STEAM_USERNAME = "username";
-static const char* const CONFIG_KEY_STEAM_LANGUAGE = "language";
+static constexpr const char* CONFIG_KEY_STEAM_APP_ID = "app_id";
+static constexpr const char* CONFIG_KEY_STEAM_STEAM_ID = "steam_id";
+static constexpr const char* CONFIG_KEY_STEAM_USERNAME = "username";
+static constexpr const char* CONFIG_KEY_STEAM_LANGUAGE = "language";
+
+// VaporCore section keys
+static constexpr const char* CONFIG_KEY_VAPORCORE_HOT_RELOAD = "hot_reload";
+static constexpr const char* CONFIG_KEY_VAPORCORE_HOT_RELOAD_POLL_MS = "hot_reload_poll_ms";
+static constexpr const char* CONFIG_KEY_VAPORCORE_CONFIG_CACHE = "config_cache";
+
+// Storage section keys
+static constexpr const char* CONFIG_KEY_STORAGE_WRITE_BACK = "write_back";
+static constexpr const char* CONFIG_KEY_STORAGE_WRITE_BACK_MAX_DIRTY_MB = "write_back_max_dirty_mb";
+static constexpr const char* CONFIG_KEY_STORAGE_IO_URING = "io_uring";
+static constexpr const char* CONFIG_KEY_STORAGE_MMAP_THRESHOLD_KB = "mmap_threshold_kb";
+static constexpr const char* CONFIG_KEY_STORAGE_BACKEND = "backend";
+static constexpr const char* CONFIG_KEY_STORAGE_COMPACT_GARBAGE_PERCENT = "compact_garbage_percent";
+static constexpr const char* CONFIG_KEY_STORAGE_DEDUP = "dedup";
+static constexpr const char* CONFIG_KEY_STORAGE_CHUNK_STORE_DIR = "chunk_store_dir";
+static constexpr const char* CONFIG_KEY_STORAGE_VERSION_HISTORY = "version_history";
+static constexpr const char* CONFIG_KEY_STORAGE_DIRECTORY = "directory";
+static constexpr const char* CONFIG_KEY_STORAGE_NAMESPACE = "namespace";
+static constexpr const char* CONFIG_KEY_STORAGE_ADOPT_LEGACY_SAVES = "adopt_legacy_saves";
+static constexpr const char* CONFIG_KEY_STORAGE_QUOTA_MB = "quota_mb";
+static constexpr const char* CONFIG_KEY_STORAGE_QUOTA_FILES = "quota_files";
+static constexpr const char* CONFIG_KEY_STORAGE_JOURNAL = "journal";
+static constexpr const char* CONFIG_KEY_STORAGE_JOURNAL_GROUP_COMMIT_MS = "journal_group_commit_ms";
+static constexpr const char* CONFIG_KEY_STORAGE_JOURNAL_GROUP_COMMIT_KB = "journal_group_commit_kb";
+static constexpr const char* CONFIG_KEY_STORAGE_JOURNAL_CHECKPOINT_MB = "journal_checkpoint_mb";
+static constexpr const char* CONFIG_KEY_STORAGE_PREFETCH_MB = "prefetch_mb";
+static constexpr const char* CONFIG_KEY_STORAGE_PREFETCH_ORDER = "prefetch_order";
+
+// Cloud section keys
+static constexpr const char* CONFIG_KEY_CLOUD_REMOTE_DIRECTORY = "remote_directory";
+static constexpr const char* CONFIG_KEY_CLOUD_CONFLICT_POLICY = "conflict_policy";
+
+// Stats section keys
+static constexpr const char* CONFIG_KEY_STATS_SCHEMA = "schema";
+static constexpr const char* CONFIG_KEY_STATS_DIRECTORY = "directory";
+static constexpr const char* CONFIG_KEY_STATS_STORE_DELAY_MS = "store_delay_ms";
 
 class Config
 {
@@ -44,10 +94,83 @@ public:
 		return instance;
 	}
 
+public:
+    //-----------------------------------------------------------------------------
+    // Purpose: Pre-hashed, case-insensitive handle for a (section, key) pair.
+    // The hash is computed once (at compile time for static constexpr keys),
+    // so lookups through a Key never allocate or lowercase strings. The names
+    // are kept as views to tell keys apart whose hashes collide; they must
+    // outlive the Key (string literals for static keys).
+    //
+    // Usage:
+    //   static constexpr Config::Key KEY_LOG_LEVEL{ "Logging", "level" };
+    //   std::string_view level = Config::GetInstance().GetString(KEY_LOG_LEVEL, "info");
+    //-----------------------------------------------------------------------------
+    class Key
+    {
+    public:
+        constexpr Key(std::string_view section, std::string_view key) noexcept
+            : m_section(section), m_key(key), m_unHash(HashKey(section, key)) {}
+
+        [[nodiscard]] constexpr uint64 Hash() const noexcept { return m_unHash; }
+        [[nodiscard]] constexpr std::string_view Section() const noexcept { return m_section; }
+        [[nodiscard]] constexpr std::string_view Name() const noexcept { return m_key; }
+
+        // FNV-1a over lowercase(section) '\0' lowercase(key); 0 is reserved for empty table slots
+        static constexpr uint64 HashKey(std::string_view section, std::string_view key) noexcept
+        {
+            uint64 hash = 14695981039346656037ULL;
+            for (char c : section) {
+                hash = (hash ^ static_cast<uint8>(AsciiToLower(c))) * 1099511628211ULL;
+            }
+            hash *= 1099511628211ULL; // separator, so ("ab","c") != ("a","bc")
+            for (char c : key) {
+                hash = (hash ^ static_cast<uint8>(AsciiToLower(c))) * 1099511628211ULL;
+            }
+            return hash ? hash : 1;
+        }
+
+        // Identifier of a section on its own (keys with an empty name are rejected by the parser)
+        static constexpr uint64 HashSection(std::string_view section) noexcept
+        {
+            return HashKey(section, std::string_view());
+        }
+
+    private:
+        static constexpr char AsciiToLower(char c) noexcept
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        std::string_view m_section;
+        std::string_view m_key;
+        uint64 m_unHash;
+    };
+
+    // Change notification handle returned by Subscribe()
+    using SubscriptionId = uint32;
+    using ChangeCallback = std::function<void()>;
+
 public:
     // Configuration loading
     bool LoadConfig(const std::string& filename = DEFAULT_CONFIG_FILENAME);
-    bool IsLoaded() const { return m_bLoaded; }
+    bool IsLoaded() const { return m_bLoaded.load(std::memory_order_acquire); }
+
+    // Hot reload: re-parse the file into a new snapshot and publish it atomically.
+    // Every getter holds a reference to the snapshot it reads, a replaced snapshot
+    // is freed once the last reader is done with it (see GetString(const Key&)).
+    bool Reload();
+    void StartWatching();
+    void StopWatching();
+
+    // Parse a configuration file and write its compiled cache, without loading it.
+    // Used by the vaporcore_config_compile tool to pre-build caches at deploy time.
+    static bool CompileCache(const std::string& filename);
+
+    // Change notification for a set of keys (an empty set means "any key").
+    // Callbacks run on the watcher thread after the new snapshot is published.
+    SubscriptionId Subscribe(const std::vector<Key>& keys, ChangeCallback callback);
+    void Unsubscribe(SubscriptionId id);
     
     // String value getters
     std::string GetString(const std::string& section, const std::string& key, const std::string& defaultValue = "") const;
@@ -69,6 +192,18 @@ public:
     
     // Get all keys in a section
     std::vector<std::string> GetSectionKeys(const std::string& section) const;
+
+    // Interned-key getters: one hash probe, no allocation, typed values parsed once at load.
+    // The view returned by GetString() points into the snapshot current at the call
+    // (or is defaultValue). That snapshot is kept until the configuration has been
+    // reloaded twice more, so copy the value unless it is used right away
+    std::string_view GetString(const Key& key, std::string_view defaultValue = {}) const;
+    bool GetBool(const Key& key, bool defaultValue = false) const;
+    int GetInt(const Key& key, int defaultValue = 0) const;
+    uint32 GetUInt32(const Key& key, uint32 defaultValue = 0) const;
+    uint64 GetUInt64(const Key& key, uint64 defaultValue = 0) const;
+    float GetFloat(const Key& key, float defaultValue = 0.0f) const;
+    bool HasKey(const Key& key) const;
     
     // Direct getters and setters for Steam settings
     [[nodiscard]] const CGameID& GameID() const noexcept { return m_gameId; }
@@ -88,17 +223,136 @@ private:
     Config& operator=(const Config&) = delete;
 
     // Private helper methods
-    std::string Trim(const std::string& str) const;
-    std::string ToLower(const std::string& str) const;
-    bool ParseLine(const std::string& line, std::string& currentSection);
+    static std::string Trim(const std::string& str);
+    static std::string ToLower(const std::string& str);
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Slot of the flat, open-addressed key table (linear probing).
+    // Names and values are views into the snapshot's copies of the source files.
+    //-----------------------------------------------------------------------------
+    struct KeyEntry
+    {
+        // Which typed representations of m_value parsed successfully
+        enum : uint8 {
+            k_EHasInt32  = 1 << 0,
+            k_EHasUInt32 = 1 << 1,
+            k_EHasUInt64 = 1 << 2,
+            k_EHasFloat  = 1 << 3
+        };
+
+        uint64 m_unHash = 0;       // Key::Hash(), 0 marks an empty slot
+        uint64 m_unSectionHash = 0;
+        std::string_view m_section; // As spelled in the file, compared on lookup with m_key
+        std::string_view m_key;    // As spelled in the file
+        std::string_view m_value;  // Trimmed, surrounding quotes removed
+        uint8 m_fTypes = 0;
+        bool m_bBool = false;
+        int32 m_nInt32 = 0;
+        uint32 m_unUInt32 = 0;
+        uint64 m_unUInt64 = 0;
+        float m_flFloat = 0.0f;
+
+        // Same hash and the same names, ignoring case
+        bool Matches(uint64 unOtherHash, std::string_view section, std::string_view key) const noexcept;
+    };
+
+    //-----------------------------------------------------------------------------
+    // Purpose: A file (or !includedir directory) a snapshot was built from, with
+    // the stamp used to decide whether a compiled cache is still current
+    //-----------------------------------------------------------------------------
+    struct SourceFile
+    {
+        std::string m_sPath;
+        bool m_bDirectory = false;
+        int64 m_nModifiedTime = 0;  // file_time_type ticks
+        uint64 m_unSize = 0;
+        uint64 m_unContentHash = 0; // HashBytes64 of the contents, or of the listing for directories
+    };
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Immutable result of one parse. Built privately, then published
+    // through m_pSnapshot and never modified again.
+    //-----------------------------------------------------------------------------
+    struct Snapshot
+    {
+        // Copies of the source files (or of the compiled cache's strings); every
+        // string_view in the table points into these, never into the files themselves
+        std::vector<std::vector<char>> m_buffers;
+
+        // Flat hash table of all keys, capacity is a power of two
+        std::vector<KeyEntry> m_keyTable;
+        uint64 m_unKeyTableMask = 0;
+        size_t m_unKeyCount = 0;
+
+        // Sorted Key::HashSection() of every section seen
+        std::vector<uint64> m_sectionHashes;
+
+        // Files this snapshot was parsed from, includes in first-seen order (watched for changes)
+        std::vector<SourceFile> m_sources;
+
+        void Insert(std::string_view section, uint64 unSectionHash, std::string_view key, std::string_view value);
+        void Finalize();
+        const KeyEntry* FindEntry(uint64 unHash, std::string_view section, std::string_view key) const noexcept;
+        const KeyEntry* FindEntry(const Key& key) const noexcept { return FindEntry(key.Hash(), key.Section(), key.Name()); }
+        bool HasSection(uint64 unSectionHash) const noexcept;
+        bool SameContents(const Snapshot& other) const noexcept;
+
+    private:
+        void Rehash(size_t capacity);
+    };
+
+    struct SubscribedKey
+    {
+        uint64 m_unHash;
+        std::string m_sSection;
+        std::string m_sKey;
+    };
+
+    struct Subscription
+    {
+        SubscriptionId m_id;
+        std::vector<SubscribedKey> m_keys;
+        ChangeCallback m_callback;
+    };
+
+    // Single-pass parser over each source file, read into a buffer the snapshot owns; handles !include and !includedir directives
+    static bool ReadSourceFile(const std::string& path, std::vector<char>& data);
+    static bool ParseSource(const std::string& path, uint32 unDepth, std::vector<std::string>& includeStack, Snapshot& snapshot);
+    static void ParseDirective(std::string_view directive, const std::string& path, size_t lineNumber,
+                               uint32 unDepth, std::vector<std::string>& includeStack, Snapshot& snapshot);
+    static std::vector<std::string> ListIncludeDirectory(const std::string& directory, bool& bSuccess);
+    static std::unique_ptr<Snapshot> ParseFile(const std::string& filename);
+
+    // Compiled cache (vapor_config_cache.cpp): parse only when no current cache exists
+    static std::unique_ptr<Snapshot> LoadSnapshot(const std::string& filename);
+    static std::unique_ptr<Snapshot> LoadCache(const std::string& cachePath, const std::string& filename, bool& bRestamped);
+    static bool WriteCache(const std::string& cachePath, const Snapshot& snapshot);
+    static bool IsSourceCurrent(SourceFile& source, bool& bRestamped);
+    void Publish(std::shared_ptr<const Snapshot> pSnapshot);
+    std::shared_ptr<const Snapshot> CurrentSnapshot() const { return std::atomic_load_explicit(&m_pSnapshot, std::memory_order_acquire); }
+    void NotifySubscribers(const Snapshot& oldSnapshot, const Snapshot& newSnapshot);
+    void WatchThread(uint32 unPollIntervalMs);
 
 private:
     // Configuration file name
     std::string m_sConfigFileName;
-    bool m_bLoaded;
-    
-    // Configuration data storage (section -> key -> value)
-    std::map<std::string, std::map<std::string, std::string>> m_configData;
+    std::atomic<bool> m_bLoaded;
+
+    // Current snapshot (never null), only accessed through std::atomic_load and
+    // friends. The one it replaced is kept for one more reload, so views from
+    // GetString() outlive the reload that retires their snapshot
+    std::shared_ptr<const Snapshot> m_pSnapshot;
+    std::shared_ptr<const Snapshot> m_pRetiredSnapshot;    // Under m_reloadMutex
+    VaporCore::Mutex m_reloadMutex VAPORCORE_MUTEX_NAME("Config::m_reloadMutex");
+
+    // Change subscriptions
+    std::vector<Subscription> m_subscriptions;
+    SubscriptionId m_nextSubscriptionId;
+    VaporCore::Mutex m_subscriptionMutex VAPORCORE_MUTEX_NAME("Config::m_subscriptionMutex");
+
+    // File watcher
+    std::thread m_watchThread;
+    std::atomic<bool> m_bStopWatching;
     
     // Steam settings (loaded once at startup)
     CGameID m_gameId;
@@ -0,0 +1,82 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Deduplicating storage layout on top of the chunk store
+ */
+
+#ifndef VAPORCORE_DEDUP_STORAGE_H
+#define VAPORCORE_DEDUP_STORAGE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <memory>
+#include <steam_api.h>
+
+#include "vapor_storage_backend.h"
+#include "vapor_chunk_store.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Present in a storage directory while its files are deduplicated
+static constexpr const char* DEDUP_MARKER_FILENAME = "storage.vcdedup";
+
+//-----------------------------------------------------------------------------
+// Purpose: Keeps file contents in the shared chunk store and only a manifest
+// in the wrapped layout, so identical saves and assets (across files, and
+// across every storage of the process) take the space of one copy. Small
+// files stay as they are. Everything above sees the original contents and
+// sizes; the wrapped layout only ever sees manifests.
+//-----------------------------------------------------------------------------
+class DedupFileBackend : public StorageBackend
+{
+public:
+    DedupFileBackend(std::unique_ptr<StorageBackend> pInner, std::shared_ptr<ChunkStore> pChunkStore);
+
+    void Enumerate(const EnumerateCallback& callback) override;
+    bool Stat(const std::string& name, uint64& unSize, int64& nTimestamp) override;
+
+    bool Write(const std::string& name, const void* pData, size_t cubData) override;
+    bool Delete(const std::string& name) override;
+    int64 Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax) override;
+
+    bool OpenView(const std::string& name, FileView& view) override;
+
+    bool OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file) override;
+    bool CommitStaged(const std::string& name, StagedFile& file) override;
+
+    void RemoveAll() override;
+
+    // Write every file back to the wrapped layout as plain contents, used when
+    // deduplication is turned off. Returns the number of files rewritten
+    uint32 ExpandAll();
+
+    // Hand back the wrapped layout, the wrapper is unusable afterwards
+    std::unique_ptr<StorageBackend> ReleaseInner();
+
+private:
+    // Manifest stored for a file, false if the file is kept as it is
+    bool LoadManifest(const std::string& name, uint64 unStoredSize, ChunkManifest& manifest);
+    bool LoadManifest(const std::string& name, ChunkManifest& manifest);
+
+    // Logical size of a stored file of unStoredSize bytes
+    bool StatLogical(const std::string& name, uint64 unStoredSize, uint64& unSize);
+
+private:
+    std::unique_ptr<StorageBackend> m_pInner;
+    std::shared_ptr<ChunkStore> m_pChunkStore;
+
+    // Serializes replacing a file's manifest with releasing the previous one
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("DedupFileBackend::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_DEDUP_STORAGE_H
@@ -0,0 +1,51 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Binary delta encoding between file versions
+ */
+
+#ifndef VAPORCORE_DELTA_H
+#define VAPORCORE_DELTA_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <vector>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Describe pTarget as copies of ranges of pBase plus literal bytes.
+// Blocks of the base are indexed by a rolling hash, the target is scanned a
+// byte at a time and every hit is verified and extended in both directions,
+// so data that moved (not just data that stayed in place) is found.
+//-----------------------------------------------------------------------------
+void EncodeDelta(const void* pBase, size_t cubBase, const void* pTarget, size_t cubTarget, std::vector<uint8>& delta);
+
+// Rebuild the target from the base and a delta, false if the delta is corrupt
+// or does not belong to a base of this size
+bool ApplyDelta(const void* pBase, size_t cubBase, const void* pDelta, size_t cubDelta, std::vector<uint8>& target);
+
+//-----------------------------------------------------------------------------
+// Purpose: Block signature of a base (rsync style): a rolling checksum and a
+// strong hash per fixed-size block. A delta for a newer version can then be
+// made from the signature alone, without the base at hand; it copies whole
+// base blocks only, and is applied with ApplyDelta() like any other delta.
+// Signatures hold HashBytes64() values, so they only travel between hosts of
+// the same byte order.
+//-----------------------------------------------------------------------------
+void ComputeSignature(const void* pBase, size_t cubBase, std::vector<uint8>& signature);
+
+// False if the signature is corrupt
+bool EncodeDeltaFromSignature(const void* pSignature, size_t cubSignature, const void* pTarget, size_t cubTarget,
+                              std::vector<uint8>& delta);
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_DELTA_H
@@ -0,0 +1,63 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: VaporCore specific exports beyond the Steamworks API
+ */
+
+#ifndef VAPORCORE_EXTENSIONS_H
+#define VAPORCORE_EXTENSIONS_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <steam_api.h>
+
+// Handle of a read-only remote storage file view, 0 is never valid
+typedef uint64 VaporCoreFileViewHandle_t;
+const VaporCoreFileViewHandle_t k_VaporCoreFileViewHandleInvalid = 0;
+
+//-----------------------------------------------------------------------------
+// Purpose: Zero-copy access to a remote storage file. On success *ppvData and
+// *pcubData describe the whole file, read-only, until the view is released.
+// Later writes or deletes of the file do not affect an open view. On Windows a
+// file cannot be replaced while a view of it is open, so release views promptly.
+//-----------------------------------------------------------------------------
+S_API VaporCoreFileViewHandle_t S_CALLTYPE VaporCore_RemoteStorage_OpenFileView( const char *pchFile, const void **ppvData, uint64 *pcubData );
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_ReleaseFileView( VaporCoreFileViewHandle_t hView );
+
+//-----------------------------------------------------------------------------
+// Purpose: Previous versions of a remote storage file, index 0 being the one
+// the current contents replaced. *pnFileSize is -1 for a version in which the
+// file did not exist (it had been deleted). Restoring writes the old contents
+// back as the current ones, which makes the replaced contents version 0, so a
+// restore can be undone the same way. Versions are kept per [Storage]
+// version_history, 0 disables them.
+//-----------------------------------------------------------------------------
+S_API int32 S_CALLTYPE VaporCore_RemoteStorage_GetFileVersionCount( const char *pchFile );
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_GetFileVersionInfo( const char *pchFile, int32 iVersion, int64 *pnTimestamp, int32 *pnFileSize );
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_RestoreFileVersion( const char *pchFile, int32 iVersion );
+
+//-----------------------------------------------------------------------------
+// Purpose: Names of the remote storage files starting with pchPrefix ("saves/"
+// for everything under that directory, null or "" for all files), normalized
+// and sorted. The names are copied into pchNames one after another, each NUL
+// terminated; a name that does not fit is left out along with all after it.
+// Returns the buffer size needed for every name, so a call with a null buffer
+// asks for the size.
+//-----------------------------------------------------------------------------
+S_API int32 S_CALLTYPE VaporCore_RemoteStorage_ListFiles( const char *pchPrefix, char *pchNames, int32 cchNames );
+
+//-----------------------------------------------------------------------------
+// Purpose: Sync remote storage with the [Cloud] remote_directory now, e.g. at
+// a checkpoint, instead of waiting for shutdown. Blocks until the pass is
+// done. Returns false once cloud sync has shut down; with no remote directory
+// configured, or cloud disabled for the app, the pass does nothing.
+//-----------------------------------------------------------------------------
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_SyncCloud();
+
+#endif // VAPORCORE_EXTENSIONS_H
@@ -0,0 +1,131 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Durable low-level file I/O helpers
+ */
+
+#ifndef VAPORCORE_FILE_IO_H
+#define VAPORCORE_FILE_IO_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+// Suffix of in-progress files written by WriteFileAtomic() and StagedFile; leftovers are crash debris
+static constexpr const char* FILE_IO_TEMP_SUFFIX = ".vctmp";
+
+//-----------------------------------------------------------------------------
+// Purpose: File built up by appends in a temporary location and then swapped
+// into place in one atomic rename. Disk space is reserved ahead of the write
+// position in growing extents (without changing the visible file size), so a
+// long series of small appends neither fragments the file nor re-copies it.
+// Anything not committed is removed when the object goes away.
+//-----------------------------------------------------------------------------
+class StagedFile
+{
+public:
+    StagedFile() noexcept;
+    ~StagedFile();
+
+    StagedFile(const StagedFile&) = delete;
+    StagedFile& operator=(const StagedFile&) = delete;
+
+    // Create (truncate) tempPath, which Commit() later renames over path
+    bool Open(const std::string& path, const std::string& tempPath);
+    bool Append(const void* pData, size_t cubData);
+
+    // Flush the contents to stable storage, then rename; both halves may be called separately.
+    // Without bSync the rename happens unflushed, for callers that sync later themselves
+    bool Sync();
+    bool Commit(bool bSync = true);
+
+    // Close and remove the temporary file
+    void Discard() noexcept;
+
+    [[nodiscard]] bool IsOpen() const noexcept;
+    [[nodiscard]] uint64 Size() const noexcept { return m_unSize; }
+    [[nodiscard]] const std::string& TempPath() const noexcept { return m_sTempPath; }
+
+private:
+    void CloseFile() noexcept;
+
+private:
+    std::string m_sPath;
+    std::string m_sTempPath;
+#ifdef _WIN32
+    void* m_hFile;
+#else
+    int m_fd;
+#endif
+    uint64 m_unSize;
+    uint64 m_unReserved;
+    bool m_bSynced;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: Replace (or create) a file so that readers and crashes only ever
+// observe the old or the complete new contents: write to <path>.vctmp,
+// flush it to stable storage, then atomically rename it over <path>.
+// Without bSync the flush is skipped: the rename is still atomic for readers,
+// but a crash may leave either version (or an empty file) until SyncPath().
+//-----------------------------------------------------------------------------
+bool WriteFileAtomic(const std::string& path, const void* pData, size_t cubData, bool bSync = true);
+
+// Flush a file already written, or on POSIX a directory (making renames and
+// deletes in it durable), to stable storage. A missing path is not an error
+bool SyncPath(const std::string& path);
+
+//-----------------------------------------------------------------------------
+// Purpose: File opened for positioned reads and appends, e.g. a log or a
+// container. Appends are not synchronized with each other, callers serialize
+// them; positioned reads may run concurrently with appends. The file may be
+// renamed or replaced while open.
+//-----------------------------------------------------------------------------
+class RandomAccessFile
+{
+public:
+    RandomAccessFile() noexcept;
+    ~RandomAccessFile();
+
+    RandomAccessFile(const RandomAccessFile&) = delete;
+    RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+    // Open for reading and appending, creating an empty file if bCreate is set
+    bool Open(const std::string& path, bool bCreate);
+    void Close() noexcept;
+
+    // Read exactly cubData bytes at unOffset (false on error or end of file)
+    bool ReadAt(uint64 unOffset, void* pData, size_t cubData) const;
+
+    // Write at the end, returning the offset the data starts at
+    bool Append(const void* pData, size_t cubData, uint64* punOffset = nullptr);
+
+    bool Sync();
+    bool Truncate(uint64 unSize);
+
+    [[nodiscard]] bool IsOpen() const noexcept;
+    [[nodiscard]] uint64 Size() const noexcept { return m_unSize; }
+    [[nodiscard]] const std::string& Path() const noexcept { return m_sPath; }
+
+private:
+    std::string m_sPath;
+#ifdef _WIN32
+    void* m_hFile;
+#else
+    int m_fd;
+#endif
+    uint64 m_unSize;
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_FILE_IO_H
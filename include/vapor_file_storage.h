@@ -16,49 +16,280 @@
 #endif
 
 #include <string>
-#include <map>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <functional>
+#include <condition_variable>
 #include <steam_api.h>
 
+#include "vapor_async_io.h"
+#include "vapor_file_io.h"
+#include "vapor_storage_backend.h"
+#include "vapor_compression.h"
+#include "vapor_version_history.h"
+#include "vapor_write_journal.h"
+#include "vapor_access_profile.h"
+#include "vapor_path_trie.h"
+#include "vapor_lock_profiler.h"
+
 namespace VaporCore {
 
 class FileStorage {
+public:
+    // Per-file state bits kept in the metadata index
+    enum EFileFlags : uint32 {
+        k_EFileFlagNone = 0,
+        k_EFileFlagEncoded = 1 << 0     // Stored behind a StoredFileHeader (usually compressed)
+    };
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Metadata index entry. The index is authoritative: it is built by
+    // one directory scan at construction and then updated on every write and
+    // delete, so queries never touch the file system.
+    //-----------------------------------------------------------------------------
+    struct FileMetadata
+    {
+        uint64 m_unSize = 0;        // Logical size, what the game wrote
+        int64 m_nTimestamp = 0;     // Unix time of the last write
+        uint32 m_fFlags = k_EFileFlagNone;
+    };
+
+    // Read-only view of a file's contents, see OpenFileView()
+    using FileView = VaporCore::FileView;
+
+    // Previous version of a file, see GetFileVersions()
+    using FileVersion = VersionHistory::VersionInfo;
+
+    // Streaming write handle, 0 is never a valid stream
+    typedef uint64 WriteStreamHandle;
+    static const WriteStreamHandle k_hWriteStreamInvalid = 0;
+
 public:
     FileStorage(const std::string& storageDir = "./vaporcore_save");
     ~FileStorage();
 
+    // Storage directory of the configured app and user: [Storage] directory, with
+    // <AppID>/<SteamID> below it unless [Storage] namespace is off. With [Storage]
+    // adopt_legacy_saves, saves left directly in the root by older builds are
+    // moved into the namespace when it is first created
+    static std::string GetUserStorageDirectory();
+
+    const std::string& GetDirectory() const { return m_storageDirectory; }
+
+    // Whether replaced contents are kept, see GetFileVersions()
+    bool HasVersionHistory() const { return m_pHistory != nullptr; }
+
+    // Names as stored: lowercase, forward slashes, no leading separator
+    bool IsValidFilename(const std::string& filename) const;
+    std::string NormalizeFilename(const std::string& filename) const;
+
 public:
     
-    // File operations
+    // File operations. Views share a cached buffer or map the file where the
+    // layout allows it, otherwise they hold a private copy. With [Storage]
+    // prefetch_mb, files are read into memory in the background from the start,
+    // reads of them are served from there
     bool WriteFile(const std::string& filename, const void* data, size_t size);
     int32 ReadFile(const std::string& filename, void* buffer, size_t maxSize);
+    bool OpenFileView(const std::string& filename, FileView& view);
     bool FileExists(const std::string& filename);
     bool DeleteFile(const std::string& filename);
     size_t GetFileSize(const std::string& filename);
     int64 GetFileTimestamp(const std::string& filename);
+
+    // Asynchronous operations, completions run on an AsyncIO thread (or inline when
+    // the data is already in memory, or the write is over quota). False means the
+    // request was rejected and the completion will not run. An asynchronous write is
+    // visible to reads at once.
+    bool WriteFileAsync(const std::string& filename, const void* data, size_t size, std::function<void(EResult eResult)> completion);
+    bool ReadFileAsync(const std::string& filename, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion);
+
+    // Streaming writes. Chunks are appended to a staged temporary file on an
+    // AsyncIO thread; Close waits for them, then renames the file into place, or
+    // re-encodes it where FileWrite would have (compression policy, header-like
+    // contents). Until then the previous contents of the file stay visible. Close
+    // blocks on the AsyncIO pool, so callers must not hold the global lock
+    WriteStreamHandle OpenWriteStream(const std::string& filename);
+    bool WriteStreamChunk(WriteStreamHandle hStream, const void* data, size_t size);
+    bool CloseWriteStream(WriteStreamHandle hStream);
+    bool CancelWriteStream(WriteStreamHandle hStream);
     
-    // Enumeration
+    // Enumeration, in sorted order of the normalized names. Names may contain
+    // subdirectories ("saves/slot1/data.bin")
     int32 GetFileCount();
-    std::string GetFileNameAndSize(int index, int32* pSize = nullptr);
+    const char* GetFileNameAndSize(int index, int32* pSize = nullptr);
+    bool ListFiles(const std::string& prefix, std::vector<std::string>& files);
     
-    // Storage statistics
+    // Storage statistics. Writes that would take the storage past [Storage]
+    // quota_mb or quota_files fail (k_EResultLimitExceeded where a result is
+    // reported); rewriting or deleting files never does
     size_t GetTotalStorageUsed();
     bool GetQuota(uint64* pnTotalBytes, uint64* pnAvailableBytes);
 
+    // Version history ([Storage] version_history), newest first. Restoring writes
+    // the old contents as a new version (or deletes the file if it did not exist
+    // then), so a restore can itself be undone
+    bool GetFileVersions(const std::string& filename, std::vector<FileVersion>& versions);
+    bool RestoreFileVersion(const std::string& filename, uint32 unVersion);
+
+    // Write-back cache: block until every pending write has reached the disk. With
+    // [Storage] journal a write is durable once it returns (or completes), the
+    // files themselves are brought up to date in the background
+    void Flush();
+
+    // Journal syncs so far, 0 without [Storage] journal. Writes that overlap share one
+    uint64 GetJournalSyncCount() const;
+
+    // Flush and stop the background writer, later writes go straight to disk
+    void Shutdown();
+
+    // Shutdown() every live FileStorage (called from SteamAPI_Shutdown)
+    static void ShutdownAll();
+
 private:
     // Utility
     bool EnsureDirectoryExists();
-    bool IsValidFilename(const std::string& filename) const;
-    std::string NormalizeFilename(const std::string& filename) const;
-    std::string GetFullPath(const std::string& filename) const;
-    void CacheFileList();
+    void BuildIndex();
+    static void AdoptLegacySaves(const std::string& root, const std::string& directory);
+
+    // Whether the file may become unSize bytes (callers hold m_mutex)
+    EResult CheckQuota(const std::string& normalized, uint64 unSize) const;
+
+    // Stored file encoding
+    ECompressionCodec GetCompressionPolicy(const std::string& normalized) const;
+    bool StatStored(const std::string& normalized, uint64 unStoredSize, uint64& unSize, uint32& fFlags);
+    bool ReadDecoded(const std::string& normalized, std::vector<uint8>& data);
+    bool ReadContents(const std::string& normalized, uint32 fFlags, std::vector<uint8>& data);
+
+    // Pick the configured layout, migrating saves left in the other one, and
+    // wrap it for deduplication if enabled
+    std::unique_ptr<StorageBackend> CreateBackend();
+    std::unique_ptr<StorageBackend> CreateLayoutBackend();
+    static uint32 MigrateFiles(StorageBackend& from, StorageBackend& to);
+
+    // Index maintenance (callers hold m_mutex)
+    void IndexFile(const std::string& normalized, uint64 unSize, int64 nTimestamp, uint32 fFlags = k_EFileFlagNone);
+    void UnindexFile(const std::string& normalized);
+    void ReindexFromBackend(const std::string& normalized);
+
+    // Backend operations shared by the write-through and write-back paths. Writes
+    // are encoded per the [Compression] policy, fFlags receives how it was stored
+    bool PersistWrite(const std::string& normalized, const void* data, size_t size, uint32& fFlags);
+    bool PersistDelete(const std::string& normalized);
+
+    // Decoded contents of a stored file, about to be replaced, for the version history
+    bool CaptureStored(const std::string& normalized, FileView& view, int64& nTimestamp);
+
+    // Dirty state shared by the write-back cache and asynchronous writes (callers hold m_mutex)
+    void SetDirty(const std::string& normalized, std::shared_ptr<const std::vector<uint8>> pData);
+    bool PersistDirtyEntry(std::unique_lock<VaporCore::Mutex>& lock, const std::string& normalized);
+
+    // Background writer for the write-back cache
+    void FlushThread();
+
+    // Write-ahead journal: replay what a crash left behind, then journal new writes
+    void OpenJournal();
+    bool IsJournaling() const;
+
+    // Cache a write (null data: a delete) and queue its journal record, returning the
+    // position the record ends at (callers hold m_mutex)
+    uint64 JournalDirty(const std::string& normalized, std::shared_ptr<const std::vector<uint8>> pData, uint64& unSequence);
+
+    // Wait for a journaled write to become durable, backing it out if it cannot (without m_mutex)
+    bool WaitForJournal(const std::string& normalized, uint64 unSequence, uint64 unJournalEnd);
+
+    // Drop the journal records already applied to the backend
+    void CheckpointJournal(std::unique_lock<VaporCore::Mutex>& lock);
+
+    // Warm-up prefetch into m_readCache, and dropping a changed file from it (callers hold m_mutex)
+    void PrefetchThread(uint64 cubBudget, bool bByProfile);
+    void EvictCached(const std::string& normalized);
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Write-back cache entry, the latest state of a file that has not
+    // reached the disk yet. Null data is a pending delete, so a delete can never
+    // be overtaken by an older write of the same file. Asynchronous writes use
+    // the same entries, so they are ordered against every other write too.
+    //-----------------------------------------------------------------------------
+    struct DirtyEntry
+    {
+        std::shared_ptr<const std::vector<uint8>> m_pData;
+        uint64 m_unSequence = 0;
+        uint64 m_unJournalStart = 0;    // Journal record of this state, 0 if not journaled.
+        uint64 m_unJournalEnd = 0;      // Only persisted once durable there
+        bool m_bInFlight = false;   // Being persisted, no other thread may write this file
+    };
+
+    //-----------------------------------------------------------------------------
+    // Purpose: Open streaming write. m_file is only touched by the tasks queued
+    // for the stream, which AsyncIO runs one at a time in order.
+    //-----------------------------------------------------------------------------
+    struct WriteStream
+    {
+        std::string m_sNormalized;
+        StagedFile m_file;
+        uint64 m_cubQueued = 0;     // Bytes handed to WriteStreamChunk, under m_mutex
+        std::atomic<bool> m_bFailed{ false };
+    };
 
 private:
     // Storage configuration
     std::string m_storageDirectory;
-    
-    // File indexing for GetFileNameAndSize() - populated by GetFileCount()
-    std::vector<std::string> m_indexToFile;
+    uint64 m_unMmapThreshold;       // Plain files at least this large are read mapped, 0 never
+    uint64 m_unQuotaBytes;          // 0 is unlimited
+    uint64 m_unQuotaFiles;          // 0 is unlimited
+
+    // On-disk layout, every disk access goes through it
+    std::unique_ptr<StorageBackend> m_pBackend;
+
+    // Previous versions of files, null if disabled
+    std::unique_ptr<VersionHistory> m_pHistory;
+
+    // Write-ahead journal, null if disabled; m_flushThread applies it
+    std::unique_ptr<WriteJournal> m_pJournal;
+    uint64 m_unJournalCheckpointBytes;
+    uint64 m_unJournalCheckpoint;   // Position of the last checkpoint
+
+    // Metadata index (normalized name -> metadata) and a running total of its sizes
+    PathTrie<FileMetadata> m_index;
+    uint64 m_unUsedBytes;
+
+    // GetFileNameAndSize() hands out a pointer to this copy, so it survives later writes/deletes
+    std::string m_sEnumeratedName;
+
+    // Write-back cache: dirty files by normalized name, persisted by m_flushThread
+    std::unordered_map<std::string, DirtyEntry> m_dirty;
+    uint64 m_unDirtyBytes;
+    uint64 m_unMaxDirtyBytes;
+    uint64 m_unNextSequence;
+    std::atomic<bool> m_bWriteBack;                 // Also read before taking m_mutex
+    std::thread m_flushThread;
+    bool m_bStopFlushing;
+    std::condition_variable_any m_flushCondition;   // Work queued or stop requested
+    std::condition_variable_any m_cleanCondition;   // Dirty bytes released (backpressure, Flush, async drain)
+
+    // Read cache filled by the warm-up prefetch: decoded contents of clean files by
+    // normalized name, null while being loaded. Any change of a file drops its entry,
+    // so a load racing a write is discarded
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<uint8>>> m_readCache;
+    uint64 m_unCachedBytes;
+    std::thread m_prefetchThread;
+    std::atomic<bool> m_bStopPrefetch;
+
+    // Read frequencies for [Storage] prefetch_order=profile, null unless prefetching
+    std::unique_ptr<AccessProfile> m_pProfile;
+
+    // Asynchronous writes queued on AsyncIO, Shutdown() waits for them
+    uint32 m_unPendingAsync;
+
+    // Open streaming writes by handle
+    std::unordered_map<WriteStreamHandle, std::shared_ptr<WriteStream>> m_streams;
+    WriteStreamHandle m_hNextStream;
+
+    mutable VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("FileStorage::m_mutex");
 };
 
 } // namespace VaporCore
@@ -0,0 +1,120 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Fast non-cryptographic hashing helpers
+ */
+
+#ifndef VAPORCORE_HASH_H
+#define VAPORCORE_HASH_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <cstring>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+// Final avalanche step (splitmix64), spreads every input bit over the whole result
+inline uint64 HashMix64(uint64 value) noexcept
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 64-bit hash of a byte range, processed a word at a time.
+// Meant for change detection and content addressing of local data; the
+// result depends on host byte order and must not be persisted across hosts.
+//-----------------------------------------------------------------------------
+inline uint64 HashBytes64(const void* pData, size_t cubData, uint64 unSeed = 0) noexcept
+{
+    const uint64 k_unMultiplier = 0x9e3779b97f4a7c15ULL;
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+    uint64 hash = unSeed ^ (static_cast<uint64>(cubData) * k_unMultiplier);
+    while (cubData >= sizeof(uint64)) {
+        uint64 word;
+        memcpy(&word, pBytes, sizeof(word));
+        hash = (hash ^ HashMix64(word)) * k_unMultiplier;
+        hash = (hash << 27) | (hash >> 37);
+        pBytes += sizeof(uint64);
+        cubData -= sizeof(uint64);
+    }
+
+    if (cubData > 0) {
+        uint64 word = 0;
+        memcpy(&word, pBytes, cubData);
+        hash = (hash ^ HashMix64(word)) * k_unMultiplier;
+    }
+
+    return HashMix64(hash);
+}
+
+// 128-bit digest, used where collisions must be negligible (content addressing)
+struct Hash128
+{
+    uint64 m_unLow = 0;
+    uint64 m_unHigh = 0;
+
+    bool operator==(const Hash128& other) const noexcept { return m_unLow == other.m_unLow && m_unHigh == other.m_unHigh; }
+    bool operator!=(const Hash128& other) const noexcept { return !(*this == other); }
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: 128-bit hash of a byte range. Four independent 64-bit lanes take
+// 32 bytes per round, so the compiler can keep them in vector registers and
+// the multiplies overlap; the lanes are folded into both halves at the end.
+// Same caveats as HashBytes64: local data only, host byte order.
+//-----------------------------------------------------------------------------
+inline Hash128 HashBytes128(const void* pData, size_t cubData) noexcept
+{
+    const uint64 k_unMultiplier = 0x9e3779b97f4a7c15ULL;
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+    uint64 lanes[4] = {
+        0x243f6a8885a308d3ULL ^ (static_cast<uint64>(cubData) * k_unMultiplier),
+        0x13198a2e03707344ULL,
+        0xa4093822299f31d0ULL,
+        0x082efa98ec4e6c89ULL
+    };
+
+    auto round = [&lanes, k_unMultiplier](const unsigned char* pBlock) {
+        for (int i = 0; i < 4; ++i) {
+            uint64 word;
+            memcpy(&word, pBlock + i * sizeof(uint64), sizeof(word));
+            lanes[i] = (lanes[i] ^ HashMix64(word)) * k_unMultiplier;
+            lanes[i] = (lanes[i] << 27) | (lanes[i] >> 37);
+        }
+    };
+
+    while (cubData >= 4 * sizeof(uint64)) {
+        round(pBytes);
+        pBytes += 4 * sizeof(uint64);
+        cubData -= 4 * sizeof(uint64);
+    }
+
+    if (cubData > 0) {
+        unsigned char tail[4 * sizeof(uint64)] = {};
+        memcpy(tail, pBytes, cubData);
+        round(tail);
+    }
+
+    Hash128 hash;
+    hash.m_unLow = HashMix64(lanes[0] ^ HashMix64(lanes[1] ^ HashMix64(lanes[2] ^ HashMix64(lanes[3]))));
+    hash.m_unHigh = HashMix64(lanes[3] ^ HashMix64(lanes[2] ^ HashMix64(lanes[1] ^ HashMix64(lanes[0] ^ k_unMultiplier))));
+    return hash;
+}
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_HASH_H
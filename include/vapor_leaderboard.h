@@ -0,0 +1,283 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Local leaderboards in memory-mapped columnar files, ranked through an
+ *          order-statistic skip list
+ */
+
+#ifndef VAPORCORE_LEADERBOARD_H
+#define VAPORCORE_LEADERBOARD_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_file_io.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Sorted set of leaderboard positions that also answers "what rank
+// is this key" and "which key has rank k" in O(log n). It is a skip list in
+// which every link also records how many entries it jumps over (its span),
+// so descending from the top level adds up the rank on the way; a page of k
+// entries is a descent to its first row plus k steps along the bottom level.
+//-----------------------------------------------------------------------------
+class LeaderboardIndex
+{
+public:
+    // Position in a board: better scores first, then earlier uploads
+    struct Key
+    {
+        int64 m_nSortScore;         // The score, negated on descending boards
+        uint64 m_unStamp;           // Upload time in microseconds, unique within the board
+        uint64 m_unSteamID;
+
+        bool operator<(const Key& other) const noexcept
+        {
+            if (m_nSortScore != other.m_nSortScore) return m_nSortScore < other.m_nSortScore;
+            if (m_unStamp != other.m_unStamp) return m_unStamp < other.m_unStamp;
+            return m_unSteamID < other.m_unSteamID;
+        }
+        bool operator==(const Key& other) const noexcept
+        {
+            return m_nSortScore == other.m_nSortScore && m_unStamp == other.m_unStamp &&
+                   m_unSteamID == other.m_unSteamID;
+        }
+    };
+
+    LeaderboardIndex();
+    ~LeaderboardIndex();
+
+    LeaderboardIndex(const LeaderboardIndex&) = delete;
+    LeaderboardIndex& operator=(const LeaderboardIndex&) = delete;
+
+    void Insert(const Key& key);
+    bool Erase(const Key& key);
+    void Clear();
+
+    // 1-based rank of the key, 0 if it is not in the index
+    uint32 Rank(const Key& key) const;
+
+    // Keys ordered before the key, which need not be in the index
+    uint32 CountLess(const Key& key) const;
+
+    // Up to cCount keys starting at 1-based rank unRank
+    void Range(uint32 unRank, uint32 cCount, std::vector<Key>& keys) const;
+
+    uint32 Size() const noexcept { return m_cKeys; }
+
+private:
+    static const int MAX_LEVEL = 32;
+
+    struct Node;
+    struct Link
+    {
+        Node* m_pNext;
+        uint32 m_unSpan;            // Entries passed by following this link
+    };
+
+    struct Node
+    {
+        Key m_key;
+        int m_nLevels;
+        Link m_links[1];            // m_nLevels links, allocated with the node
+    };
+
+    static Node* CreateNode(int nLevels, const Key& key);
+    static void FreeNode(Node* pNode) noexcept;
+    int RandomLevel() noexcept;
+
+private:
+    Node* m_pHead;
+    int m_nLevel;
+    uint32 m_cKeys;
+    uint64 m_unRandom;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: The leaderboards of the running game, addressed by the handles the
+// Steam API hands out. Each board lives in
+// <[Stats] directory>/<app_id>/leaderboards/<name hash>.vclb, a file of
+// columns in rank order (score, upload time, Steam ID, UGC handle, details)
+// plus the Steam IDs sorted with their rows. Opening one maps it and checks
+// the header, whatever its size, and a page of rows reads just the part of
+// each column it covers.
+//
+// Uploads do not rewrite the file. The entries changed since it was written
+// stay in memory, ranked by a LeaderboardIndex, and each replaces its old row
+// in the file; ranks and pages merge the two sorted sequences. Every change
+// is also appended to <name hash>.vclog, replayed when the board is opened.
+// Once enough entries piled up, a background thread merges them into a new
+// board file and trims the log down to what changed in the meantime.
+//
+// Downloaded entry sets are kept for GetDownloadedLeaderboardEntry; only the
+// most recent ones are, so games that never read theirs do not pile them up.
+//-----------------------------------------------------------------------------
+class Leaderboards
+{
+public:
+    // One row of a download
+    struct Row
+    {
+        uint64 m_unSteamID = 0;
+        int32 m_nGlobalRank = 0;
+        int32 m_nScore = 0;
+        UGCHandle_t m_hUGC = k_UGCHandleInvalid;
+        std::vector<int32> m_details;
+    };
+
+    struct UploadResult
+    {
+        bool m_bScoreChanged = false;
+        int32 m_nGlobalRankNew = 0;
+        int32 m_nGlobalRankPrevious = 0;
+    };
+
+    Leaderboards();
+    ~Leaderboards();
+
+    Leaderboards(const Leaderboards&) = delete;
+    Leaderboards& operator=(const Leaderboards&) = delete;
+
+    // 0 when there is no such board (or, for FindOrCreate, the name is invalid)
+    SteamLeaderboard_t Find(const char* pchName);
+    SteamLeaderboard_t FindOrCreate(const char* pchName, ELeaderboardSortMethod eSortMethod,
+                                    ELeaderboardDisplayType eDisplayType);
+
+    const char* GetName(SteamLeaderboard_t hLeaderboard);
+    int GetEntryCount(SteamLeaderboard_t hLeaderboard);
+    ELeaderboardSortMethod GetSortMethod(SteamLeaderboard_t hLeaderboard);
+    ELeaderboardDisplayType GetDisplayType(SteamLeaderboard_t hLeaderboard);
+
+    bool Upload(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, ELeaderboardUploadScoreMethod eMethod,
+                int32 nScore, const int32* pDetails, int cDetails, UploadResult& result);
+    bool AttachUGC(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, UGCHandle_t hUGC);
+
+    // Rows by 1-based rank, inclusive; around a user the range is relative to
+    // their rank and shifted to stay inside the board
+    bool GetRange(SteamLeaderboard_t hLeaderboard, int nRankStart, int nRankEnd, std::vector<Row>& rows);
+    bool GetAroundUser(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, int nStart, int nEnd,
+                       std::vector<Row>& rows);
+    bool GetUsers(SteamLeaderboard_t hLeaderboard, const uint64* pSteamIDs, int cUsers, std::vector<Row>& rows);
+
+    // Keep a download for GetDownloadedLeaderboardEntry
+    SteamLeaderboardEntries_t AddDownload(std::vector<Row>&& rows);
+    bool GetDownloadedEntry(SteamLeaderboardEntries_t hEntries, int nIndex, Row& row);
+
+    // Finish a running merge and stop the merge thread; changes still go to
+    // the logs afterwards
+    void Shutdown();
+
+    // Shutdown() every live Leaderboards (called from SteamAPI_Shutdown)
+    static void ShutdownAll();
+
+private:
+    static const uint32 NO_ROW = 0xffffffff;
+
+    // A mapped board file (defined with its layout in the source)
+    struct BoardFile;
+
+    // An entry changed since the board file was written
+    struct Entry
+    {
+        int32 m_nScore = 0;
+        uint64 m_unStamp = 0;
+        UGCHandle_t m_hUGC = k_UGCHandleInvalid;
+        std::vector<int32> m_details;
+        uint32 m_unFileRow = NO_ROW;    // The row it replaces in the board file
+        uint64 m_unVersion = 0;         // Bumped on every change, so merges can tell
+    };
+
+    struct Board
+    {
+        std::string m_sName;
+        std::string m_sPath;            // Board file; the log is next to it
+        ELeaderboardSortMethod m_eSortMethod = k_ELeaderboardSortMethodDescending;
+        ELeaderboardDisplayType m_eDisplayType = k_ELeaderboardDisplayTypeNumeric;
+        uint64 m_unLastStamp = 0;
+        uint64 m_unNextVersion = 1;
+
+        std::shared_ptr<const BoardFile> m_pFile;
+        std::unordered_map<uint64, Entry> m_changed;
+        LeaderboardIndex m_index;       // Keys of m_changed
+        std::vector<uint32> m_replaced; // File rows with an entry in m_changed, sorted
+
+        RandomAccessFile m_log;
+        bool m_bMergeQueued = false;
+    };
+
+    // A changed entry as a merge sees it
+    struct MergeEntry
+    {
+        LeaderboardIndex::Key m_key;
+        Entry m_entry;
+    };
+
+    struct Download
+    {
+        SteamLeaderboardEntries_t m_hEntries;
+        std::vector<Row> m_rows;
+    };
+
+    Board* GetBoard(SteamLeaderboard_t hLeaderboard);
+    SteamLeaderboard_t OpenBoard(const std::string& name, bool bCreate, ELeaderboardSortMethod eSortMethod,
+                                 ELeaderboardDisplayType eDisplayType);
+    bool ReplayLog(Board& board);
+
+    static LeaderboardIndex::Key MakeKey(const Board& board, uint64 unSteamID, int32 nScore, uint64 unStamp);
+    static LeaderboardIndex::Key MakeFileKey(const Board& board, const BoardFile& file, uint32 unRow);
+    static bool IsBetter(const Board& board, int32 nScore, int32 nCurrent);
+
+    // Ranks over the board file and the changed entries together
+    static uint32 GetCount(const Board& board);
+    static uint32 CountFileRowsBefore(const Board& board, const LeaderboardIndex::Key& key);
+    static uint32 GetRank(const Board& board, uint64 unSteamID);
+    static bool GetRow(const Board& board, uint64 unSteamID, Row& row);
+    static void AppendRows(const Board& board, uint32 unRank, uint32 cCount, std::vector<Row>& rows);
+
+    // The changed entry of a user, taken out of the index until the caller
+    // puts its new key back; created from their file row if needed
+    Entry* EditEntry(Board& board, uint64 unSteamID, bool bCreate);
+    void CommitEntry(Board& board, uint64 unSteamID, Entry& entry);
+
+    // Board file and log writers
+    static bool WriteBoardFile(const Board& board, uint64 unLastStamp, const BoardFile* pFile,
+                               const std::vector<uint32>& replaced, const std::vector<MergeEntry>& changed);
+    static void EncodeLogRecord(uint64 unSteamID, const Entry& entry, std::vector<uint8>& data);
+    bool RewriteLog(Board& board);
+
+    void MergeThread();
+    bool MergeBoard(Board& board, std::unique_lock<VaporCore::Mutex>& lock);
+
+private:
+    std::vector<std::unique_ptr<Board>> m_boards;       // Handle - 1
+    std::unordered_map<std::string, SteamLeaderboard_t> m_names;
+    std::deque<Download> m_downloads;
+    SteamLeaderboardEntries_t m_hNextEntries;
+
+    std::thread m_mergeThread;
+    std::deque<Board*> m_mergeQueue;
+    bool m_bStop;
+    std::condition_variable_any m_mergeCondition;
+
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("Leaderboards::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_LEADERBOARD_H
@@ -0,0 +1,210 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Instrumented mutex wrapper and lock contention profiler
+ */
+
+#ifndef VAPORCORE_LOCK_PROFILER_H
+#define VAPORCORE_LOCK_PROFILER_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+#include <steam_api.h>
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Point-in-time counters for one profiled mutex
+//-----------------------------------------------------------------------------
+struct LockStats
+{
+    std::string m_sName;                 // Name given to the mutex at construction
+    uint64 m_unAcquisitions;             // Outermost lock() calls that succeeded
+    uint64 m_unContendedAcquisitions;    // Acquisitions that had to wait for another owner
+    uint64 m_unTotalWaitNs;              // Total time spent waiting on contended acquisitions
+    uint64 m_unMaxHoldNs;                // Longest time the mutex was held in one go
+    std::string m_sMaxHoldSite;          // Call site ("file:line") responsible for m_unMaxHoldNs
+};
+
+#ifdef VAPORCORE_ENABLE_LOCK_PROFILING
+
+//-----------------------------------------------------------------------------
+// Purpose: Non-template part of ProfiledMutex. All counters are only written
+// while the underlying mutex is held, so writers never race; they are atomics
+// purely so that LockProfiler can read them from another thread.
+//-----------------------------------------------------------------------------
+class ProfiledMutexBase
+{
+public:
+    explicit ProfiledMutexBase(const char* pchName);
+    ~ProfiledMutexBase();
+
+    ProfiledMutexBase(const ProfiledMutexBase&) = delete;
+    ProfiledMutexBase& operator=(const ProfiledMutexBase&) = delete;
+
+    LockStats GetStats() const;
+    void ResetStats();
+
+protected:
+    void OnAcquired(std::chrono::steady_clock::duration wait, bool bContended, const char* pchSite);
+    void OnReleasing();
+
+private:
+    const char* m_pchName;
+
+    std::atomic<uint64> m_unAcquisitions;
+    std::atomic<uint64> m_unContendedAcquisitions;
+    std::atomic<uint64> m_unTotalWaitNs;
+    std::atomic<uint64> m_unMaxHoldNs;
+    std::atomic<const char*> m_pchMaxHoldSite;
+
+    // Owner-only state (touched exclusively by the thread holding the mutex)
+    uint32 m_unDepth;
+    std::chrono::steady_clock::time_point m_acquiredAt;
+    const char* m_pchCurrentSite;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: Drop-in replacement for std::mutex / std::recursive_mutex that
+// records acquisitions, contention, wait time and the longest hold.
+// Re-entrant acquisitions of a recursive mutex are folded into the outermost one.
+//-----------------------------------------------------------------------------
+template<typename MutexType>
+class ProfiledMutex : public ProfiledMutexBase
+{
+public:
+    explicit ProfiledMutex(const char* pchName = "unnamed") : ProfiledMutexBase(pchName) {}
+
+    void lock() { lock(nullptr); }
+
+    void lock(const char* pchSite)
+    {
+        if (m_mutex.try_lock()) {
+            OnAcquired(std::chrono::steady_clock::duration::zero(), false, pchSite);
+            return;
+        }
+
+        auto waitStart = std::chrono::steady_clock::now();
+        m_mutex.lock();
+        OnAcquired(std::chrono::steady_clock::now() - waitStart, true, pchSite);
+    }
+
+    bool try_lock(const char* pchSite = nullptr)
+    {
+        if (!m_mutex.try_lock()) {
+            return false;
+        }
+        OnAcquired(std::chrono::steady_clock::duration::zero(), false, pchSite);
+        return true;
+    }
+
+    void unlock()
+    {
+        OnReleasing();
+        m_mutex.unlock();
+    }
+
+private:
+    MutexType m_mutex;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: lock_guard equivalent that passes the call site to ProfiledMutex
+//-----------------------------------------------------------------------------
+template<typename MutexType>
+class ProfiledLockGuard
+{
+public:
+    ProfiledLockGuard(MutexType& mutex, const char* pchSite) : m_mutex(mutex) { m_mutex.lock(pchSite); }
+    ~ProfiledLockGuard() { m_mutex.unlock(); }
+
+    ProfiledLockGuard(const ProfiledLockGuard&) = delete;
+    ProfiledLockGuard& operator=(const ProfiledLockGuard&) = delete;
+
+private:
+    MutexType& m_mutex;
+};
+
+using Mutex = ProfiledMutex<std::mutex>;
+using RecursiveMutex = ProfiledMutex<std::recursive_mutex>;
+
+#define VAPORCORE_LOCK_STRINGIFY_IMPL(x) #x
+#define VAPORCORE_LOCK_STRINGIFY(x) VAPORCORE_LOCK_STRINGIFY_IMPL(x)
+#define VAPORCORE_LOCK_SITE __FILE__ ":" VAPORCORE_LOCK_STRINGIFY(__LINE__)
+
+// Mutex declaration helper: VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("Subsystem");
+#define VAPORCORE_MUTEX_NAME(name) { name }
+
+// Scoped lock that records the call site when profiling is enabled
+#define VAPORCORE_SCOPED_LOCK(mutex) \
+    VaporCore::ProfiledLockGuard<std::remove_reference_t<decltype(mutex)>> lock(mutex, VAPORCORE_LOCK_SITE)
+
+#else
+
+// Profiling disabled: the wrappers are the plain standard mutexes
+using Mutex = std::mutex;
+using RecursiveMutex = std::recursive_mutex;
+
+#define VAPORCORE_MUTEX_NAME(name)
+#define VAPORCORE_SCOPED_LOCK(mutex) \
+    std::lock_guard<std::remove_reference_t<decltype(mutex)>> lock(mutex)
+
+#endif // VAPORCORE_ENABLE_LOCK_PROFILING
+
+//-----------------------------------------------------------------------------
+// Purpose: Registry of every live ProfiledMutex. Provides a metrics snapshot
+// and a human-readable report (logged at SteamAPI_Shutdown).
+// Both calls are cheap no-ops when profiling is compiled out.
+//-----------------------------------------------------------------------------
+class LockProfiler
+{
+public:
+    // Singleton accessor
+    static LockProfiler& GetInstance()
+    {
+        static LockProfiler instance;
+        return instance;
+    }
+
+public:
+    std::vector<LockStats> GetSnapshot() const;
+    void LogReport() const;
+    void Reset();
+
+#ifdef VAPORCORE_ENABLE_LOCK_PROFILING
+    void Register(ProfiledMutexBase* pMutex);
+    void Unregister(ProfiledMutexBase* pMutex);
+#endif
+
+private:
+    LockProfiler() = default;
+    ~LockProfiler() = default;
+
+    // Delete copy constructor and assignment operator
+    LockProfiler(const LockProfiler&) = delete;
+    LockProfiler& operator=(const LockProfiler&) = delete;
+
+#ifdef VAPORCORE_ENABLE_LOCK_PROFILING
+private:
+    // Plain mutex on purpose: the registry must never profile itself
+    mutable std::mutex m_registryMutex;
+    std::vector<ProfiledMutexBase*> m_mutexes;
+#endif
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_LOCK_PROFILER_H
@@ -0,0 +1,68 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Read-only memory-mapped file view
+ */
+
+#ifndef VAPORCORE_MAPPED_FILE_H
+#define VAPORCORE_MAPPED_FILE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <string_view>
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: RAII wrapper around a read-only mapping of a whole file.
+// The underlying file handle is released as soon as the view exists, so an
+// open MappedFile only costs address space. Empty files open successfully
+// with a null Data() and zero Size().
+//-----------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    // Access pattern hints forwarded to madvise (ignored where unsupported)
+    enum class AccessPattern {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    MappedFile() noexcept;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Move-only: a mapping has exactly one owner
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close() noexcept;
+
+    [[nodiscard]] bool IsOpen() const noexcept { return m_bOpen; }
+    [[nodiscard]] const char* Data() const noexcept { return m_pData; }
+    [[nodiscard]] size_t Size() const noexcept { return m_unSize; }
+    [[nodiscard]] std::string_view View() const noexcept { return std::string_view(m_pData, m_unSize); }
+
+    void Advise(AccessPattern pattern) const noexcept;
+
+private:
+    const char* m_pData;
+    size_t m_unSize;
+    bool m_bOpen;
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_MAPPED_FILE_H
@@ -0,0 +1,124 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Packed, log-structured storage layout
+ */
+
+#ifndef VAPORCORE_PACKED_STORAGE_H
+#define VAPORCORE_PACKED_STORAGE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_storage_backend.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Name of the container inside the storage directory
+static constexpr const char* PACKED_CONTAINER_FILENAME = "storage.vcpack";
+
+//-----------------------------------------------------------------------------
+// Purpose: All files of a storage directory in one append-only container.
+// Every write appends a checksummed record and every delete a tombstone, so
+// a save costs one append + sync instead of a file create/rename. Opening
+// the container replays it into an in-memory index and cuts off a torn tail
+// left by a crash. Once superseded records make up more than the configured
+// share of the container, a background thread copies the live records into
+// a fresh container and swaps it in; writes continue meanwhile.
+//-----------------------------------------------------------------------------
+class PackedFileBackend : public StorageBackend
+{
+public:
+    PackedFileBackend(const std::string& directory, uint32 unCompactGarbagePercent);
+    ~PackedFileBackend() override;
+
+    // Open or create the container, false if it cannot be used
+    bool Open();
+
+    // True if the directory holds a container (used to migrate away from it)
+    static bool Exists(const std::string& directory);
+
+    void Enumerate(const EnumerateCallback& callback) override;
+    bool Stat(const std::string& name, uint64& unSize, int64& nTimestamp) override;
+
+    bool Write(const std::string& name, const void* pData, size_t cubData) override;
+    bool Delete(const std::string& name) override;
+    int64 Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax) override;
+
+    bool OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file) override;
+    bool CommitStaged(const std::string& name, StagedFile& file) override;
+
+    void RemoveAll() override;
+
+    void SetDeferSync(bool bDefer) override;
+    bool Sync() override;
+
+private:
+    // Location of a live record in the current container
+    struct IndexEntry
+    {
+        uint64 m_unRecordOffset = 0;
+        uint64 m_unDataOffset = 0;
+        uint64 m_unSize = 0;
+        int64 m_nTimestamp = 0;
+    };
+
+    using Index = std::unordered_map<std::string, IndexEntry>;
+
+    // Replay the container into m_index, truncating anything after the last valid record
+    bool Load();
+
+    // Append one record and sync unless deferred (callers hold m_mutex)
+    bool AppendRecord(RandomAccessFile& file, uint32 unType, const std::string& name,
+                      const void* pData, size_t cubData, int64 nTimestamp, IndexEntry* pEntry);
+
+    // Copy a record verbatim from one container to another
+    static bool CopyRecord(const RandomAccessFile& from, const IndexEntry& entry, const std::string& name,
+                           RandomAccessFile& to, IndexEntry& copied);
+
+    static uint64 RecordSize(const std::string& name, uint64 unDataSize);
+
+    bool NeedsCompaction() const;
+    void CompactionThread();
+    void Compact();
+
+private:
+    std::string m_sDirectory;
+    std::string m_sContainerPath;
+
+    // Current container, replaced as a whole by compaction. Readers take a reference
+    // so they can finish on the old file after a swap
+    std::shared_ptr<RandomAccessFile> m_pFile;
+    Index m_index;
+
+    // Bytes of superseded records and tombstones, reclaimed by compaction
+    uint64 m_unGarbageBytes;
+    uint32 m_unCompactGarbagePercent;
+
+    // Records are appended without a flush until Sync()
+    bool m_bDeferSync;
+
+    std::thread m_compactionThread;
+    bool m_bStopCompaction;
+    bool m_bCompacting;
+    std::condition_variable_any m_compactionCondition;
+
+    mutable VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("PackedFileBackend::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_PACKED_STORAGE_H
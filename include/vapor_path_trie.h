@@ -0,0 +1,330 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Radix tree over normalized file names
+ */
+
+#ifndef VAPORCORE_PATH_TRIE_H
+#define VAPORCORE_PATH_TRIE_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Radix tree (compressed trie) mapping names to values. Keys are
+// compared byte for byte, so callers pass normalized (lowercased) names to
+// get case-insensitive lookups. Keys come out in sorted order, every key
+// under a prefix is one subtree, and each node counts the values below it,
+// so the n-th key is found without walking the keys before it; stepping to
+// the next index from the previous one is O(1) amortized.
+//-----------------------------------------------------------------------------
+template <typename T>
+class PathTrie
+{
+public:
+    using Callback = std::function<void(const std::string& key, const T& value)>;
+
+    PathTrie() : m_pRoot(std::make_unique<Node>()) {}
+
+    size_t Size() const { return m_pRoot->m_cValues; }
+
+    T* Find(const std::string& key)
+    {
+        Node* pNode = FindNode(key);
+        return pNode && pNode->m_bHasValue ? &pNode->m_value : nullptr;
+    }
+
+    const T* Find(const std::string& key) const
+    {
+        return const_cast<PathTrie*>(this)->Find(key);
+    }
+
+    // Value for the key, default constructed if it was not there; second is true if inserted
+    std::pair<T*, bool> Emplace(const std::string& key)
+    {
+        Node* pNode = m_pRoot.get();
+        size_t unPos = 0;
+        while (unPos < key.size()) {
+            auto it = FindChild(pNode, key[unPos]);
+            if (it == pNode->m_children.end() || (*it)->m_sLabel[0] != key[unPos]) {
+                // Nothing shares the next byte: a new leaf with the rest of the key
+                auto pLeaf = std::make_unique<Node>();
+                pLeaf->m_sLabel = key.substr(unPos);
+                pLeaf->m_pParent = pNode;
+                pNode = pNode->m_children.insert(it, std::move(pLeaf))->get();
+                unPos = key.size();
+                break;
+            }
+
+            Node* pChild = it->get();
+            size_t cchCommon = 0;
+            while (cchCommon < pChild->m_sLabel.size() && unPos + cchCommon < key.size() &&
+                   pChild->m_sLabel[cchCommon] == key[unPos + cchCommon]) {
+                ++cchCommon;
+            }
+
+            if (cchCommon < pChild->m_sLabel.size()) {
+                // The key leaves the label part way: split it at that point
+                auto pSplit = std::make_unique<Node>();
+                pSplit->m_sLabel = pChild->m_sLabel.substr(0, cchCommon);
+                pSplit->m_pParent = pNode;
+                pSplit->m_cValues = pChild->m_cValues;
+                pChild->m_sLabel.erase(0, cchCommon);
+                pChild->m_pParent = pSplit.get();
+                pSplit->m_children.push_back(std::move(*it));
+                *it = std::move(pSplit);
+                pChild = it->get();
+            }
+
+            pNode = pChild;
+            unPos += cchCommon;
+        }
+
+        if (pNode->m_bHasValue) {
+            return { &pNode->m_value, false };
+        }
+
+        pNode->m_bHasValue = true;
+        pNode->m_value = T();
+        for (Node* pCounted = pNode; pCounted; pCounted = pCounted->m_pParent) {
+            ++pCounted->m_cValues;
+        }
+        m_pCursor = nullptr;
+        return { &pNode->m_value, true };
+    }
+
+    bool Erase(const std::string& key)
+    {
+        Node* pNode = FindNode(key);
+        if (!pNode || !pNode->m_bHasValue) {
+            return false;
+        }
+
+        pNode->m_bHasValue = false;
+        pNode->m_value = T();
+        for (Node* pCounted = pNode; pCounted; pCounted = pCounted->m_pParent) {
+            --pCounted->m_cValues;
+        }
+        m_pCursor = nullptr;
+
+        // Drop the node if it is empty now, then keep the tree compressed
+        Node* pParent = pNode->m_pParent;
+        if (pNode->m_children.empty() && pParent) {
+            RemoveChild(pParent, pNode);
+            pNode = pParent;
+        }
+        Compress(pNode);
+        return true;
+    }
+
+    void Clear()
+    {
+        m_pRoot = std::make_unique<Node>();
+        m_pCursor = nullptr;
+    }
+
+    // Key and value at a position in sorted order, null past the end
+    const T* At(size_t unIndex, std::string& key)
+    {
+        if (unIndex >= Size()) {
+            return nullptr;
+        }
+
+        if (m_pCursor && unIndex == m_unCursorIndex + 1) {
+            m_pCursor = Next(m_pCursor);
+        } else if (!m_pCursor || unIndex != m_unCursorIndex) {
+            m_pCursor = Select(unIndex);
+        }
+        m_unCursorIndex = unIndex;
+
+        key = KeyOf(m_pCursor);
+        return &m_pCursor->m_value;
+    }
+
+    // Every key starting with the prefix, in sorted order
+    void ForEachWithPrefix(const std::string& prefix, const Callback& callback) const
+    {
+        const Node* pNode = m_pRoot.get();
+        std::string key;
+        size_t unPos = 0;
+        while (unPos < prefix.size()) {
+            auto it = FindChild(const_cast<Node*>(pNode), prefix[unPos]);
+            if (it == pNode->m_children.end() || (*it)->m_sLabel[0] != prefix[unPos]) {
+                return;
+            }
+
+            // The prefix may end inside the label, the rest of the label must still match
+            const Node* pChild = it->get();
+            size_t cchCompare = std::min(pChild->m_sLabel.size(), prefix.size() - unPos);
+            if (prefix.compare(unPos, cchCompare, pChild->m_sLabel, 0, cchCompare) != 0) {
+                return;
+            }
+
+            key += pChild->m_sLabel;
+            unPos += pChild->m_sLabel.size();
+            pNode = pChild;
+        }
+
+        Visit(pNode, key, callback);
+    }
+
+private:
+    struct Node
+    {
+        std::string m_sLabel;                           // Bytes on the edge from the parent
+        std::vector<std::unique_ptr<Node>> m_children;  // Sorted by the first byte of their label
+        Node* m_pParent = nullptr;
+        size_t m_cValues = 0;                           // Values in this subtree, this node included
+        bool m_bHasValue = false;
+        T m_value = T();
+    };
+
+    using Children = std::vector<std::unique_ptr<Node>>;
+
+    static typename Children::iterator FindChild(Node* pNode, char ch)
+    {
+        return std::lower_bound(pNode->m_children.begin(), pNode->m_children.end(), ch,
+            [](const std::unique_ptr<Node>& pChild, char value) {
+                return static_cast<unsigned char>(pChild->m_sLabel[0]) < static_cast<unsigned char>(value);
+            });
+    }
+
+    Node* FindNode(const std::string& key) const
+    {
+        Node* pNode = m_pRoot.get();
+        size_t unPos = 0;
+        while (unPos < key.size()) {
+            auto it = FindChild(pNode, key[unPos]);
+            if (it == pNode->m_children.end() || key.compare(unPos, (*it)->m_sLabel.size(), (*it)->m_sLabel) != 0) {
+                return nullptr;
+            }
+            unPos += (*it)->m_sLabel.size();
+            pNode = it->get();
+        }
+        return pNode;
+    }
+
+    static void RemoveChild(Node* pParent, Node* pChild)
+    {
+        auto it = FindChild(pParent, pChild->m_sLabel[0]);
+        pParent->m_children.erase(it);
+    }
+
+    // Merge a valueless node with its only child (never the root)
+    static void Compress(Node* pNode)
+    {
+        if (!pNode->m_pParent || pNode->m_bHasValue || pNode->m_children.size() != 1) {
+            return;
+        }
+
+        std::unique_ptr<Node> pChild = std::move(pNode->m_children.front());
+        pNode->m_children.clear();
+        pNode->m_sLabel += pChild->m_sLabel;
+        pNode->m_bHasValue = pChild->m_bHasValue;
+        pNode->m_value = std::move(pChild->m_value);
+        pNode->m_children = std::move(pChild->m_children);
+        for (auto& pGrandchild : pNode->m_children) {
+            pGrandchild->m_pParent = pNode;
+        }
+    }
+
+    // Descend by subtree counts; values come before the subtrees below them
+    Node* Select(size_t unIndex) const
+    {
+        Node* pNode = m_pRoot.get();
+        for (;;) {
+            if (pNode->m_bHasValue) {
+                if (unIndex == 0) {
+                    return pNode;
+                }
+                --unIndex;
+            }
+            for (auto& pChild : pNode->m_children) {
+                if (unIndex < pChild->m_cValues) {
+                    pNode = pChild.get();
+                    break;
+                }
+                unIndex -= pChild->m_cValues;
+            }
+        }
+    }
+
+    static Node* FirstValue(Node* pNode)
+    {
+        while (!pNode->m_bHasValue) {
+            pNode = pNode->m_children.front().get();
+        }
+        return pNode;
+    }
+
+    // Next value in sorted order, null after the last
+    static Node* Next(Node* pNode)
+    {
+        if (!pNode->m_children.empty()) {
+            return FirstValue(pNode->m_children.front().get());
+        }
+
+        while (Node* pParent = pNode->m_pParent) {
+            auto it = FindChild(pParent, pNode->m_sLabel[0]);
+            if (++it != pParent->m_children.end()) {
+                return FirstValue(it->get());
+            }
+            pNode = pParent;
+        }
+        return nullptr;
+    }
+
+    static std::string KeyOf(const Node* pNode)
+    {
+        std::vector<const std::string*> labels;
+        size_t cchKey = 0;
+        for (; pNode->m_pParent; pNode = pNode->m_pParent) {
+            labels.push_back(&pNode->m_sLabel);
+            cchKey += pNode->m_sLabel.size();
+        }
+
+        std::string key;
+        key.reserve(cchKey);
+        for (auto it = labels.rbegin(); it != labels.rend(); ++it) {
+            key += **it;
+        }
+        return key;
+    }
+
+    static void Visit(const Node* pNode, std::string& key, const Callback& callback)
+    {
+        if (pNode->m_bHasValue) {
+            callback(key, pNode->m_value);
+        }
+        for (const auto& pChild : pNode->m_children) {
+            key += pChild->m_sLabel;
+            Visit(pChild.get(), key, callback);
+            key.resize(key.size() - pChild->m_sLabel.size());
+        }
+    }
+
+private:
+    std::unique_ptr<Node> m_pRoot;
+
+    // Last position handed out by At(), for sequential enumeration
+    Node* m_pCursor = nullptr;
+    size_t m_unCursorIndex = 0;
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_PATH_TRIE_H
@@ -0,0 +1,66 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Perfect hash index over a fixed set of names
+ */
+
+#ifndef VAPORCORE_PERFECT_HASH_H
+#define VAPORCORE_PERFECT_HASH_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <steam_api.h>
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Maps each name of a set fixed at build time to its position in
+// that set, with no collisions (hash and displace). Names are hashed into
+// buckets of a few names each, and every bucket gets a seed, found at build
+// time, that sends its names to slots no other bucket uses. A lookup is one
+// hash of the name, one seed and one slot read, then a compare with the name
+// stored there to turn away names that are not in the set.
+//-----------------------------------------------------------------------------
+class PerfectHashIndex
+{
+public:
+    static constexpr uint32 NOT_FOUND = 0xFFFFFFFFu;
+
+    // Index the names, Find() returns the position in the vector. Fails on duplicates
+    bool Build(const std::vector<std::string>& names);
+    void Clear();
+
+    uint32 Find(std::string_view name) const noexcept;
+
+    uint32 Size() const noexcept { return static_cast<uint32>(m_names.size()); }
+
+private:
+    bool TryBuild(uint64 unSalt);
+
+    uint32 BucketOf(uint64 unHash) const noexcept
+    {
+        return static_cast<uint32>(unHash % m_seeds.size());
+    }
+
+    uint32 SlotOf(uint64 unHash, uint32 unSeed) const noexcept;
+
+private:
+    std::vector<std::string> m_names;
+    uint64 m_unSalt = 0;                // Hash seed, changed when a build attempt fails
+    std::vector<uint32> m_seeds;        // Displacement per bucket
+    std::vector<uint32> m_slotIndexes;  // Position of the name in each slot, NOT_FOUND if free
+    std::vector<uint64> m_slotHashes;   // Its hash, so most misses skip the compare
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_PERFECT_HASH_H
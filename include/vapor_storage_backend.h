@@ -0,0 +1,134 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: On-disk layouts behind FileStorage
+ */
+
+#ifndef VAPORCORE_STORAGE_BACKEND_H
+#define VAPORCORE_STORAGE_BACKEND_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <set>
+#include <steam_api.h>
+
+#include "vapor_async_io.h"
+#include "vapor_file_io.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Purpose: Read-only view of a file's contents. Depending on the layout it
+// is a memory mapping or a buffer of its own; either way it keeps showing the
+// contents it was opened on until the last copy of m_pOwner is released,
+// whatever happens to the file meanwhile.
+//-----------------------------------------------------------------------------
+struct FileView
+{
+    const uint8* m_pData = nullptr;
+    size_t m_cubData = 0;
+    std::shared_ptr<const void> m_pOwner;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: Storage layout interface. Names are normalized by FileStorage
+// before they get here; sizes are the stored sizes. Implementations are
+// thread-safe, FileStorage calls them with and without its own lock held.
+//-----------------------------------------------------------------------------
+class StorageBackend
+{
+public:
+    using EnumerateCallback = std::function<void(const std::string& name, uint64 unSize, int64 nTimestamp)>;
+
+    virtual ~StorageBackend() = default;
+
+    virtual void Enumerate(const EnumerateCallback& callback) = 0;
+    virtual bool Stat(const std::string& name, uint64& unSize, int64& nTimestamp) = 0;
+
+    // Replace the whole file; durable once this returns true
+    virtual bool Write(const std::string& name, const void* pData, size_t cubData) = 0;
+    virtual bool Delete(const std::string& name) = 0;
+
+    // Read up to cubMax bytes at unOffset, returns the number of bytes read or -1
+    virtual int64 Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax) = 0;
+
+    // Defaults build on Read(): a private copy, and a blocking read on the AsyncIO pool
+    virtual bool OpenView(const std::string& name, FileView& view);
+    virtual void ReadAsync(const std::string& name, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion);
+
+    // Streaming writes: stage into a temporary file, then make it the named file
+    virtual bool OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file) = 0;
+    virtual bool CommitStaged(const std::string& name, StagedFile& file) = 0;
+
+    // Drop every file, used once they have been migrated to another layout
+    virtual void RemoveAll() = 0;
+
+    // Deferred sync, for callers keeping a write-ahead journal of their own: Write()
+    // and Delete() stop flushing to stable storage, Sync() makes everything done so
+    // far durable at once. Layouts that cannot defer safely keep syncing each write
+    virtual void SetDeferSync(bool /*bDefer*/) {}
+    virtual bool Sync() { return true; }
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: One regular file per save in the storage directory, replaced by
+// atomic rename. Names with '/' live in subdirectories, created on write and
+// removed again when their last file is deleted. Files at least
+// m_unMmapThreshold bytes (0: never) are read through a memory mapping.
+//-----------------------------------------------------------------------------
+class PlainFileBackend : public StorageBackend
+{
+public:
+    PlainFileBackend(const std::string& directory, uint64 unMmapThreshold);
+
+    void Enumerate(const EnumerateCallback& callback) override;
+    bool Stat(const std::string& name, uint64& unSize, int64& nTimestamp) override;
+
+    bool Write(const std::string& name, const void* pData, size_t cubData) override;
+    bool Delete(const std::string& name) override;
+    int64 Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax) override;
+
+    bool OpenView(const std::string& name, FileView& view) override;
+    void ReadAsync(const std::string& name, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion) override;
+
+    bool OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file) override;
+    bool CommitStaged(const std::string& name, StagedFile& file) override;
+
+    void RemoveAll() override;
+
+    void SetDeferSync(bool bDefer) override;
+    bool Sync() override;
+
+private:
+    std::string GetFullPath(const std::string& name) const;
+    bool CreateParentDirectories(const std::string& name) const;
+    void RemoveEmptyParentDirectories(const std::string& name) const;
+
+    // Deferred sync: remember a file or directory Sync() has to flush
+    void AddUnsynced(const std::string& path);
+
+private:
+    std::string m_sDirectory;
+    uint64 m_unMmapThreshold;
+
+    // Files and directories changed without a flush since the last Sync()
+    std::atomic<bool> m_bDeferSync;
+    std::set<std::string> m_unsyncedPaths;
+    VaporCore::Mutex m_syncMutex VAPORCORE_MUTEX_NAME("PlainFileBackend::m_syncMutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_STORAGE_BACKEND_H
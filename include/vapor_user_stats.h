@@ -0,0 +1,185 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Stats and achievements of the current user, defined by a schema file
+ */
+
+#ifndef VAPORCORE_USER_STATS_H
+#define VAPORCORE_USER_STATS_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_perfect_hash.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Stat types as the schema names them (int, float, avgrate)
+enum EStatType : uint8
+{
+    k_EStatTypeInt,
+    k_EStatTypeFloat,
+    k_EStatTypeAvgRate      // Float, updated as a running count over time
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: The user's stats and achievements. Their definitions come from a
+// schema file ([Stats] schema), read once at the first RequestCurrentStats:
+//
+//   [stat NumWins]              [achievement ACH_WIN_ONE_GAME]
+//   type=int                    name=Winner
+//   min=0                       desc=Win one game
+//   max=1000                    name_french=Gagnant
+//   increment_only=true         hidden=0
+//
+// Names go into a perfect hash index and values into flat arrays by type, so
+// a lookup by name is one hash and one array read, and achievements are
+// addressed by position for GetNumAchievements/GetAchievementName. The schema
+// never changes once loaded, so those two read it without taking the lock.
+//
+// Values persist in <[Stats] directory>/<app_id>/<steam_id>.vcstats, a
+// fixed-size record per schema entry. Setters mark the entries they change;
+// StoreStats() only queues a request, and a background thread waits out a
+// short window ([Stats] store_delay_ms) so a burst of calls shares one write,
+// re-encodes just the changed records into the file image, replaces the file
+// atomically and then posts the callbacks of every request it covered.
+//-----------------------------------------------------------------------------
+class UserStats
+{
+public:
+    UserStats();
+    ~UserStats();
+
+    UserStats(const UserStats&) = delete;
+    UserStats& operator=(const UserStats&) = delete;
+
+    // Load the schema and the stored values on the first call
+    bool Load();
+    bool IsLoaded() const noexcept { return m_bLoaded.load(std::memory_order_acquire); }
+
+    // Stats; setters refuse wrong types and values outside the schema limits
+    bool GetStat(const char* pchName, int32* pData);
+    bool GetStat(const char* pchName, float* pData);
+    bool SetStat(const char* pchName, int32 nData);
+    bool SetStat(const char* pchName, float fData);
+    bool UpdateAvgRateStat(const char* pchName, float flCountThisSession, double dSessionLength);
+
+    // Achievements; the unlock time is seconds since 1970, 0 while locked
+    bool GetAchievement(const char* pchName, bool* pbAchieved, uint32* punUnlockTime);
+    bool SetAchievement(const char* pchName, bool bAchieved);
+    uint32 GetNumAchievements() const noexcept;
+    const char* GetAchievementName(uint32 iAchievement) const noexcept;
+
+    // Schema attribute of an achievement ("name", "desc", "hidden", ...). "name"
+    // and "desc" prefer a "<key>_<language>" entry for the configured language
+    const char* GetAchievementDisplayAttribute(const char* pchName, const char* pchKey) const;
+
+    // Back to the schema defaults
+    void ResetAll(bool bAchievementsToo);
+
+    // Queue a write of the changed values; UserStatsStored_t follows it, plus
+    // UserAchievementStored_t for each achievement unlocked since the last one
+    bool StoreStats();
+
+    // Post a progress UserAchievementStored_t for a locked achievement
+    bool IndicateAchievementProgress(const char* pchName, uint32 nCurProgress, uint32 nMaxProgress);
+
+    // Write what is queued and stop the store thread
+    void Shutdown();
+
+    // Shutdown() every live UserStats (called from SteamAPI_Shutdown)
+    static void ShutdownAll();
+
+private:
+    struct StatDef
+    {
+        EStatType m_eType = k_EStatTypeInt;
+        bool m_bIncrementOnly = false;
+        uint32 m_unSlot = 0;            // Value in m_intValues (int) or m_floatValues (float, avgrate)
+        uint32 m_unRateSlot = 0;        // Avgrate totals in m_rateCounts / m_rateSeconds
+        int32 m_nMin = INT32_MIN;
+        int32 m_nMax = INT32_MAX;
+        int32 m_nDefault = 0;
+        float m_flMin = -FLT_MAX;
+        float m_flMax = FLT_MAX;
+        float m_flDefault = 0.0f;
+    };
+
+    struct AchievementDef
+    {
+        std::vector<std::pair<std::string, std::string>> m_attributes;
+    };
+
+    bool LoadSchema(const std::string& path);
+    void LoadValues();
+    void ResetStats();
+    void ResetAchievements();
+
+    // Dirty tracking and the file image, under m_mutex
+    void MarkStatDirty(uint32 unStat);
+    void MarkAchievementDirty(uint32 unAchievement);
+    void EncodeStat(uint32 unStat);
+    void EncodeAchievement(uint32 unAchievement);
+
+    void StoreThread();
+    void PostAchievementStored(const std::string& name, uint32 nCurProgress, uint32 nMaxProgress);
+
+    const StatDef* FindStat(const char* pchName) const;
+    uint32 FindAchievement(const char* pchName) const;
+
+private:
+    // Schema, fixed once m_bLoaded is set
+    std::vector<std::string> m_statNames;
+    std::vector<StatDef> m_stats;
+    PerfectHashIndex m_statIndex;
+    std::vector<std::string> m_achievementNames;
+    std::vector<AchievementDef> m_achievements;
+    PerfectHashIndex m_achievementIndex;
+    std::atomic<bool> m_bLoaded;
+
+    // Values, under m_mutex
+    std::vector<int32> m_intValues;
+    std::vector<float> m_floatValues;
+    std::vector<double> m_rateCounts;
+    std::vector<double> m_rateSeconds;
+    std::vector<uint8> m_achieved;
+    std::vector<uint32> m_unlockTimes;
+
+    // Entries changed since the last store, each listed once
+    std::vector<uint8> m_statDirty;
+    std::vector<uint8> m_achievementDirty;
+    std::vector<uint32> m_dirtyStats;
+    std::vector<uint32> m_dirtyAchievements;
+
+    // The stats file as of the last store, patched record by record
+    std::string m_sPath;
+    std::vector<uint8> m_image;
+    bool m_bImageStale;                 // The file on disk does not match m_image
+
+    std::thread m_storeThread;
+    uint32 m_cStoreRequests;            // StoreStats() calls not written yet
+    bool m_bStop;
+    std::condition_variable_any m_storeCondition;
+
+    mutable VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("UserStats::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_USER_STATS_H
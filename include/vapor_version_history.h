@@ -0,0 +1,125 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Bounded per-file version history kept as reverse deltas
+ */
+
+#ifndef VAPORCORE_VERSION_HISTORY_H
+#define VAPORCORE_VERSION_HISTORY_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_storage_backend.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Directory inside the storage directory that holds the history files
+static constexpr const char* VERSION_HISTORY_DIRECTORY = ".vcversions";
+
+//-----------------------------------------------------------------------------
+// Purpose: Previous versions of each file, newest first. Every version is a
+// delta against the version that replaced it, so only the current file is
+// kept in full, rebuilding version n applies n + 1 deltas to it, and dropping
+// the oldest version never touches the others. Deltas are computed by a
+// background thread; callers only hand over the contents. A file whose
+// contents changed behind the history's back (edited while history was off)
+// starts a new chain, older versions of it are dropped.
+//-----------------------------------------------------------------------------
+class VersionHistory
+{
+public:
+    //-----------------------------------------------------------------------------
+    // Purpose: Listing entry. A file that did not exist at that point (deleted,
+    // then written again) has a version with m_bExists false.
+    //-----------------------------------------------------------------------------
+    struct VersionInfo
+    {
+        int64 m_nTimestamp = 0;     // Unix time the version was written
+        uint64 m_unSize = 0;
+        bool m_bExists = true;
+    };
+
+    VersionHistory(const std::string& storageDirectory, uint32 unMaxVersions);
+    ~VersionHistory();
+
+    // Queue a change of a file: previous contents (null if the file did not exist)
+    // replaced by the current ones (null if it was deleted). The views keep the
+    // contents alive until the delta is written
+    void Record(const std::string& name, const FileView* pPrevious, int64 nPreviousTimestamp, const FileView* pCurrent);
+
+    // Versions of a file, newest first. Waits for queued changes
+    bool List(const std::string& name, std::vector<VersionInfo>& versions);
+
+    // Rebuild version unVersion (0 is the newest) from the current contents of the
+    // file. Waits for queued changes
+    bool Reconstruct(const std::string& name, const FileView* pCurrent, uint32 unVersion,
+                     std::vector<uint8>& data, bool& bExists);
+
+    // Wait until every queued change is written
+    void Flush();
+
+private:
+    struct Job
+    {
+        std::string m_sName;
+        FileView m_previous;
+        int64 m_nPreviousTimestamp;
+        FileView m_current;
+        bool m_bPreviousExists;
+        bool m_bCurrentExists;
+    };
+
+    //-----------------------------------------------------------------------------
+    // Purpose: One stored version. m_unBaseHash/m_unBaseSize identify the
+    // contents the delta applies to, m_unHash the contents it produces.
+    //-----------------------------------------------------------------------------
+    struct Version
+    {
+        int64 m_nTimestamp = 0;
+        uint64 m_unSize = 0;
+        uint64 m_unHash = 0;
+        uint64 m_unBaseSize = 0;
+        uint64 m_unBaseHash = 0;
+        bool m_bExists = true;
+        std::vector<uint8> m_delta;
+    };
+
+    std::string GetHistoryPath(const std::string& name) const;
+    bool Load(const std::string& name, std::vector<Version>& versions);
+    bool Save(const std::string& name, const std::vector<Version>& versions);
+
+    void Process(const Job& job);
+    void WorkerThread();
+
+private:
+    std::string m_sDirectory;
+    uint32 m_unMaxVersions;
+
+    std::deque<Job> m_jobs;
+    bool m_bBusy;
+    bool m_bStop;
+    std::thread m_workerThread;
+    std::condition_variable_any m_jobCondition;     // Job queued or stop requested
+    std::condition_variable_any m_idleCondition;    // Queue drained
+
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("VersionHistory::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_VERSION_HISTORY_H
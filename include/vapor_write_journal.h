@@ -0,0 +1,136 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Group-commit write-ahead journal for remote storage writes
+ */
+
+#ifndef VAPORCORE_WRITE_JOURNAL_H
+#define VAPORCORE_WRITE_JOURNAL_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <steam_api.h>
+
+#include "vapor_file_io.h"
+#include "vapor_lock_profiler.h"
+
+namespace VaporCore {
+
+// Name of the journal inside the storage directory
+static constexpr const char* JOURNAL_FILENAME = "storage.vcjournal";
+
+//-----------------------------------------------------------------------------
+// Purpose: Write-ahead journal shared by every write of a storage directory.
+// Enqueue() only queues a record in memory; a background thread appends all
+// records queued meanwhile and makes them durable with a single sync (group
+// commit), waiting a few milliseconds for more writers to join unless enough
+// bytes are already queued. Positions are logical byte offsets that keep
+// growing across checkpoints, a record is durable once the durable end has
+// passed it. Once its records have been applied elsewhere and synced there,
+// Checkpoint() drops them. Opening the journal replays the records a crash
+// left behind and cuts off a torn tail.
+//-----------------------------------------------------------------------------
+class WriteJournal
+{
+public:
+    enum ERecordType : uint32 {
+        k_ERecordWrite = 1,         // New contents of a file
+        k_ERecordDelete = 2,        // File deleted
+        k_ERecordDiscard = 3        // File replaced outside the journal, earlier records are stale
+    };
+
+    using Data = std::shared_ptr<const std::vector<uint8>>;
+    using ReplayCallback = std::function<void(ERecordType eType, const std::string& name, const Data& pData)>;
+    using DurableCallback = std::function<void()>;
+
+public:
+    WriteJournal(const std::string& directory, uint32 unGroupCommitMs, uint64 cubGroupCommit);
+    ~WriteJournal();
+
+    WriteJournal(const WriteJournal&) = delete;
+    WriteJournal& operator=(const WriteJournal&) = delete;
+
+    // Replay the records already in the journal in order, then start accepting new
+    // ones. durable runs on the journal thread after every batch, without locks held
+    bool Open(const ReplayCallback& replay, DurableCallback durable);
+
+    // Write out whatever is queued and stop the journal thread
+    void Close();
+
+    // Queue a record (pData is referenced, not copied), returning the position after it
+    uint64 Enqueue(ERecordType eType, const std::string& name, Data pData);
+
+    // Block until everything before unPosition is durable, false if it never will be
+    bool WaitDurable(uint64 unPosition);
+    bool IsDurable(uint64 unPosition) const;
+
+    // A failed append or sync breaks the journal: records not durable by then fail
+    bool IsBroken() const;
+
+    // Position after the last record queued, and the bytes the journal takes on disk
+    uint64 GetEnd() const;
+    uint64 GetSize() const;
+
+    // Batches made durable so far, one sync each; concurrent writers share one
+    uint64 GetSyncCount() const;
+
+    // Drop the records before unPosition (a record boundary), which the caller has
+    // made durable elsewhere. Records not yet durable are always kept
+    bool Checkpoint(uint64 unPosition);
+
+private:
+    struct Record
+    {
+        ERecordType m_eType;
+        std::string m_sName;
+        Data m_pData;
+    };
+
+    bool Replay(const ReplayCallback& replay);
+    bool WriteBatch(const std::vector<Record>& batch, uint64 cubBatch);
+    uint64 FileOffset(uint64 unPosition) const;
+    void SyncThread();
+
+private:
+    std::string m_sPath;
+    uint32 m_unGroupCommitMs;
+    uint64 m_cubGroupCommit;
+    DurableCallback m_durableCallback;
+
+    // Only the journal thread appends; Checkpoint() rewrites the file under m_fileMutex
+    RandomAccessFile m_file;
+    VaporCore::Mutex m_fileMutex VAPORCORE_MUTEX_NAME("WriteJournal::m_fileMutex");
+
+    // Records queued for the next batch
+    std::vector<Record> m_pending;
+    uint64 m_cubPending;
+
+    uint64 m_unEnd;             // After the last queued record
+    uint64 m_unDurableEnd;      // After the last durable record
+    uint64 m_unBase;            // Position of the first record in the file, under both mutexes
+    uint64 m_cSyncs;            // Batches made durable
+    bool m_bBroken;
+    bool m_bStop;
+
+    std::thread m_syncThread;
+    std::condition_variable_any m_pendingCondition;     // Records queued or stop requested
+    std::condition_variable_any m_durableCondition;     // Durable end advanced or journal broken
+
+    mutable VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("WriteJournal::m_mutex");
+};
+
+} // namespace VaporCore
+
+#endif // VAPORCORE_WRITE_JOURNAL_H
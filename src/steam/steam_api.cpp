@@ -66,6 +66,27 @@ S_API void S_CALLTYPE SteamAPI_Shutdown() {
 
     g_hSteamUser = 0;
     g_hSteamPipe = 0;
+
+    // Stop background threads before the process starts tearing down statics
+    VaporCore::Config::GetInstance().StopWatching();
+
+    // Write stats still waiting in a StoreStats() batch
+    VaporCore::UserStats::ShutdownAll();
+
+    // Let a running leaderboard merge finish; later changes stay in the logs
+    VaporCore::Leaderboards::ShutdownAll();
+
+    // Last cloud sync pass, while the storage still takes writes
+    VaporCore::CloudSync::ShutdownAll();
+
+    // Persist everything still sitting in write-back caches
+    VaporCore::FileStorage::ShutdownAll();
+
+    // Finish outstanding asynchronous reads and stop the I/O threads
+    VaporCore::AsyncIO::GetInstance().Shutdown();
+
+    // Dump lock contention statistics (no-op unless built with ENABLE_LOCK_PROFILING)
+    VaporCore::LockProfiler::GetInstance().LogReport();
 }
 
 // restart your app through Steam to enable required Steamworks features
@@ -33,7 +33,7 @@ void CCallbackMgr::RegisterCallback(class CCallbackBase* pCallback, int iCallbac
         return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    VAPORCORE_SCOPED_LOCK(m_mutex);
 
     auto& callbacks = IsGameserverCallback(pCallback) ? m_serverCallbacks : m_clientCallbacks;
     pCallback->m_iCallback = iCallback;
@@ -67,7 +67,7 @@ void CCallbackMgr::UnregisterCallback(class CCallbackBase* pCallback)
         return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    VAPORCORE_SCOPED_LOCK(m_mutex);
 
     auto& callbacks = IsGameserverCallback(pCallback) ? m_serverCallbacks : m_clientCallbacks;
     int iCallback = pCallback->GetICallback();
@@ -117,7 +117,7 @@ void CCallbackMgr::RegisterCallResult(class CCallbackBase* pCallback, SteamAPICa
         return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    VAPORCORE_SCOPED_LOCK(m_mutex);
     
     // Check if already registered
     auto existing = m_callResults.find(hAPICall);
@@ -144,7 +144,7 @@ void CCallbackMgr::UnregisterCallResult(class CCallbackBase* pCallback, SteamAPI
         return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    VAPORCORE_SCOPED_LOCK(m_mutex);
 
     auto it = m_callResults.find(hAPICall);
     if (it != m_callResults.end()) {
@@ -165,7 +165,7 @@ void CCallbackMgr::DispatchCallbacks()
     // Swap the event queue with a temporary queue to avoid deadlocks
     std::queue<CallbackEvent_t> eventQueue;
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        VAPORCORE_SCOPED_LOCK(m_mutex);
         eventQueue.swap(m_eventQueue);
     }
 
@@ -178,7 +178,7 @@ void CCallbackMgr::DispatchCallbacks()
             // Find the callback handler while holding the lock
             CCallbackBase* pCallbackHandler = nullptr;
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
+                VAPORCORE_SCOPED_LOCK(m_mutex);
                 auto it = m_callResults.find(event.m_hAPICall);
                 if (it != m_callResults.end()) {
                     pCallbackHandler = it->second;
@@ -196,7 +196,7 @@ void CCallbackMgr::DispatchCallbacks()
             // Copy callback list while holding the lock
             std::vector<CCallbackBase*> callbackList;
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
+                VAPORCORE_SCOPED_LOCK(m_mutex);
                 
                 // Use callback type to determine which map to check
                 auto& callbacks = (event.m_callbackType == CallbackEvent_t::CallbackType::ServerCallback) 
@@ -239,7 +239,7 @@ bool CCallbackMgr::PostCallbackEvent(CallbackEvent_t::CallbackType callbackType,
         return false;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    VAPORCORE_SCOPED_LOCK(m_mutex);
 
     // Create RAII-managed copy of callback data
     auto copiedCallbackData = std::make_unique<char[]>(cubCallbackData);
@@ -291,14 +291,32 @@ SteamAPICall_t CCallbackMgr::PostCallResult(void *pvCallbackData, size_t cubCall
     VLOG_INFO(__FUNCTION__ " - cubCallbackData: %zu, bIOFailure: %d", cubCallbackData, bIOFailure);
     
     // Generate unique API call handle for this call result
-    static std::atomic<SteamAPICall_t> s_hNextAPICall(k_uAPICallInvalid + 1);
-    SteamAPICall_t hAPICall = s_hNextAPICall.fetch_add(1);
+    SteamAPICall_t hAPICall = AllocateAPICall();
     
     bool success = PostCallbackEvent(CallbackEvent_t::CallbackType::CallResult, 0, hAPICall, 
                                     pvCallbackData, cubCallbackData, bIOFailure);
     return success ? hAPICall : k_uAPICallInvalid;
 }
 
+SteamAPICall_t CCallbackMgr::AllocateAPICall()
+{
+    static std::atomic<SteamAPICall_t> s_hNextAPICall(k_uAPICallInvalid + 1);
+    return s_hNextAPICall.fetch_add(1);
+}
+
+bool CCallbackMgr::PostCallResult(SteamAPICall_t hAPICall, void *pvCallbackData, size_t cubCallbackData, bool bIOFailure)
+{
+    VLOG_INFO(__FUNCTION__ " - hAPICall: %llu, cubCallbackData: %zu, bIOFailure: %d", hAPICall, cubCallbackData, bIOFailure);
+
+    if (hAPICall == k_uAPICallInvalid) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid API call handle");
+        return false;
+    }
+
+    return PostCallbackEvent(CallbackEvent_t::CallbackType::CallResult, 0, hAPICall, 
+                            pvCallbackData, cubCallbackData, bIOFailure);
+}
+
 void CCallbackMgr::DispatchCallbackImmediate(int iCallback, void *pvCallbackData, size_t cubCallbackData)
 {
     VLOG_INFO(__FUNCTION__ " - iCallback: %d, cubCallbackData: %zu", iCallback, cubCallbackData);
@@ -315,7 +333,7 @@ void CCallbackMgr::DispatchCallbackImmediate(int iCallback, void *pvCallbackData
     // Copy callback list while holding the lock
     std::vector<CCallbackBase*> callbackList;
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        VAPORCORE_SCOPED_LOCK(m_mutex);
         
         // Check both client and server callbacks
         auto clientIt = m_clientCallbacks.find(iCallback);
@@ -7,17 +7,30 @@
  * Author: Tommy Lau <tommy.lhg@gmail.com>
  */
 
+#include <algorithm>
 #include <cstring>
 
 #include "vapor_base.h"
+#include "vapor_chunk_store.h"
+#include "vapor_async_io.h"
+#include "vapor_hash.h"
 #include "steam_remote_storage.h"
 
+// UGC downloads read in windows of this size; reads grow their read-ahead
+// window from the minimum up to the maximum while they stay sequential
+static const size_t UGC_DOWNLOAD_WINDOW = 1024 * 1024;
+static const size_t UGC_READ_AHEAD_MIN = 256 * 1024;
+static const size_t UGC_READ_AHEAD_MAX = 4 * 1024 * 1024;
+
 CSteamRemoteStorage::CSteamRemoteStorage()
     : m_bCloudEnabledForAccount(true),
       m_bCloudEnabledForApp(true),
-      m_fileStorage()
+      m_fileStorage(VaporCore::FileStorage::GetUserStorageDirectory()),
+      m_cloudSync(m_fileStorage)
 {
     VLOG_INFO(__FUNCTION__);
+
+    m_cloudSync.Start();
 }
 
 CSteamRemoteStorage::~CSteamRemoteStorage()
@@ -37,14 +50,20 @@ bool CSteamRemoteStorage::FileWrite( const char *pchFile, const void *pvData, in
 {
     VLOG_INFO(__FUNCTION__ " - File: %s, DataSize: %d", pchFile, cubData);
 
-    VAPORCORE_LOCK_GUARD();
-    
     if (!pchFile || !pvData || cubData < 0) {
         VLOG_DEBUG(__FUNCTION__ " - Invalid parameters for FileWrite");
         return false;
     }
-    
-    return m_fileStorage.WriteFile(pchFile, pvData, static_cast<size_t>(cubData));
+
+    // No global lock: a journaled write waits for its sync, which logs, and
+    // writers that overlap should share that sync
+    auto writeLock = m_cloudSync.LockLocalWrites();
+    if (!m_fileStorage.WriteFile(pchFile, pvData, static_cast<size_t>(cubData))) {
+        return false;
+    }
+
+    m_cloudSync.OnFileWritten(pchFile);
+    return true;
 }
 
 int32 CSteamRemoteStorage::FileRead( const char *pchFile, void *pvData, int32 cubDataToRead )
@@ -64,89 +83,280 @@ int32 CSteamRemoteStorage::FileRead( const char *pchFile, void *pvData, int32 cu
 STEAM_CALL_RESULT( RemoteStorageFileWriteAsyncComplete_t )
 SteamAPICall_t CSteamRemoteStorage::FileWriteAsync( const char *pchFile, const void *pvData, uint32 cubData )
 {
-    VAPORCORE_LOCK_GUARD();
-    VLOG_INFO(__FUNCTION__ " - File: %s, DataSize: %d", pchFile, cubData);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - File: %s, DataSize: %u", pchFile, cubData);
+
+    if (!pchFile || !pvData || cubData > k_unMaxCloudFileChunkSize) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid parameters for FileWriteAsync");
+        return k_uAPICallInvalid;
+    }
+
+    // No global lock: past AsyncIO shutdown the write is persisted inline
+    auto writeLock = m_cloudSync.LockLocalWrites();
+
+    // The handle is returned now, the call result is posted once the data is on disk
+    SteamAPICall_t hAPICall = CCallbackMgr::GetInstance().AllocateAPICall();
+    bool bQueued = m_fileStorage.WriteFileAsync(pchFile, pvData, cubData, [hAPICall](EResult eResult) {
+        RemoteStorageFileWriteAsyncComplete_t result;
+        result.m_eResult = eResult;
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+    });
+
+    if (!bQueued) {
+        return k_uAPICallInvalid;
+    }
+
+    // The write is visible at once, so is the file's cloud state
+    m_cloudSync.OnFileWritten(pchFile);
+    return hAPICall;
 }
 
 STEAM_CALL_RESULT( RemoteStorageFileReadAsyncComplete_t )
 SteamAPICall_t CSteamRemoteStorage::FileReadAsync( const char *pchFile, uint32 nOffset, uint32 cubToRead )
 {
+    VLOG_INFO(__FUNCTION__ " - File: %s, Offset: %u, DataSize: %u", pchFile, nOffset, cubToRead);
+
     VAPORCORE_LOCK_GUARD();
-    VLOG_INFO(__FUNCTION__ " - File: %s, Offset: %d, DataSize: %d", pchFile, nOffset, cubToRead);
-    return 0;
+
+    if (!pchFile || !m_fileStorage.FileExists(pchFile) || nOffset > m_fileStorage.GetFileSize(pchFile)) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid file or offset for FileReadAsync");
+        return k_uAPICallInvalid;
+    }
+
+    SteamAPICall_t hAPICall = CCallbackMgr::GetInstance().AllocateAPICall();
+    {
+        VAPORCORE_SCOPED_LOCK(m_asyncReadsMutex);
+        m_asyncReads[hAPICall];
+    }
+
+    bool bQueued = m_fileStorage.ReadFileAsync(pchFile, nOffset, cubToRead,
+        [this, hAPICall, nOffset](bool bSuccess, std::vector<uint8>&& data) {
+            RemoteStorageFileReadAsyncComplete_t result;
+            result.m_hFileReadAsync = hAPICall;
+            result.m_eResult = bSuccess ? k_EResultOK : k_EResultIOFailure;
+            result.m_nOffset = nOffset;
+            result.m_cubRead = static_cast<uint32>(data.size());
+
+            {
+                VAPORCORE_SCOPED_LOCK(m_asyncReadsMutex);
+                AsyncRead& read = m_asyncReads[hAPICall];
+                read.m_data = std::move(data);
+                read.m_bComplete = true;
+                read.m_bSuccess = bSuccess;
+            }
+
+            CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+        });
+
+    if (!bQueued) {
+        VAPORCORE_SCOPED_LOCK(m_asyncReadsMutex);
+        m_asyncReads.erase(hAPICall);
+        return k_uAPICallInvalid;
+    }
+
+    return hAPICall;
 }
 
 bool CSteamRemoteStorage::FileReadAsyncComplete( SteamAPICall_t hReadCall, void *pvBuffer, uint32 cubToRead )
 {
-    VAPORCORE_LOCK_GUARD();
-    VLOG_INFO(__FUNCTION__ " - Call: %llu, DataSize: %d", hReadCall, cubToRead);
-    return false;
+    VLOG_INFO(__FUNCTION__ " - Call: %llu, DataSize: %u", hReadCall, cubToRead);
+
+    VAPORCORE_SCOPED_LOCK(m_asyncReadsMutex);
+
+    auto it = m_asyncReads.find(hReadCall);
+    if (it == m_asyncReads.end() || !it->second.m_bComplete) {
+        VLOG_DEBUG(__FUNCTION__ " - No completed read for call: %llu", hReadCall);
+        return false;
+    }
+
+    // The buffer is handed out once, whether or not the read succeeded
+    AsyncRead read = std::move(it->second);
+    m_asyncReads.erase(it);
+
+    if (!read.m_bSuccess || !pvBuffer) {
+        return false;
+    }
+
+    memcpy(pvBuffer, read.m_data.data(), std::min<size_t>(cubToRead, read.m_data.size()));
+    return true;
 }
 
 bool CSteamRemoteStorage::FileForget( const char *pchFile )
 {
-    VAPORCORE_LOCK_GUARD();
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    return false;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for FileForget");
+        return false;
+    }
+
+    return m_cloudSync.Forget(pchFile);
 }
 
 bool CSteamRemoteStorage::FileDelete( const char *pchFile )
 {
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    
-    VAPORCORE_LOCK_GUARD();
 
     if (!pchFile) {
         VLOG_DEBUG(__FUNCTION__ " - Invalid filename for FileDelete");
         return false;
     }
-    
+
+    // No global lock: a journaled delete waits for its sync
+    auto writeLock = m_cloudSync.LockLocalWrites();
     return m_fileStorage.DeleteFile(pchFile);
 }
 
 STEAM_CALL_RESULT( RemoteStorageFileShareResult_t )
 SteamAPICall_t CSteamRemoteStorage::FileShare( const char *pchFile )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    return 0;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for FileShare");
+        return k_uAPICallInvalid;
+    }
+
+    SteamAPICall_t hAPICall = CCallbackMgr::GetInstance().AllocateAPICall();
+    RemoteStorageFileShareResult_t result = {};
+    result.m_eResult = k_EResultFileNotFound;
+    result.m_hFile = k_UGCHandleInvalid;
+    strncpy(result.m_rgchFilename, pchFile, sizeof(result.m_rgchFilename) - 1);
+
+    // The view pins the contents, so the file can change meanwhile
+    auto pView = std::make_shared<VaporCore::FileStorage::FileView>();
+    if (!m_fileStorage.OpenFileView(pchFile, *pView)) {
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+        return hAPICall;
+    }
+
+    // Shared content goes to the chunk store under a root named by its handle;
+    // chunks it has in common with saves or other shares are not stored again
+    uint64 unKey = VaporCore::HashBytes64(pchFile, strlen(pchFile));
+    bool bPosted = VaporCore::AsyncIO::GetInstance().Post(unKey, [hAPICall, result, pView]() mutable {
+        std::shared_ptr<VaporCore::ChunkStore> pChunkStore = VaporCore::ChunkStore::OpenDefault();
+        VaporCore::ChunkManifest manifest;
+        if (pChunkStore && pChunkStore->Store(pView->m_pData, pView->m_cubData, manifest)) {
+            std::vector<uint8> serialized;
+            manifest.Serialize(serialized);
+
+            // Same contents share a handle
+            UGCHandle_t hFile = VaporCore::HashBytes64(serialized.data(), serialized.size());
+            if (hFile == 0 || hFile == k_UGCHandleInvalid) {
+                hFile = 1;
+            }
+
+            if (pChunkStore->PutRoot(VaporCore::GetUGCRootKey(hFile), manifest)) {
+                result.m_eResult = k_EResultOK;
+                result.m_hFile = hFile;
+            } else {
+                pChunkStore->Release(manifest);
+                result.m_eResult = k_EResultIOFailure;
+            }
+        } else {
+            result.m_eResult = k_EResultIOFailure;
+        }
+
+        VLOG_DEBUG(__FUNCTION__ " - Shared %s as %llu, result %d", result.m_rgchFilename, result.m_hFile, result.m_eResult);
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+    });
+
+    // Past shutdown there is nobody to share it
+    if (!bPosted) {
+        result.m_eResult = k_EResultFail;
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+    }
+
+    return hAPICall;
 }
 
 bool CSteamRemoteStorage::SetSyncPlatforms( const char *pchFile, ERemoteStoragePlatform eRemoteStoragePlatform )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - File: %s, Platform: %d", pchFile, eRemoteStoragePlatform);
-    return false;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for SetSyncPlatforms");
+        return false;
+    }
+
+    return m_cloudSync.SetPlatforms(pchFile, static_cast<uint32>(eRemoteStoragePlatform));
 }
 
 // file operations that cause network IO
 UGCFileWriteStreamHandle_t CSteamRemoteStorage::FileWriteStreamOpen( const char *pchFile )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    return 0;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for FileWriteStreamOpen");
+        return k_UGCFileStreamHandleInvalid;
+    }
+
+    VaporCore::FileStorage::WriteStreamHandle hStream = m_fileStorage.OpenWriteStream(pchFile);
+    if (hStream == VaporCore::FileStorage::k_hWriteStreamInvalid) {
+        return k_UGCFileStreamHandleInvalid;
+    }
+
+    m_streamFiles[hStream] = pchFile;
+    return hStream;
 }
 
 bool CSteamRemoteStorage::FileWriteStreamWriteChunk( UGCFileWriteStreamHandle_t writeHandle, const void *pvData, int32 cubData )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - Handle: %llu, DataSize: %d", writeHandle, cubData);
-    return false;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pvData || cubData < 0 || static_cast<uint32>(cubData) > k_unMaxCloudFileChunkSize) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid parameters for FileWriteStreamWriteChunk");
+        return false;
+    }
+
+    return m_fileStorage.WriteStreamChunk(writeHandle, pvData, static_cast<size_t>(cubData));
 }
 
 bool CSteamRemoteStorage::FileWriteStreamClose( UGCFileWriteStreamHandle_t writeHandle )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - Handle: %llu", writeHandle);
-    return false;
+
+    std::string file;
+    {
+        VAPORCORE_LOCK_GUARD();
+
+        auto it = m_streamFiles.find(writeHandle);
+        if (it != m_streamFiles.end()) {
+            file = std::move(it->second);
+            m_streamFiles.erase(it);
+        }
+    }
+
+    // Not under the global lock: the close waits for the stream's AsyncIO tasks, which log
+    auto writeLock = m_cloudSync.LockLocalWrites();
+    if (!m_fileStorage.CloseWriteStream(writeHandle)) {
+        return false;
+    }
+
+    if (!file.empty()) {
+        m_cloudSync.OnFileWritten(file);
+    }
+    return true;
 }
 
 bool CSteamRemoteStorage::FileWriteStreamCancel( UGCFileWriteStreamHandle_t writeHandle )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - Handle: %llu", writeHandle);
-    return false;
+
+    VAPORCORE_LOCK_GUARD();
+
+    m_streamFiles.erase(writeHandle);
+    return m_fileStorage.CancelWriteStream(writeHandle);
 }
 
 // file information
@@ -166,9 +376,16 @@ bool CSteamRemoteStorage::FileExists( const char *pchFile )
 
 bool CSteamRemoteStorage::FilePersisted( const char *pchFile )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    return false;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for FilePersisted");
+        return false;
+    }
+
+    return m_cloudSync.IsPersisted(pchFile);
 }
 
 int32 CSteamRemoteStorage::GetFileSize( const char *pchFile )
@@ -201,9 +418,16 @@ int64 CSteamRemoteStorage::GetFileTimestamp( const char *pchFile )
 
 ERemoteStoragePlatform CSteamRemoteStorage::GetSyncPlatforms( const char *pchFile )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
-    return ERemoteStoragePlatform::k_ERemoteStoragePlatformNone;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchFile) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid filename for GetSyncPlatforms");
+        return k_ERemoteStoragePlatformNone;
+    }
+
+    return static_cast<ERemoteStoragePlatform>(m_cloudSync.GetPlatforms(pchFile));
 }
 
 // iteration
@@ -222,7 +446,7 @@ const char *CSteamRemoteStorage::GetFileNameAndSize( int iFile, int32 *pnFileSiz
     
     VAPORCORE_LOCK_GUARD();
     
-    return m_fileStorage.GetFileNameAndSize(iFile, pnFileSizeInBytes).c_str();
+    return m_fileStorage.GetFileNameAndSize(iFile, pnFileSizeInBytes);
 }
 
 // configuration management
@@ -275,6 +499,7 @@ void CSteamRemoteStorage::SetCloudEnabledForApp( bool bEnabled )
     VAPORCORE_LOCK_GUARD();
     VLOG_INFO(__FUNCTION__ " - Setting to: %s", bEnabled ? "true" : "false");
     m_bCloudEnabledForApp = bEnabled;
+    m_cloudSync.SetCloudEnabled(bEnabled);
 }
 
 // user generated content
@@ -285,26 +510,44 @@ void CSteamRemoteStorage::SetCloudEnabledForApp( bool bEnabled )
 STEAM_CALL_RESULT( RemoteStorageDownloadUGCResult_t )
 SteamAPICall_t CSteamRemoteStorage::UGCDownload( UGCHandle_t hContent, uint32 unPriority )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d, Priority: %d", hContent, unPriority);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu, Priority: %u", hContent, unPriority);
+
+    VAPORCORE_LOCK_GUARD();
+
+    // Content is local, every download starts right away whatever its priority
+    return StartUGCDownload(hContent, nullptr);
 }
 
 // Changed from Steam SDK v1.22, backward compatibility
 SteamAPICall_t CSteamRemoteStorage::UGCDownload( UGCHandle_t hContent )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d", hContent);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu", hContent);
+    return UGCDownload(hContent, 0);
 }
 
 // Gets the amount of data downloaded so far for a piece of content. pnBytesExpected can be 0 if function returns false
 // or if the transfer hasn't started yet, so be careful to check for that before dividing to get a percentage
 bool CSteamRemoteStorage::GetUGCDownloadProgress( UGCHandle_t hContent, int32 *pnBytesDownloaded, int32 *pnBytesExpected )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d", hContent);
-    return false;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu", hContent);
+
+    std::shared_ptr<UGCContent> pContent;
+    {
+        VAPORCORE_SCOPED_LOCK(m_ugcMutex);
+        auto it = m_ugcContents.find(hContent);
+        if (it == m_ugcContents.end()) {
+            return false;
+        }
+        pContent = it->second;
+    }
+
+    if (pnBytesDownloaded) {
+        *pnBytesDownloaded = static_cast<int32>(std::min<uint64>(pContent->m_cubDownloaded, INT32_MAX));
+    }
+    if (pnBytesExpected) {
+        *pnBytesExpected = static_cast<int32>(std::min<uint64>(pContent->m_cubExpected, INT32_MAX));
+    }
+    return true;
 }
 
 // Gets metadata for a file after it has been downloaded. This is the same metadata given in the RemoteStorageDownloadUGCResult_t call result
@@ -323,25 +566,64 @@ bool CSteamRemoteStorage::GetUGCDetails( UGCHandle_t hContent, AppId_t *pnAppID,
 // For especially large files (anything over 100MB) it is a requirement that the file is read in chunks.
 int32 CSteamRemoteStorage::UGCRead( UGCHandle_t hContent, void *pvData, int32 cubDataToRead, uint32 cOffset, EUGCReadAction eAction )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d, DataSize: %d, Offset: %d, Action: %d", hContent, cubDataToRead, cOffset, eAction);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu, DataSize: %d, Offset: %u, Action: %d", hContent, cubDataToRead, cOffset, eAction);
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pvData || cubDataToRead < 0) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid parameters for UGCRead");
+        return 0;
+    }
+
+    std::unique_lock<VaporCore::Mutex> ugcLock(m_ugcMutex);
+
+    auto it = m_ugcContents.find(hContent);
+    if (it == m_ugcContents.end() || !it->second->m_bComplete) {
+        VLOG_DEBUG(__FUNCTION__ " - Content not downloaded: %llu", hContent);
+        return 0;
+    }
+
+    UGCContent& content = *it->second;
+    int32 cubRead = ReadUGC(content, pvData, cubDataToRead, cOffset);
+
+    // Closing frees the handle, reading it again takes another UGCDownload
+    bool bClose = eAction == k_EUGCRead_Close || cubRead < 0 ||
+                  (eAction == k_EUGCRead_ContinueReadingUntilFinished &&
+                   static_cast<uint64>(cOffset) + std::max(cubRead, 0) >= content.m_manifest.m_unSize);
+    if (bClose) {
+        m_ugcContents.erase(it);
+    }
+    return std::max(cubRead, 0);
 }
 
 // Changed from Steam SDK v1.26, backward compatibility
 int32 CSteamRemoteStorage::UGCRead( UGCHandle_t hContent, void *pvData, int32 cubDataToRead, uint32 cOffset )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d, DataSize: %d, Offset: %d", hContent, cubDataToRead, cOffset);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu, DataSize: %d, Offset: %u", hContent, cubDataToRead, cOffset);
+    return UGCRead(hContent, pvData, cubDataToRead, cOffset, k_EUGCRead_ContinueReadingUntilFinished);
 }
 
 // Changed from Steam SDK v1.22, backward compatibility
 int32 CSteamRemoteStorage::UGCRead( UGCHandle_t hContent, void *pvData, int32 cubDataToRead )
 {
-    // TODO: Implement
-    VLOG_INFO(__FUNCTION__ " - Content: %d, DataSize: %d", hContent, cubDataToRead);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Content: %llu, DataSize: %d", hContent, cubDataToRead);
+
+    VAPORCORE_LOCK_GUARD();
+
+    // Without an offset, reads continue where the previous one stopped
+    uint64 unOffset = 0;
+    {
+        VAPORCORE_SCOPED_LOCK(m_ugcMutex);
+        auto it = m_ugcContents.find(hContent);
+        if (it != m_ugcContents.end()) {
+            unOffset = it->second->m_unNextOffset;
+        }
+    }
+    if (unOffset > UINT32_MAX) {
+        return 0;
+    }
+
+    return UGCRead(hContent, pvData, cubDataToRead, static_cast<uint32>(unOffset), k_EUGCRead_ContinueReadingUntilFinished);
 }
 
 // Functions to iterate through UGC that has finished downloading but has not yet been read via UGCRead()
@@ -592,7 +874,195 @@ SteamAPICall_t CSteamRemoteStorage::EnumeratePublishedWorkshopFiles( EWorkshopEn
 STEAM_CALL_RESULT( RemoteStorageDownloadUGCResult_t )
 SteamAPICall_t CSteamRemoteStorage::UGCDownloadToLocation( UGCHandle_t hContent, const char *pchLocation, uint32 unPriority )
 {
-    // TODO: Implement
     VLOG_INFO(__FUNCTION__ " - Content: %llu, Location: %s, Priority: %d", hContent, pchLocation, unPriority);
-    return 0;
+
+    VAPORCORE_LOCK_GUARD();
+
+    if (!pchLocation || !*pchLocation) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid location for UGCDownloadToLocation");
+        return k_uAPICallInvalid;
+    }
+
+    return StartUGCDownload(hContent, pchLocation);
+}
+
+SteamAPICall_t CSteamRemoteStorage::StartUGCDownload( UGCHandle_t hContent, const char *pchLocation )
+{
+    if (hContent == k_UGCHandleInvalid) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid content handle");
+        return k_uAPICallInvalid;
+    }
+
+    // A new download replaces the handle's read state, reading starts over
+    auto pContent = std::make_shared<UGCContent>();
+    {
+        VAPORCORE_SCOPED_LOCK(m_ugcMutex);
+        m_ugcContents[hContent] = pContent;
+    }
+
+    SteamAPICall_t hAPICall = CCallbackMgr::GetInstance().AllocateAPICall();
+    RemoteStorageDownloadUGCResult_t result = {};
+    result.m_hFile = hContent;
+    result.m_nAppID = VaporCore::Config::GetInstance().GameID().AppID();
+    result.m_ulSteamIDOwner = VaporCore::Config::GetInstance().SteamID().ConvertToUint64();
+
+    std::string location(pchLocation ? pchLocation : "");
+    bool bPosted = VaporCore::AsyncIO::GetInstance().Post(hContent, [this, hAPICall, hContent, pContent, location, result]() mutable {
+        result.m_eResult = DownloadUGC(hContent, *pContent, location);
+        result.m_nSizeInBytes = static_cast<int32>(std::min<uint64>(pContent->m_cubExpected, INT32_MAX));
+
+        if (result.m_eResult == k_EResultOK) {
+            pContent->m_bComplete = true;
+        } else {
+            VAPORCORE_SCOPED_LOCK(m_ugcMutex);
+            auto it = m_ugcContents.find(hContent);
+            if (it != m_ugcContents.end() && it->second == pContent) {
+                m_ugcContents.erase(it);
+            }
+        }
+
+        VLOG_DEBUG(__FUNCTION__ " - Downloaded %llu, result %d", hContent, result.m_eResult);
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+    });
+
+    if (!bPosted) {
+        {
+            VAPORCORE_SCOPED_LOCK(m_ugcMutex);
+            auto it = m_ugcContents.find(hContent);
+            if (it != m_ugcContents.end() && it->second == pContent) {
+                m_ugcContents.erase(it);
+            }
+        }
+        result.m_eResult = k_EResultFail;
+        CCallbackMgr::GetInstance().PostCallResult(hAPICall, &result, sizeof(result));
+    }
+
+    return hAPICall;
+}
+
+EResult CSteamRemoteStorage::DownloadUGC( UGCHandle_t hContent, UGCContent &content, const std::string &location )
+{
+    std::shared_ptr<VaporCore::ChunkStore> pChunkStore = VaporCore::ChunkStore::OpenDefault();
+    if (!pChunkStore) {
+        return k_EResultIOFailure;
+    }
+    if (!pChunkStore->GetRoot(VaporCore::GetUGCRootKey(hContent), content.m_manifest)) {
+        return k_EResultFileNotFound;
+    }
+    content.m_pStore = pChunkStore;
+    content.m_cubExpected = content.m_manifest.m_unSize;
+
+    VaporCore::StagedFile file;
+    if (!location.empty() && !file.Open(location, location + VaporCore::FILE_IO_TEMP_SUFFIX)) {
+        return k_EResultIOFailure;
+    }
+
+    // Read through once: every chunk is checked and warm afterwards, and the
+    // first window stays behind for the first UGCRead
+    std::vector<uint8> window;
+    for (uint64 unOffset = 0; unOffset < content.m_manifest.m_unSize; unOffset += window.size()) {
+        window.resize(static_cast<size_t>(std::min<uint64>(UGC_DOWNLOAD_WINDOW, content.m_manifest.m_unSize - unOffset)));
+        int64 cubRead = pChunkStore->Read(content.m_manifest, unOffset, window.data(), window.size());
+        if (cubRead != static_cast<int64>(window.size()) || (file.IsOpen() && !file.Append(window.data(), window.size()))) {
+            return k_EResultIOFailure;
+        }
+
+        if (unOffset == 0) {
+            content.m_readAhead = window;
+            content.m_cubReadAheadWindow = window.size();
+        }
+        content.m_cubDownloaded += window.size();
+    }
+
+    if (file.IsOpen() && !file.Commit()) {
+        return k_EResultIOFailure;
+    }
+    return k_EResultOK;
+}
+
+int32 CSteamRemoteStorage::ReadUGC( UGCContent &content, void *pvData, int32 cubDataToRead, uint64 unOffset )
+{
+    uint64 unSize = content.m_manifest.m_unSize;
+    if (unOffset >= unSize) {
+        return 0;
+    }
+    size_t cubToRead = static_cast<size_t>(std::min<uint64>(cubDataToRead, unSize - unOffset));
+
+    // Outside the window: a sequential read doubles it, a seek starts small again
+    bool bInWindow = unOffset >= content.m_unReadAheadOffset &&
+                     unOffset + cubToRead <= content.m_unReadAheadOffset + content.m_readAhead.size();
+    if (!bInWindow) {
+        content.m_cubReadAheadWindow = unOffset == content.m_unNextOffset
+            ? std::min(std::max(content.m_cubReadAheadWindow * 2, UGC_READ_AHEAD_MIN), UGC_READ_AHEAD_MAX)
+            : UGC_READ_AHEAD_MIN;
+
+        size_t cubFetch = static_cast<size_t>(std::min<uint64>(std::max(cubToRead, content.m_cubReadAheadWindow),
+                                                                unSize - unOffset));
+        content.m_readAhead.resize(cubFetch);
+        int64 cubFetched = content.m_pStore->Read(content.m_manifest, unOffset, content.m_readAhead.data(), cubFetch);
+        if (cubFetched < static_cast<int64>(cubToRead)) {
+            content.m_readAhead.clear();
+            return -1;
+        }
+        content.m_readAhead.resize(static_cast<size_t>(cubFetched));
+        content.m_unReadAheadOffset = unOffset;
+    }
+
+    memcpy(pvData, content.m_readAhead.data() + (unOffset - content.m_unReadAheadOffset), cubToRead);
+    content.m_unNextOffset = unOffset + cubToRead;
+    return static_cast<int32>(cubToRead);
+}
+
+// VaporCore extensions
+bool CSteamRemoteStorage::OpenFileView( const char *pchFile, VaporCore::FileStorage::FileView &view )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
+
+    if (!pchFile) {
+        return false;
+    }
+
+    // No global lock: mapping a large file must not stall other Steam API calls
+    return m_fileStorage.OpenFileView(pchFile, view);
+}
+
+bool CSteamRemoteStorage::GetFileVersions( const char *pchFile, std::vector<VaporCore::FileStorage::FileVersion> &versions )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
+
+    if (!pchFile) {
+        return false;
+    }
+
+    // No global lock: waits for pending history work
+    return m_fileStorage.GetFileVersions(pchFile, versions);
+}
+
+bool CSteamRemoteStorage::RestoreFileVersion( const char *pchFile, uint32 unVersion )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s, Version: %u", pchFile, unVersion);
+
+    if (!pchFile) {
+        return false;
+    }
+
+    // No global lock: the restore is a write, which may wait for the journal
+    auto writeLock = m_cloudSync.LockLocalWrites();
+    return m_fileStorage.RestoreFileVersion(pchFile, unVersion);
+}
+
+bool CSteamRemoteStorage::ListFiles( const char *pchPrefix, std::vector<std::string> &files )
+{
+    VLOG_INFO(__FUNCTION__ " - Prefix: %s", pchPrefix ? pchPrefix : "");
+
+    // No global lock: the index answers without touching the disk
+    return m_fileStorage.ListFiles(pchPrefix ? pchPrefix : "", files);
+}
+
+bool CSteamRemoteStorage::SyncCloud()
+{
+    VLOG_INFO(__FUNCTION__);
+
+    // No global lock: the pass applies pulled files under it
+    return m_cloudSync.SyncNow();
 }
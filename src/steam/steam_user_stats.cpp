@@ -8,6 +8,7 @@
  */
 
 #include <cstring>
+#include <algorithm>
 
 #include "vapor_base.h"
 #include "steam_user_stats.h"
@@ -27,11 +28,14 @@ bool CSteamUserStats::RequestCurrentStats( )
 {
     VLOG_INFO(__FUNCTION__);
 
+    // The schema is read here, the first time
+    bool bLoaded = m_userStats.Load();
+
     VAPORCORE_LOCK_GUARD();
 
     UserStatsReceived_t callback = {
         VaporCore::Config::GetInstance().GameID().ToUint64(),
-        k_EResultOK,
+        bLoaded ? k_EResultOK : k_EResultFail,
         VaporCore::Config::GetInstance().SteamID().ConvertToUint64()
     };
 
@@ -42,59 +46,56 @@ bool CSteamUserStats::RequestCurrentStats( )
 STEAM_FLAT_NAME( GetStatInt32 )
 bool CSteamUserStats::GetStat( const char *pchName, int32 *pData )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    if (pData) *pData = 0;
-    return false;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
+    return m_userStats.GetStat(pchName, pData);
 }
 
 STEAM_FLAT_NAME( GetStatFloat )
 bool CSteamUserStats::GetStat( const char *pchName, float *pData )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    if (pData) *pData = 0.0f;
-    return false;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
+    return m_userStats.GetStat(pchName, pData);
 }
 
 // Set / update data
 STEAM_FLAT_NAME( SetStatInt32 )
 bool CSteamUserStats::SetStat( const char *pchName, int32 nData )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s, Data: %d", pchName ? pchName : "null", nData);
-    return true;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s, Data: %d", pchName ? pchName : "null", nData);
+    return m_userStats.SetStat(pchName, nData);
 }
 
 STEAM_FLAT_NAME( SetStatFloat )
 bool CSteamUserStats::SetStat( const char *pchName, float fData )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s, Data: %f", pchName ? pchName : "null", fData);
-    return true;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s, Data: %f", pchName ? pchName : "null", fData);
+    return m_userStats.SetStat(pchName, fData);
 }
 
 bool CSteamUserStats::UpdateAvgRateStat( const char *pchName, float flCountThisSession, double dSessionLength )
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s, Count: %f, Length: %f", 
                pchName ? pchName : "null", flCountThisSession, dSessionLength);
-    return true;
+    return m_userStats.UpdateAvgRateStat(pchName, flCountThisSession, dSessionLength);
 }
 
 // Achievement flag accessors
 bool CSteamUserStats::GetAchievement( const char *pchName, bool *pbAchieved )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    if (pbAchieved) *pbAchieved = false;
-    return false;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
+    return m_userStats.GetAchievement(pchName, pbAchieved, nullptr);
 }
 
 bool CSteamUserStats::SetAchievement( const char *pchName )
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    return true;
+    return m_userStats.SetAchievement(pchName, true);
 }
 
 bool CSteamUserStats::ClearAchievement( const char *pchName )
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    return true;
+    return m_userStats.SetAchievement(pchName, false);
 }
 
 // Get the achievement status, and the time it was unlocked if unlocked.
@@ -102,8 +103,8 @@ bool CSteamUserStats::ClearAchievement( const char *pchName )
 // began tracking achievement unlock times (December 2009). Time is seconds since January 1, 1970.
 bool CSteamUserStats::GetAchievementAndUnlockTime( const char *pchName, bool *pbAchieved, uint32 *punUnlockTime )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
-    return false;
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s", pchName ? pchName : "null");
+    return m_userStats.GetAchievement(pchName, pbAchieved, punUnlockTime);
 }
 
 // Store the current data on the server, will get a callback when set
@@ -115,8 +116,8 @@ bool CSteamUserStats::GetAchievementAndUnlockTime( const char *pchName, bool *pb
 // The stats should be re-iterated to keep in sync.
 bool CSteamUserStats::StoreStats( )
 {
-    VLOG_INFO(__FUNCTION__);
-    return true;
+    VLOG_DEBUG(__FUNCTION__);
+    return m_userStats.StoreStats();
 }
 
 // Achievement / GroupAchievement metadata
@@ -136,9 +137,9 @@ int CSteamUserStats::GetAchievementIcon( const char *pchName )
 // - "hidden" for retrieving if an achievement is hidden (returns "0" when not hidden, "1" when hidden)
 const char *CSteamUserStats::GetAchievementDisplayAttribute( const char *pchName, const char *pchKey )
 {
-    VLOG_INFO(__FUNCTION__ " - Name: %s, Key: %s", 
+    VLOG_DEBUG(__FUNCTION__ " - Name: %s, Key: %s", 
                pchName ? pchName : "null", pchKey ? pchKey : "null");
-    return "";
+    return m_userStats.GetAchievementDisplayAttribute(pchName, pchKey);
 }
 
 // Achievement progress - triggers an AchievementProgress callback, that is all.
@@ -147,22 +148,22 @@ bool CSteamUserStats::IndicateAchievementProgress( const char *pchName, uint32 n
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s, Progress: %u/%u", 
                pchName ? pchName : "null", nCurProgress, nMaxProgress);
-    return true;
+    return m_userStats.IndicateAchievementProgress(pchName, nCurProgress, nMaxProgress);
 }
 
 // Used for iterating achievements. In general games should not need these functions because they should have a
 // list of existing achievements compiled into them
 uint32 CSteamUserStats::GetNumAchievements()
 {
-    VLOG_INFO(__FUNCTION__);
-    return 0;
+    VLOG_DEBUG(__FUNCTION__);
+    return m_userStats.GetNumAchievements();
 }
 
 // Get achievement name iAchievement in [0,GetNumAchievements)
 const char* CSteamUserStats::GetAchievementName(uint32 iAchievement)
 {
-    VLOG_INFO(__FUNCTION__ " - Achievement: %u", iAchievement);
-    return "";
+    VLOG_DEBUG(__FUNCTION__ " - Achievement: %u", iAchievement);
+    return m_userStats.GetAchievementName(iAchievement);
 }
 
 // Friends stats & achievements
@@ -210,6 +211,7 @@ bool CSteamUserStats::GetUserAchievementAndUnlockTime( CSteamID steamIDUser, con
 bool CSteamUserStats::ResetAllStats( bool bAchievementsToo )
 {
     VLOG_INFO(__FUNCTION__ " - Achievements: %d", bAchievementsToo);
+    m_userStats.ResetAll(bAchievementsToo);
     return true;
 }
 
@@ -222,7 +224,12 @@ SteamAPICall_t CSteamUserStats::FindOrCreateLeaderboard( const char *pchLeaderbo
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s, Sort: %d, Display: %d", 
                pchLeaderboardName ? pchLeaderboardName : "null", eLeaderboardSortMethod, eLeaderboardDisplayType);
-    return 0;
+
+    LeaderboardFindResult_t result = {};
+    result.m_hSteamLeaderboard = m_leaderboards.FindOrCreate(pchLeaderboardName, eLeaderboardSortMethod,
+                                                             eLeaderboardDisplayType);
+    result.m_bLeaderboardFound = result.m_hSteamLeaderboard != 0;
+    return CCallbackMgr::GetInstance().PostCallResult(&result, sizeof(result));
 }
 
 // as above, but won't create the leaderboard if it's not found
@@ -231,35 +238,39 @@ STEAM_CALL_RESULT( LeaderboardFindResult_t )
 SteamAPICall_t CSteamUserStats::FindLeaderboard( const char *pchLeaderboardName )
 {
     VLOG_INFO(__FUNCTION__ " - Name: %s", pchLeaderboardName ? pchLeaderboardName : "null");
-    return 0;
+
+    LeaderboardFindResult_t result = {};
+    result.m_hSteamLeaderboard = m_leaderboards.Find(pchLeaderboardName);
+    result.m_bLeaderboardFound = result.m_hSteamLeaderboard != 0;
+    return CCallbackMgr::GetInstance().PostCallResult(&result, sizeof(result));
 }
 
 // returns the name of a leaderboard
 const char *CSteamUserStats::GetLeaderboardName( SteamLeaderboard_t hSteamLeaderboard )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u", hSteamLeaderboard);
-    return "";
+    VLOG_DEBUG(__FUNCTION__ " - Leaderboard: %llu", hSteamLeaderboard);
+    return m_leaderboards.GetName(hSteamLeaderboard);
 }
 
 // returns the total number of entries in a leaderboard, as of the last request
 int CSteamUserStats::GetLeaderboardEntryCount( SteamLeaderboard_t hSteamLeaderboard )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u", hSteamLeaderboard);
-    return 0;
+    VLOG_DEBUG(__FUNCTION__ " - Leaderboard: %llu", hSteamLeaderboard);
+    return m_leaderboards.GetEntryCount(hSteamLeaderboard);
 }
 
 // returns the sort method of the leaderboard
 ELeaderboardSortMethod CSteamUserStats::GetLeaderboardSortMethod( SteamLeaderboard_t hSteamLeaderboard )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u", hSteamLeaderboard);
-    return ELeaderboardSortMethod::k_ELeaderboardSortMethodNone;
+    VLOG_DEBUG(__FUNCTION__ " - Leaderboard: %llu", hSteamLeaderboard);
+    return m_leaderboards.GetSortMethod(hSteamLeaderboard);
 }
 
 // returns the display type of the leaderboard
 ELeaderboardDisplayType CSteamUserStats::GetLeaderboardDisplayType( SteamLeaderboard_t hSteamLeaderboard )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u", hSteamLeaderboard);
-    return ELeaderboardDisplayType::k_ELeaderboardDisplayTypeNone;
+    VLOG_DEBUG(__FUNCTION__ " - Leaderboard: %llu", hSteamLeaderboard);
+    return m_leaderboards.GetDisplayType(hSteamLeaderboard);
 }
 
 // Asks the Steam back-end for a set of rows in the leaderboard.
@@ -273,8 +284,27 @@ ELeaderboardDisplayType CSteamUserStats::GetLeaderboardDisplayType( SteamLeaderb
 STEAM_CALL_RESULT( LeaderboardScoresDownloaded_t )
 SteamAPICall_t CSteamUserStats::DownloadLeaderboardEntries( SteamLeaderboard_t hSteamLeaderboard, ELeaderboardDataRequest eLeaderboardDataRequest, int nRangeStart, int nRangeEnd )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, Request: %d, Range: %d-%d", hSteamLeaderboard, eLeaderboardDataRequest, nRangeStart, nRangeEnd);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Leaderboard: %llu, Request: %d, Range: %d-%d", hSteamLeaderboard, eLeaderboardDataRequest, nRangeStart, nRangeEnd);
+
+    const uint64 ulSteamID = VaporCore::Config::GetInstance().SteamID().ConvertToUint64();
+    std::vector<VaporCore::Leaderboards::Row> rows;
+    bool bSuccess = false;
+    switch (eLeaderboardDataRequest) {
+    case k_ELeaderboardDataRequestGlobal:
+        bSuccess = m_leaderboards.GetRange(hSteamLeaderboard, nRangeStart, nRangeEnd, rows);
+        break;
+    case k_ELeaderboardDataRequestGlobalAroundUser:
+        bSuccess = m_leaderboards.GetAroundUser(hSteamLeaderboard, ulSteamID, nRangeStart, nRangeEnd, rows);
+        break;
+    case k_ELeaderboardDataRequestFriends:
+        // No friends list here, so the user is the only friend with an entry
+        bSuccess = m_leaderboards.GetUsers(hSteamLeaderboard, &ulSteamID, 1, rows);
+        break;
+    default:
+        break;
+    }
+
+    return PostDownloadResult(hSteamLeaderboard, bSuccess, std::move(rows));
 }
 
 // as above, but downloads leaderboard entries for an arbitrary set of users - ELeaderboardDataRequest is k_ELeaderboardDataRequestUsers
@@ -285,8 +315,29 @@ STEAM_CALL_RESULT( LeaderboardScoresDownloaded_t )
 SteamAPICall_t CSteamUserStats::DownloadLeaderboardEntriesForUsers( SteamLeaderboard_t hSteamLeaderboard,
 	                                                                STEAM_ARRAY_COUNT_D(cUsers, Array of users to retrieve) CSteamID *prgUsers, int cUsers )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, Users: %d", hSteamLeaderboard, cUsers);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Leaderboard: %llu, Users: %d", hSteamLeaderboard, cUsers);
+
+    std::vector<uint64> steamIDs;
+    for (int i = 0; prgUsers && i < cUsers; ++i) {
+        steamIDs.push_back(prgUsers[i].ConvertToUint64());
+    }
+
+    std::vector<VaporCore::Leaderboards::Row> rows;
+    bool bSuccess = m_leaderboards.GetUsers(hSteamLeaderboard, steamIDs.data(), cUsers, rows);
+    return PostDownloadResult(hSteamLeaderboard, bSuccess, std::move(rows));
+}
+
+SteamAPICall_t CSteamUserStats::PostDownloadResult( SteamLeaderboard_t hSteamLeaderboard, bool bSuccess,
+                                                    std::vector<VaporCore::Leaderboards::Row>&& rows )
+{
+    // An unknown board or a bad request fails the call; the game sees an I/O failure
+    LeaderboardScoresDownloaded_t result = {};
+    result.m_hSteamLeaderboard = hSteamLeaderboard;
+    result.m_cEntryCount = static_cast<int>(rows.size());
+    if (bSuccess) {
+        result.m_hSteamLeaderboardEntries = m_leaderboards.AddDownload(std::move(rows));
+    }
+    return CCallbackMgr::GetInstance().PostCallResult(&result, sizeof(result), !bSuccess);
 }
 
 // Returns data about a single leaderboard entry
@@ -305,8 +356,24 @@ SteamAPICall_t CSteamUserStats::DownloadLeaderboardEntriesForUsers( SteamLeaderb
 // once you've accessed all the entries, the data will be free'd, and the SteamLeaderboardEntries_t handle will become invalid
 bool CSteamUserStats::GetDownloadedLeaderboardEntry( SteamLeaderboardEntries_t hSteamLeaderboardEntries, int index, LeaderboardEntry_t *pLeaderboardEntry, int32 *pDetails, int cDetailsMax )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, Index: %d, Details: %d", hSteamLeaderboardEntries, index, cDetailsMax);
-    return false;
+    VLOG_DEBUG(__FUNCTION__ " - Entries: %llu, Index: %d, Details: %d", hSteamLeaderboardEntries, index, cDetailsMax);
+
+    VaporCore::Leaderboards::Row row;
+    if (!pLeaderboardEntry || !m_leaderboards.GetDownloadedEntry(hSteamLeaderboardEntries, index, row)) {
+        return false;
+    }
+
+    pLeaderboardEntry->m_steamIDUser = CSteamID(row.m_unSteamID);
+    pLeaderboardEntry->m_nGlobalRank = row.m_nGlobalRank;
+    pLeaderboardEntry->m_nScore = row.m_nScore;
+    pLeaderboardEntry->m_cDetails = static_cast<int32>(row.m_details.size());
+    pLeaderboardEntry->m_hUGC = row.m_hUGC;
+
+    if (pDetails && cDetailsMax > 0) {
+        size_t cCopy = std::min(row.m_details.size(), static_cast<size_t>(cDetailsMax));
+        memcpy(pDetails, row.m_details.data(), cCopy * sizeof(int32));
+    }
+    return true;
 }
 
 // Uploads a user score to the Steam back-end.
@@ -316,15 +383,32 @@ bool CSteamUserStats::GetDownloadedLeaderboardEntry( SteamLeaderboardEntries_t h
 STEAM_CALL_RESULT( LeaderboardScoreUploaded_t )
 SteamAPICall_t CSteamUserStats::UploadLeaderboardScore( SteamLeaderboard_t hSteamLeaderboard, ELeaderboardUploadScoreMethod eLeaderboardUploadScoreMethod, int32 nScore, const int32 *pScoreDetails, int cScoreDetailsCount )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, Score: %d, Details: %d", hSteamLeaderboard, nScore, cScoreDetailsCount);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Leaderboard: %llu, Score: %d, Details: %d", hSteamLeaderboard, nScore, cScoreDetailsCount);
+
+    VaporCore::Leaderboards::UploadResult upload;
+    bool bSuccess = m_leaderboards.Upload(hSteamLeaderboard,
+                                          VaporCore::Config::GetInstance().SteamID().ConvertToUint64(),
+                                          eLeaderboardUploadScoreMethod, nScore, pScoreDetails, cScoreDetailsCount,
+                                          upload);
+
+    LeaderboardScoreUploaded_t result = {};
+    result.m_bSuccess = bSuccess;
+    result.m_hSteamLeaderboard = hSteamLeaderboard;
+    result.m_nScore = nScore;
+    result.m_bScoreChanged = upload.m_bScoreChanged;
+    result.m_nGlobalRankNew = upload.m_nGlobalRankNew;
+    result.m_nGlobalRankPrevious = upload.m_nGlobalRankPrevious;
+    return CCallbackMgr::GetInstance().PostCallResult(&result, sizeof(result));
 }
 
 // Changed from Steam SDK v1.05, backward compatibility
 SteamAPICall_t CSteamUserStats::UploadLeaderboardScore( SteamLeaderboard_t hSteamLeaderboard, int32 nScore, int32 *pScoreDetails, int cScoreDetailsCount )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, Score: %d, Details: %d", hSteamLeaderboard, nScore, cScoreDetailsCount);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Leaderboard: %llu, Score: %d, Details: %d", hSteamLeaderboard, nScore, cScoreDetailsCount);
+
+    // Before upload methods existed a board kept each user's best score
+    return UploadLeaderboardScore(hSteamLeaderboard, k_ELeaderboardUploadScoreMethodKeepBest, nScore, pScoreDetails,
+                                  cScoreDetailsCount);
 }
 
 // Attaches a piece of user generated content the user's entry on a leaderboard.
@@ -333,8 +417,16 @@ SteamAPICall_t CSteamUserStats::UploadLeaderboardScore( SteamLeaderboard_t hStea
 STEAM_CALL_RESULT( LeaderboardUGCSet_t )
 SteamAPICall_t CSteamUserStats::AttachLeaderboardUGC( SteamLeaderboard_t hSteamLeaderboard, UGCHandle_t hUGC )
 {
-    VLOG_INFO(__FUNCTION__ " - Leaderboard: %u, UGC: %u", hSteamLeaderboard, hUGC);
-    return 0;
+    VLOG_INFO(__FUNCTION__ " - Leaderboard: %llu, UGC: %llu", hSteamLeaderboard, hUGC);
+
+    // The user needs an entry to attach to
+    LeaderboardUGCSet_t result = {};
+    result.m_hSteamLeaderboard = hSteamLeaderboard;
+    result.m_eResult = m_leaderboards.AttachUGC(hSteamLeaderboard,
+                                                VaporCore::Config::GetInstance().SteamID().ConvertToUint64(), hUGC)
+                           ? k_EResultOK
+                           : k_EResultFail;
+    return CCallbackMgr::GetInstance().PostCallResult(&result, sizeof(result));
 }
 
 // Retrieves the number of players currently playing your game (online + offline)
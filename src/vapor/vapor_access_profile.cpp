@@ -0,0 +1,122 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Per-file read frequency remembered across runs
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "vapor_access_profile.h"
+#include "vapor_file_io.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+static const uint32 PROFILE_MAGIC = 0x50414356;     // "VCAP"
+static const uint32 PROFILE_VERSION = 1;
+
+// Sanity bound for names read back from a profile
+static const uint32 PROFILE_MAX_NAME_LENGTH = 4096;
+
+struct ProfileHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_cEntries;
+    uint32 m_unReserved;
+};
+
+struct ProfileEntryHeader
+{
+    uint32 m_unScore;
+    uint32 m_cchName;
+};
+
+AccessProfile::AccessProfile(const std::string& directory)
+    : m_sPath(directory + "/" + ACCESS_PROFILE_FILENAME)
+{
+}
+
+void AccessProfile::Load()
+{
+    m_scores.clear();
+
+    std::ifstream file(m_sPath, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    ProfileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_unMagic != PROFILE_MAGIC || header.m_unVersion != PROFILE_VERSION) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring unreadable profile: %s", m_sPath.c_str());
+        return;
+    }
+
+    for (uint32 i = 0; i < header.m_cEntries; ++i) {
+        ProfileEntryHeader entry;
+        if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) || entry.m_cchName > PROFILE_MAX_NAME_LENGTH) {
+            break;
+        }
+        std::string name(entry.m_cchName, '\0');
+        if (!file.read(&name[0], entry.m_cchName)) {
+            break;
+        }
+        m_scores[name] = entry.m_unScore;
+    }
+}
+
+bool AccessProfile::Save()
+{
+    // Earlier runs count half as much as this one
+    std::unordered_map<std::string, uint32> scores;
+    for (const auto& score : m_scores) {
+        if (score.second / 2 > 0) {
+            scores[score.first] = score.second / 2;
+        }
+    }
+    for (const auto& reads : m_reads) {
+        uint32& unScore = scores[reads.first];
+        unScore = static_cast<uint32>(std::min<uint64>(static_cast<uint64>(unScore) + reads.second, UINT32_MAX));
+    }
+
+    std::vector<uint8> data;
+    ProfileHeader header = { PROFILE_MAGIC, PROFILE_VERSION, static_cast<uint32>(scores.size()), 0 };
+    const uint8* pHeader = reinterpret_cast<const uint8*>(&header);
+    data.insert(data.end(), pHeader, pHeader + sizeof(header));
+    for (const auto& score : scores) {
+        ProfileEntryHeader entry = { score.second, static_cast<uint32>(score.first.size()) };
+        const uint8* pEntry = reinterpret_cast<const uint8*>(&entry);
+        data.insert(data.end(), pEntry, pEntry + sizeof(entry));
+        data.insert(data.end(), score.first.begin(), score.first.end());
+    }
+
+    if (!WriteFileAtomic(m_sPath, data.data(), data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write profile: %s", m_sPath.c_str());
+        return false;
+    }
+
+    m_scores.swap(scores);
+    m_reads.clear();
+    return true;
+}
+
+void AccessProfile::RecordRead(const std::string& name)
+{
+    ++m_reads[name];
+}
+
+uint32 AccessProfile::GetScore(const std::string& name) const
+{
+    auto it = m_scores.find(name);
+    return it != m_scores.end() ? it->second : 0;
+}
+
+} // namespace VaporCore
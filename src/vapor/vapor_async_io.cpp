@@ -0,0 +1,513 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Asynchronous file I/O engine (io_uring on Linux, worker threads elsewhere)
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define VAPORCORE_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef VAPORCORE_HAS_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "vapor_async_io.h"
+#include "vapor_config.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+static constexpr Config::Key KEY_STORAGE_IO_URING{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_IO_URING };
+
+// Worker pool bounds, scaled from the number of hardware threads
+static const uint32 MIN_WORKER_THREADS = 2;
+static const uint32 MAX_WORKER_THREADS = 8;
+
+//-----------------------------------------------------------------------------
+// Purpose: One pool thread with a private FIFO. Keyed tasks always map to the
+// same worker, which is what serializes them.
+//-----------------------------------------------------------------------------
+struct AsyncIO::Worker
+{
+    std::thread m_thread;
+    std::deque<std::function<void()>> m_queue;
+    bool m_bStop = false;
+    bool m_bExited = false;         // Drained and stopped, takes no more tasks
+    std::condition_variable_any m_condition;
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("AsyncIO::Worker::m_mutex");
+};
+
+#ifdef VAPORCORE_HAS_IO_URING
+
+// Submission queue depth, also the cap on reads in flight (the completion queue is twice as deep)
+static const unsigned IO_URING_ENTRIES = 256;
+
+static int IoUringSetup(unsigned entries, io_uring_params* pParams)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, pParams));
+}
+
+static int IoUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Minimal io_uring driver, talking to the kernel through the raw
+// system calls so there is no liburing dependency. Submissions are made under
+// m_mutex and entered immediately; a dedicated thread reaps completions.
+//-----------------------------------------------------------------------------
+struct AsyncIO::Ring
+{
+    struct Request
+    {
+        int m_fd = -1;
+        struct iovec m_iov = {};
+        std::vector<uint8> m_buffer;
+        ReadCompletion m_completion;
+    };
+
+    ~Ring() { Destroy(); }
+
+    bool Init()
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        m_fd = IoUringSetup(IO_URING_ENTRIES, &params);
+        if (m_fd < 0) {
+            VLOG_INFO(__FUNCTION__ " - io_uring unavailable (errno %d), using worker threads", errno);
+            return false;
+        }
+
+        m_unSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_unCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (bSingleMap) {
+            m_unSqRingSize = m_unCqRingSize = std::max(m_unSqRingSize, m_unCqRingSize);
+        }
+
+        m_pSqRing = mmap(nullptr, m_unSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if (m_pSqRing == MAP_FAILED) {
+            m_pSqRing = nullptr;
+            Destroy();
+            return false;
+        }
+
+        m_pCqRing = bSingleMap ? m_pSqRing
+                               : mmap(nullptr, m_unCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        if (m_pCqRing == MAP_FAILED) {
+            m_pCqRing = nullptr;
+            Destroy();
+            return false;
+        }
+
+        m_unSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* pSqes = mmap(nullptr, m_unSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+        if (pSqes == MAP_FAILED) {
+            Destroy();
+            return false;
+        }
+        m_pSqes = static_cast<io_uring_sqe*>(pSqes);
+
+        char* pSq = static_cast<char*>(m_pSqRing);
+        m_pSqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+        m_unSqMask = *reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+        m_pSqArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+
+        char* pCq = static_cast<char*>(m_pCqRing);
+        m_pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+        m_pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+        m_unCqMask = *reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+        m_pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+
+        m_unMaxInFlight = params.sq_entries - 1;   // One slot stays free for the shutdown wake-up
+        m_completionThread = std::thread(&Ring::CompletionThread, this);
+
+        VLOG_INFO(__FUNCTION__ " - io_uring ready, %u entries", params.sq_entries);
+        return true;
+    }
+
+    // Drain in-flight reads, stop the completion thread and unmap the rings
+    void Destroy()
+    {
+        if (m_completionThread.joinable()) {
+            {
+                VAPORCORE_SCOPED_LOCK(m_mutex);
+                m_bStopping = true;
+                PushLocked(IORING_OP_NOP, -1, nullptr, 0, 0);
+            }
+            m_completionThread.join();
+        }
+
+        if (m_pSqes) {
+            munmap(m_pSqes, m_unSqesSize);
+            m_pSqes = nullptr;
+        }
+        if (m_pCqRing && m_pCqRing != m_pSqRing) {
+            munmap(m_pCqRing, m_unCqRingSize);
+        }
+        m_pCqRing = nullptr;
+        if (m_pSqRing) {
+            munmap(m_pSqRing, m_unSqRingSize);
+            m_pSqRing = nullptr;
+        }
+        if (m_fd >= 0) {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    // Hand a read to the kernel. False when the ring is saturated or refused it,
+    // in which case the caller still owns pRequest
+    bool Submit(Request* pRequest, uint64 unOffset)
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+
+        if (m_bStopping || m_unInFlight >= m_unMaxInFlight) {
+            return false;
+        }
+
+        if (!PushLocked(IORING_OP_READV, pRequest->m_fd, &pRequest->m_iov, unOffset, reinterpret_cast<uint64>(pRequest))) {
+            return false;
+        }
+
+        ++m_unInFlight;
+        return true;
+    }
+
+private:
+    // Queue one submission entry and enter it (callers hold m_mutex)
+    bool PushLocked(uint8 opcode, int fd, struct iovec* pIov, uint64 unOffset, uint64 unUserData)
+    {
+        unsigned tail = *m_pSqTail;
+        unsigned index = tail & m_unSqMask;
+
+        io_uring_sqe* pSqe = &m_pSqes[index];
+        memset(pSqe, 0, sizeof(*pSqe));
+        pSqe->opcode = opcode;
+        pSqe->fd = fd;
+        pSqe->addr = reinterpret_cast<uint64>(pIov);
+        pSqe->len = pIov ? 1 : 0;
+        pSqe->off = unOffset;
+        pSqe->user_data = unUserData;
+
+        m_pSqArray[index] = index;
+        __atomic_store_n(m_pSqTail, tail + 1, __ATOMIC_RELEASE);
+
+        int nSubmitted;
+        do {
+            nSubmitted = IoUringEnter(m_fd, 1, 0, 0);
+        } while (nSubmitted < 0 && errno == EINTR);
+
+        if (nSubmitted != 1) {
+            // Nothing was consumed, take the entry back
+            __atomic_store_n(m_pSqTail, tail, __ATOMIC_RELEASE);
+            VLOG_WARNING(__FUNCTION__ " - io_uring_enter failed (errno %d)", errno);
+            return false;
+        }
+        return true;
+    }
+
+    void CompletionThread()
+    {
+        for (;;) {
+            int nResult = IoUringEnter(m_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (nResult < 0 && errno != EINTR) {
+                VLOG_ERROR(__FUNCTION__ " - io_uring_enter failed (errno %d)", errno);
+                break;
+            }
+
+            unsigned head = *m_pCqHead;
+            unsigned tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+            uint32 unCompleted = 0;
+
+            while (head != tail) {
+                io_uring_cqe* pCqe = &m_pCqes[head & m_unCqMask];
+                Request* pRequest = reinterpret_cast<Request*>(pCqe->user_data);
+                int32 nBytes = pCqe->res;
+                __atomic_store_n(m_pCqHead, ++head, __ATOMIC_RELEASE);
+
+                if (pRequest) {
+                    Complete(pRequest, nBytes);
+                    ++unCompleted;
+                }
+            }
+
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            m_unInFlight -= unCompleted;
+            if (m_bStopping && m_unInFlight == 0) {
+                break;
+            }
+        }
+    }
+
+    static void Complete(Request* pRequest, int32 nBytes)
+    {
+        std::unique_ptr<Request> request(pRequest);
+        close(request->m_fd);
+
+        if (nBytes < 0) {
+            VLOG_ERROR(__FUNCTION__ " - Read failed (errno %d)", -nBytes);
+            request->m_completion(false, std::vector<uint8>());
+            return;
+        }
+
+        request->m_buffer.resize(static_cast<size_t>(nBytes));
+        request->m_completion(true, std::move(request->m_buffer));
+    }
+
+private:
+    int m_fd = -1;
+    void* m_pSqRing = nullptr;
+    void* m_pCqRing = nullptr;
+    size_t m_unSqRingSize = 0;
+    size_t m_unCqRingSize = 0;
+    size_t m_unSqesSize = 0;
+
+    io_uring_sqe* m_pSqes = nullptr;
+    unsigned* m_pSqTail = nullptr;
+    unsigned* m_pSqArray = nullptr;
+    unsigned m_unSqMask = 0;
+
+    io_uring_cqe* m_pCqes = nullptr;
+    unsigned* m_pCqHead = nullptr;
+    unsigned* m_pCqTail = nullptr;
+    unsigned m_unCqMask = 0;
+
+    std::thread m_completionThread;
+    uint32 m_unInFlight = 0;
+    uint32 m_unMaxInFlight = 0;
+    bool m_bStopping = false;
+    VaporCore::Mutex m_mutex VAPORCORE_MUTEX_NAME("AsyncIO::Ring::m_mutex");
+};
+
+#else
+
+// No io_uring on this platform, every read goes through the worker pool
+struct AsyncIO::Ring
+{
+};
+
+#endif // VAPORCORE_HAS_IO_URING
+
+AsyncIO& AsyncIO::GetInstance()
+{
+    static AsyncIO instance;
+    return instance;
+}
+
+AsyncIO::AsyncIO()
+    : m_unNextWorker(0),
+      m_bIoUring(false),
+      m_bStarted(false),
+      m_bShutdown(false)
+{
+}
+
+AsyncIO::~AsyncIO()
+{
+    Shutdown();
+}
+
+void AsyncIO::Start()
+{
+    if (m_bStarted || m_bShutdown) {
+        return;
+    }
+
+    uint32 unThreads = std::clamp(std::thread::hardware_concurrency() / 2, MIN_WORKER_THREADS, MAX_WORKER_THREADS);
+    for (uint32 i = 0; i < unThreads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+        Worker* pWorker = m_workers.back().get();
+        pWorker->m_thread = std::thread(&AsyncIO::WorkerThread, this, pWorker);
+    }
+
+#ifdef VAPORCORE_HAS_IO_URING
+    if (Config::GetInstance().GetBool(KEY_STORAGE_IO_URING, true)) {
+        auto pRing = std::make_unique<Ring>();
+        if (pRing->Init()) {
+            m_pRing = std::move(pRing);
+            m_bIoUring.store(true);
+        }
+    }
+#endif
+
+    m_bStarted = true;
+    VLOG_DEBUG(__FUNCTION__ " - %u worker threads, io_uring %s", unThreads, m_bIoUring.load() ? "on" : "off");
+}
+
+void AsyncIO::Shutdown()
+{
+    // Nothing starts the engine again, so late posts cannot create threads nobody joins
+    std::unique_ptr<Ring> pRing;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        bool bShutdown = m_bShutdown;
+        m_bShutdown = true;
+        if (!m_bStarted || bShutdown) {
+            return;
+        }
+
+        pRing = std::move(m_pRing);
+        m_bIoUring.store(false);
+    }
+
+    // Reads first, while the workers still run: their completions may post follow-up work
+    pRing.reset();
+
+    // Workers drain their queues before exiting, still taking posts until they do
+    for (auto& pWorker : m_workers) {
+        {
+            VAPORCORE_SCOPED_LOCK(pWorker->m_mutex);
+            pWorker->m_bStop = true;
+        }
+        pWorker->m_condition.notify_one();
+    }
+    for (auto& pWorker : m_workers) {
+        pWorker->m_thread.join();
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_workers.clear();
+    m_bStarted = false;
+}
+
+bool AsyncIO::Post(uint64 unKey, std::function<void()> task)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Start();
+    if (m_workers.empty()) {
+        VLOG_DEBUG(__FUNCTION__ " - Rejected a task posted after shutdown");
+        return false;
+    }
+
+    Worker* pWorker = m_workers[unKey % m_workers.size()].get();
+    {
+        VAPORCORE_SCOPED_LOCK(pWorker->m_mutex);
+        if (pWorker->m_bExited) {
+            VLOG_DEBUG(__FUNCTION__ " - Rejected a task posted after shutdown");
+            return false;
+        }
+        pWorker->m_queue.push_back(std::move(task));
+    }
+    pWorker->m_condition.notify_one();
+    return true;
+}
+
+void AsyncIO::ReadAt(const std::string& path, uint64 unOffset, uint32 cubToRead, ReadCompletion completion)
+{
+#ifdef VAPORCORE_HAS_IO_URING
+    {
+        // Completions never run under m_mutex, they may post follow-up work
+        std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+        Start();
+
+        if (m_pRing) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                VLOG_DEBUG(__FUNCTION__ " - Failed to open %s: errno %d", path.c_str(), errno);
+                lock.unlock();
+                completion(false, std::vector<uint8>());
+                return;
+            }
+
+            auto pRequest = std::make_unique<Ring::Request>();
+            pRequest->m_fd = fd;
+            pRequest->m_buffer.resize(cubToRead);
+            pRequest->m_iov.iov_base = pRequest->m_buffer.data();
+            pRequest->m_iov.iov_len = cubToRead;
+            pRequest->m_completion = std::move(completion);
+
+            if (m_pRing->Submit(pRequest.get(), unOffset)) {
+                pRequest.release();
+                return;
+            }
+
+            // Ring saturated, let a worker do this one
+            close(fd);
+            completion = std::move(pRequest->m_completion);
+        }
+    }
+#endif
+
+    // The task owns the completion; a rejected one hands it back to fail it here
+    auto pCompletion = std::make_shared<ReadCompletion>(std::move(completion));
+    bool bPosted = Post(m_unNextWorker.fetch_add(1), [path, unOffset, cubToRead, pCompletion]() {
+        std::vector<uint8> data;
+        bool bSuccess = ReadAtBlocking(path, unOffset, cubToRead, data);
+        (*pCompletion)(bSuccess, std::move(data));
+    });
+    if (!bPosted) {
+        (*pCompletion)(false, std::vector<uint8>());
+    }
+}
+
+bool AsyncIO::ReadAtBlocking(const std::string& path, uint64 unOffset, uint32 cubToRead, std::vector<uint8>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        VLOG_DEBUG(__FUNCTION__ " - Failed to open %s", path.c_str());
+        return false;
+    }
+
+    uint64 unFileSize = static_cast<uint64>(file.tellg());
+    if (unOffset >= unFileSize) {
+        return true;
+    }
+
+    data.resize(static_cast<size_t>(std::min<uint64>(cubToRead, unFileSize - unOffset)));
+    file.seekg(static_cast<std::streamoff>(unOffset));
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    data.resize(static_cast<size_t>(file.gcount()));
+
+    if (file.bad()) {
+        VLOG_ERROR(__FUNCTION__ " - Error reading %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void AsyncIO::WorkerThread(Worker* pWorker)
+{
+    std::unique_lock<VaporCore::Mutex> lock(pWorker->m_mutex);
+
+    for (;;) {
+        pWorker->m_condition.wait(lock, [pWorker]() { return !pWorker->m_queue.empty() || pWorker->m_bStop; });
+        if (pWorker->m_queue.empty()) {
+            pWorker->m_bExited = true;
+            break;
+        }
+
+        std::function<void()> task = std::move(pWorker->m_queue.front());
+        pWorker->m_queue.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+} // namespace VaporCore
@@ -12,4 +12,4 @@
 #include "vapor_base.h"
 
 // Global synchronization mutex
-std::recursive_mutex g_GlobalMutex; 
+VaporCore::RecursiveMutex g_GlobalMutex VAPORCORE_MUTEX_NAME("g_GlobalMutex");
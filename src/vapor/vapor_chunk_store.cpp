@@ -0,0 +1,740 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Content-addressed, deduplicating chunk store
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include "vapor_chunk_store.h"
+#include "vapor_config.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Content-defined chunking: no cut before the minimum, a strict boundary test
+// up to the average and a looser one after it, a forced cut at the maximum
+static const size_t CHUNK_MIN_SIZE = 16 * 1024;
+static const size_t CHUNK_AVG_SIZE = 64 * 1024;
+static const size_t CHUNK_MAX_SIZE = 256 * 1024;
+static const uint64 CHUNK_MASK_STRICT = ~0ULL << (64 - 18);
+static const uint64 CHUNK_MASK_LOOSE = ~0ULL << (64 - 14);
+
+// Contents up to this size stay inside the manifest
+static const size_t MANIFEST_INLINE_MAX = 4096;
+
+static const uint32 MANIFEST_MAGIC = 0x464d4356;    // "VCMF"
+static const uint16 MANIFEST_VERSION = 1;
+
+static const uint32 REF_LOG_MAGIC = 0x4c524356;     // "VCRL"
+static const uint32 REF_LOG_VERSION = 1;
+static const char* REF_LOG_FILENAME = "refs.vclog";
+static const char* ROOTS_DIRECTORY = "roots";
+static const char* CHUNK_EXTENSION = ".vcchunk";
+static const char* ROOT_EXTENSION = ".vcmanifest";
+
+// Compact the reference log once it holds this many records per live chunk
+static const uint64 REF_LOG_COMPACT_RATIO = 4;
+static const uint64 REF_LOG_COMPACT_MIN_RECORDS = 4096;
+
+static constexpr Config::Key KEY_STORAGE_CHUNK_STORE_DIR{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_CHUNK_STORE_DIR };
+
+struct ManifestHeader
+{
+    uint32 m_unMagic;
+    uint16 m_unVersion;
+    uint16 m_unReserved;
+    uint32 m_cChunks;
+    uint32 m_cubInline;
+    uint64 m_unSize;
+    uint64 m_unChecksum;    // Over the fields above and everything after the header
+};
+
+struct ManifestChunk
+{
+    uint64 m_unIdLow;
+    uint64 m_unIdHigh;
+    uint32 m_cubSize;
+    uint32 m_unReserved;
+};
+
+struct RefLogHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint64 m_unReserved;
+};
+
+struct RefLogRecord
+{
+    uint64 m_unIdLow;
+    uint64 m_unIdHigh;
+    int32 m_nDelta;
+    uint32 m_cubSize;
+    uint64 m_unCheck;
+};
+
+static_assert(sizeof(ManifestHeader) == 32, "Manifest header layout changed");
+static_assert(sizeof(ManifestChunk) == 24, "Manifest chunk layout changed");
+static_assert(sizeof(RefLogRecord) == 32, "Reference log record layout changed");
+
+// Shared instances by directory
+static std::mutex s_storesMutex;
+static std::unordered_map<std::string, std::weak_ptr<ChunkStore>> s_stores;
+
+// Random value per byte for the gear rolling hash
+static const std::array<uint64, 256>& GearTable()
+{
+    static const std::array<uint64, 256> table = []() {
+        std::array<uint64, 256> values{};
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = HashMix64(0x9e3779b97f4a7c15ULL * (i + 1));
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Length of the next chunk. The fingerprint only depends on the last 64 bytes,
+// so boundaries move with the content instead of with absolute offsets
+static size_t FindChunkBoundary(const uint8* pData, size_t cubData)
+{
+    if (cubData <= CHUNK_MIN_SIZE) {
+        return cubData;
+    }
+
+    const std::array<uint64, 256>& gear = GearTable();
+    size_t unLimit = std::min(cubData, CHUNK_MAX_SIZE);
+    size_t unNormal = std::min(unLimit, CHUNK_AVG_SIZE);
+    uint64 fingerprint = 0;
+
+    size_t i = CHUNK_MIN_SIZE;
+    for (; i < unNormal; ++i) {
+        fingerprint = (fingerprint << 1) + gear[pData[i]];
+        if (!(fingerprint & CHUNK_MASK_STRICT)) {
+            return i + 1;
+        }
+    }
+    for (; i < unLimit; ++i) {
+        fingerprint = (fingerprint << 1) + gear[pData[i]];
+        if (!(fingerprint & CHUNK_MASK_LOOSE)) {
+            return i + 1;
+        }
+    }
+    return unLimit;
+}
+
+static uint64 RefRecordCheck(const RefLogRecord& record)
+{
+    return HashBytes64(&record, offsetof(RefLogRecord, m_unCheck), REF_LOG_MAGIC);
+}
+
+static std::string ChunkIdToString(const ChunkId& id)
+{
+    char buffer[33];
+    snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+             static_cast<unsigned long long>(id.m_unHigh), static_cast<unsigned long long>(id.m_unLow));
+    return buffer;
+}
+
+// References per distinct chunk, in first-seen order
+static std::vector<std::pair<ChunkManifest::Chunk, int32>> CountChunks(const std::vector<ChunkManifest::Chunk>& chunks)
+{
+    std::vector<std::pair<ChunkManifest::Chunk, int32>> counts;
+    std::unordered_map<ChunkId, size_t, ChunkIdHasher> positions;
+    for (const ChunkManifest::Chunk& chunk : chunks) {
+        auto result = positions.try_emplace(chunk.m_id, counts.size());
+        if (result.second) {
+            counts.emplace_back(chunk, 1);
+        } else {
+            ++counts[result.first->second].second;
+        }
+    }
+    return counts;
+}
+
+//-----------------------------------------------------------------------------
+// ChunkManifest
+//-----------------------------------------------------------------------------
+
+size_t ChunkManifest::HeaderSize()
+{
+    return sizeof(ManifestHeader);
+}
+
+void ChunkManifest::Serialize(std::vector<uint8>& data) const
+{
+    data.resize(sizeof(ManifestHeader) + m_chunks.size() * sizeof(ManifestChunk) + m_inline.size());
+
+    uint8* pBody = data.data() + sizeof(ManifestHeader);
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        ManifestChunk chunk = {};
+        chunk.m_unIdLow = m_chunks[i].m_id.m_unLow;
+        chunk.m_unIdHigh = m_chunks[i].m_id.m_unHigh;
+        chunk.m_cubSize = m_chunks[i].m_cubSize;
+        memcpy(pBody + i * sizeof(ManifestChunk), &chunk, sizeof(chunk));
+    }
+    if (!m_inline.empty()) {
+        memcpy(pBody + m_chunks.size() * sizeof(ManifestChunk), m_inline.data(), m_inline.size());
+    }
+
+    ManifestHeader header = {};
+    header.m_unMagic = MANIFEST_MAGIC;
+    header.m_unVersion = MANIFEST_VERSION;
+    header.m_cChunks = static_cast<uint32>(m_chunks.size());
+    header.m_cubInline = static_cast<uint32>(m_inline.size());
+    header.m_unSize = m_unSize;
+    header.m_unChecksum = HashBytes64(pBody, data.size() - sizeof(header),
+                                      HashBytes64(&header, offsetof(ManifestHeader, m_unChecksum)));
+    memcpy(data.data(), &header, sizeof(header));
+}
+
+bool ChunkManifest::ParseHeader(const void* pHeader, size_t cubHeader, uint64 unStoredSize, uint64& unSize)
+{
+    if (cubHeader < sizeof(ManifestHeader)) {
+        return false;
+    }
+
+    ManifestHeader header;
+    memcpy(&header, pHeader, sizeof(header));
+    if (header.m_unMagic != MANIFEST_MAGIC || header.m_unVersion != MANIFEST_VERSION ||
+        unStoredSize != sizeof(ManifestHeader) + static_cast<uint64>(header.m_cChunks) * sizeof(ManifestChunk) + header.m_cubInline) {
+        return false;
+    }
+
+    unSize = header.m_unSize;
+    return true;
+}
+
+bool ChunkManifest::Parse(const void* pData, size_t cubData, ChunkManifest& manifest)
+{
+    uint64 unSize;
+    if (!ParseHeader(pData, cubData, cubData, unSize)) {
+        return false;
+    }
+
+    ManifestHeader header;
+    memcpy(&header, pData, sizeof(header));
+    const uint8* pBody = static_cast<const uint8*>(pData) + sizeof(header);
+    uint64 unChecksum = HashBytes64(pBody, cubData - sizeof(header),
+                                    HashBytes64(&header, offsetof(ManifestHeader, m_unChecksum)));
+    if (unChecksum != header.m_unChecksum) {
+        return false;
+    }
+
+    manifest.m_unSize = unSize;
+    manifest.m_chunks.resize(header.m_cChunks);
+
+    uint64 unTotal = header.m_cubInline;
+    for (uint32 i = 0; i < header.m_cChunks; ++i) {
+        ManifestChunk chunk;
+        memcpy(&chunk, pBody + i * sizeof(ManifestChunk), sizeof(chunk));
+        manifest.m_chunks[i].m_id.m_unLow = chunk.m_unIdLow;
+        manifest.m_chunks[i].m_id.m_unHigh = chunk.m_unIdHigh;
+        manifest.m_chunks[i].m_cubSize = chunk.m_cubSize;
+        unTotal += chunk.m_cubSize;
+    }
+
+    const uint8* pInline = pBody + header.m_cChunks * sizeof(ManifestChunk);
+    manifest.m_inline.assign(pInline, pInline + header.m_cubInline);
+    return unTotal == unSize;
+}
+
+//-----------------------------------------------------------------------------
+// ChunkStore
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<ChunkStore> ChunkStore::Open(const std::string& directory)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(directory, ec).string();
+    if (ec) {
+        key = directory;
+    }
+
+    std::lock_guard<std::mutex> lock(s_storesMutex);
+    std::shared_ptr<ChunkStore> pStore = s_stores[key].lock();
+    if (pStore) {
+        return pStore;
+    }
+
+    pStore.reset(new ChunkStore(directory));
+    if (!pStore->Load()) {
+        VLOG_ERROR(__FUNCTION__ " - Cannot open chunk store: %s", directory.c_str());
+        return nullptr;
+    }
+
+    s_stores[key] = pStore;
+    return pStore;
+}
+
+std::shared_ptr<ChunkStore> ChunkStore::OpenDefault()
+{
+    return Open(std::string(Config::GetInstance().GetString(KEY_STORAGE_CHUNK_STORE_DIR, DEFAULT_CHUNK_STORE_DIRECTORY)));
+}
+
+ChunkStore::ChunkStore(const std::string& directory)
+    : m_sDirectory(directory),
+      m_cRefRecords(0)
+{
+}
+
+ChunkStore::~ChunkStore()
+{
+    VLOG_INFO(__FUNCTION__ " - %s: %llu chunks, %llu bytes; this session stored %llu bytes, wrote %llu",
+              m_sDirectory.c_str(), m_stats.m_cChunks, m_stats.m_cubStored, m_stats.m_cubLogicalWritten, m_stats.m_cubWritten);
+}
+
+std::string ChunkStore::GetChunkPath(const ChunkId& id) const
+{
+    // Fan out over 256 directories to keep each one small
+    std::string name = ChunkIdToString(id);
+    return m_sDirectory + "/" + name.substr(0, 2) + "/" + name + CHUNK_EXTENSION;
+}
+
+std::string ChunkStore::GetRootPath(const std::string& key) const
+{
+    return m_sDirectory + "/" + ROOTS_DIRECTORY + "/" + key + ROOT_EXTENSION;
+}
+
+bool ChunkStore::Load()
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_sDirectory + "/" + ROOTS_DIRECTORY, ec);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    if (!m_refLog.Open(m_sDirectory + "/" + REF_LOG_FILENAME, true)) {
+        return false;
+    }
+
+    if (m_refLog.Size() == 0) {
+        RefLogHeader header = {};
+        header.m_unMagic = REF_LOG_MAGIC;
+        header.m_unVersion = REF_LOG_VERSION;
+        if (!m_refLog.Append(&header, sizeof(header)) || !m_refLog.Sync()) {
+            return false;
+        }
+    }
+
+    std::vector<uint8> log(static_cast<size_t>(m_refLog.Size()));
+    RefLogHeader header;
+    if (!m_refLog.ReadAt(0, log.data(), log.size()) || log.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, log.data(), sizeof(header));
+    if (header.m_unMagic != REF_LOG_MAGIC || header.m_unVersion != REF_LOG_VERSION) {
+        VLOG_ERROR(__FUNCTION__ " - Not a supported reference log in %s", m_sDirectory.c_str());
+        return false;
+    }
+
+    size_t unPos = sizeof(header);
+    for (; unPos + sizeof(RefLogRecord) <= log.size(); unPos += sizeof(RefLogRecord)) {
+        RefLogRecord record;
+        memcpy(&record, log.data() + unPos, sizeof(record));
+        if (record.m_unCheck != RefRecordCheck(record)) {
+            break;
+        }
+
+        ChunkEntry& entry = m_chunks[ChunkId{ record.m_unIdLow, record.m_unIdHigh }];
+        entry.m_nRefs += record.m_nDelta;
+        entry.m_nLoggedRefs += record.m_nDelta;
+        entry.m_cubSize = record.m_cubSize;
+        entry.m_bWritten = true;
+        ++m_cRefRecords;
+    }
+
+    // A torn record from a crash mid-append, nothing after it was acknowledged
+    if (unPos < log.size()) {
+        VLOG_WARNING(__FUNCTION__ " - Discarding %zu bytes of incomplete records in %s", log.size() - unPos, m_sDirectory.c_str());
+        if (!m_refLog.Truncate(unPos) || !m_refLog.Sync()) {
+            return false;
+        }
+    }
+
+    // Chunks whose last release was logged but not yet deleted
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        if (it->second.m_nRefs <= 0) {
+            std::filesystem::remove(GetChunkPath(it->first), ec);
+            it = m_chunks.erase(it);
+        } else {
+            m_stats.m_cubStored += it->second.m_cubSize;
+            ++it;
+        }
+    }
+    m_stats.m_cChunks = m_chunks.size();
+
+    if (m_cRefRecords > REF_LOG_COMPACT_MIN_RECORDS && m_cRefRecords > m_chunks.size() * REF_LOG_COMPACT_RATIO) {
+        CompactRefLog();
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Opened %s: %llu chunks, %llu bytes", m_sDirectory.c_str(), m_stats.m_cChunks, m_stats.m_cubStored);
+    return true;
+}
+
+bool ChunkStore::AppendRefs(const std::vector<RefDelta>& deltas)
+{
+    if (deltas.empty()) {
+        return true;
+    }
+
+    // One append and one sync for the whole file, however many chunks it has
+    std::vector<RefLogRecord> records(deltas.size());
+    for (size_t i = 0; i < deltas.size(); ++i) {
+        RefLogRecord& record = records[i];
+        record.m_unIdLow = deltas[i].m_id.m_unLow;
+        record.m_unIdHigh = deltas[i].m_id.m_unHigh;
+        record.m_nDelta = deltas[i].m_nDelta;
+        record.m_cubSize = deltas[i].m_cubSize;
+        record.m_unCheck = RefRecordCheck(record);
+    }
+
+    uint64 unOffset = 0;
+    if (!m_refLog.Append(records.data(), records.size() * sizeof(RefLogRecord), &unOffset) || !m_refLog.Sync()) {
+        m_refLog.Truncate(unOffset);
+        VLOG_ERROR(__FUNCTION__ " - Failed to log reference changes in %s", m_sDirectory.c_str());
+        return false;
+    }
+
+    m_cRefRecords += records.size();
+    for (const RefDelta& delta : deltas) {
+        auto it = m_chunks.find(delta.m_id);
+        if (it != m_chunks.end()) {
+            it->second.m_nLoggedRefs += delta.m_nDelta;
+        }
+    }
+    return true;
+}
+
+bool ChunkStore::CompactRefLog()
+{
+    std::string logPath = m_sDirectory + "/" + REF_LOG_FILENAME;
+
+    std::vector<uint8> data(sizeof(RefLogHeader));
+    RefLogHeader header = {};
+    header.m_unMagic = REF_LOG_MAGIC;
+    header.m_unVersion = REF_LOG_VERSION;
+    memcpy(data.data(), &header, sizeof(header));
+
+    // Logged counts only: references a Store has taken but not logged yet are
+    // appended by that Store, or dropped again if it fails
+    uint64 cRecords = 0;
+    for (const auto& [id, entry] : m_chunks) {
+        if (entry.m_nLoggedRefs <= 0) {
+            continue;
+        }
+
+        RefLogRecord record;
+        record.m_unIdLow = id.m_unLow;
+        record.m_unIdHigh = id.m_unHigh;
+        record.m_nDelta = static_cast<int32>(std::min<int64>(entry.m_nLoggedRefs, INT32_MAX));
+        record.m_cubSize = entry.m_cubSize;
+        record.m_unCheck = RefRecordCheck(record);
+        const uint8* pRecord = reinterpret_cast<const uint8*>(&record);
+        data.insert(data.end(), pRecord, pRecord + sizeof(record));
+        ++cRecords;
+    }
+
+    if (!WriteFileAtomic(logPath, data.data(), data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to compact %s", logPath.c_str());
+        return false;
+    }
+
+    // The old handle still points at the replaced file
+    m_refLog.Close();
+    if (!m_refLog.Open(logPath, false)) {
+        return false;
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Compacted reference log: %llu -> %llu records", m_cRefRecords, cRecords);
+    m_cRefRecords = cRecords;
+    return true;
+}
+
+bool ChunkStore::Store(const void* pData, size_t cubData, ChunkManifest& manifest)
+{
+    const uint8* pBytes = static_cast<const uint8*>(pData);
+
+    manifest = ChunkManifest();
+    manifest.m_unSize = cubData;
+    if (cubData <= MANIFEST_INLINE_MAX) {
+        manifest.m_inline.assign(pBytes, pBytes + cubData);
+        return true;
+    }
+
+    // Cut and hash without the lock, this is where the time goes
+    std::vector<size_t> offsets;
+    for (size_t unPos = 0; unPos < cubData;) {
+        size_t cubChunk = FindChunkBoundary(pBytes + unPos, cubData - unPos);
+        ChunkManifest::Chunk chunk;
+        chunk.m_id = HashBytes128(pBytes + unPos, cubChunk);
+        chunk.m_cubSize = static_cast<uint32>(cubChunk);
+        manifest.m_chunks.push_back(chunk);
+        offsets.push_back(unPos);
+        unPos += cubChunk;
+    }
+
+    auto counts = CountChunks(manifest.m_chunks);
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    // Reference every chunk in memory right away so no release can delete one
+    // of them meanwhile; chunks nobody has (or whose write failed) are claimed
+    // for writing by this call
+    std::vector<size_t> claimed;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        ChunkEntry& entry = m_chunks[counts[i].first.m_id];
+        entry.m_nRefs += counts[i].second;
+        if (!entry.m_bWritten && !entry.m_bWriting) {
+            entry.m_cubSize = counts[i].first.m_cubSize;
+            entry.m_bWriting = true;
+            claimed.push_back(i);
+        }
+    }
+
+    lock.unlock();
+
+    // First offset of every distinct chunk
+    std::unordered_map<ChunkId, size_t, ChunkIdHasher> firstOffsets;
+    for (size_t i = 0; i < manifest.m_chunks.size(); ++i) {
+        firstOffsets.try_emplace(manifest.m_chunks[i].m_id, offsets[i]);
+    }
+
+    bool bSuccess = true;
+    uint64 cubWritten = 0;
+    for (size_t i : claimed) {
+        const ChunkManifest::Chunk& chunk = counts[i].first;
+        std::string path = GetChunkPath(chunk.m_id);
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        if (!WriteFileAtomic(path, pBytes + firstOffsets[chunk.m_id], chunk.m_cubSize)) {
+            bSuccess = false;
+            break;
+        }
+        cubWritten += chunk.m_cubSize;
+    }
+
+    lock.lock();
+
+    for (size_t i : claimed) {
+        ChunkEntry& entry = m_chunks[counts[i].first.m_id];
+        entry.m_bWriting = false;
+        entry.m_bWritten = bSuccess;
+        if (bSuccess) {
+            m_stats.m_cubStored += entry.m_cubSize;
+        }
+    }
+    m_writtenCondition.notify_all();
+
+    // Chunks claimed by other writers must be on disk before the manifest can refer to them
+    for (size_t i = 0; bSuccess && i < counts.size(); ++i) {
+        const ChunkEntry& entry = m_chunks[counts[i].first.m_id];
+        m_writtenCondition.wait(lock, [&entry]() { return !entry.m_bWriting; });
+        bSuccess = entry.m_bWritten;
+    }
+
+    std::vector<RefDelta> deltas;
+    for (const auto& [chunk, nCount] : counts) {
+        deltas.push_back({ chunk.m_id, nCount, chunk.m_cubSize });
+    }
+
+    if (!bSuccess || !AppendRefs(deltas)) {
+        // Undo the in-memory references; chunks nobody else wants, and the log
+        // does not reference, are deleted again
+        for (size_t i = 0; i < counts.size(); ++i) {
+            auto it = m_chunks.find(counts[i].first.m_id);
+            it->second.m_nRefs -= counts[i].second;
+            if (it->second.m_nRefs <= 0 && it->second.m_nLoggedRefs <= 0 && !it->second.m_bWriting) {
+                std::error_code ec;
+                std::filesystem::remove(GetChunkPath(it->first), ec);
+                if (it->second.m_bWritten) {
+                    m_stats.m_cubStored -= it->second.m_cubSize;
+                }
+                m_chunks.erase(it);
+            }
+        }
+        m_stats.m_cChunks = m_chunks.size();
+        VLOG_ERROR(__FUNCTION__ " - Failed to store %zu bytes in %s", cubData, m_sDirectory.c_str());
+        return false;
+    }
+
+    m_stats.m_cChunks = m_chunks.size();
+    m_stats.m_cubLogicalWritten += cubData;
+    m_stats.m_cubWritten += cubWritten;
+
+    VLOG_DEBUG(__FUNCTION__ " - Stored %zu bytes as %zu chunks, %zu new (%llu bytes written)",
+               cubData, manifest.m_chunks.size(), claimed.size(), cubWritten);
+    return true;
+}
+
+bool ChunkStore::AddRef(const ChunkManifest& manifest)
+{
+    auto counts = CountChunks(manifest.m_chunks);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::vector<RefDelta> deltas;
+    for (const auto& [chunk, nCount] : counts) {
+        auto it = m_chunks.find(chunk.m_id);
+        if (it == m_chunks.end() || !it->second.m_bWritten) {
+            VLOG_ERROR(__FUNCTION__ " - Unknown chunk %s", ChunkIdToString(chunk.m_id).c_str());
+            return false;
+        }
+        deltas.push_back({ chunk.m_id, nCount, chunk.m_cubSize });
+    }
+
+    if (!AppendRefs(deltas)) {
+        return false;
+    }
+    for (const RefDelta& delta : deltas) {
+        m_chunks[delta.m_id].m_nRefs += delta.m_nDelta;
+    }
+    return true;
+}
+
+void ChunkStore::Release(const ChunkManifest& manifest)
+{
+    ReleaseChunks(manifest.m_chunks);
+}
+
+void ChunkStore::ReleaseChunks(const std::vector<ChunkManifest::Chunk>& chunks)
+{
+    auto counts = CountChunks(chunks);
+    if (counts.empty()) {
+        return;
+    }
+
+    std::vector<RefDelta> deltas;
+    for (const auto& [chunk, nCount] : counts) {
+        deltas.push_back({ chunk.m_id, -nCount, chunk.m_cubSize });
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    // Unlogged, the references would come back on the next open, so the files must stay
+    bool bLogged = AppendRefs(deltas);
+
+    for (const auto& [chunk, nCount] : counts) {
+        auto it = m_chunks.find(chunk.m_id);
+        if (it == m_chunks.end()) {
+            continue;
+        }
+
+        it->second.m_nRefs -= nCount;
+        if (it->second.m_nRefs <= 0 && it->second.m_nLoggedRefs <= 0 && bLogged) {
+            // Deleted under the lock, so a writer claiming the same contents cannot race it
+            std::error_code ec;
+            std::filesystem::remove(GetChunkPath(it->first), ec);
+            m_stats.m_cubStored -= it->second.m_cubSize;
+            m_chunks.erase(it);
+        }
+    }
+    m_stats.m_cChunks = m_chunks.size();
+
+    if (m_cRefRecords > REF_LOG_COMPACT_MIN_RECORDS && m_cRefRecords > m_chunks.size() * REF_LOG_COMPACT_RATIO) {
+        CompactRefLog();
+    }
+}
+
+int64 ChunkStore::Read(const ChunkManifest& manifest, uint64 unOffset, void* pBuffer, size_t cubMax)
+{
+    if (unOffset >= manifest.m_unSize) {
+        return 0;
+    }
+    size_t cubToRead = static_cast<size_t>(std::min<uint64>(cubMax, manifest.m_unSize - unOffset));
+    uint8* pOut = static_cast<uint8*>(pBuffer);
+
+    if (!manifest.m_inline.empty()) {
+        memcpy(pOut, manifest.m_inline.data() + unOffset, cubToRead);
+        return static_cast<int64>(cubToRead);
+    }
+
+    // Copy the overlapping part of every chunk in the range
+    uint64 unChunkStart = 0;
+    size_t cubDone = 0;
+    for (const ChunkManifest::Chunk& chunk : manifest.m_chunks) {
+        uint64 unChunkEnd = unChunkStart + chunk.m_cubSize;
+        if (unChunkEnd > unOffset + cubDone && cubDone < cubToRead) {
+            uint64 unInChunk = unOffset + cubDone - unChunkStart;
+            size_t cubPart = static_cast<size_t>(std::min<uint64>(chunk.m_cubSize - unInChunk, cubToRead - cubDone));
+
+            std::string path = GetChunkPath(chunk.m_id);
+            std::ifstream file(path, std::ios::binary);
+            file.seekg(static_cast<std::streamoff>(unInChunk));
+            file.read(reinterpret_cast<char*>(pOut + cubDone), static_cast<std::streamsize>(cubPart));
+            if (!file || static_cast<size_t>(file.gcount()) != cubPart) {
+                VLOG_ERROR(__FUNCTION__ " - Missing or short chunk: %s", path.c_str());
+                return -1;
+            }
+            cubDone += cubPart;
+        }
+        if (cubDone == cubToRead) {
+            break;
+        }
+        unChunkStart = unChunkEnd;
+    }
+
+    return static_cast<int64>(cubDone);
+}
+
+bool ChunkStore::PutRoot(const std::string& key, const ChunkManifest& manifest)
+{
+    ChunkManifest previous;
+    bool bHadPrevious = GetRoot(key, previous);
+
+    std::vector<uint8> data;
+    manifest.Serialize(data);
+    if (!WriteFileAtomic(GetRootPath(key), data.data(), data.size())) {
+        return false;
+    }
+
+    if (bHadPrevious) {
+        ReleaseChunks(previous.m_chunks);
+    }
+    return true;
+}
+
+bool ChunkStore::GetRoot(const std::string& key, ChunkManifest& manifest)
+{
+    std::ifstream file(GetRootPath(key), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<uint8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return ChunkManifest::Parse(data.data(), data.size(), manifest);
+}
+
+bool ChunkStore::DeleteRoot(const std::string& key)
+{
+    ChunkManifest manifest;
+    if (!GetRoot(key, manifest)) {
+        return false;
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::remove(GetRootPath(key), ec)) {
+        return false;
+    }
+
+    ReleaseChunks(manifest.m_chunks);
+    return true;
+}
+
+ChunkStore::Stats ChunkStore::GetStats() const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return m_stats;
+}
+
+} // namespace VaporCore
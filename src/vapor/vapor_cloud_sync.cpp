@@ -0,0 +1,925 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Steam Cloud emulation by syncing saves against a remote directory
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+
+#include "vapor_base.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_delta.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+static constexpr Config::Key KEY_CLOUD_REMOTE_DIRECTORY{ CONFIG_SECTION_CLOUD, CONFIG_KEY_CLOUD_REMOTE_DIRECTORY };
+static constexpr Config::Key KEY_CLOUD_CONFLICT_POLICY{ CONFIG_SECTION_CLOUD, CONFIG_KEY_CLOUD_CONFLICT_POLICY };
+
+static constexpr const char* CONFLICT_POLICY_LOCAL = "local";
+static constexpr const char* CONFLICT_POLICY_REMOTE = "remote";
+
+// Layout of the remote directory of an app and user
+static constexpr const char* REMOTE_MANIFEST_FILENAME = "manifest.vcsync";
+static constexpr const char* REMOTE_LOCK_DIRECTORY = "lock";
+static constexpr const char* REMOTE_OBJECTS_DIRECTORY = "objects";
+static constexpr const char* OBJECT_FULL_EXTENSION = "full";
+static constexpr const char* OBJECT_DELTA_EXTENSION = "delta";
+static constexpr const char* OBJECT_SIGNATURE_EXTENSION = "sig";
+
+// A lock this old belongs to a pass that died; a pass waits this long for a live one
+static constexpr std::chrono::seconds REMOTE_LOCK_STALE_AGE{ 120 };
+static constexpr std::chrono::seconds REMOTE_LOCK_WAIT{ 10 };
+static constexpr std::chrono::milliseconds REMOTE_LOCK_POLL{ 100 };
+
+// Deltas in a row before a push writes a full object again
+static const uint64 MAX_DELTA_CHAIN = 8;
+
+// Platform bit a pull must find in a file's sync platforms
+#if defined(_WIN32)
+static const uint32 CURRENT_PLATFORM = k_ERemoteStoragePlatformWindows;
+#elif defined(__APPLE__)
+static const uint32 CURRENT_PLATFORM = k_ERemoteStoragePlatformOSX;
+#else
+static const uint32 CURRENT_PLATFORM = k_ERemoteStoragePlatformLinux;
+#endif
+
+static const uint32 STATE_MAGIC = 0x53434356;       // "VCCS"
+static const uint32 STATE_VERSION = 1;
+static const uint32 MANIFEST_MAGIC = 0x4d434356;    // "VCCM"
+static const uint32 MANIFEST_VERSION = 1;
+
+// Sanity bounds for records read back
+static const uint32 SYNC_MAX_NAME_LENGTH = 4096;
+static const uint32 SYNC_MAX_VERSIONS = 4096;
+
+// Both files: header, then per file an entry header, the name and the version
+// vector as (machine id, counter) pairs. Host byte order
+struct StateHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_cEntries;
+    uint32 m_unReserved;
+    uint64 m_unMachineId;
+};
+
+enum EStateFlags : uint32 {
+    k_EStateFlagExists = 1 << 0,
+    k_EStateFlagForgotten = 1 << 1
+};
+
+struct StateEntryHeader
+{
+    uint64 m_unHash;
+    uint64 m_unSize;
+    uint64 m_unRemoteSeq;
+    uint32 m_unPlatforms;
+    uint32 m_fFlags;
+    uint32 m_cchName;
+    uint32 m_cVersions;
+};
+
+struct ManifestFileHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_cEntries;
+    uint32 m_unReserved;
+};
+
+struct ManifestEntryHeader
+{
+    uint64 m_unSeq;
+    uint64 m_unFullSeq;
+    uint64 m_unHash;
+    uint64 m_unSize;
+    int64 m_nTimestamp;
+    uint32 m_unPlatforms;
+    uint32 m_bDeleted;
+    uint32 m_cchName;
+    uint32 m_cVersions;
+};
+
+struct VersionRecord
+{
+    uint64 m_unMachineId;
+    uint64 m_unCounter;
+};
+
+static_assert(sizeof(StateHeader) == 24, "State header layout changed");
+static_assert(sizeof(StateEntryHeader) == 40, "State entry layout changed");
+static_assert(sizeof(ManifestFileHeader) == 16, "Manifest header layout changed");
+static_assert(sizeof(ManifestEntryHeader) == 56, "Manifest entry layout changed");
+static_assert(sizeof(VersionRecord) == 16, "Version record layout changed");
+
+// Live instances, for ShutdownAll(). Plain mutex: only taken at construction and shutdown
+static std::mutex s_instancesMutex;
+static std::vector<CloudSync*> s_instances;
+
+template <typename T>
+static void AppendRecord(std::vector<uint8>& data, const T& record)
+{
+    const uint8* p = reinterpret_cast<const uint8*>(&record);
+    data.insert(data.end(), p, p + sizeof(record));
+}
+
+static bool ReadWholeFile(const std::string& path, std::vector<uint8>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamoff cubFile = file.tellg();
+    if (cubFile < 0) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(cubFile));
+    file.seekg(0);
+    return cubFile == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), cubFile));
+}
+
+// Name and version vector following an entry header
+static bool ReadNameAndVersions(std::ifstream& file, uint32 cchName, uint32 cVersions, std::string& name,
+                                std::map<uint64, uint64>& versions)
+{
+    if (cchName > SYNC_MAX_NAME_LENGTH || cVersions > SYNC_MAX_VERSIONS) {
+        return false;
+    }
+
+    name.assign(cchName, '\0');
+    if (!file.read(&name[0], cchName)) {
+        return false;
+    }
+    for (uint32 i = 0; i < cVersions; ++i) {
+        VersionRecord record;
+        if (!file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            return false;
+        }
+        versions[record.m_unMachineId] = record.m_unCounter;
+    }
+    return true;
+}
+
+static void AppendNameAndVersions(std::vector<uint8>& data, const std::string& name,
+                                  const std::map<uint64, uint64>& versions)
+{
+    data.insert(data.end(), name.begin(), name.end());
+    for (const auto& version : versions) {
+        AppendRecord(data, VersionRecord{ version.first, version.second });
+    }
+}
+
+CloudSync::CloudSync(FileStorage& storage)
+    : m_storage(storage),
+      m_sStatePath(storage.GetDirectory() + "/" + CLOUD_SYNC_STATE_FILENAME),
+      m_eConflictPolicy(k_EConflictNewest),
+      m_unMachineId(0),
+      m_bCloudEnabled(true),
+      m_bSyncRequested(false),
+      m_bStop(false),
+      m_bRunning(false),
+      m_cPassesStarted(0),
+      m_cPassesDone(0)
+{
+    const Config& config = Config::GetInstance();
+    std::string remoteRoot(config.GetString(KEY_CLOUD_REMOTE_DIRECTORY, ""));
+    if (!remoteRoot.empty()) {
+        char userDirectory[64];
+        snprintf(userDirectory, sizeof(userDirectory), "%u/%llu", config.GameID().AppID(),
+                 static_cast<unsigned long long>(config.SteamID().ConvertToUint64()));
+        m_sRemoteDirectory = remoteRoot + "/" + userDirectory;
+    }
+
+    std::string policy(config.GetString(KEY_CLOUD_CONFLICT_POLICY, ""));
+    if (policy == CONFLICT_POLICY_LOCAL) {
+        m_eConflictPolicy = k_EConflictLocal;
+    } else if (policy == CONFLICT_POLICY_REMOTE) {
+        m_eConflictPolicy = k_EConflictRemote;
+    }
+
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        LoadState();
+        if (m_unMachineId == 0) {
+            // First run in this directory: a machine id of its own for the version vectors
+            std::random_device random;
+            std::mt19937_64 generator((static_cast<uint64>(random()) << 32) ^ random() ^
+                                      static_cast<uint64>(std::chrono::steady_clock::now().time_since_epoch().count()));
+            while (m_unMachineId == 0) {
+                m_unMachineId = generator();
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    s_instances.push_back(this);
+}
+
+CloudSync::~CloudSync()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_instancesMutex);
+        s_instances.erase(std::remove(s_instances.begin(), s_instances.end(), this), s_instances.end());
+    }
+
+    Shutdown();
+}
+
+void CloudSync::Start()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (m_bRunning || m_bStop) {
+        return;
+    }
+
+    m_bRunning = true;
+    m_bSyncRequested = true;
+    m_syncThread = std::thread(&CloudSync::SyncThread, this);
+}
+
+void CloudSync::Shutdown()
+{
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_bStop = true;
+        if (!m_bRunning) {
+            return;
+        }
+        m_syncCondition.notify_all();
+    }
+
+    m_syncThread.join();
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_bRunning = false;
+}
+
+void CloudSync::ShutdownAll()
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    for (CloudSync* pSync : s_instances) {
+        pSync->Shutdown();
+    }
+}
+
+bool CloudSync::SyncNow()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    if (!m_bRunning || m_bStop) {
+        return false;
+    }
+
+    // The pass after those already started
+    uint64 unPass = m_cPassesStarted + 1;
+    m_bSyncRequested = true;
+    m_syncCondition.notify_all();
+    m_doneCondition.wait(lock, [this, unPass]() { return m_cPassesDone >= unPass; });
+    return true;
+}
+
+void CloudSync::SyncThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    for (;;) {
+        m_syncCondition.wait(lock, [this]() { return m_bSyncRequested || m_bStop; });
+
+        // A stop request gets one last pass, covering anything requested with it
+        bool bLast = m_bStop;
+        m_bSyncRequested = false;
+        ++m_cPassesStarted;
+
+        lock.unlock();
+        RunSync();
+        lock.lock();
+
+        ++m_cPassesDone;
+        m_doneCondition.notify_all();
+        if (bLast) {
+            break;
+        }
+    }
+}
+
+void CloudSync::OnFileWritten(const std::string& filename)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::string normalized;
+    SyncedFile* pFile = FindFile(filename, normalized);
+    if (pFile && pFile->m_bForgotten) {
+        pFile->m_bForgotten = false;
+        SaveState();
+    }
+}
+
+std::shared_lock<std::shared_mutex> CloudSync::LockLocalWrites()
+{
+    return std::shared_lock<std::shared_mutex>(m_localWriteMutex);
+}
+
+bool CloudSync::IsPersisted(const std::string& filename)
+{
+    if (!m_storage.FileExists(filename)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::string normalized;
+    SyncedFile* pFile = FindFile(filename, normalized);
+    return !pFile || !pFile->m_bForgotten;
+}
+
+bool CloudSync::Forget(const std::string& filename)
+{
+    if (!m_storage.FileExists(filename)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::string normalized;
+    if (!FindFile(filename, normalized)) {
+        m_files[normalized] = SyncedFile();
+    }
+    m_files[normalized].m_bForgotten = true;
+    return SaveState();
+}
+
+bool CloudSync::SetPlatforms(const std::string& filename, uint32 unPlatforms)
+{
+    if (!m_storage.FileExists(filename)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::string normalized;
+    if (!FindFile(filename, normalized)) {
+        m_files[normalized] = SyncedFile();
+    }
+    m_files[normalized].m_unPlatforms = unPlatforms;
+    return SaveState();
+}
+
+uint32 CloudSync::GetPlatforms(const std::string& filename)
+{
+    if (!m_storage.FileExists(filename)) {
+        return k_ERemoteStoragePlatformNone;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    std::string normalized;
+    SyncedFile* pFile = FindFile(filename, normalized);
+    return pFile ? pFile->m_unPlatforms : static_cast<uint32>(k_ERemoteStoragePlatformAll);
+}
+
+void CloudSync::SetCloudEnabled(bool bEnabled)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_bCloudEnabled = bEnabled;
+}
+
+void CloudSync::RunSync()
+{
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (m_sRemoteDirectory.empty() || !m_bCloudEnabled) {
+            return;
+        }
+    }
+
+    if (!LockRemote()) {
+        VLOG_WARNING(__FUNCTION__ " - Remote busy or unreachable, skipping sync: %s", m_sRemoteDirectory.c_str());
+        return;
+    }
+
+    Manifest manifest;
+    if (!LoadManifest(manifest)) {
+        UnlockRemote();
+        return;
+    }
+
+    // Every file either side knows of
+    std::set<std::string> names;
+    std::vector<std::string> localFiles;
+    m_storage.ListFiles("", localFiles);
+    names.insert(localFiles.begin(), localFiles.end());
+    for (const auto& remote : manifest) {
+        names.insert(remote.first);
+    }
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        for (const auto& file : m_files) {
+            names.insert(file.first);
+        }
+    }
+
+    SyncStats stats;
+    bool bManifestChanged = false;
+    for (const std::string& name : names) {
+        bManifestChanged = SyncFile(name, manifest, stats) || bManifestChanged;
+    }
+
+    // Objects the old manifest referenced go only once the new one is in place. If
+    // it cannot be written, the remote stays as it was and the pushes are redone by
+    // the next pass, their versions being ahead of the remote ones
+    if (bManifestChanged && !WriteManifest(manifest)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write manifest: %s", m_sRemoteDirectory.c_str());
+        m_garbage.clear();
+    }
+    for (const std::string& path : m_garbage) {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    m_garbage.clear();
+    UnlockRemote();
+
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        SaveState();
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Synced %s: %u pushed, %u pulled (%u as deltas), %u conflicts, %llu bytes sent, %llu received",
+              m_sRemoteDirectory.c_str(), stats.m_cPushed, stats.m_cPulled, stats.m_cDeltas, stats.m_cConflicts,
+              static_cast<unsigned long long>(stats.m_cubSent), static_cast<unsigned long long>(stats.m_cubReceived));
+}
+
+bool CloudSync::SyncFile(const std::string& name, Manifest& manifest, SyncStats& stats)
+{
+    SyncedFile synced;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_files.find(name);
+        if (it != m_files.end()) {
+            synced = it->second;
+        }
+    }
+
+    LocalFile local;
+    FileStorage::FileView view;
+    if (m_storage.OpenFileView(name, view)) {
+        local.m_bExists = true;
+        local.m_data.assign(view.m_pData, view.m_pData + view.m_cubData);
+        local.m_unHash = HashBytes64(local.m_data.data(), local.m_data.size());
+    } else if (m_storage.FileExists(name)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to read, not syncing: %s", name.c_str());
+        return false;
+    }
+
+    auto it = manifest.find(name);
+    const RemoteFile* pRemote = it != manifest.end() ? &it->second : nullptr;
+    bool bRemoteExists = pRemote && !pRemote->m_bDeleted;
+    EVersionOrder eOrder = CompareVersions(pRemote ? pRemote->m_versions : VersionVector(), synced.m_versions);
+
+    // Forgotten files stay local: take them out of the cloud once, unless another
+    // machine has changed them since, then leave them alone
+    if (synced.m_bForgotten) {
+        if (bRemoteExists && (eOrder == k_EVersionEqual || eOrder == k_EVersionBefore)) {
+            return Push(name, LocalFile(), MergeVersions(pRemote->m_versions, synced.m_versions), manifest, stats);
+        }
+        return false;
+    }
+
+    bool bLocalChanged = local.m_bExists != synced.m_bExists || (local.m_bExists && local.m_unHash != synced.m_unHash);
+
+    // No remote change since the last sync
+    if (eOrder == k_EVersionEqual || eOrder == k_EVersionBefore) {
+        if (bLocalChanged || (eOrder == k_EVersionBefore && (local.m_bExists || bRemoteExists))) {
+            return Push(name, local, MergeVersions(pRemote ? pRemote->m_versions : VersionVector(), synced.m_versions),
+                        manifest, stats);
+        }
+        if (bRemoteExists && it->second.m_unPlatforms != synced.m_unPlatforms) {
+            it->second.m_unPlatforms = synced.m_unPlatforms;
+            return true;
+        }
+        return false;
+    }
+
+    if (!bLocalChanged) {
+        Pull(name, local, *pRemote, stats);
+        return false;
+    }
+
+    // Both sides changed; the same change on both is no conflict
+    if (local.m_bExists == bRemoteExists && (!local.m_bExists || local.m_unHash == pRemote->m_unHash)) {
+        MarkSynced(name, pRemote->m_versions, pRemote->m_unHash, pRemote->m_unSize, pRemote->m_unSeq, bRemoteExists);
+        return false;
+    }
+
+    ++stats.m_cConflicts;
+    bool bKeepLocal = m_eConflictPolicy == k_EConflictLocal;
+    if (m_eConflictPolicy == k_EConflictNewest) {
+        int64 nLocalTimestamp = local.m_bExists ? m_storage.GetFileTimestamp(name) : 0;
+        bKeepLocal = nLocalTimestamp > pRemote->m_nTimestamp;
+    }
+    VLOG_WARNING(__FUNCTION__ " - Conflict on %s, keeping the %s copy", name.c_str(), bKeepLocal ? "local" : "remote");
+
+    if (bKeepLocal) {
+        return Push(name, local, MergeVersions(pRemote->m_versions, synced.m_versions), manifest, stats);
+    }
+
+    // The losing local copy stays in the version history, or without one in a conflict copy
+    if (Pull(name, local, *pRemote, stats) && local.m_bExists && !m_storage.HasVersionHistory()) {
+        SaveConflictCopy(name, local);
+    }
+    return false;
+}
+
+bool CloudSync::Push(const std::string& name, const LocalFile& local, const VersionVector& versions, Manifest& manifest,
+                     SyncStats& stats)
+{
+    RemoteFile& remote = manifest[name];
+
+    RemoteFile pushed;
+    pushed.m_versions = versions;
+    ++pushed.m_versions[m_unMachineId];
+    pushed.m_unSeq = remote.m_unSeq + 1;
+    pushed.m_unFullSeq = pushed.m_unSeq;
+    pushed.m_unHash = local.m_unHash;
+    pushed.m_unSize = local.m_data.size();
+    pushed.m_nTimestamp = local.m_bExists ? m_storage.GetFileTimestamp(name) : static_cast<int64>(time(nullptr));
+    pushed.m_bDeleted = !local.m_bExists;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_files.find(name);
+        if (it != m_files.end()) {
+            pushed.m_unPlatforms = it->second.m_unPlatforms;
+        }
+    }
+
+    if (pushed.m_bDeleted) {
+        m_garbage.push_back(ObjectDirectory(name));
+    } else {
+        std::error_code ec;
+        std::filesystem::create_directories(ObjectDirectory(name), ec);
+
+        // A delta against the previous version's signature, while it saves enough
+        std::vector<uint8> object;
+        bool bDelta = false;
+        if (!remote.m_bDeleted && remote.m_unSeq > 0 && remote.m_unSeq - remote.m_unFullSeq < MAX_DELTA_CHAIN) {
+            std::vector<uint8> signature;
+            bDelta = ReadWholeFile(ObjectPath(name, remote.m_unSeq, OBJECT_SIGNATURE_EXTENSION), signature) &&
+                     EncodeDeltaFromSignature(signature.data(), signature.size(), local.m_data.data(),
+                                              local.m_data.size(), object) &&
+                     object.size() < local.m_data.size() / 2;
+        }
+
+        const char* pchExtension = bDelta ? OBJECT_DELTA_EXTENSION : OBJECT_FULL_EXTENSION;
+        const std::vector<uint8>& contents = bDelta ? object : local.m_data;
+        std::vector<uint8> signature;
+        ComputeSignature(local.m_data.data(), local.m_data.size(), signature);
+        if (!WriteFileAtomic(ObjectPath(name, pushed.m_unSeq, pchExtension), contents.data(), contents.size()) ||
+            !WriteFileAtomic(ObjectPath(name, pushed.m_unSeq, OBJECT_SIGNATURE_EXTENSION), signature.data(),
+                             signature.size())) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to upload: %s", name.c_str());
+            if (remote.m_unSeq == 0) {
+                manifest.erase(name);
+            }
+            return false;
+        }
+
+        if (bDelta) {
+            pushed.m_unFullSeq = remote.m_unFullSeq;
+            m_garbage.push_back(ObjectPath(name, remote.m_unSeq, OBJECT_SIGNATURE_EXTENSION));
+            ++stats.m_cDeltas;
+        } else {
+            // A new full object ends the chain, everything before it can go
+            for (uint64 unSeq = remote.m_unFullSeq; unSeq > 0 && unSeq <= remote.m_unSeq; ++unSeq) {
+                m_garbage.push_back(ObjectPath(name, unSeq, OBJECT_FULL_EXTENSION));
+                m_garbage.push_back(ObjectPath(name, unSeq, OBJECT_DELTA_EXTENSION));
+                m_garbage.push_back(ObjectPath(name, unSeq, OBJECT_SIGNATURE_EXTENSION));
+            }
+        }
+        stats.m_cubSent += contents.size() + signature.size();
+    }
+
+    remote = pushed;
+    MarkSynced(name, pushed.m_versions, pushed.m_unHash, pushed.m_unSize, pushed.m_unSeq, local.m_bExists);
+    ++stats.m_cPushed;
+    return true;
+}
+
+void CloudSync::SaveConflictCopy(const std::string& name, const LocalFile& local)
+{
+    std::filesystem::path path = std::filesystem::path(m_storage.GetDirectory()) / CLOUD_SYNC_CONFLICT_DIRECTORY /
+                                 (name + "." + std::to_string(static_cast<int64>(time(nullptr))));
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (!WriteFileAtomic(path.string(), local.m_data.data(), local.m_data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to keep the conflicting copy of %s", name.c_str());
+        return;
+    }
+    VLOG_INFO(__FUNCTION__ " - Kept the conflicting local copy of %s as %s", name.c_str(), path.string().c_str());
+}
+
+bool CloudSync::Pull(const std::string& name, const LocalFile& local, const RemoteFile& remote, SyncStats& stats)
+{
+    if ((remote.m_unPlatforms & CURRENT_PLATFORM) == 0) {
+        VLOG_DEBUG(__FUNCTION__ " - Not synced to this platform: %s", name.c_str());
+        return false;
+    }
+
+    std::vector<uint8> data;
+    if (!remote.m_bDeleted && !ReadRemoteVersion(name, local, remote, data, stats)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to download: %s", name.c_str());
+        return false;
+    }
+
+    {
+        // API writes are held off, so the game cannot write in between: if it
+        // has written the file since it was read, the next pass sorts that out
+        std::unique_lock<std::shared_mutex> writeLock(m_localWriteMutex);
+
+        FileStorage::FileView view;
+        bool bExists = m_storage.OpenFileView(name, view);
+        if (bExists != local.m_bExists ||
+            (bExists && HashBytes64(view.m_pData, view.m_cubData) != local.m_unHash)) {
+            VLOG_DEBUG(__FUNCTION__ " - Changed while syncing: %s", name.c_str());
+            return false;
+        }
+
+        bool bApplied = remote.m_bDeleted ? (!bExists || m_storage.DeleteFile(name))
+                                          : m_storage.WriteFile(name, data.data(), data.size());
+        if (!bApplied) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to apply: %s", name.c_str());
+            return false;
+        }
+    }
+
+    MarkSynced(name, remote.m_versions, remote.m_unHash, remote.m_unSize, remote.m_unSeq, !remote.m_bDeleted);
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_files[name].m_unPlatforms = remote.m_unPlatforms;
+    }
+    ++stats.m_cPulled;
+    return true;
+}
+
+bool CloudSync::ReadRemoteVersion(const std::string& name, const LocalFile& local, const RemoteFile& remote,
+                                  std::vector<uint8>& data, SyncStats& stats)
+{
+    SyncedFile synced;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_files.find(name);
+        if (it != m_files.end()) {
+            synced = it->second;
+        }
+    }
+
+    // Rebuild from unStart on, applying the deltas after it
+    auto rebuild = [&](uint64 unStart) {
+        for (uint64 unSeq = unStart + 1; unSeq <= remote.m_unSeq; ++unSeq) {
+            std::vector<uint8> delta, target;
+            if (!ReadWholeFile(ObjectPath(name, unSeq, OBJECT_DELTA_EXTENSION), delta) ||
+                !ApplyDelta(data.data(), data.size(), delta.data(), delta.size(), target)) {
+                return false;
+            }
+            stats.m_cubReceived += delta.size();
+            data.swap(target);
+        }
+        return data.size() == remote.m_unSize && HashBytes64(data.data(), data.size()) == remote.m_unHash;
+    };
+
+    // The local copy is the version last synced and still inside the chain: deltas suffice
+    if (local.m_bExists && synced.m_bExists && local.m_unHash == synced.m_unHash &&
+        synced.m_unRemoteSeq >= remote.m_unFullSeq && synced.m_unRemoteSeq < remote.m_unSeq) {
+        data = local.m_data;
+        if (rebuild(synced.m_unRemoteSeq)) {
+            ++stats.m_cDeltas;
+            return true;
+        }
+    }
+
+    if (!ReadWholeFile(ObjectPath(name, remote.m_unFullSeq, OBJECT_FULL_EXTENSION), data)) {
+        return false;
+    }
+    stats.m_cubReceived += data.size();
+    return rebuild(remote.m_unFullSeq);
+}
+
+void CloudSync::MarkSynced(const std::string& name, const VersionVector& versions, uint64 unHash, uint64 unSize,
+                           uint64 unRemoteSeq, bool bExists)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    SyncedFile& file = m_files[name];
+    file.m_versions = versions;
+    file.m_unHash = unHash;
+    file.m_unSize = unSize;
+    file.m_unRemoteSeq = unRemoteSeq;
+    file.m_bExists = bExists;
+}
+
+CloudSync::EVersionOrder CloudSync::CompareVersions(const VersionVector& a, const VersionVector& b)
+{
+    bool bAhead = false, bBehind = false;
+    for (const auto& version : a) {
+        auto it = b.find(version.first);
+        uint64 unOther = it != b.end() ? it->second : 0;
+        bAhead = bAhead || version.second > unOther;
+        bBehind = bBehind || version.second < unOther;
+    }
+    for (const auto& version : b) {
+        bBehind = bBehind || (version.second > 0 && a.find(version.first) == a.end());
+    }
+
+    if (bAhead && bBehind) {
+        return k_EVersionConcurrent;
+    }
+    return bAhead ? k_EVersionAfter : (bBehind ? k_EVersionBefore : k_EVersionEqual);
+}
+
+CloudSync::VersionVector CloudSync::MergeVersions(const VersionVector& a, const VersionVector& b)
+{
+    VersionVector merged = a;
+    for (const auto& version : b) {
+        uint64& unCounter = merged[version.first];
+        unCounter = std::max(unCounter, version.second);
+    }
+    return merged;
+}
+
+void CloudSync::LoadState()
+{
+    m_files.clear();
+
+    std::ifstream file(m_sStatePath, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    StateHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_unMagic != STATE_MAGIC || header.m_unVersion != STATE_VERSION) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring unreadable sync state: %s", m_sStatePath.c_str());
+        return;
+    }
+    m_unMachineId = header.m_unMachineId;
+
+    for (uint32 i = 0; i < header.m_cEntries; ++i) {
+        StateEntryHeader entry;
+        std::string name;
+        SyncedFile synced;
+        if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) ||
+            !ReadNameAndVersions(file, entry.m_cchName, entry.m_cVersions, name, synced.m_versions)) {
+            VLOG_WARNING(__FUNCTION__ " - Truncated sync state: %s", m_sStatePath.c_str());
+            break;
+        }
+
+        synced.m_unHash = entry.m_unHash;
+        synced.m_unSize = entry.m_unSize;
+        synced.m_unRemoteSeq = entry.m_unRemoteSeq;
+        synced.m_unPlatforms = entry.m_unPlatforms;
+        synced.m_bExists = (entry.m_fFlags & k_EStateFlagExists) != 0;
+        synced.m_bForgotten = (entry.m_fFlags & k_EStateFlagForgotten) != 0;
+        m_files[name] = synced;
+    }
+}
+
+bool CloudSync::SaveState()
+{
+    std::vector<uint8> data;
+    AppendRecord(data, StateHeader{ STATE_MAGIC, STATE_VERSION, static_cast<uint32>(m_files.size()), 0, m_unMachineId });
+    for (const auto& file : m_files) {
+        const SyncedFile& synced = file.second;
+        uint32 fFlags = (synced.m_bExists ? static_cast<uint32>(k_EStateFlagExists) : 0) |
+                        (synced.m_bForgotten ? static_cast<uint32>(k_EStateFlagForgotten) : 0);
+        AppendRecord(data, StateEntryHeader{ synced.m_unHash, synced.m_unSize, synced.m_unRemoteSeq,
+                                             synced.m_unPlatforms, fFlags, static_cast<uint32>(file.first.size()),
+                                             static_cast<uint32>(synced.m_versions.size()) });
+        AppendNameAndVersions(data, file.first, synced.m_versions);
+    }
+
+    if (!WriteFileAtomic(m_sStatePath, data.data(), data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write sync state: %s", m_sStatePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+CloudSync::SyncedFile* CloudSync::FindFile(const std::string& filename, std::string& normalized)
+{
+    normalized = m_storage.NormalizeFilename(filename);
+    auto it = m_files.find(normalized);
+    return it != m_files.end() ? &it->second : nullptr;
+}
+
+bool CloudSync::LockRemote()
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_sRemoteDirectory, ec);
+
+    std::string lockPath = m_sRemoteDirectory + "/" + REMOTE_LOCK_DIRECTORY;
+    auto deadline = std::chrono::steady_clock::now() + REMOTE_LOCK_WAIT;
+    for (;;) {
+        if (std::filesystem::create_directory(lockPath, ec)) {
+            return true;
+        }
+        if (ec) {
+            return false;
+        }
+
+        // Left behind by a pass that never finished
+        auto lockTime = std::filesystem::last_write_time(lockPath, ec);
+        if (!ec && std::filesystem::file_time_type::clock::now() - lockTime > REMOTE_LOCK_STALE_AGE) {
+            VLOG_WARNING(__FUNCTION__ " - Breaking stale lock: %s", lockPath.c_str());
+            std::filesystem::remove(lockPath, ec);
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(REMOTE_LOCK_POLL);
+    }
+}
+
+void CloudSync::UnlockRemote()
+{
+    std::error_code ec;
+    std::filesystem::remove(m_sRemoteDirectory + "/" + REMOTE_LOCK_DIRECTORY, ec);
+}
+
+bool CloudSync::LoadManifest(Manifest& manifest)
+{
+    manifest.clear();
+
+    std::string path = m_sRemoteDirectory + "/" + REMOTE_MANIFEST_FILENAME;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    // Nothing may be pushed over a manifest that cannot be read, it would lose the files in it
+    ManifestFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_unMagic != MANIFEST_MAGIC || header.m_unVersion != MANIFEST_VERSION) {
+        VLOG_ERROR(__FUNCTION__ " - Unreadable manifest: %s", path.c_str());
+        return false;
+    }
+
+    for (uint32 i = 0; i < header.m_cEntries; ++i) {
+        ManifestEntryHeader entry;
+        std::string name;
+        RemoteFile remote;
+        if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) ||
+            !ReadNameAndVersions(file, entry.m_cchName, entry.m_cVersions, name, remote.m_versions)) {
+            VLOG_ERROR(__FUNCTION__ " - Truncated manifest: %s", path.c_str());
+            return false;
+        }
+
+        remote.m_unSeq = entry.m_unSeq;
+        remote.m_unFullSeq = entry.m_unFullSeq;
+        remote.m_unHash = entry.m_unHash;
+        remote.m_unSize = entry.m_unSize;
+        remote.m_nTimestamp = entry.m_nTimestamp;
+        remote.m_unPlatforms = entry.m_unPlatforms;
+        remote.m_bDeleted = entry.m_bDeleted != 0;
+        manifest[name] = remote;
+    }
+    return true;
+}
+
+bool CloudSync::WriteManifest(const Manifest& manifest)
+{
+    std::vector<uint8> data;
+    AppendRecord(data, ManifestFileHeader{ MANIFEST_MAGIC, MANIFEST_VERSION, static_cast<uint32>(manifest.size()), 0 });
+    for (const auto& file : manifest) {
+        const RemoteFile& remote = file.second;
+        AppendRecord(data, ManifestEntryHeader{ remote.m_unSeq, remote.m_unFullSeq, remote.m_unHash, remote.m_unSize,
+                                                remote.m_nTimestamp, remote.m_unPlatforms, remote.m_bDeleted ? 1u : 0u,
+                                                static_cast<uint32>(file.first.size()),
+                                                static_cast<uint32>(remote.m_versions.size()) });
+        AppendNameAndVersions(data, file.first, remote.m_versions);
+    }
+
+    return WriteFileAtomic(m_sRemoteDirectory + "/" + REMOTE_MANIFEST_FILENAME, data.data(), data.size());
+}
+
+std::string CloudSync::ObjectDirectory(const std::string& name) const
+{
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(HashBytes64(name.data(), name.size())));
+    return m_sRemoteDirectory + "/" + REMOTE_OBJECTS_DIRECTORY + "/" + key;
+}
+
+std::string CloudSync::ObjectPath(const std::string& name, uint64 unSeq, const char* pchExtension) const
+{
+    char file[48];
+    snprintf(file, sizeof(file), "/%llu.%s", static_cast<unsigned long long>(unSeq), pchExtension);
+    return ObjectDirectory(name) + file;
+}
+
+} // namespace VaporCore
@@ -0,0 +1,352 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Block compression for stored files
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+
+#include "vapor_compression.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+static const uint32 STORED_FILE_MAGIC = 0x5a435600;     // "\0VCZ"
+static const uint8 STORED_FILE_VERSION = 1;
+
+// LZ block parameters. A sequence is a token (literal length << 4 | match
+// length - 4), extra length bytes, the literals, a 16-bit little-endian
+// offset and extra match length bytes; the last sequence is literals only.
+static const size_t LZ_MIN_MATCH = 4;
+static const size_t LZ_LAST_LITERALS = 5;      // The block always ends in this many literals
+static const size_t LZ_MATCH_FIND_LIMIT = 12;  // No match starts this close to the end
+static const size_t LZ_MAX_OFFSET = 65535;
+static const uint32 LZ_HASH_BITS = 14;
+
+static inline uint32 Read32(const uint8* p)
+{
+    uint32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64 Read64(const uint8* p)
+{
+    uint64 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32 HashSequence(uint32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+// Length continuation bytes: runs of 255 terminated by a smaller byte
+static inline uint8* WriteLength(uint8* op, size_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8>(length);
+    return op;
+}
+
+size_t LZCompressBound(size_t cubSrc)
+{
+    return cubSrc + cubSrc / 255 + 16;
+}
+
+size_t LZCompress(const uint8* pSrc, size_t cubSrc, uint8* pDst, size_t cubDst)
+{
+    uint8* op = pDst;
+    uint8* const opEnd = pDst + cubDst;
+
+    auto emit = [&](const uint8* pLiterals, size_t cubLiterals, size_t unOffset, size_t cubMatch) -> bool {
+        size_t cubWorst = 1 + cubLiterals / 255 + 1 + cubLiterals + 2 + cubMatch / 255 + 1;
+        if (static_cast<size_t>(opEnd - op) < cubWorst) {
+            return false;
+        }
+
+        uint8* pToken = op++;
+        *pToken = static_cast<uint8>(std::min<size_t>(cubLiterals, 15) << 4);
+        if (cubLiterals >= 15) {
+            op = WriteLength(op, cubLiterals - 15);
+        }
+        if (cubLiterals > 0) {
+            memcpy(op, pLiterals, cubLiterals);
+            op += cubLiterals;
+        }
+
+        if (cubMatch > 0) {
+            *op++ = static_cast<uint8>(unOffset);
+            *op++ = static_cast<uint8>(unOffset >> 8);
+
+            size_t cubExtra = cubMatch - LZ_MIN_MATCH;
+            *pToken |= static_cast<uint8>(std::min<size_t>(cubExtra, 15));
+            if (cubExtra >= 15) {
+                op = WriteLength(op, cubExtra - 15);
+            }
+        }
+        return true;
+    };
+
+    size_t anchor = 0;
+    if (cubSrc > LZ_MATCH_FIND_LIMIT) {
+        // Last position seen for each hashed 4-byte sequence
+        std::unique_ptr<uint32[]> table(new uint32[1u << LZ_HASH_BITS]());
+
+        const size_t unFindLimit = cubSrc - LZ_MATCH_FIND_LIMIT;
+        const size_t unMatchLimit = cubSrc - LZ_LAST_LITERALS;
+        size_t ip = 1;
+        table[HashSequence(Read32(pSrc))] = 0;
+
+        while (ip < unFindLimit) {
+            uint32 sequence = Read32(pSrc + ip);
+            uint32 unHash = HashSequence(sequence);
+            size_t ref = table[unHash];
+            table[unHash] = static_cast<uint32>(ip);
+
+            if (ip - ref > LZ_MAX_OFFSET || Read32(pSrc + ref) != sequence) {
+                // Skip faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend backwards over literals, then forwards a word at a time
+            while (ip > anchor && ref > 0 && pSrc[ip - 1] == pSrc[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            size_t cubMatch = LZ_MIN_MATCH;
+            while (ip + cubMatch + sizeof(uint64) <= unMatchLimit && Read64(pSrc + ip + cubMatch) == Read64(pSrc + ref + cubMatch)) {
+                cubMatch += sizeof(uint64);
+            }
+            while (ip + cubMatch < unMatchLimit && pSrc[ip + cubMatch] == pSrc[ref + cubMatch]) {
+                ++cubMatch;
+            }
+
+            if (!emit(pSrc + anchor, ip - anchor, ip - ref, cubMatch)) {
+                return 0;
+            }
+
+            ip += cubMatch;
+            anchor = ip;
+
+            // Remember a position inside the match, it often starts the next one
+            if (ip - 2 < unFindLimit) {
+                table[HashSequence(Read32(pSrc + ip - 2))] = static_cast<uint32>(ip - 2);
+            }
+        }
+    }
+
+    if (!emit(pSrc + anchor, cubSrc - anchor, 0, 0)) {
+        return 0;
+    }
+    return static_cast<size_t>(op - pDst);
+}
+
+bool LZDecompress(const uint8* pSrc, size_t cubSrc, uint8* pDst, size_t cubDst)
+{
+    size_t ip = 0;
+    size_t op = 0;
+
+    auto readLength = [&](size_t& length) -> bool {
+        uint8 byte;
+        do {
+            if (ip >= cubSrc) {
+                return false;
+            }
+            byte = pSrc[ip++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < cubSrc) {
+        uint8 token = pSrc[ip++];
+
+        size_t cubLiterals = token >> 4;
+        if (cubLiterals == 15 && !readLength(cubLiterals)) {
+            return false;
+        }
+        if (cubLiterals > cubSrc - ip || cubLiterals > cubDst - op) {
+            return false;
+        }
+        if (cubLiterals <= 16 && cubSrc - ip >= 16 && cubDst - op >= 16) {
+            // Short run with room on both sides: one fixed-size copy
+            memcpy(pDst + op, pSrc + ip, 16);
+        } else if (cubLiterals > 0) {
+            memcpy(pDst + op, pSrc + ip, cubLiterals);
+        }
+        ip += cubLiterals;
+        op += cubLiterals;
+
+        // The last sequence carries no match
+        if (ip == cubSrc) {
+            break;
+        }
+
+        if (cubSrc - ip < 2) {
+            return false;
+        }
+        size_t unOffset = pSrc[ip] | (static_cast<size_t>(pSrc[ip + 1]) << 8);
+        ip += 2;
+        if (unOffset == 0 || unOffset > op) {
+            return false;
+        }
+
+        size_t cubMatch = token & 15;
+        if (cubMatch == 15 && !readLength(cubMatch)) {
+            return false;
+        }
+        cubMatch += LZ_MIN_MATCH;
+        if (cubMatch > cubDst - op) {
+            return false;
+        }
+
+        uint8* pOut = pDst + op;
+        const uint8* pMatch = pOut - unOffset;
+        if (unOffset >= sizeof(uint64) && cubDst - op >= cubMatch + sizeof(uint64)) {
+            // Word copies only ever read bytes already written, even when the match overlaps
+            for (size_t i = 0; i < cubMatch; i += sizeof(uint64)) {
+                memcpy(pOut + i, pMatch + i, sizeof(uint64));
+            }
+        } else if (unOffset >= cubMatch) {
+            memcpy(pOut, pMatch, cubMatch);
+        } else {
+            // Overlapping copy repeats the last unOffset bytes
+            for (size_t i = 0; i < cubMatch; ++i) {
+                pOut[i] = pMatch[i];
+            }
+        }
+        op += cubMatch;
+    }
+
+    return op == cubDst;
+}
+
+bool ParseCompressionCodec(const std::string& name, ECompressionCodec& codec)
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == COMPRESSION_CODEC_NONE) {
+        codec = k_ECompressionCodecNone;
+        return true;
+    }
+    if (lower == COMPRESSION_CODEC_LZ || lower == "lz4") {
+        codec = k_ECompressionCodecLZ;
+        return true;
+    }
+    return false;
+}
+
+static uint16 HeaderCheck(const StoredFileHeader& header)
+{
+    uint64 hash = HashBytes64(&header.m_unOriginalSize, sizeof(header.m_unOriginalSize),
+                              (static_cast<uint64>(header.m_unCodec) << 8) | header.m_unVersion);
+    return static_cast<uint16>(hash);
+}
+
+static void WriteHeader(ECompressionCodec codec, size_t cubOriginal, uint8* pDst)
+{
+    StoredFileHeader header;
+    header.m_unMagic = STORED_FILE_MAGIC;
+    header.m_unCodec = codec;
+    header.m_unVersion = STORED_FILE_VERSION;
+    header.m_unOriginalSize = cubOriginal;
+    header.m_unCheck = HeaderCheck(header);
+    memcpy(pDst, &header, sizeof(header));
+}
+
+bool EncodeStoredFile(ECompressionCodec codec, const void* pData, size_t cubData, std::vector<uint8>& encoded)
+{
+    const uint8* pBytes = static_cast<const uint8*>(pData);
+
+    if (codec == k_ECompressionCodecNone) {
+        encoded.resize(sizeof(StoredFileHeader) + cubData);
+        WriteHeader(codec, cubData, encoded.data());
+        memcpy(encoded.data() + sizeof(StoredFileHeader), pBytes, cubData);
+        return true;
+    }
+
+    // Anything that does not come out smaller is not worth decoding on every read
+    if (cubData <= sizeof(StoredFileHeader)) {
+        return false;
+    }
+    size_t cubLimit = cubData - 1;
+    encoded.resize(sizeof(StoredFileHeader) + std::min(LZCompressBound(cubData), cubLimit));
+
+    size_t cubCompressed = LZCompress(pBytes, cubData, encoded.data() + sizeof(StoredFileHeader),
+                                      encoded.size() - sizeof(StoredFileHeader));
+    if (cubCompressed == 0 || sizeof(StoredFileHeader) + cubCompressed >= cubData) {
+        return false;
+    }
+
+    WriteHeader(codec, cubData, encoded.data());
+    encoded.resize(sizeof(StoredFileHeader) + cubCompressed);
+    return true;
+}
+
+bool NeedsStoredFileHeader(const void* pData, size_t cubData)
+{
+    StoredFileHeader header;
+    return ReadStoredFileHeader(pData, cubData, header);
+}
+
+bool ReadStoredFileHeader(const void* pStored, size_t cubStored, StoredFileHeader& header)
+{
+    if (cubStored < sizeof(StoredFileHeader)) {
+        return false;
+    }
+
+    memcpy(&header, pStored, sizeof(header));
+    return header.m_unMagic == STORED_FILE_MAGIC && header.m_unVersion == STORED_FILE_VERSION &&
+           header.m_unCodec <= k_ECompressionCodecLZ && header.m_unCheck == HeaderCheck(header);
+}
+
+int64 DecodeStoredFile(const void* pStored, size_t cubStored, void* pBuffer, size_t cubMax)
+{
+    StoredFileHeader header;
+    if (!ReadStoredFileHeader(pStored, cubStored, header)) {
+        return -1;
+    }
+
+    const uint8* pPayload = static_cast<const uint8*>(pStored) + sizeof(header);
+    size_t cubPayload = cubStored - sizeof(header);
+    size_t cubOriginal = static_cast<size_t>(header.m_unOriginalSize);
+
+    if (header.m_unCodec == k_ECompressionCodecNone) {
+        if (cubPayload != cubOriginal) {
+            return -1;
+        }
+        size_t cubCopy = std::min(cubOriginal, cubMax);
+        memcpy(pBuffer, pPayload, cubCopy);
+        return static_cast<int64>(cubCopy);
+    }
+
+    // A block only decodes as a whole; go through a scratch buffer for a short read
+    if (cubMax >= cubOriginal) {
+        return LZDecompress(pPayload, cubPayload, static_cast<uint8*>(pBuffer), cubOriginal) ? static_cast<int64>(cubOriginal) : -1;
+    }
+
+    std::vector<uint8> scratch(cubOriginal);
+    if (!LZDecompress(pPayload, cubPayload, scratch.data(), scratch.size())) {
+        return -1;
+    }
+    memcpy(pBuffer, scratch.data(), cubMax);
+    return static_cast<int64>(cubMax);
+}
+
+} // namespace VaporCore
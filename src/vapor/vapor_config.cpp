@@ -9,26 +9,54 @@
  * Purpose: Configuration file reader implementation
  */
 
-#include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <locale>
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 #include "vapor_config.h"
+#include "vapor_hash.h"
 #include "vapor_logger.h"
 
 namespace VaporCore {
 
+// Minimum capacity of the flat key table (must be a power of two)
+static const size_t MIN_KEY_TABLE_CAPACITY = 16;
+
+// Hot reload timing
+static const uint32 DEFAULT_HOT_RELOAD_POLL_MS = 1000;   // Polling fallback interval
+static const uint32 HOT_RELOAD_DEBOUNCE_MS = 100;        // Quiet period before re-parsing
+static const uint32 HOT_RELOAD_WAKEUP_MS = 100;          // Max latency of StopWatching()
+
 // Default configuration values (private implementation details)
 static const uint32 DEFAULT_STEAM_APP_ID = 0;
 static const uint64 DEFAULT_STEAM_ID = 76561198000000000ULL;
 static const char* const DEFAULT_STEAM_USERNAME = "VaporCore User";
 static const char* const DEFAULT_STEAM_LANGUAGE = "english";
 
+// Interned keys for the settings read at load time
+static constexpr Config::Key KEY_STEAM_APP_ID{ CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_APP_ID };
+static constexpr Config::Key KEY_STEAM_STEAM_ID{ CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_STEAM_ID };
+static constexpr Config::Key KEY_STEAM_USERNAME{ CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_USERNAME };
+static constexpr Config::Key KEY_STEAM_LANGUAGE{ CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_LANGUAGE };
+static constexpr Config::Key KEY_VAPORCORE_HOT_RELOAD{ CONFIG_SECTION_VAPORCORE, CONFIG_KEY_VAPORCORE_HOT_RELOAD };
+static constexpr Config::Key KEY_VAPORCORE_HOT_RELOAD_POLL_MS{ CONFIG_SECTION_VAPORCORE, CONFIG_KEY_VAPORCORE_HOT_RELOAD_POLL_MS };
+
 Config::Config()
     : m_sConfigFileName(DEFAULT_CONFIG_FILENAME),
       m_bLoaded(false),
+      m_pSnapshot(nullptr),
+      m_nextSubscriptionId(1),
+      m_bStopWatching(false),
       m_gameId(DEFAULT_STEAM_APP_ID),
       m_steamId(DEFAULT_STEAM_ID),
       m_sUsername(DEFAULT_STEAM_USERNAME),
@@ -36,15 +64,24 @@ Config::Config()
 {
     VLOG_INFO(__FUNCTION__);
 
+    // Readers always see a valid snapshot, even before the first load
+    Publish(std::make_unique<Snapshot>());
+
     LoadConfig(m_sConfigFileName);
+
+    if (GetBool(KEY_VAPORCORE_HOT_RELOAD, false)) {
+        StartWatching();
+    }
 }
 
 Config::~Config()
 {
     VLOG_INFO(__FUNCTION__);
+
+    StopWatching();
 }
 
-std::string Config::Trim(const std::string& str) const
+std::string Config::Trim(const std::string& str)
 {
     // Use C++11 standard library approach
     auto start = std::find_if_not(str.begin(), str.end(), [](unsigned char ch) {
@@ -58,7 +95,7 @@ std::string Config::Trim(const std::string& str) const
     return (start < end) ? std::string(start, end) : std::string();
 }
 
-std::string Config::ToLower(const std::string& str) const
+std::string Config::ToLower(const std::string& str)
 {
     std::string result;
     result.reserve(str.size());
@@ -69,89 +106,304 @@ std::string Config::ToLower(const std::string& str) const
     return result;
 }
 
-bool Config::ParseLine(const std::string& line, std::string& currentSection)
+// Whitespace as std::isspace() in the "C" locale, without the locale lookup
+static inline bool IsConfigSpace(char c)
 {
-    std::string trimmedLine = Trim(line);
-    
-    // Skip empty lines and comments
-    if (trimmedLine.empty() || trimmedLine[0] == '#' || trimmedLine[0] == ';')
-        return true;
-    
-    // Parse section header [SectionName]
-    if (trimmedLine[0] == '[' && trimmedLine.back() == ']')
-    {
-        currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
-        currentSection = Trim(currentSection);
-        // Make section name case-insensitive by converting to lowercase
-        currentSection = ToLower(currentSection);
-        VLOG_INFO(__FUNCTION__ " - Found section: %s", currentSection.c_str());
-        return true;
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static std::string_view TrimView(std::string_view str)
+{
+    size_t start = 0;
+    size_t end = str.size();
+    while (start < end && IsConfigSpace(str[start])) ++start;
+    while (end > start && IsConfigSpace(str[end - 1])) --end;
+    return str.substr(start, end - start);
+}
+
+static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
     }
-    
-    // Parse key=value pair
-    size_t equalPos = trimmedLine.find('=');
-    if (equalPos != std::string::npos && !currentSection.empty())
-    {
-        std::string key = Trim(trimmedLine.substr(0, equalPos));
-        std::string value = Trim(trimmedLine.substr(equalPos + 1));
-        
-        // Make key case-insensitive by converting to lowercase
-        key = ToLower(key);
-        
-        // Remove quotes if present
-        if (value.length() >= 2 && 
-            ((value[0] == '"' && value.back() == '"') || 
-             (value[0] == '\'' && value.back() == '\'')))
-        {
-            value = value.substr(1, value.length() - 2);
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
         }
-        
-        m_configData[currentSection][key] = value;
-        VLOG_INFO(__FUNCTION__ " - Config: [%s] %s = %s", currentSection.c_str(), key.c_str(), value.c_str());
-        return true;
     }
-    
-    // Invalid line format
-    VLOG_WARNING(__FUNCTION__ " - Invalid config line: %s", trimmedLine.c_str());
-    return false;
+    return true;
+}
+
+// Include directives
+static constexpr std::string_view CONFIG_DIRECTIVE_INCLUDE = "!include";
+static constexpr std::string_view CONFIG_DIRECTIVE_INCLUDEDIR = "!includedir";
+static const uint32 MAX_INCLUDE_DEPTH = 16;
+
+bool Config::ReadSourceFile(const std::string& path, std::vector<char>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamoff cubFile = file.tellg();
+    if (cubFile < 0) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(cubFile));
+    file.seekg(0);
+    return cubFile == 0 || static_cast<bool>(file.read(data.data(), cubFile));
+}
+
+bool Config::ParseSource(const std::string& path, uint32 unDepth, std::vector<std::string>& includeStack, Snapshot& snapshot)
+{
+    std::error_code ec;
+    std::string canonicalPath = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) {
+        canonicalPath = path;
+    }
+
+    if (std::find(includeStack.begin(), includeStack.end(), canonicalPath) != includeStack.end()) {
+        VLOG_ERROR(__FUNCTION__ " - Include cycle detected at %s, skipped", path.c_str());
+        return false;
+    }
+
+    // The stamp is taken first: a write racing the read leaves a newer stamp
+    // behind, so the next check re-reads rather than trusting stale contents
+    SourceFile source;
+    source.m_sPath = path;
+    source.m_nModifiedTime = static_cast<int64>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+
+    // The snapshot owns a private copy read straight into its buffer: an editor
+    // truncating or rewriting the file must not reach a published snapshot, and
+    // on Windows an open mapping would keep it from replacing the file at all
+    std::vector<char>& buffer = snapshot.m_buffers.emplace_back();
+    if (!ReadSourceFile(path, buffer)) {
+        snapshot.m_buffers.pop_back();
+        return false;
+    }
+    source.m_unSize = buffer.size();
+    source.m_unContentHash = HashBytes64(buffer.data(), buffer.size());
+    snapshot.m_sources.push_back(std::move(source));
+    std::string_view text(buffer.data(), buffer.size());
+    includeStack.push_back(canonicalPath);
+
+    // Every file starts outside any section; an included file cannot change the includer's section
+    std::string_view currentSection;
+    uint64 unSectionHash = 0;
+    size_t lineNumber = 0;
+    size_t pos = 0;
+
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) {
+            eol = text.size();
+        }
+        std::string_view line = TrimView(text.substr(pos, eol - pos));
+        pos = eol + 1;
+        ++lineNumber;
+
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+
+        if (line[0] == '!') {
+            ParseDirective(line, path, lineNumber, unDepth, includeStack, snapshot);
+            continue;
+        }
+
+        // Parse section header [SectionName]; repeated sections merge, later values win
+        if (line[0] == '[' && line.back() == ']') {
+            currentSection = TrimView(line.substr(1, line.size() - 2));
+            unSectionHash = Key::HashSection(currentSection);
+            snapshot.m_sectionHashes.push_back(unSectionHash);
+            continue;
+        }
+
+        // Parse key=value pair
+        size_t equalPos = line.find('=');
+        if (equalPos != std::string_view::npos && !currentSection.empty()) {
+            std::string_view key = TrimView(line.substr(0, equalPos));
+            std::string_view value = TrimView(line.substr(equalPos + 1));
+
+            if (!key.empty()) {
+                // Remove quotes if present
+                if (value.size() >= 2 &&
+                    ((value.front() == '"' && value.back() == '"') ||
+                     (value.front() == '\'' && value.back() == '\''))) {
+                    value = value.substr(1, value.size() - 2);
+                }
+
+                snapshot.Insert(currentSection, unSectionHash, key, value);
+                continue;
+            }
+        }
+
+        // Invalid line format
+        VLOG_WARNING(__FUNCTION__ " - Invalid config line %zu in %s: %s",
+                     lineNumber, path.c_str(), std::string(line).c_str());
+    }
+
+    includeStack.pop_back();
+    return true;
+}
+
+void Config::ParseDirective(std::string_view directive, const std::string& path, [[maybe_unused]] size_t lineNumber,
+                            uint32 unDepth, std::vector<std::string>& includeStack, Snapshot& snapshot)
+{
+    // Longest directive first, "!include" is a prefix of "!includedir"
+    bool bDirectory = false;
+    std::string_view argument;
+    if (directive.substr(0, CONFIG_DIRECTIVE_INCLUDEDIR.size()) == CONFIG_DIRECTIVE_INCLUDEDIR) {
+        bDirectory = true;
+        argument = directive.substr(CONFIG_DIRECTIVE_INCLUDEDIR.size());
+    } else if (directive.substr(0, CONFIG_DIRECTIVE_INCLUDE.size()) == CONFIG_DIRECTIVE_INCLUDE) {
+        argument = directive.substr(CONFIG_DIRECTIVE_INCLUDE.size());
+    } else {
+        VLOG_WARNING(__FUNCTION__ " - Unknown directive at line %zu in %s: %s",
+                     lineNumber, path.c_str(), std::string(directive).c_str());
+        return;
+    }
+
+    if (argument.empty() || !IsConfigSpace(argument[0])) {
+        VLOG_WARNING(__FUNCTION__ " - Malformed directive at line %zu in %s: %s",
+                     lineNumber, path.c_str(), std::string(directive).c_str());
+        return;
+    }
+
+    argument = TrimView(argument);
+    if (argument.size() >= 2 &&
+        ((argument.front() == '"' && argument.back() == '"') ||
+         (argument.front() == '\'' && argument.back() == '\''))) {
+        argument = argument.substr(1, argument.size() - 2);
+    }
+
+    if (unDepth + 1 > MAX_INCLUDE_DEPTH) {
+        VLOG_ERROR(__FUNCTION__ " - Include depth limit (%u) exceeded at line %zu in %s",
+                   MAX_INCLUDE_DEPTH, lineNumber, path.c_str());
+        return;
+    }
+
+    // Relative paths are resolved against the including file
+    std::filesystem::path target(argument);
+    if (target.is_relative()) {
+        target = std::filesystem::path(path).parent_path() / target;
+    }
+
+    if (!bDirectory) {
+        if (!ParseSource(target.string(), unDepth + 1, includeStack, snapshot)) {
+            VLOG_ERROR(__FUNCTION__ " - Could not include %s (line %zu in %s)",
+                       target.string().c_str(), lineNumber, path.c_str());
+        }
+        return;
+    }
+
+    bool bListed = false;
+    std::vector<std::string> files = ListIncludeDirectory(target.string(), bListed);
+    if (!bListed) {
+        VLOG_ERROR(__FUNCTION__ " - Could not read include directory %s (line %zu in %s)",
+                   target.string().c_str(), lineNumber, path.c_str());
+        return;
+    }
+
+    // The directory itself is a source too, so adding or removing a file invalidates the cache
+    std::string listing;
+    for (const std::string& file : files) {
+        listing.append(file).push_back('\0');
+    }
+
+    std::error_code ec;
+    SourceFile source;
+    source.m_sPath = target.string();
+    source.m_bDirectory = true;
+    source.m_nModifiedTime = static_cast<int64>(std::filesystem::last_write_time(target, ec).time_since_epoch().count());
+    source.m_unContentHash = HashBytes64(listing.data(), listing.size());
+    snapshot.m_sources.push_back(std::move(source));
+
+    for (const std::string& file : files) {
+        if (!ParseSource(file, unDepth + 1, includeStack, snapshot)) {
+            VLOG_ERROR(__FUNCTION__ " - Could not include %s", file.c_str());
+        }
+    }
+}
+
+std::vector<std::string> Config::ListIncludeDirectory(const std::string& directory, bool& bSuccess)
+{
+    // Every *.ini in the directory, in name order so the merge result is deterministic
+    std::error_code ec;
+    std::vector<std::string> files;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && EqualsIgnoreCase(it->path().extension().string(), ".ini")) {
+            files.push_back(it->path().string());
+        }
+    }
+
+    bSuccess = !ec;
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::unique_ptr<Config::Snapshot> Config::ParseFile(const std::string& filename)
+{
+    auto pSnapshot = std::make_unique<Snapshot>();
+    std::vector<std::string> includeStack;
+
+    if (!ParseSource(filename, 0, includeStack, *pSnapshot)) {
+        return nullptr;
+    }
+
+    pSnapshot->Finalize();
+    VLOG_DEBUG(__FUNCTION__ " - Parsed %zu keys from %zu files", pSnapshot->m_unKeyCount, pSnapshot->m_sources.size());
+    return pSnapshot;
+}
+
+void Config::Publish(std::shared_ptr<const Snapshot> pSnapshot)
+{
+    std::shared_ptr<const Snapshot> pOldSnapshot;
+    {
+        VAPORCORE_SCOPED_LOCK(m_reloadMutex);
+        pOldSnapshot = std::atomic_exchange_explicit(&m_pSnapshot, pSnapshot, std::memory_order_acq_rel);
+
+        // The snapshot retired before this one is released here (or by its last reader)
+        m_pRetiredSnapshot = pOldSnapshot;
+    }
+
+    if (pOldSnapshot) {
+        NotifySubscribers(*pOldSnapshot, *pSnapshot);
+    }
 }
 
 bool Config::LoadConfig(const std::string& filename)
 {
-    m_sConfigFileName = filename;
-    m_configData.clear();
-    m_bLoaded = false;
+    {
+        VAPORCORE_SCOPED_LOCK(m_reloadMutex);
+        m_sConfigFileName = filename;
+    }
+    m_bLoaded.store(false, std::memory_order_release);
     
     VLOG_INFO(__FUNCTION__ " - Loading configuration from: %s", filename.c_str());
     
-    std::ifstream file(filename);
-    if (!file.is_open())
+    std::unique_ptr<Snapshot> pSnapshot = LoadSnapshot(filename);
+    if (!pSnapshot)
     {
         VLOG_WARNING(__FUNCTION__ " - Could not open config file: %s (using defaults)", filename.c_str());
+
+        // Still remember the file so the watcher picks it up once it is created
+        pSnapshot = std::make_unique<Snapshot>();
+        pSnapshot->m_sources.push_back(SourceFile{ filename });
+        Publish(std::move(pSnapshot));
         return false;
     }
     
-    std::string line;
-    std::string currentSection;
-    int lineNumber = 0;
-    
-    while (std::getline(file, line))
-    {
-        lineNumber++;
-        if (!ParseLine(line, currentSection))
-        {
-            VLOG_WARNING(__FUNCTION__ " - Error parsing line %d in %s", lineNumber, filename.c_str());
-        }
-    }
-    
-    file.close();
-    m_bLoaded = true;
+    Publish(std::move(pSnapshot));
+    m_bLoaded.store(true, std::memory_order_release);
     
     // Load Steam settings after config is loaded
-    m_gameId = CGameID(GetUInt32(CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_APP_ID, DEFAULT_STEAM_APP_ID));
-    m_steamId = CSteamID(GetUInt64(CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_STEAM_ID, DEFAULT_STEAM_ID));
-    m_sUsername = GetString(CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_USERNAME, DEFAULT_STEAM_USERNAME);
-    m_sLanguage = GetString(CONFIG_SECTION_STEAM, CONFIG_KEY_STEAM_LANGUAGE, DEFAULT_STEAM_LANGUAGE);
+    m_gameId = CGameID(GetUInt32(KEY_STEAM_APP_ID, DEFAULT_STEAM_APP_ID));
+    m_steamId = CSteamID(GetUInt64(KEY_STEAM_STEAM_ID, DEFAULT_STEAM_ID));
+    m_sUsername = GetString(KEY_STEAM_USERNAME, DEFAULT_STEAM_USERNAME);
+    m_sLanguage = GetString(KEY_STEAM_LANGUAGE, DEFAULT_STEAM_LANGUAGE);
 
     VLOG_INFO(__FUNCTION__ " - Loaded Steam settings: AppId=%u, SteamId=%llu, Username=%s, Language=%s", 
                m_gameId.AppID(), m_steamId.ConvertToUint64(), m_sUsername.c_str(), m_sLanguage.c_str());
@@ -160,95 +412,452 @@ bool Config::LoadConfig(const std::string& filename)
     return true;
 }
 
-std::string Config::GetString(const std::string& section, const std::string& key, const std::string& defaultValue) const
+bool Config::Reload()
 {
-    // Make lookups case-insensitive
-    std::string lowerSection = ToLower(section);
-    std::string lowerKey = ToLower(key);
-    
-    auto sectionIt = m_configData.find(lowerSection);
-    if (sectionIt != m_configData.end())
+    std::string filename;
     {
-        auto keyIt = sectionIt->second.find(lowerKey);
-        if (keyIt != sectionIt->second.end())
-        {
-            return keyIt->second;
-        }
+        VAPORCORE_SCOPED_LOCK(m_reloadMutex);
+        filename = m_sConfigFileName;
     }
-    return defaultValue;
+
+    // Steam identity settings are handed out as references/c_str() and stay as loaded at startup
+    std::unique_ptr<Snapshot> pSnapshot = LoadSnapshot(filename);
+    if (!pSnapshot)
+    {
+        VLOG_WARNING(__FUNCTION__ " - Could not open config file: %s (keeping previous values)", filename.c_str());
+        return false;
+    }
+
+    Publish(std::move(pSnapshot));
+    m_bLoaded.store(true, std::memory_order_release);
+
+    VLOG_INFO(__FUNCTION__ " - Configuration reloaded from: %s", filename.c_str());
+    return true;
 }
 
-bool Config::GetBool(const std::string& section, const std::string& key, bool defaultValue) const
+Config::SubscriptionId Config::Subscribe(const std::vector<Key>& keys, ChangeCallback callback)
 {
-    std::string value = ToLower(GetString(section, key));
-    if (value.empty()) return defaultValue;
-    
-    return (value == "true" || value == "1" || value == "yes" || value == "on");
+    Subscription subscription;
+    subscription.m_keys.reserve(keys.size());
+    for (const Key& key : keys) {
+        subscription.m_keys.push_back(SubscribedKey{ key.Hash(), std::string(key.Section()), std::string(key.Name()) });
+    }
+    subscription.m_callback = std::move(callback);
+
+    VAPORCORE_SCOPED_LOCK(m_subscriptionMutex);
+    subscription.m_id = m_nextSubscriptionId++;
+    m_subscriptions.push_back(std::move(subscription));
+    return m_subscriptions.back().m_id;
 }
 
-int Config::GetInt(const std::string& section, const std::string& key, int defaultValue) const
+void Config::Unsubscribe(SubscriptionId id)
 {
-    std::string value = GetString(section, key);
-    if (value.empty()) return defaultValue;
-    
-    try
+    VAPORCORE_SCOPED_LOCK(m_subscriptionMutex);
+    m_subscriptions.erase(std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
+        [id](const Subscription& subscription) { return subscription.m_id == id; }), m_subscriptions.end());
+}
+
+void Config::NotifySubscribers(const Snapshot& oldSnapshot, const Snapshot& newSnapshot)
+{
+    std::vector<ChangeCallback> callbacks;
     {
-        return std::stoi(value);
+        VAPORCORE_SCOPED_LOCK(m_subscriptionMutex);
+        if (m_subscriptions.empty()) {
+            return;
+        }
+
+        if (oldSnapshot.SameContents(newSnapshot)) {
+            return;
+        }
+
+        for (const Subscription& subscription : m_subscriptions) {
+            bool bChanged = subscription.m_keys.empty();
+            for (const SubscribedKey& key : subscription.m_keys) {
+                const KeyEntry* pOld = oldSnapshot.FindEntry(key.m_unHash, key.m_sSection, key.m_sKey);
+                const KeyEntry* pNew = newSnapshot.FindEntry(key.m_unHash, key.m_sSection, key.m_sKey);
+                if ((pOld == nullptr) != (pNew == nullptr) || (pOld && pOld->m_value != pNew->m_value)) {
+                    bChanged = true;
+                    break;
+                }
+            }
+
+            if (bChanged) {
+                callbacks.push_back(subscription.m_callback);
+            }
+        }
     }
-    catch (const std::exception&)
-    {
-        VLOG_WARNING(__FUNCTION__ " - Invalid integer value for [%s] %s: %s", section.c_str(), key.c_str(), value.c_str());
-        return defaultValue;
+
+    // Run callbacks without holding the lock so they may (un)subscribe
+    for (const ChangeCallback& callback : callbacks) {
+        callback();
     }
 }
 
-uint32 Config::GetUInt32(const std::string& section, const std::string& key, uint32 defaultValue) const
+void Config::StartWatching()
 {
-    std::string value = GetString(section, key);
-    if (value.empty()) return defaultValue;
-    
-    try
-    {
-        unsigned long result = std::stoul(value);
-        return static_cast<uint32>(result);
+    if (m_watchThread.joinable()) {
+        return;
     }
-    catch (const std::exception&)
-    {
-        VLOG_WARNING(__FUNCTION__ " - Invalid uint32 value for [%s] %s: %s", section.c_str(), key.c_str(), value.c_str());
-        return defaultValue;
+
+    uint32 unPollIntervalMs = GetUInt32(KEY_VAPORCORE_HOT_RELOAD_POLL_MS, DEFAULT_HOT_RELOAD_POLL_MS);
+    m_bStopWatching.store(false);
+    m_watchThread = std::thread(&Config::WatchThread, this, unPollIntervalMs);
+
+    VLOG_INFO(__FUNCTION__ " - Watching configuration for changes");
+}
+
+void Config::StopWatching()
+{
+    if (!m_watchThread.joinable()) {
+        return;
     }
+
+    m_bStopWatching.store(true);
+    m_watchThread.join();
+
+    VLOG_INFO(__FUNCTION__ " - Stopped watching configuration");
 }
 
-uint64 Config::GetUInt64(const std::string& section, const std::string& key, uint64 defaultValue) const
+void Config::WatchThread(uint32 unPollIntervalMs)
 {
-    std::string value = GetString(section, key);
-    if (value.empty()) return defaultValue;
-    
-    try
-    {
-        return std::stoull(value);
+    using Clock = std::chrono::steady_clock;
+    const auto debounce = std::chrono::milliseconds(HOT_RELOAD_DEBOUNCE_MS);
+
+#ifdef __linux__
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        std::vector<int> watches;
+        std::vector<std::string> watchedNames;
+
+        // Watch the parent directories: editors usually replace the file via rename
+        auto refreshWatches = [&]() {
+            for (int wd : watches) {
+                inotify_rm_watch(inotifyFd, wd);
+            }
+            watches.clear();
+            watchedNames.clear();
+
+            std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+            for (const SourceFile& source : pSnapshot->m_sources) {
+                std::filesystem::path sourcePath(source.m_sPath);
+                std::string directory = sourcePath.has_parent_path() ? sourcePath.parent_path().string() : ".";
+                int wd = inotify_add_watch(inotifyFd, directory.c_str(),
+                                           IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB);
+                if (wd >= 0) {
+                    watches.push_back(wd);
+                }
+                watchedNames.push_back(sourcePath.filename().string());
+            }
+        };
+        refreshWatches();
+
+        bool bPending = false;
+        Clock::time_point lastEvent;
+        alignas(inotify_event) char buffer[4096];
+
+        while (!m_bStopWatching.load()) {
+            pollfd pfd = { inotifyFd, POLLIN, 0 };
+            if (poll(&pfd, 1, HOT_RELOAD_WAKEUP_MS) > 0) {
+                ssize_t length;
+                while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                    for (char* ptr = buffer; ptr < buffer + length; ) {
+                        const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(ptr);
+                        if (pEvent->len > 0 &&
+                            std::find(watchedNames.begin(), watchedNames.end(), pEvent->name) != watchedNames.end()) {
+                            bPending = true;
+                            lastEvent = Clock::now();
+                        }
+                        ptr += sizeof(inotify_event) + pEvent->len;
+                    }
+                }
+            }
+
+            if (bPending && Clock::now() - lastEvent >= debounce) {
+                bPending = false;
+                Reload();
+                refreshWatches();
+            }
+        }
+
+        close(inotifyFd);
+        return;
     }
-    catch (const std::exception&)
-    {
-        VLOG_WARNING(__FUNCTION__ " - Invalid uint64 value for [%s] %s: %s", section.c_str(), key.c_str(), value.c_str());
+
+    VLOG_WARNING(__FUNCTION__ " - inotify unavailable, falling back to polling every %u ms", unPollIntervalMs);
+#endif
+
+    // Polling fallback: compare modification time and size of every source file
+    using Fingerprint = std::vector<std::pair<std::filesystem::file_time_type, std::uintmax_t>>;
+    auto fingerprint = [this]() {
+        Fingerprint result;
+        std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+        for (const SourceFile& source : pSnapshot->m_sources) {
+            std::error_code ec;
+            auto mtime = std::filesystem::last_write_time(source.m_sPath, ec);
+            auto size = (ec || source.m_bDirectory) ? 0 : std::filesystem::file_size(source.m_sPath, ec);
+            result.emplace_back(ec ? std::filesystem::file_time_type() : mtime, ec ? 0 : size);
+        }
+        return result;
+    };
+
+    Fingerprint lastFingerprint = fingerprint();
+    Clock::time_point nextPoll = Clock::now() + std::chrono::milliseconds(unPollIntervalMs);
+
+    while (!m_bStopWatching.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(unPollIntervalMs, HOT_RELOAD_WAKEUP_MS)));
+        if (Clock::now() < nextPoll) {
+            continue;
+        }
+        nextPoll = Clock::now() + std::chrono::milliseconds(unPollIntervalMs);
+
+        Fingerprint currentFingerprint = fingerprint();
+        if (currentFingerprint != lastFingerprint) {
+            // Give the writer a moment to finish before re-parsing
+            std::this_thread::sleep_for(debounce);
+            Reload();
+            lastFingerprint = fingerprint();
+        }
+    }
+}
+
+void Config::Snapshot::Insert(std::string_view section, uint64 unSectionHash, std::string_view key, std::string_view value)
+{
+    // Keep the load factor at or below 50% so probe sequences stay short
+    if ((m_unKeyCount + 1) * 2 > m_keyTable.size()) {
+        Rehash(std::max(MIN_KEY_TABLE_CAPACITY, m_keyTable.size() * 2));
+    }
+
+    // A key whose hash collides with another's gets a slot further along the probe sequence
+    uint64 unHash = Key::HashKey(section, key);
+    size_t slot = static_cast<size_t>(unHash & m_unKeyTableMask);
+    while (m_keyTable[slot].m_unHash != 0 && !m_keyTable[slot].Matches(unHash, section, key)) {
+        slot = (slot + 1) & m_unKeyTableMask;
+    }
+
+    KeyEntry& entry = m_keyTable[slot];
+    if (entry.m_unHash == 0) {
+        ++m_unKeyCount;
+    }
+
+    entry.m_unHash = unHash;
+    entry.m_unSectionHash = unSectionHash;
+    entry.m_section = section;
+    entry.m_key = key;
+    entry.m_value = value;
+}
+
+void Config::Snapshot::Rehash(size_t capacity)
+{
+    std::vector<KeyEntry> oldTable(capacity);
+    oldTable.swap(m_keyTable);
+    m_unKeyTableMask = capacity - 1;
+
+    for (const KeyEntry& entry : oldTable) {
+        if (entry.m_unHash == 0) {
+            continue;
+        }
+
+        size_t slot = static_cast<size_t>(entry.m_unHash & m_unKeyTableMask);
+        while (m_keyTable[slot].m_unHash != 0) {
+            slot = (slot + 1) & m_unKeyTableMask;
+        }
+        m_keyTable[slot] = entry;
+    }
+}
+
+void Config::Snapshot::Finalize()
+{
+    std::sort(m_sectionHashes.begin(), m_sectionHashes.end());
+    m_sectionHashes.erase(std::unique(m_sectionHashes.begin(), m_sectionHashes.end()), m_sectionHashes.end());
+
+    // Parse every typed representation once (final values only) so typed getters are plain field reads
+    for (KeyEntry& entry : m_keyTable) {
+        if (entry.m_unHash == 0) {
+            continue;
+        }
+
+        entry.m_bBool = EqualsIgnoreCase(entry.m_value, "true") || entry.m_value == "1" ||
+                        EqualsIgnoreCase(entry.m_value, "yes") || EqualsIgnoreCase(entry.m_value, "on");
+
+        // The whole value must be the number (quotes may have left spaces inside);
+        // a leading '+' is accepted as the std::stoi family did, from_chars does not
+        std::string_view number = TrimView(entry.m_value);
+        if (number.size() > 1 && number[0] == '+' && number[1] != '+' && number[1] != '-') {
+            number.remove_prefix(1);
+        }
+        const char* first = number.data();
+        const char* last = first + number.size();
+        auto parseAll = [first, last](auto& value) {
+            std::from_chars_result result = std::from_chars(first, last, value);
+            return result.ec == std::errc() && result.ptr == last;
+        };
+
+        if (parseAll(entry.m_nInt32)) {
+            entry.m_fTypes |= KeyEntry::k_EHasInt32;
+        }
+        if (parseAll(entry.m_unUInt32)) {
+            entry.m_fTypes |= KeyEntry::k_EHasUInt32;
+        }
+        if (parseAll(entry.m_unUInt64)) {
+            entry.m_fTypes |= KeyEntry::k_EHasUInt64;
+        }
+        if (parseAll(entry.m_flFloat)) {
+            entry.m_fTypes |= KeyEntry::k_EHasFloat;
+        }
+    }
+}
+
+bool Config::Snapshot::HasSection(uint64 unSectionHash) const noexcept
+{
+    return std::binary_search(m_sectionHashes.begin(), m_sectionHashes.end(), unSectionHash);
+}
+
+bool Config::Snapshot::SameContents(const Snapshot& other) const noexcept
+{
+    if (m_unKeyCount != other.m_unKeyCount) {
+        return false;
+    }
+
+    for (const KeyEntry& entry : m_keyTable) {
+        if (entry.m_unHash == 0) {
+            continue;
+        }
+        const KeyEntry* pOther = other.FindEntry(entry.m_unHash, entry.m_section, entry.m_key);
+        if (!pOther || pOther->m_value != entry.m_value) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Config::KeyEntry::Matches(uint64 unOtherHash, std::string_view section, std::string_view key) const noexcept
+{
+    return m_unHash == unOtherHash && EqualsIgnoreCase(m_key, key) && EqualsIgnoreCase(m_section, section);
+}
+
+const Config::KeyEntry* Config::Snapshot::FindEntry(uint64 unHash, std::string_view section, std::string_view key) const noexcept
+{
+    if (m_keyTable.empty()) {
+        return nullptr;
+    }
+
+    size_t slot = static_cast<size_t>(unHash & m_unKeyTableMask);
+    while (m_keyTable[slot].m_unHash != 0) {
+        if (m_keyTable[slot].Matches(unHash, section, key)) {
+            return &m_keyTable[slot];
+        }
+        slot = (slot + 1) & m_unKeyTableMask;
+    }
+
+    return nullptr;
+}
+
+std::string_view Config::GetString(const Key& key, std::string_view defaultValue) const
+{
+    // Released on return, the retired snapshot keeps the view valid past the next reload
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    return pEntry ? pEntry->m_value : defaultValue;
+}
+
+bool Config::GetBool(const Key& key, bool defaultValue) const
+{
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    if (!pEntry || pEntry->m_value.empty()) return defaultValue;
+
+    return pEntry->m_bBool;
+}
+
+int Config::GetInt(const Key& key, int defaultValue) const
+{
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    if (!pEntry || pEntry->m_value.empty()) return defaultValue;
+
+    if (!(pEntry->m_fTypes & KeyEntry::k_EHasInt32)) {
+        VLOG_WARNING(__FUNCTION__ " - Invalid integer value: %s", std::string(pEntry->m_value).c_str());
         return defaultValue;
     }
+    return pEntry->m_nInt32;
 }
 
-float Config::GetFloat(const std::string& section, const std::string& key, float defaultValue) const
+uint32 Config::GetUInt32(const Key& key, uint32 defaultValue) const
 {
-    std::string value = GetString(section, key);
-    if (value.empty()) return defaultValue;
-    
-    try
-    {
-        return std::stof(value);
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    if (!pEntry || pEntry->m_value.empty()) return defaultValue;
+
+    if (!(pEntry->m_fTypes & KeyEntry::k_EHasUInt32)) {
+        VLOG_WARNING(__FUNCTION__ " - Invalid uint32 value: %s", std::string(pEntry->m_value).c_str());
+        return defaultValue;
     }
-    catch (const std::exception&)
-    {
-        VLOG_WARNING(__FUNCTION__ " - Invalid float value for [%s] %s: %s", section.c_str(), key.c_str(), value.c_str());
+    return pEntry->m_unUInt32;
+}
+
+uint64 Config::GetUInt64(const Key& key, uint64 defaultValue) const
+{
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    if (!pEntry || pEntry->m_value.empty()) return defaultValue;
+
+    if (!(pEntry->m_fTypes & KeyEntry::k_EHasUInt64)) {
+        VLOG_WARNING(__FUNCTION__ " - Invalid uint64 value: %s", std::string(pEntry->m_value).c_str());
+        return defaultValue;
+    }
+    return pEntry->m_unUInt64;
+}
+
+float Config::GetFloat(const Key& key, float defaultValue) const
+{
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(key);
+    if (!pEntry || pEntry->m_value.empty()) return defaultValue;
+
+    if (!(pEntry->m_fTypes & KeyEntry::k_EHasFloat)) {
+        VLOG_WARNING(__FUNCTION__ " - Invalid float value: %s", std::string(pEntry->m_value).c_str());
         return defaultValue;
     }
+    return pEntry->m_flFloat;
+}
+
+bool Config::HasKey(const Key& key) const
+{
+    return CurrentSnapshot()->FindEntry(key) != nullptr;
+}
+
+// String-based getters hash the names on the fly, so they no longer lowercase or allocate either
+std::string Config::GetString(const std::string& section, const std::string& key, const std::string& defaultValue) const
+{
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    const KeyEntry* pEntry = pSnapshot->FindEntry(Key(section, key));
+    return pEntry ? std::string(pEntry->m_value) : defaultValue;
+}
+
+bool Config::GetBool(const std::string& section, const std::string& key, bool defaultValue) const
+{
+    return GetBool(Key(section, key), defaultValue);
+}
+
+int Config::GetInt(const std::string& section, const std::string& key, int defaultValue) const
+{
+    return GetInt(Key(section, key), defaultValue);
+}
+
+uint32 Config::GetUInt32(const std::string& section, const std::string& key, uint32 defaultValue) const
+{
+    return GetUInt32(Key(section, key), defaultValue);
+}
+
+uint64 Config::GetUInt64(const std::string& section, const std::string& key, uint64 defaultValue) const
+{
+    return GetUInt64(Key(section, key), defaultValue);
+}
+
+float Config::GetFloat(const std::string& section, const std::string& key, float defaultValue) const
+{
+    return GetFloat(Key(section, key), defaultValue);
 }
 
 std::vector<std::string> Config::GetStringList(const std::string& section, const std::string& key) const
@@ -295,36 +904,28 @@ std::vector<int> Config::GetIntList(const std::string& section, const std::strin
 
 bool Config::HasSection(const std::string& section) const
 {
-    std::string lowerSection = ToLower(section);
-    return m_configData.find(lowerSection) != m_configData.end();
+    return CurrentSnapshot()->HasSection(Key::HashSection(section));
 }
 
 bool Config::HasKey(const std::string& section, const std::string& key) const
 {
-    std::string lowerSection = ToLower(section);
-    std::string lowerKey = ToLower(key);
-    
-    auto sectionIt = m_configData.find(lowerSection);
-    if (sectionIt != m_configData.end())
-    {
-        return sectionIt->second.find(lowerKey) != sectionIt->second.end();
-    }
-    return false;
+    return HasKey(Key(section, key));
 }
 
 std::vector<std::string> Config::GetSectionKeys(const std::string& section) const
 {
     std::vector<std::string> result;
-    auto sectionIt = m_configData.find(section);
-    
-    if (sectionIt != m_configData.end())
-    {
-        for (const auto& pair : sectionIt->second)
-        {
-            result.push_back(pair.first);
+    std::shared_ptr<const Snapshot> pSnapshot = CurrentSnapshot();
+    uint64 unSectionHash = Key::HashSection(section);
+
+    for (const KeyEntry& entry : pSnapshot->m_keyTable) {
+        if (entry.m_unHash != 0 && entry.m_unSectionHash == unSectionHash && EqualsIgnoreCase(entry.m_section, section)) {
+            result.push_back(ToLower(std::string(entry.m_key)));
         }
     }
-    
+
+    // Table order is hash order, keep the sorted output of the old std::map storage
+    std::sort(result.begin(), result.end());
     return result;
 }
 
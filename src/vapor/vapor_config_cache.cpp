@@ -0,0 +1,444 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Compiled binary configuration cache
+ */
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <type_traits>
+
+#include "vapor_config.h"
+#include "vapor_hash.h"
+#include "vapor_logger.h"
+#include "vapor_mapped_file.h"
+
+namespace VaporCore {
+
+//-----------------------------------------------------------------------------
+// Cache image layout (host byte order, every section 8-byte aligned):
+//
+//   ConfigCacheHeader
+//   ConfigCacheSource[m_unSourceCount]
+//   ConfigCacheEntry[m_unKeyTableCapacity]   key table, slot positions preserved
+//   uint64[m_unSectionCount]                 sorted section hashes
+//   char[m_unStringsSize]                    string table (paths, section and key names, values)
+//
+// The key table is stored exactly as Snapshot::m_keyTable lays it out, so
+// loading is a bounds-checked copy with no tokenizing, hashing or number parsing.
+//-----------------------------------------------------------------------------
+
+static const uint32 CONFIG_CACHE_MAGIC = 0x47464356; // "VCFG"
+static const uint32 CONFIG_CACHE_VERSION = 2;
+
+// Source flags
+static const uint32 k_ECacheSourceDirectory = 1 << 0;
+
+struct ConfigCacheHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_unEntrySize;       // sizeof(ConfigCacheEntry), catches layout changes
+    uint32 m_unSourceCount;
+    uint64 m_unImageSize;       // Whole file, catches truncation
+    uint64 m_unKeyTableOffset;
+    uint64 m_unKeyTableCapacity;
+    uint64 m_unKeyCount;
+    uint64 m_unSectionOffset;
+    uint64 m_unSectionCount;
+    uint64 m_unSourceOffset;
+    uint64 m_unStringsOffset;
+    uint64 m_unStringsSize;
+};
+
+struct ConfigCacheSource
+{
+    uint32 m_unPathOffset;
+    uint32 m_unPathLength;
+    uint32 m_unFlags;
+    uint32 m_unReserved;
+    int64 m_nModifiedTime;
+    uint64 m_unSize;
+    uint64 m_unContentHash;
+};
+
+struct ConfigCacheEntry
+{
+    uint64 m_unHash;            // 0 marks an empty slot
+    uint64 m_unSectionHash;
+    uint64 m_unUInt64;
+    uint32 m_unSectionNameOffset;
+    uint32 m_unSectionNameLength;
+    uint32 m_unKeyOffset;
+    uint32 m_unKeyLength;
+    uint32 m_unValueOffset;
+    uint32 m_unValueLength;
+    int32 m_nInt32;
+    uint32 m_unUInt32;
+    float m_flFloat;
+    uint8 m_fTypes;
+    uint8 m_bBool;
+    uint8 m_reserved[2];
+};
+
+static_assert(std::is_trivially_copyable<ConfigCacheHeader>::value, "cache header must be POD");
+static_assert(sizeof(ConfigCacheSource) == 40, "unexpected ConfigCacheSource layout");
+static_assert(sizeof(ConfigCacheEntry) == 64, "unexpected ConfigCacheEntry layout");
+
+static size_t AlignCacheOffset(size_t offset)
+{
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+static bool IsRangeValid(uint64 unOffset, uint64 unLength, uint64 unLimit)
+{
+    return unOffset <= unLimit && unLength <= unLimit - unOffset;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Check a recorded source against the file system. A matching
+// modification time and size is taken as unchanged, so a launch with a current
+// cache only stats its sources. The contents are hashed only when the stamp
+// differs; if they still match (a touch, a restore from backup) the source is
+// current and takes the new stamp, and bRestamped is set
+//-----------------------------------------------------------------------------
+bool Config::IsSourceCurrent(SourceFile& source, bool& bRestamped)
+{
+    std::error_code ec;
+    int64 nModifiedTime = static_cast<int64>(std::filesystem::last_write_time(source.m_sPath, ec).time_since_epoch().count());
+    if (ec) {
+        return false;
+    }
+
+    if (source.m_bDirectory) {
+        // Adding, removing or renaming a file updates the directory's own time
+        if (nModifiedTime == source.m_nModifiedTime) {
+            return true;
+        }
+
+        bool bListed = false;
+        std::vector<std::string> files = ListIncludeDirectory(source.m_sPath, bListed);
+        if (!bListed) {
+            return false;
+        }
+
+        std::string listing;
+        for (const std::string& file : files) {
+            listing.append(file).push_back('\0');
+        }
+        if (HashBytes64(listing.data(), listing.size()) != source.m_unContentHash) {
+            return false;
+        }
+        source.m_nModifiedTime = nModifiedTime;
+        bRestamped = true;
+        return true;
+    }
+
+    uint64 unSize = std::filesystem::file_size(source.m_sPath, ec);
+    if (ec || unSize != source.m_unSize) {
+        return false;
+    }
+    if (nModifiedTime == source.m_nModifiedTime) {
+        return true;
+    }
+
+    std::vector<char> data;
+    if (!ReadSourceFile(source.m_sPath, data) || data.size() != source.m_unSize ||
+        HashBytes64(data.data(), data.size()) != source.m_unContentHash) {
+        return false;
+    }
+    source.m_nModifiedTime = nModifiedTime;
+    bRestamped = true;
+    return true;
+}
+
+std::unique_ptr<Config::Snapshot> Config::LoadSnapshot(const std::string& filename)
+{
+    std::string cachePath = filename + CONFIG_CACHE_EXTENSION;
+
+    bool bRestamped = false;
+    std::unique_ptr<Snapshot> pSnapshot = LoadCache(cachePath, filename, bRestamped);
+    if (pSnapshot) {
+        VLOG_DEBUG(__FUNCTION__ " - Using compiled cache %s", cachePath.c_str());
+
+        // Record the new stamps so the next launch does not hash the same sources again
+        if (bRestamped) {
+            WriteCache(cachePath, *pSnapshot);
+        }
+        return pSnapshot;
+    }
+
+    pSnapshot = ParseFile(filename);
+    if (!pSnapshot) {
+        return nullptr;
+    }
+
+    // Opt-in: the cache is only written when the configuration asks for it
+    static constexpr Key KEY_VAPORCORE_CONFIG_CACHE{ CONFIG_SECTION_VAPORCORE, CONFIG_KEY_VAPORCORE_CONFIG_CACHE };
+    const KeyEntry* pEntry = pSnapshot->FindEntry(KEY_VAPORCORE_CONFIG_CACHE);
+    if (pEntry && pEntry->m_bBool) {
+        WriteCache(cachePath, *pSnapshot);
+    }
+
+    return pSnapshot;
+}
+
+bool Config::CompileCache(const std::string& filename)
+{
+    std::unique_ptr<Snapshot> pSnapshot = ParseFile(filename);
+    if (!pSnapshot) {
+        VLOG_ERROR(__FUNCTION__ " - Could not open config file: %s", filename.c_str());
+        return false;
+    }
+
+    return WriteCache(filename + CONFIG_CACHE_EXTENSION, *pSnapshot);
+}
+
+std::unique_ptr<Config::Snapshot> Config::LoadCache(const std::string& cachePath, const std::string& filename, bool& bRestamped)
+{
+    MappedFile image;
+    if (!image.Open(cachePath)) {
+        return nullptr;
+    }
+
+    const uint64 unImageSize = image.Size();
+    if (unImageSize < sizeof(ConfigCacheHeader)) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring truncated config cache %s", cachePath.c_str());
+        return nullptr;
+    }
+
+    ConfigCacheHeader header;
+    memcpy(&header, image.Data(), sizeof(header));
+    if (header.m_unMagic != CONFIG_CACHE_MAGIC || header.m_unVersion != CONFIG_CACHE_VERSION ||
+        header.m_unEntrySize != sizeof(ConfigCacheEntry)) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring config cache %s from another version", cachePath.c_str());
+        return nullptr;
+    }
+
+    const uint64 unCapacity = header.m_unKeyTableCapacity;
+    if (header.m_unImageSize != unImageSize ||
+        (unCapacity & (unCapacity - 1)) != 0 ||
+        header.m_unKeyCount * 2 > unCapacity ||
+        unCapacity > unImageSize / sizeof(ConfigCacheEntry) ||
+        header.m_unSourceCount > unImageSize / sizeof(ConfigCacheSource) ||
+        header.m_unSectionCount > unImageSize / sizeof(uint64) ||
+        !IsRangeValid(header.m_unSourceOffset, header.m_unSourceCount * sizeof(ConfigCacheSource), unImageSize) ||
+        !IsRangeValid(header.m_unKeyTableOffset, unCapacity * sizeof(ConfigCacheEntry), unImageSize) ||
+        !IsRangeValid(header.m_unSectionOffset, header.m_unSectionCount * sizeof(uint64), unImageSize) ||
+        !IsRangeValid(header.m_unStringsOffset, header.m_unStringsSize, unImageSize)) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring corrupt config cache %s", cachePath.c_str());
+        return nullptr;
+    }
+
+    auto pSnapshot = std::make_unique<Snapshot>();
+    const char* pPool = image.Data() + header.m_unStringsOffset;
+    const uint64 unStringsSize = header.m_unStringsSize;
+
+    // Sources: the cache is only usable if it was built from this file and nothing changed since
+    pSnapshot->m_sources.reserve(header.m_unSourceCount);
+    for (uint32 i = 0; i < header.m_unSourceCount; ++i) {
+        ConfigCacheSource cached;
+        memcpy(&cached, image.Data() + header.m_unSourceOffset + i * sizeof(ConfigCacheSource), sizeof(cached));
+        if (!IsRangeValid(cached.m_unPathOffset, cached.m_unPathLength, unStringsSize)) {
+            VLOG_WARNING(__FUNCTION__ " - Ignoring corrupt config cache %s", cachePath.c_str());
+            return nullptr;
+        }
+
+        SourceFile source;
+        source.m_sPath.assign(pPool + cached.m_unPathOffset, cached.m_unPathLength);
+        source.m_bDirectory = (cached.m_unFlags & k_ECacheSourceDirectory) != 0;
+        source.m_nModifiedTime = cached.m_nModifiedTime;
+        source.m_unSize = cached.m_unSize;
+        source.m_unContentHash = cached.m_unContentHash;
+        pSnapshot->m_sources.push_back(std::move(source));
+    }
+
+    // The cache may have been compiled through a different (relative) spelling of the same path
+    std::error_code ec;
+    if (pSnapshot->m_sources.empty() ||
+        !std::filesystem::equivalent(pSnapshot->m_sources.front().m_sPath, filename, ec)) {
+        return nullptr;
+    }
+
+    for (SourceFile& source : pSnapshot->m_sources) {
+        if (!IsSourceCurrent(source, bRestamped)) {
+            VLOG_DEBUG(__FUNCTION__ " - Config cache %s is stale (%s changed)", cachePath.c_str(), source.m_sPath.c_str());
+            return nullptr;
+        }
+    }
+
+    // Keys and values are views into the snapshot's own copy of the string pool,
+    // a single copy of a few kilobytes. Views into the mapping would keep it open
+    // for as long as the snapshot lives, and on Windows that keeps WriteCache()
+    // from replacing the cache file
+    pSnapshot->m_buffers.emplace_back(pPool, pPool + unStringsSize);
+    const char* pStrings = pSnapshot->m_buffers.back().data();
+
+    // Key table: same slots as when it was written
+    if (unCapacity > 0) {
+        pSnapshot->m_keyTable.resize(static_cast<size_t>(unCapacity));
+        pSnapshot->m_unKeyTableMask = unCapacity - 1;
+    }
+
+    const char* pEntries = image.Data() + header.m_unKeyTableOffset;
+    size_t unKeyCount = 0;
+    for (size_t slot = 0; slot < unCapacity; ++slot) {
+        ConfigCacheEntry cached;
+        memcpy(&cached, pEntries + slot * sizeof(ConfigCacheEntry), sizeof(cached));
+        if (cached.m_unHash == 0) {
+            continue;
+        }
+
+        if (!IsRangeValid(cached.m_unSectionNameOffset, cached.m_unSectionNameLength, unStringsSize) ||
+            !IsRangeValid(cached.m_unKeyOffset, cached.m_unKeyLength, unStringsSize) ||
+            !IsRangeValid(cached.m_unValueOffset, cached.m_unValueLength, unStringsSize)) {
+            VLOG_WARNING(__FUNCTION__ " - Ignoring corrupt config cache %s", cachePath.c_str());
+            return nullptr;
+        }
+
+        KeyEntry& entry = pSnapshot->m_keyTable[slot];
+        entry.m_unHash = cached.m_unHash;
+        entry.m_unSectionHash = cached.m_unSectionHash;
+        entry.m_section = std::string_view(pStrings + cached.m_unSectionNameOffset, cached.m_unSectionNameLength);
+        entry.m_key = std::string_view(pStrings + cached.m_unKeyOffset, cached.m_unKeyLength);
+        entry.m_value = std::string_view(pStrings + cached.m_unValueOffset, cached.m_unValueLength);
+        entry.m_fTypes = cached.m_fTypes;
+        entry.m_bBool = cached.m_bBool != 0;
+        entry.m_nInt32 = cached.m_nInt32;
+        entry.m_unUInt32 = cached.m_unUInt32;
+        entry.m_unUInt64 = cached.m_unUInt64;
+        entry.m_flFloat = cached.m_flFloat;
+        ++unKeyCount;
+    }
+
+    if (unKeyCount != header.m_unKeyCount) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring corrupt config cache %s", cachePath.c_str());
+        return nullptr;
+    }
+    pSnapshot->m_unKeyCount = unKeyCount;
+
+    pSnapshot->m_sectionHashes.resize(static_cast<size_t>(header.m_unSectionCount));
+    if (header.m_unSectionCount > 0) {
+        memcpy(pSnapshot->m_sectionHashes.data(), image.Data() + header.m_unSectionOffset,
+               header.m_unSectionCount * sizeof(uint64));
+    }
+
+    return pSnapshot;
+}
+
+bool Config::WriteCache(const std::string& cachePath, const Snapshot& snapshot)
+{
+    ConfigCacheHeader header = {};
+    header.m_unMagic = CONFIG_CACHE_MAGIC;
+    header.m_unVersion = CONFIG_CACHE_VERSION;
+    header.m_unEntrySize = sizeof(ConfigCacheEntry);
+    header.m_unSourceCount = static_cast<uint32>(snapshot.m_sources.size());
+    header.m_unKeyTableCapacity = snapshot.m_keyTable.size();
+    header.m_unKeyCount = snapshot.m_unKeyCount;
+    header.m_unSectionCount = snapshot.m_sectionHashes.size();
+
+    size_t offset = AlignCacheOffset(sizeof(ConfigCacheHeader));
+    header.m_unSourceOffset = offset;
+    offset = AlignCacheOffset(offset + snapshot.m_sources.size() * sizeof(ConfigCacheSource));
+    header.m_unKeyTableOffset = offset;
+    offset = AlignCacheOffset(offset + snapshot.m_keyTable.size() * sizeof(ConfigCacheEntry));
+    header.m_unSectionOffset = offset;
+    offset = AlignCacheOffset(offset + snapshot.m_sectionHashes.size() * sizeof(uint64));
+    header.m_unStringsOffset = offset;
+
+    // String table is appended while the fixed-size records are filled in
+    std::string strings;
+    auto addString = [&strings](std::string_view str, uint32& unOffset, uint32& unLength) {
+        unOffset = static_cast<uint32>(strings.size());
+        unLength = static_cast<uint32>(str.size());
+        strings.append(str.data(), str.size());
+    };
+
+    std::vector<ConfigCacheSource> sources(snapshot.m_sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const SourceFile& source = snapshot.m_sources[i];
+        ConfigCacheSource& cached = sources[i];
+        memset(&cached, 0, sizeof(cached));
+        addString(source.m_sPath, cached.m_unPathOffset, cached.m_unPathLength);
+        cached.m_unFlags = source.m_bDirectory ? k_ECacheSourceDirectory : 0;
+        cached.m_nModifiedTime = source.m_nModifiedTime;
+        cached.m_unSize = source.m_unSize;
+        cached.m_unContentHash = source.m_unContentHash;
+    }
+
+    std::vector<ConfigCacheEntry> entries(snapshot.m_keyTable.size());
+    for (size_t slot = 0; slot < entries.size(); ++slot) {
+        const KeyEntry& entry = snapshot.m_keyTable[slot];
+        ConfigCacheEntry& cached = entries[slot];
+        memset(&cached, 0, sizeof(cached));
+        if (entry.m_unHash == 0) {
+            continue;
+        }
+
+        cached.m_unHash = entry.m_unHash;
+        cached.m_unSectionHash = entry.m_unSectionHash;
+        addString(entry.m_section, cached.m_unSectionNameOffset, cached.m_unSectionNameLength);
+        addString(entry.m_key, cached.m_unKeyOffset, cached.m_unKeyLength);
+        addString(entry.m_value, cached.m_unValueOffset, cached.m_unValueLength);
+        cached.m_fTypes = entry.m_fTypes;
+        cached.m_bBool = entry.m_bBool ? 1 : 0;
+        cached.m_nInt32 = entry.m_nInt32;
+        cached.m_unUInt32 = entry.m_unUInt32;
+        cached.m_unUInt64 = entry.m_unUInt64;
+        cached.m_flFloat = entry.m_flFloat;
+    }
+
+    header.m_unStringsSize = strings.size();
+    header.m_unImageSize = header.m_unStringsOffset + strings.size();
+
+    // Write to a temporary file and rename over the old cache so readers never see a partial image
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            VLOG_ERROR(__FUNCTION__ " - Could not create config cache %s", tempPath.c_str());
+            return false;
+        }
+
+        static const char padding[8] = {};
+        auto writeSection = [&file](uint64 unOffset, const void* pData, size_t cubData) {
+            size_t unPosition = static_cast<size_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(unOffset - unPosition));
+            file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(cubData));
+        };
+
+        writeSection(0, &header, sizeof(header));
+        writeSection(header.m_unSourceOffset, sources.data(), sources.size() * sizeof(ConfigCacheSource));
+        writeSection(header.m_unKeyTableOffset, entries.data(), entries.size() * sizeof(ConfigCacheEntry));
+        writeSection(header.m_unSectionOffset, snapshot.m_sectionHashes.data(), snapshot.m_sectionHashes.size() * sizeof(uint64));
+        writeSection(header.m_unStringsOffset, strings.data(), strings.size());
+
+        if (!file.good()) {
+            VLOG_ERROR(__FUNCTION__ " - Could not write config cache %s", tempPath.c_str());
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        VLOG_ERROR(__FUNCTION__ " - Could not replace config cache %s: %s", cachePath.c_str(), ec.message().c_str());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Wrote config cache %s (%zu keys, %llu bytes)",
+              cachePath.c_str(), snapshot.m_unKeyCount, static_cast<unsigned long long>(header.m_unImageSize));
+    return true;
+}
+
+} // namespace VaporCore
@@ -0,0 +1,250 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Deduplicating storage layout on top of the chunk store
+ */
+
+#include <tuple>
+#include <vector>
+
+#include "vapor_dedup_storage.h"
+#include "vapor_mapped_file.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Files below this size are not worth a manifest and stay as they are
+static const size_t DEDUP_MIN_SIZE = 4096;
+
+DedupFileBackend::DedupFileBackend(std::unique_ptr<StorageBackend> pInner, std::shared_ptr<ChunkStore> pChunkStore)
+    : m_pInner(std::move(pInner)),
+      m_pChunkStore(std::move(pChunkStore))
+{
+}
+
+bool DedupFileBackend::StatLogical(const std::string& name, uint64 unStoredSize, uint64& unSize)
+{
+    unSize = unStoredSize;
+    if (unStoredSize < ChunkManifest::HeaderSize()) {
+        return true;
+    }
+
+    std::vector<uint8> header(ChunkManifest::HeaderSize());
+    int64 nRead = m_pInner->Read(name, 0, header.data(), header.size());
+    if (nRead < 0) {
+        return false;
+    }
+
+    uint64 unLogicalSize;
+    if (ChunkManifest::ParseHeader(header.data(), static_cast<size_t>(nRead), unStoredSize, unLogicalSize)) {
+        unSize = unLogicalSize;
+    }
+    return true;
+}
+
+bool DedupFileBackend::LoadManifest(const std::string& name, uint64 unStoredSize, ChunkManifest& manifest)
+{
+    if (unStoredSize < ChunkManifest::HeaderSize()) {
+        return false;
+    }
+
+    std::vector<uint8> data(ChunkManifest::HeaderSize());
+    uint64 unLogicalSize;
+    int64 nRead = m_pInner->Read(name, 0, data.data(), data.size());
+    if (nRead < 0 || !ChunkManifest::ParseHeader(data.data(), static_cast<size_t>(nRead), unStoredSize, unLogicalSize)) {
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(unStoredSize));
+    nRead = m_pInner->Read(name, 0, data.data(), data.size());
+    return nRead == static_cast<int64>(data.size()) && ChunkManifest::Parse(data.data(), data.size(), manifest);
+}
+
+bool DedupFileBackend::LoadManifest(const std::string& name, ChunkManifest& manifest)
+{
+    uint64 unStoredSize;
+    int64 nTimestamp;
+    return m_pInner->Stat(name, unStoredSize, nTimestamp) && LoadManifest(name, unStoredSize, manifest);
+}
+
+void DedupFileBackend::Enumerate(const EnumerateCallback& callback)
+{
+    // Collected first, the wrapped layout may hold its lock during the callback
+    std::vector<std::tuple<std::string, uint64, int64>> entries;
+    m_pInner->Enumerate([&entries](const std::string& name, uint64 unSize, int64 nTimestamp) {
+        entries.emplace_back(name, unSize, nTimestamp);
+    });
+
+    for (const auto& [name, unStoredSize, nTimestamp] : entries) {
+        uint64 unSize;
+        if (StatLogical(name, unStoredSize, unSize)) {
+            callback(name, unSize, nTimestamp);
+        }
+    }
+}
+
+bool DedupFileBackend::Stat(const std::string& name, uint64& unSize, int64& nTimestamp)
+{
+    uint64 unStoredSize;
+    return m_pInner->Stat(name, unStoredSize, nTimestamp) && StatLogical(name, unStoredSize, unSize);
+}
+
+bool DedupFileBackend::Write(const std::string& name, const void* pData, size_t cubData)
+{
+    // Small files stay as they are, unless they would be mistaken for a manifest
+    uint64 unIgnored;
+    if (cubData < DEDUP_MIN_SIZE && !ChunkManifest::ParseHeader(pData, cubData, cubData, unIgnored)) {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+
+        ChunkManifest previous;
+        bool bHadManifest = LoadManifest(name, previous);
+        if (!m_pInner->Write(name, pData, cubData)) {
+            return false;
+        }
+        if (bHadManifest) {
+            m_pChunkStore->Release(previous);
+        }
+        return true;
+    }
+
+    // Chunking and writing new chunks happen before taking the lock
+    ChunkManifest manifest;
+    if (!m_pChunkStore->Store(pData, cubData, manifest)) {
+        return false;
+    }
+
+    std::vector<uint8> serialized;
+    manifest.Serialize(serialized);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    ChunkManifest previous;
+    bool bHadManifest = LoadManifest(name, previous);
+    if (!m_pInner->Write(name, serialized.data(), serialized.size())) {
+        m_pChunkStore->Release(manifest);
+        return false;
+    }
+    if (bHadManifest) {
+        m_pChunkStore->Release(previous);
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - %s: %zu bytes as %zu chunks", name.c_str(), cubData, manifest.m_chunks.size());
+    return true;
+}
+
+bool DedupFileBackend::Delete(const std::string& name)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    ChunkManifest manifest;
+    bool bHadManifest = LoadManifest(name, manifest);
+    if (!m_pInner->Delete(name)) {
+        return false;
+    }
+    if (bHadManifest) {
+        m_pChunkStore->Release(manifest);
+    }
+    return true;
+}
+
+int64 DedupFileBackend::Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax)
+{
+    ChunkManifest manifest;
+    if (LoadManifest(name, manifest)) {
+        return m_pChunkStore->Read(manifest, unOffset, pBuffer, cubMax);
+    }
+    return m_pInner->Read(name, unOffset, pBuffer, cubMax);
+}
+
+bool DedupFileBackend::OpenView(const std::string& name, FileView& view)
+{
+    ChunkManifest manifest;
+    if (!LoadManifest(name, manifest)) {
+        return m_pInner->OpenView(name, view);
+    }
+
+    // Contents are spread over chunk files, assemble a private copy
+    auto pData = std::make_shared<std::vector<uint8>>(static_cast<size_t>(manifest.m_unSize));
+    if (m_pChunkStore->Read(manifest, 0, pData->data(), pData->size()) != static_cast<int64>(pData->size())) {
+        return false;
+    }
+
+    view.m_pData = pData->data();
+    view.m_cubData = pData->size();
+    view.m_pOwner = std::move(pData);
+    return true;
+}
+
+bool DedupFileBackend::OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file)
+{
+    return m_pInner->OpenStaged(name, unUnique, file);
+}
+
+bool DedupFileBackend::CommitStaged(const std::string& name, StagedFile& file)
+{
+    // The staged contents still have to be chunked, so they go through Write()
+    MappedFile mapped;
+    bool bSuccess = mapped.Open(file.TempPath());
+    if (bSuccess) {
+        mapped.Advise(MappedFile::AccessPattern::Sequential);
+        bSuccess = Write(name, mapped.Data(), mapped.Size());
+    }
+
+    mapped.Close();
+    file.Discard();
+    return bSuccess;
+}
+
+void DedupFileBackend::RemoveAll()
+{
+    std::vector<std::string> names;
+    m_pInner->Enumerate([&names](const std::string& name, uint64, int64) { names.push_back(name); });
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    for (const std::string& name : names) {
+        ChunkManifest manifest;
+        if (LoadManifest(name, manifest)) {
+            m_pChunkStore->Release(manifest);
+        }
+    }
+    m_pInner->RemoveAll();
+}
+
+uint32 DedupFileBackend::ExpandAll()
+{
+    std::vector<std::string> names;
+    m_pInner->Enumerate([&names](const std::string& name, uint64, int64) { names.push_back(name); });
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    uint32 unExpanded = 0;
+    for (const std::string& name : names) {
+        ChunkManifest manifest;
+        if (!LoadManifest(name, manifest)) {
+            continue;
+        }
+
+        std::vector<uint8> data(static_cast<size_t>(manifest.m_unSize));
+        if (m_pChunkStore->Read(manifest, 0, data.data(), data.size()) != static_cast<int64>(data.size()) ||
+            !m_pInner->Write(name, data.data(), data.size())) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to expand %s", name.c_str());
+            continue;
+        }
+
+        m_pChunkStore->Release(manifest);
+        ++unExpanded;
+    }
+    return unExpanded;
+}
+
+std::unique_ptr<StorageBackend> DedupFileBackend::ReleaseInner()
+{
+    return std::move(m_pInner);
+}
+
+} // namespace VaporCore
@@ -0,0 +1,358 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Binary delta encoding between file versions
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "vapor_delta.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+// Delta layout: varint base size, varint target size, then operations until
+// the end. An operation is a tag byte followed by varints:
+//   DELTA_OP_COPY   offset, length   bytes from the base
+//   DELTA_OP_INSERT length, bytes    literal bytes
+static const uint8 DELTA_OP_COPY = 0;
+static const uint8 DELTA_OP_INSERT = 1;
+
+// Rolling hash multiplier (odd, so every byte position contributes)
+static const uint64 DELTA_HASH_PRIME = 0x100000001b3ULL;
+
+// Matches shorter than a block are left as literals
+static size_t DeltaBlockSize(size_t cubBase)
+{
+    if (cubBase < 64 * 1024) {
+        return 32;
+    }
+    return cubBase < 4 * 1024 * 1024 ? 64 : 256;
+}
+
+static void PutVarint(std::vector<uint8>& out, uint64 value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8>(value));
+}
+
+static bool GetVarint(const uint8*& p, const uint8* pEnd, uint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == pEnd) {
+            return false;
+        }
+        uint8 byte = *p++;
+        value |= static_cast<uint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64 HashBlock(const uint8* p, size_t cubBlock)
+{
+    uint64 hash = 0;
+    for (size_t i = 0; i < cubBlock; ++i) {
+        hash = hash * DELTA_HASH_PRIME + p[i];
+    }
+    return hash;
+}
+
+static void EmitInsert(std::vector<uint8>& delta, const uint8* p, size_t cub)
+{
+    if (cub > 0) {
+        delta.push_back(DELTA_OP_INSERT);
+        PutVarint(delta, cub);
+        delta.insert(delta.end(), p, p + cub);
+    }
+}
+
+void EncodeDelta(const void* pBase, size_t cubBase, const void* pTarget, size_t cubTarget, std::vector<uint8>& delta)
+{
+    const uint8* pB = static_cast<const uint8*>(pBase);
+    const uint8* pT = static_cast<const uint8*>(pTarget);
+
+    delta.clear();
+    PutVarint(delta, cubBase);
+    PutVarint(delta, cubTarget);
+
+    size_t cubBlock = DeltaBlockSize(cubBase);
+    if (cubBase < cubBlock || cubTarget < cubBlock) {
+        EmitInsert(delta, pT, cubTarget);
+        return;
+    }
+
+    // Index every aligned block of the base by its hash; the first one wins a slot
+    size_t cBlocks = cubBase / cubBlock;
+    size_t cSlots = 1;
+    while (cSlots < cBlocks * 2) {
+        cSlots <<= 1;
+    }
+    std::vector<uint32> slots(cSlots, 0);
+    for (size_t i = 0; i < cBlocks; ++i) {
+        uint32& slot = slots[HashBlock(pB + i * cubBlock, cubBlock) & (cSlots - 1)];
+        if (slot == 0) {
+            slot = static_cast<uint32>(i + 1);
+        }
+    }
+
+    // Weight of the byte leaving the window
+    uint64 unOutFactor = 1;
+    for (size_t i = 1; i < cubBlock; ++i) {
+        unOutFactor *= DELTA_HASH_PRIME;
+    }
+
+    size_t unLiteralStart = 0;
+    size_t unPos = 0;
+    uint64 hash = HashBlock(pT, cubBlock);
+    while (unPos + cubBlock <= cubTarget) {
+        uint32 slot = slots[hash & (cSlots - 1)];
+        if (slot != 0) {
+            size_t unBaseOffset = (slot - 1) * cubBlock;
+            if (memcmp(pB + unBaseOffset, pT + unPos, cubBlock) == 0) {
+                // Grow the match backwards into the pending literal, then forwards
+                size_t unStart = unPos;
+                while (unStart > unLiteralStart && unBaseOffset > 0 && pB[unBaseOffset - 1] == pT[unStart - 1]) {
+                    --unStart;
+                    --unBaseOffset;
+                }
+                size_t cubMatch = unPos - unStart + cubBlock;
+                while (unStart + cubMatch < cubTarget && unBaseOffset + cubMatch < cubBase &&
+                       pB[unBaseOffset + cubMatch] == pT[unStart + cubMatch]) {
+                    ++cubMatch;
+                }
+
+                EmitInsert(delta, pT + unLiteralStart, unStart - unLiteralStart);
+                delta.push_back(DELTA_OP_COPY);
+                PutVarint(delta, unBaseOffset);
+                PutVarint(delta, cubMatch);
+
+                unPos = unStart + cubMatch;
+                unLiteralStart = unPos;
+                if (unPos + cubBlock <= cubTarget) {
+                    hash = HashBlock(pT + unPos, cubBlock);
+                }
+                continue;
+            }
+        }
+
+        // Slide the window one byte
+        if (unPos + cubBlock < cubTarget) {
+            hash = (hash - pT[unPos] * unOutFactor) * DELTA_HASH_PRIME + pT[unPos + cubBlock];
+        }
+        ++unPos;
+    }
+
+    EmitInsert(delta, pT + unLiteralStart, cubTarget - unLiteralStart);
+}
+
+bool ApplyDelta(const void* pBase, size_t cubBase, const void* pDelta, size_t cubDelta, std::vector<uint8>& target)
+{
+    const uint8* pB = static_cast<const uint8*>(pBase);
+    const uint8* p = static_cast<const uint8*>(pDelta);
+    const uint8* pEnd = p + cubDelta;
+
+    uint64 unBaseSize, unTargetSize;
+    if (!GetVarint(p, pEnd, unBaseSize) || !GetVarint(p, pEnd, unTargetSize) || unBaseSize != cubBase) {
+        return false;
+    }
+
+    // The size comes from the delta, so only reserve what is certainly needed
+    target.clear();
+    target.reserve(static_cast<size_t>(std::min<uint64>(unTargetSize, cubBase + cubDelta)));
+    while (p < pEnd) {
+        uint8 op = *p++;
+        uint64 unOffset = 0, cub;
+        if (op == DELTA_OP_COPY) {
+            if (!GetVarint(p, pEnd, unOffset) || !GetVarint(p, pEnd, cub) ||
+                unOffset > cubBase || cub > cubBase - unOffset || cub > unTargetSize - target.size()) {
+                return false;
+            }
+            target.insert(target.end(), pB + unOffset, pB + unOffset + cub);
+        } else if (op == DELTA_OP_INSERT) {
+            if (!GetVarint(p, pEnd, cub) || cub > static_cast<uint64>(pEnd - p) || cub > unTargetSize - target.size()) {
+                return false;
+            }
+            target.insert(target.end(), p, p + cub);
+            p += cub;
+        } else {
+            return false;
+        }
+    }
+
+    return target.size() == unTargetSize;
+}
+
+// Signature layout: varint base size, varint block size, then per block (the
+// last one may be short) the rolling checksum and the strong hash
+struct SignatureBlock
+{
+    uint32 m_unWeak;
+    uint64 m_unStrong;
+};
+
+static size_t SignatureBlockSize(size_t cubBase)
+{
+    // About the square root of the size, so both the signature and the literals stay small
+    size_t cubBlock = 512;
+    while (cubBlock < 64 * 1024 && cubBlock * cubBlock < cubBase) {
+        cubBlock <<= 1;
+    }
+    return cubBlock;
+}
+
+// Adler-style checksum of a window, both halves modulo 2^16, rolled a byte at a time
+struct RollingChecksum
+{
+    uint32 m_a = 0;
+    uint32 m_b = 0;
+
+    void Reset(const uint8* p, size_t cub)
+    {
+        m_a = m_b = 0;
+        for (size_t i = 0; i < cub; ++i) {
+            m_a += p[i];
+            m_b += static_cast<uint32>(cub - i) * p[i];
+        }
+    }
+
+    void Roll(uint8 out, uint8 in, size_t cubWindow)
+    {
+        m_a = m_a - out + in;
+        m_b = m_b - static_cast<uint32>(cubWindow) * out + m_a;
+    }
+
+    uint32 Value() const { return (m_a & 0xffff) | (m_b << 16); }
+};
+
+static void EmitCopy(std::vector<uint8>& delta, uint64 unOffset, uint64 cub)
+{
+    delta.push_back(DELTA_OP_COPY);
+    PutVarint(delta, unOffset);
+    PutVarint(delta, cub);
+}
+
+void ComputeSignature(const void* pBase, size_t cubBase, std::vector<uint8>& signature)
+{
+    const uint8* pB = static_cast<const uint8*>(pBase);
+    size_t cubBlock = SignatureBlockSize(cubBase);
+
+    signature.clear();
+    PutVarint(signature, cubBase);
+    PutVarint(signature, cubBlock);
+    for (size_t unOffset = 0; unOffset < cubBase; unOffset += cubBlock) {
+        size_t cub = std::min(cubBlock, cubBase - unOffset);
+        RollingChecksum checksum;
+        checksum.Reset(pB + unOffset, cub);
+
+        SignatureBlock block = { checksum.Value(), HashBytes64(pB + unOffset, cub) };
+        const uint8* pBlock = reinterpret_cast<const uint8*>(&block.m_unWeak);
+        signature.insert(signature.end(), pBlock, pBlock + sizeof(block.m_unWeak));
+        pBlock = reinterpret_cast<const uint8*>(&block.m_unStrong);
+        signature.insert(signature.end(), pBlock, pBlock + sizeof(block.m_unStrong));
+    }
+}
+
+bool EncodeDeltaFromSignature(const void* pSignature, size_t cubSignature, const void* pTarget, size_t cubTarget,
+                              std::vector<uint8>& delta)
+{
+    const uint8* p = static_cast<const uint8*>(pSignature);
+    const uint8* pEnd = p + cubSignature;
+    const uint8* pT = static_cast<const uint8*>(pTarget);
+
+    uint64 unBaseSize, unBlockSize;
+    if (!GetVarint(p, pEnd, unBaseSize) || !GetVarint(p, pEnd, unBlockSize) || unBlockSize == 0 ||
+        static_cast<uint64>(pEnd - p) != (unBaseSize + unBlockSize - 1) / unBlockSize * 12) {
+        return false;
+    }
+
+    size_t cubBlock = static_cast<size_t>(unBlockSize);
+    size_t cBlocks = static_cast<size_t>((unBaseSize + cubBlock - 1) / cubBlock);
+    std::vector<SignatureBlock> blocks(cBlocks);
+    for (SignatureBlock& block : blocks) {
+        memcpy(&block.m_unWeak, p, sizeof(block.m_unWeak));
+        memcpy(&block.m_unStrong, p + sizeof(block.m_unWeak), sizeof(block.m_unStrong));
+        p += 12;
+    }
+
+    delta.clear();
+    PutVarint(delta, unBaseSize);
+    PutVarint(delta, cubTarget);
+
+    // Full blocks by rolling checksum; the first block with a given checksum wins
+    std::unordered_map<uint32, size_t> byWeak;
+    size_t cFullBlocks = static_cast<size_t>(unBaseSize / cubBlock);
+    for (size_t i = 0; i < cFullBlocks; ++i) {
+        byWeak.emplace(blocks[i].m_unWeak, i);
+    }
+
+    // Consecutive block copies are merged into one operation
+    uint64 unCopyOffset = 0, cubCopy = 0;
+    size_t unLiteralStart = 0;
+    size_t unPos = 0;
+    RollingChecksum checksum;
+    if (cubTarget >= cubBlock) {
+        checksum.Reset(pT, cubBlock);
+    }
+    while (cFullBlocks > 0 && unPos + cubBlock <= cubTarget) {
+        auto it = byWeak.find(checksum.Value());
+        if (it != byWeak.end() && blocks[it->second].m_unStrong == HashBytes64(pT + unPos, cubBlock)) {
+            uint64 unBlockOffset = static_cast<uint64>(it->second) * cubBlock;
+            if (cubCopy > 0 && unLiteralStart == unPos && unCopyOffset + cubCopy == unBlockOffset) {
+                cubCopy += cubBlock;
+            } else {
+                if (cubCopy > 0) {
+                    EmitCopy(delta, unCopyOffset, cubCopy);
+                }
+                EmitInsert(delta, pT + unLiteralStart, unPos - unLiteralStart);
+                unCopyOffset = unBlockOffset;
+                cubCopy = cubBlock;
+            }
+
+            unPos += cubBlock;
+            unLiteralStart = unPos;
+            if (unPos + cubBlock <= cubTarget) {
+                checksum.Reset(pT + unPos, cubBlock);
+            }
+            continue;
+        }
+
+        if (unPos + cubBlock < cubTarget) {
+            checksum.Roll(pT[unPos], pT[unPos + cubBlock], cubBlock);
+        }
+        ++unPos;
+    }
+
+    // A short last block can only match the end of the target
+    size_t cubTail = static_cast<size_t>(unBaseSize % cubBlock);
+    size_t cubLiteral = cubTarget - unLiteralStart;
+    bool bTailMatch = cubTail > 0 && cubLiteral >= cubTail &&
+                      blocks.back().m_unStrong == HashBytes64(pT + cubTarget - cubTail, cubTail);
+    if (bTailMatch) {
+        cubLiteral -= cubTail;
+    }
+
+    if (cubCopy > 0) {
+        EmitCopy(delta, unCopyOffset, cubCopy);
+    }
+    EmitInsert(delta, pT + unLiteralStart, cubLiteral);
+    if (bTailMatch) {
+        EmitCopy(delta, unBaseSize - cubTail, cubTail);
+    }
+    return true;
+}
+
+} // namespace VaporCore
@@ -0,0 +1,133 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: VaporCore specific exports beyond the Steamworks API
+ */
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "vapor_base.h"
+#include "vapor_extensions.h"
+
+// Open file views by handle, each keeps its mapping or cache buffer alive
+static VaporCore::Mutex s_fileViewsMutex VAPORCORE_MUTEX_NAME("s_fileViewsMutex");
+static std::unordered_map<VaporCoreFileViewHandle_t, VaporCore::FileStorage::FileView> s_fileViews;
+static VaporCoreFileViewHandle_t s_hNextFileView = 1;
+
+S_API VaporCoreFileViewHandle_t S_CALLTYPE VaporCore_RemoteStorage_OpenFileView( const char *pchFile, const void **ppvData, uint64 *pcubData )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
+
+    if (!pchFile || !ppvData || !pcubData) {
+        return k_VaporCoreFileViewHandleInvalid;
+    }
+
+    VaporCore::FileStorage::FileView view;
+    if (!CSteamRemoteStorage::GetInstance().OpenFileView(pchFile, view)) {
+        return k_VaporCoreFileViewHandleInvalid;
+    }
+
+    *ppvData = view.m_pData;
+    *pcubData = view.m_cubData;
+
+    VAPORCORE_SCOPED_LOCK(s_fileViewsMutex);
+    VaporCoreFileViewHandle_t hView = s_hNextFileView++;
+    s_fileViews.emplace(hView, std::move(view));
+    return hView;
+}
+
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_ReleaseFileView( VaporCoreFileViewHandle_t hView )
+{
+    VLOG_INFO(__FUNCTION__ " - View: %llu", hView);
+
+    // Unmap outside the lock
+    VaporCore::FileStorage::FileView view;
+    {
+        VAPORCORE_SCOPED_LOCK(s_fileViewsMutex);
+        auto it = s_fileViews.find(hView);
+        if (it == s_fileViews.end()) {
+            return false;
+        }
+        view = std::move(it->second);
+        s_fileViews.erase(it);
+    }
+
+    return true;
+}
+
+S_API int32 S_CALLTYPE VaporCore_RemoteStorage_GetFileVersionCount( const char *pchFile )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s", pchFile);
+
+    std::vector<VaporCore::FileStorage::FileVersion> versions;
+    if (!pchFile || !CSteamRemoteStorage::GetInstance().GetFileVersions(pchFile, versions)) {
+        return 0;
+    }
+    return static_cast<int32>(versions.size());
+}
+
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_GetFileVersionInfo( const char *pchFile, int32 iVersion, int64 *pnTimestamp, int32 *pnFileSize )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s, Version: %d", pchFile, iVersion);
+
+    std::vector<VaporCore::FileStorage::FileVersion> versions;
+    if (!pchFile || iVersion < 0 || !CSteamRemoteStorage::GetInstance().GetFileVersions(pchFile, versions) ||
+        static_cast<size_t>(iVersion) >= versions.size()) {
+        return false;
+    }
+
+    const VaporCore::FileStorage::FileVersion& version = versions[iVersion];
+    if (pnTimestamp) {
+        *pnTimestamp = version.m_nTimestamp;
+    }
+    if (pnFileSize) {
+        *pnFileSize = version.m_bExists ? static_cast<int32>(version.m_unSize) : -1;
+    }
+    return true;
+}
+
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_RestoreFileVersion( const char *pchFile, int32 iVersion )
+{
+    VLOG_INFO(__FUNCTION__ " - File: %s, Version: %d", pchFile, iVersion);
+
+    if (!pchFile || iVersion < 0) {
+        return false;
+    }
+    return CSteamRemoteStorage::GetInstance().RestoreFileVersion(pchFile, static_cast<uint32>(iVersion));
+}
+
+S_API int32 S_CALLTYPE VaporCore_RemoteStorage_ListFiles( const char *pchPrefix, char *pchNames, int32 cchNames )
+{
+    VLOG_INFO(__FUNCTION__ " - Prefix: %s", pchPrefix ? pchPrefix : "");
+
+    std::vector<std::string> files;
+    if (!CSteamRemoteStorage::GetInstance().ListFiles(pchPrefix, files)) {
+        return 0;
+    }
+
+    int32 cchNeeded = 0;
+    bool bFits = pchNames != nullptr;
+    for (const std::string& file : files) {
+        int32 cchFile = static_cast<int32>(file.size()) + 1;
+        bFits = bFits && cchNeeded + cchFile <= cchNames;
+        if (bFits) {
+            memcpy(pchNames + cchNeeded, file.c_str(), cchFile);
+        }
+        cchNeeded += cchFile;
+    }
+    return cchNeeded;
+}
+
+S_API bool S_CALLTYPE VaporCore_RemoteStorage_SyncCloud()
+{
+    VLOG_INFO(__FUNCTION__);
+
+    return CSteamRemoteStorage::GetInstance().SyncCloud();
+}
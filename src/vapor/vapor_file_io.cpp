@@ -0,0 +1,466 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Durable low-level file I/O helpers
+ */
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vapor_file_io.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Space reservation extents for StagedFile: at least the minimum, otherwise
+// the current size (so reservations double), never more than the maximum
+static const uint64 STAGED_RESERVE_MIN = 1ULL * 1024 * 1024;
+static const uint64 STAGED_RESERVE_MAX = 64ULL * 1024 * 1024;
+
+bool WriteFileAtomic(const std::string& path, const void* pData, size_t cubData, bool bSync)
+{
+    StagedFile file;
+    return file.Open(path, path + FILE_IO_TEMP_SUFFIX) && file.Append(pData, cubData) && file.Commit(bSync);
+}
+
+bool SyncPath(const std::string& path)
+{
+#ifdef _WIN32
+    // Directories cannot be flushed here, NTFS journals renames on its own
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        DWORD dwError = GetLastError();
+        return dwError == ERROR_FILE_NOT_FOUND || dwError == ERROR_PATH_NOT_FOUND || dwError == ERROR_ACCESS_DENIED;
+    }
+    bool bSuccess = FlushFileBuffers(hFile) != 0;
+    if (!bSuccess) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: %lu", path.c_str(), GetLastError());
+    }
+    CloseHandle(hFile);
+    return bSuccess;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+    bool bSuccess = fsync(fd) == 0;
+    if (!bSuccess) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: errno %d", path.c_str(), errno);
+    }
+    close(fd);
+    return bSuccess;
+#endif
+}
+
+StagedFile::StagedFile() noexcept
+    :
+#ifdef _WIN32
+      m_hFile(INVALID_HANDLE_VALUE),
+#else
+      m_fd(-1),
+#endif
+      m_unSize(0),
+      m_unReserved(0),
+      m_bSynced(false)
+{
+}
+
+StagedFile::~StagedFile()
+{
+    Discard();
+}
+
+bool StagedFile::IsOpen() const noexcept
+{
+#ifdef _WIN32
+    return m_hFile != INVALID_HANDLE_VALUE;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+bool StagedFile::Open(const std::string& path, const std::string& tempPath)
+{
+    Discard();
+
+    m_sPath = path;
+    m_sTempPath = tempPath;
+    m_unSize = 0;
+    m_unReserved = 0;
+    m_bSynced = false;
+
+#ifdef _WIN32
+    m_hFile = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to create %s: %lu", tempPath.c_str(), GetLastError());
+        return false;
+    }
+#else
+    m_fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to create %s: errno %d", tempPath.c_str(), errno);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool StagedFile::Append(const void* pData, size_t cubData)
+{
+    if (!IsOpen()) {
+        return false;
+    }
+
+    // Once appends start arriving, reserve the next extent before writing into it.
+    // Best effort: without reservation support the data still lands, less contiguously
+    if (m_unSize > 0 && m_unSize + cubData > m_unReserved) {
+        uint64 unExtent = std::clamp<uint64>(m_unSize, STAGED_RESERVE_MIN, STAGED_RESERVE_MAX);
+        uint64 unReserve = std::max<uint64>(m_unSize + cubData, m_unReserved + unExtent);
+#ifdef _WIN32
+        FILE_ALLOCATION_INFO allocation;
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(unReserve);
+        SetFileInformationByHandle(m_hFile, FileAllocationInfo, &allocation, sizeof(allocation));
+#elif defined(__linux__)
+        fallocate(m_fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(m_unReserved), static_cast<off_t>(unReserve - m_unReserved));
+#endif
+        m_unReserved = unReserve;
+    }
+
+    const char* pBytes = static_cast<const char*>(pData);
+    m_bSynced = false;
+
+#ifdef _WIN32
+    while (cubData > 0) {
+        DWORD chunk = static_cast<DWORD>(cubData > 0x40000000 ? 0x40000000 : cubData);
+        DWORD written = 0;
+        if (!::WriteFile(m_hFile, pBytes, chunk, &written, nullptr) || written != chunk) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to write %s: %lu", m_sTempPath.c_str(), GetLastError());
+            return false;
+        }
+        pBytes += written;
+        cubData -= written;
+        m_unSize += written;
+    }
+#else
+    while (cubData > 0) {
+        ssize_t written = write(m_fd, pBytes, cubData);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            VLOG_ERROR(__FUNCTION__ " - Failed to write %s: errno %d", m_sTempPath.c_str(), errno);
+            return false;
+        }
+        pBytes += written;
+        cubData -= static_cast<size_t>(written);
+        m_unSize += static_cast<uint64>(written);
+    }
+#endif
+
+    return true;
+}
+
+bool StagedFile::Sync()
+{
+    if (!IsOpen()) {
+        return false;
+    }
+    if (m_bSynced) {
+        return true;
+    }
+
+#ifdef _WIN32
+    if (!FlushFileBuffers(m_hFile)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: %lu", m_sTempPath.c_str(), GetLastError());
+        return false;
+    }
+#else
+    if (fsync(m_fd) != 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: errno %d", m_sTempPath.c_str(), errno);
+        return false;
+    }
+#endif
+
+    m_bSynced = true;
+    return true;
+}
+
+bool StagedFile::Commit(bool bSync)
+{
+    if (bSync && !Sync()) {
+        Discard();
+        return false;
+    }
+
+    // Give back reserved space past the end (Windows releases it when the handle closes)
+#if defined(__linux__)
+    if (m_unReserved > m_unSize && ftruncate(m_fd, static_cast<off_t>(m_unSize)) != 0) {
+        VLOG_WARNING(__FUNCTION__ " - Failed to trim %s: errno %d", m_sTempPath.c_str(), errno);
+    }
+#endif
+    CloseFile();
+
+#ifdef _WIN32
+    if (!MoveFileExA(m_sTempPath.c_str(), m_sPath.c_str(), MOVEFILE_REPLACE_EXISTING | (bSync ? MOVEFILE_WRITE_THROUGH : 0))) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to rename %s: %lu", m_sTempPath.c_str(), GetLastError());
+        Discard();
+        return false;
+    }
+#else
+    if (rename(m_sTempPath.c_str(), m_sPath.c_str()) != 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to rename %s: errno %d", m_sTempPath.c_str(), errno);
+        Discard();
+        return false;
+    }
+#endif
+
+    m_sTempPath.clear();
+    return true;
+}
+
+void StagedFile::Discard() noexcept
+{
+    CloseFile();
+
+    if (!m_sTempPath.empty()) {
+#ifdef _WIN32
+        DeleteFileA(m_sTempPath.c_str());
+#else
+        unlink(m_sTempPath.c_str());
+#endif
+        m_sTempPath.clear();
+    }
+}
+
+void StagedFile::CloseFile() noexcept
+{
+#ifdef _WIN32
+    if (m_hFile != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+}
+
+RandomAccessFile::RandomAccessFile() noexcept
+    :
+#ifdef _WIN32
+      m_hFile(INVALID_HANDLE_VALUE),
+#else
+      m_fd(-1),
+#endif
+      m_unSize(0)
+{
+}
+
+RandomAccessFile::~RandomAccessFile()
+{
+    Close();
+}
+
+bool RandomAccessFile::IsOpen() const noexcept
+{
+#ifdef _WIN32
+    return m_hFile != INVALID_HANDLE_VALUE;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+bool RandomAccessFile::Open(const std::string& path, bool bCreate)
+{
+    Close();
+    m_sPath = path;
+
+#ifdef _WIN32
+    // Share delete so the file can be replaced by rename while it is open
+    m_hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          nullptr, bCreate ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to open %s: %lu", path.c_str(), GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_hFile, &size)) {
+        Close();
+        return false;
+    }
+    m_unSize = static_cast<uint64>(size.QuadPart);
+#else
+    m_fd = open(path.c_str(), O_RDWR | O_CLOEXEC | (bCreate ? O_CREAT : 0), 0644);
+    if (m_fd < 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to open %s: errno %d", path.c_str(), errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        Close();
+        return false;
+    }
+    m_unSize = static_cast<uint64>(st.st_size);
+#endif
+
+    return true;
+}
+
+void RandomAccessFile::Close() noexcept
+{
+#ifdef _WIN32
+    if (m_hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_unSize = 0;
+}
+
+bool RandomAccessFile::ReadAt(uint64 unOffset, void* pData, size_t cubData) const
+{
+    char* pBytes = static_cast<char*>(pData);
+
+#ifdef _WIN32
+    while (cubData > 0) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(unOffset);
+        overlapped.OffsetHigh = static_cast<DWORD>(unOffset >> 32);
+
+        DWORD chunk = static_cast<DWORD>(cubData > 0x40000000 ? 0x40000000 : cubData);
+        DWORD read = 0;
+        if (!::ReadFile(m_hFile, pBytes, chunk, &read, &overlapped) || read == 0) {
+            return false;
+        }
+        pBytes += read;
+        cubData -= read;
+        unOffset += read;
+    }
+#else
+    while (cubData > 0) {
+        ssize_t read = pread(m_fd, pBytes, cubData, static_cast<off_t>(unOffset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return false;
+        }
+        pBytes += read;
+        cubData -= static_cast<size_t>(read);
+        unOffset += static_cast<uint64>(read);
+    }
+#endif
+
+    return true;
+}
+
+bool RandomAccessFile::Append(const void* pData, size_t cubData, uint64* punOffset)
+{
+    const char* pBytes = static_cast<const char*>(pData);
+    uint64 unOffset = m_unSize;
+    if (punOffset) {
+        *punOffset = unOffset;
+    }
+
+#ifdef _WIN32
+    while (cubData > 0) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(unOffset);
+        overlapped.OffsetHigh = static_cast<DWORD>(unOffset >> 32);
+
+        DWORD chunk = static_cast<DWORD>(cubData > 0x40000000 ? 0x40000000 : cubData);
+        DWORD written = 0;
+        if (!::WriteFile(m_hFile, pBytes, chunk, &written, &overlapped) || written != chunk) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to write %s: %lu", m_sPath.c_str(), GetLastError());
+            return false;
+        }
+        pBytes += written;
+        cubData -= written;
+        unOffset += written;
+        m_unSize = unOffset;
+    }
+#else
+    while (cubData > 0) {
+        ssize_t written = pwrite(m_fd, pBytes, cubData, static_cast<off_t>(unOffset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            VLOG_ERROR(__FUNCTION__ " - Failed to write %s: errno %d", m_sPath.c_str(), errno);
+            return false;
+        }
+        pBytes += written;
+        cubData -= static_cast<size_t>(written);
+        unOffset += static_cast<uint64>(written);
+        m_unSize = unOffset;
+    }
+#endif
+
+    return true;
+}
+
+bool RandomAccessFile::Sync()
+{
+#ifdef _WIN32
+    if (!FlushFileBuffers(m_hFile)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: %lu", m_sPath.c_str(), GetLastError());
+        return false;
+    }
+#elif defined(__linux__)
+    if (fdatasync(m_fd) != 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: errno %d", m_sPath.c_str(), errno);
+        return false;
+    }
+#else
+    if (fsync(m_fd) != 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to flush %s: errno %d", m_sPath.c_str(), errno);
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool RandomAccessFile::Truncate(uint64 unSize)
+{
+#ifdef _WIN32
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(unSize);
+    if (!SetFileInformationByHandle(m_hFile, FileEndOfFileInfo, &info, sizeof(info))) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to truncate %s: %lu", m_sPath.c_str(), GetLastError());
+        return false;
+    }
+#else
+    if (ftruncate(m_fd, static_cast<off_t>(unSize)) != 0) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to truncate %s: errno %d", m_sPath.c_str(), errno);
+        return false;
+    }
+#endif
+    m_unSize = unSize;
+    return true;
+}
+
+} // namespace VaporCore
@@ -9,34 +9,194 @@
  * Purpose: File storage implementation for Steam Remote Storage emulation
  */
 
-#include <fstream>
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <mutex>
 
 #include "vapor_file_storage.h"
+#include "vapor_file_io.h"
+#include "vapor_mapped_file.h"
+#include "vapor_hash.h"
+#include "vapor_packed_storage.h"
+#include "vapor_dedup_storage.h"
+#include "vapor_version_history.h"
+#include "vapor_access_profile.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_config.h"
 #include "vapor_logger.h"
 
 namespace VaporCore {
 
+// Root of the per-app, per-user storage directories
+static const char* DEFAULT_STORAGE_DIRECTORY = "./vaporcore_save";
+
 // Default quota limits (matching Steam's typical limits)
-static const uint64 DEFAULT_TOTAL_QUOTA = 100ULL * 1024 * 1024;  // 100MB
-static const int32 DEFAULT_FILE_LIMIT = 1000;                // Max files
+static const uint32 DEFAULT_QUOTA_MB = 100;
+static const uint32 DEFAULT_QUOTA_FILES = 1000;
+
+// Write-back cache defaults
+static const uint32 DEFAULT_WRITE_BACK_MAX_DIRTY_MB = 64;
+
+// Files from this size on are read through a memory mapping
+static const uint32 DEFAULT_MMAP_THRESHOLD_KB = 1024;
+
+// Packed layout: compact once this share of the container is superseded data
+static const uint32 DEFAULT_COMPACT_GARBAGE_PERCENT = 50;
+
+// Previous versions kept per file
+static const uint32 DEFAULT_VERSION_HISTORY = 5;
+
+// Journal group commit window and size, and the journal size that triggers a checkpoint
+static const uint32 DEFAULT_JOURNAL_GROUP_COMMIT_MS = 2;
+static const uint32 DEFAULT_JOURNAL_GROUP_COMMIT_KB = 256;
+static const uint32 DEFAULT_JOURNAL_CHECKPOINT_MB = 16;
+
+static const char* PREFETCH_ORDER_SIZE = "size";
+static const char* PREFETCH_ORDER_PROFILE = "profile";
+
+static const char* STORAGE_BACKEND_FILES = "files";
+static const char* STORAGE_BACKEND_PACKED = "packed";
+
+// Smaller files are never compressed, the header alone would eat most of the gain
+static const size_t COMPRESSION_MIN_SIZE = 64;
+
+// [Compression] key applying to extensions without a policy of their own
+static const char* COMPRESSION_POLICY_DEFAULT = "*";
+
+static constexpr Config::Key KEY_STORAGE_WRITE_BACK{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_WRITE_BACK };
+static constexpr Config::Key KEY_STORAGE_WRITE_BACK_MAX_DIRTY_MB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_WRITE_BACK_MAX_DIRTY_MB };
+static constexpr Config::Key KEY_STORAGE_MMAP_THRESHOLD_KB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_MMAP_THRESHOLD_KB };
+static constexpr Config::Key KEY_STORAGE_BACKEND{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_BACKEND };
+static constexpr Config::Key KEY_STORAGE_COMPACT_GARBAGE_PERCENT{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_COMPACT_GARBAGE_PERCENT };
+static constexpr Config::Key KEY_STORAGE_DEDUP{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_DEDUP };
+static constexpr Config::Key KEY_STORAGE_VERSION_HISTORY{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_VERSION_HISTORY };
+static constexpr Config::Key KEY_STORAGE_DIRECTORY{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_DIRECTORY };
+static constexpr Config::Key KEY_STORAGE_NAMESPACE{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_NAMESPACE };
+static constexpr Config::Key KEY_STORAGE_ADOPT_LEGACY_SAVES{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_ADOPT_LEGACY_SAVES };
+static constexpr Config::Key KEY_STORAGE_QUOTA_MB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_QUOTA_MB };
+static constexpr Config::Key KEY_STORAGE_QUOTA_FILES{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_QUOTA_FILES };
+static constexpr Config::Key KEY_STORAGE_JOURNAL{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_JOURNAL };
+static constexpr Config::Key KEY_STORAGE_JOURNAL_GROUP_COMMIT_MS{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_JOURNAL_GROUP_COMMIT_MS };
+static constexpr Config::Key KEY_STORAGE_JOURNAL_GROUP_COMMIT_KB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_JOURNAL_GROUP_COMMIT_KB };
+static constexpr Config::Key KEY_STORAGE_JOURNAL_CHECKPOINT_MB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_JOURNAL_CHECKPOINT_MB };
+static constexpr Config::Key KEY_STORAGE_PREFETCH_MB{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_PREFETCH_MB };
+static constexpr Config::Key KEY_STORAGE_PREFETCH_ORDER{ CONFIG_SECTION_STORAGE, CONFIG_KEY_STORAGE_PREFETCH_ORDER };
+
+// Live instances, for ShutdownAll(). Plain mutex: only taken at construction and shutdown
+static std::mutex s_instancesMutex;
+static std::vector<FileStorage*> s_instances;
+
+// Copy of up to cubToRead bytes at unOffset, empty past the end
+static std::vector<uint8> SliceBuffer(const std::vector<uint8>& data, uint64 unOffset, uint32 cubToRead)
+{
+    std::vector<uint8> slice;
+    if (unOffset < data.size()) {
+        size_t cubSlice = static_cast<size_t>(std::min<uint64>(cubToRead, data.size() - unOffset));
+        slice.assign(data.begin() + unOffset, data.begin() + unOffset + cubSlice);
+    }
+    return slice;
+}
+
+// Whether a staged stream starts with what reads would take for a stored-file header
+static bool StagedNeedsHeader(const StagedFile& file)
+{
+    StoredFileHeader header;
+    if (file.Size() < sizeof(header)) {
+        return false;
+    }
+
+    RandomAccessFile staged;
+    return staged.Open(file.TempPath(), false) && staged.ReadAt(0, &header, sizeof(header)) &&
+           NeedsStoredFileHeader(&header, sizeof(header));
+}
+
+static int64 CurrentUnixTime()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
 FileStorage::FileStorage(const std::string& storageDir)
-    : m_storageDirectory(storageDir)
+    : m_storageDirectory(storageDir),
+      m_unMmapThreshold(0),
+      m_unQuotaBytes(0),
+      m_unQuotaFiles(0),
+      m_unJournalCheckpointBytes(0),
+      m_unJournalCheckpoint(0),
+      m_unUsedBytes(0),
+      m_unDirtyBytes(0),
+      m_unMaxDirtyBytes(0),
+      m_unNextSequence(1),
+      m_bWriteBack(false),
+      m_bStopFlushing(false),
+      m_unCachedBytes(0),
+      m_bStopPrefetch(false),
+      m_unPendingAsync(0),
+      m_hNextStream(1)
 {
     // Ensure the storage directory exists
     if (!EnsureDirectoryExists()) {
         VLOG_DEBUG(__FUNCTION__ " - Failed to create storage directory: %s", storageDir.c_str());
     }
     
-    // Initialize file index from existing files
-    CacheFileList();
+    m_unMmapThreshold = static_cast<uint64>(
+        Config::GetInstance().GetUInt32(KEY_STORAGE_MMAP_THRESHOLD_KB, DEFAULT_MMAP_THRESHOLD_KB)) * 1024;
+    m_unQuotaBytes = static_cast<uint64>(
+        Config::GetInstance().GetUInt32(KEY_STORAGE_QUOTA_MB, DEFAULT_QUOTA_MB)) * 1024 * 1024;
+    m_unQuotaFiles = Config::GetInstance().GetUInt32(KEY_STORAGE_QUOTA_FILES, DEFAULT_QUOTA_FILES);
+    m_pBackend = CreateBackend();
+
+    uint32 unMaxVersions = Config::GetInstance().GetUInt32(KEY_STORAGE_VERSION_HISTORY, DEFAULT_VERSION_HISTORY);
+    if (unMaxVersions > 0) {
+        m_pHistory = std::make_unique<VersionHistory>(m_storageDirectory, unMaxVersions);
+    }
+
+    // Recover writes a crash left in the journal before the index sees the files
+    if (Config::GetInstance().GetBool(KEY_STORAGE_JOURNAL, false)) {
+        OpenJournal();
+    }
+
+    // Build the metadata index from existing files, the only directory scan
+    BuildIndex();
+
+    // Write-back mode: FileWrite only copies into memory, a background thread persists
+    if (m_pJournal || Config::GetInstance().GetBool(KEY_STORAGE_WRITE_BACK, false)) {
+        m_unMaxDirtyBytes = static_cast<uint64>(
+            Config::GetInstance().GetUInt32(KEY_STORAGE_WRITE_BACK_MAX_DIRTY_MB, DEFAULT_WRITE_BACK_MAX_DIRTY_MB)) * 1024 * 1024;
+        m_bWriteBack.store(true);
+        m_flushThread = std::thread(&FileStorage::FlushThread, this);
+        VLOG_INFO(__FUNCTION__ " - Write-back cache enabled, %llu bytes dirty budget", m_unMaxDirtyBytes);
+    }
+
+    // Warm-up: read saves into memory before the game asks for them
+    uint64 cubPrefetch = static_cast<uint64>(Config::GetInstance().GetUInt32(KEY_STORAGE_PREFETCH_MB, 0)) * 1024 * 1024;
+    if (cubPrefetch > 0) {
+        std::string order(Config::GetInstance().GetString(KEY_STORAGE_PREFETCH_ORDER, PREFETCH_ORDER_SIZE));
+        if (order != PREFETCH_ORDER_SIZE && order != PREFETCH_ORDER_PROFILE) {
+            VLOG_WARNING(__FUNCTION__ " - Unknown prefetch order '%s', using '%s'", order.c_str(), PREFETCH_ORDER_SIZE);
+        }
+        m_pProfile = std::make_unique<AccessProfile>(m_storageDirectory);
+        m_pProfile->Load();
+        m_prefetchThread = std::thread(&FileStorage::PrefetchThread, this, cubPrefetch, order == PREFETCH_ORDER_PROFILE);
+    }
+
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    s_instances.push_back(this);
 }
 
 FileStorage::~FileStorage()
 {
+    {
+        std::lock_guard<std::mutex> lock(s_instancesMutex);
+        s_instances.erase(std::remove(s_instances.begin(), s_instances.end(), this), s_instances.end());
+    }
+
+    Shutdown();
 }
 
 bool FileStorage::WriteFile(const std::string& filename, const void* data, size_t size)
@@ -46,30 +206,78 @@ bool FileStorage::WriteFile(const std::string& filename, const void* data, size_
         return false;
     }
     
-    std::string fullPath = GetFullPath(filename);
-    
-    try {
-        std::ofstream file(fullPath, std::ios::binary);
-        if (!file.is_open()) {
-            VLOG_ERROR(__FUNCTION__ " - Failed to open file for writing: %s", fullPath.c_str());
-            return false;
+    std::string normalized = NormalizeFilename(filename);
+
+    // Copy outside the lock, the caller's buffer is only valid for the duration of the call
+    std::shared_ptr<const std::vector<uint8>> pData;
+    if (m_bWriteBack.load()) {
+        const uint8* pBytes = static_cast<const uint8*>(data);
+        pData = std::make_shared<const std::vector<uint8>>(pBytes, pBytes + size);
+    }
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    if (CheckQuota(normalized, size) != k_EResultOK) {
+        return false;
+    }
+
+    if (!pData || !m_bWriteBack.load()) {
+        // Write-through, behind any asynchronous write of the same file still pending
+        if (m_dirty.find(normalized) != m_dirty.end()) {
+            const uint8* pBytes = static_cast<const uint8*>(data);
+            SetDirty(normalized, std::make_shared<const std::vector<uint8>>(pBytes, pBytes + size));
+            IndexFile(normalized, size, CurrentUnixTime());
+            return PersistDirtyEntry(lock, normalized);
         }
-        
-        file.write(static_cast<const char*>(data), size);
-        if (!file.good()) {
-            VLOG_ERROR(__FUNCTION__ " - Failed to write data to file: %s", fullPath.c_str());
+
+        uint32 fFlags;
+        if (!PersistWrite(normalized, data, size, fFlags)) {
             return false;
         }
-        
-        file.close();
-        
-        VLOG_DEBUG(__FUNCTION__ " - Successfully wrote %zu bytes to: %s", size, fullPath.c_str());
+
+        IndexFile(normalized, size, CurrentUnixTime(), fFlags);
+        VLOG_DEBUG(__FUNCTION__ " - Successfully wrote %zu bytes to: %s", size, normalized.c_str());
         return true;
-        
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Exception writing file %s: %s", fullPath.c_str(), e.what());
+    }
+
+    // Backpressure: wait for the writer while the dirty budget is exhausted. A single
+    // write larger than the whole budget is admitted once nothing else is dirty.
+    m_cleanCondition.wait(lock, [&]() {
+        return m_unDirtyBytes == 0 || m_unDirtyBytes + size <= m_unMaxDirtyBytes || !m_bWriteBack.load();
+    });
+
+    // Other writes may have used up the quota while this one waited
+    if (CheckQuota(normalized, size) != k_EResultOK) {
         return false;
     }
+
+    if (!m_bWriteBack.load()) {
+        // Shut down while waiting
+        uint32 fFlags;
+        if (!PersistWrite(normalized, data, size, fFlags)) {
+            return false;
+        }
+        IndexFile(normalized, size, CurrentUnixTime(), fFlags);
+        return true;
+    }
+
+    if (IsJournaling()) {
+        // Durable once its journal record is, the background writer applies it after that
+        uint64 unSequence;
+        uint64 unJournalEnd = JournalDirty(normalized, std::move(pData), unSequence);
+        IndexFile(normalized, size, CurrentUnixTime());
+        lock.unlock();
+
+        VLOG_DEBUG(__FUNCTION__ " - Journaled %zu bytes for: %s", size, normalized.c_str());
+        return WaitForJournal(normalized, unSequence, unJournalEnd);
+    }
+
+    SetDirty(normalized, std::move(pData));
+    IndexFile(normalized, size, CurrentUnixTime());
+    m_flushCondition.notify_one();
+
+    VLOG_DEBUG(__FUNCTION__ " - Cached %zu bytes for: %s (%llu bytes dirty)", size, normalized.c_str(), m_unDirtyBytes);
+    return true;
 }
 
 int32 FileStorage::ReadFile(const std::string& filename, void* buffer, size_t maxSize)
@@ -79,36 +287,114 @@ int32 FileStorage::ReadFile(const std::string& filename, void* buffer, size_t ma
         return 0;
     }
 
-    std::string fullPath = GetFullPath(filename);
-    
-    try {
-        std::ifstream file(fullPath, std::ios::binary);
-        if (!file.is_open()) {
-            VLOG_DEBUG(__FUNCTION__ " - File not found: %s", fullPath.c_str());
+    std::string normalized = NormalizeFilename(filename);
+    uint32 fFlags = k_EFileFlagNone;
+    {
+        // Dirty files are served from the write-back cache, the disk copy may be stale
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (m_pProfile) {
+            m_pProfile->RecordRead(normalized);
+        }
+
+        auto it = m_dirty.find(normalized);
+        if (it != m_dirty.end()) {
+            if (!it->second.m_pData) {
+                return 0;
+            }
+
+            size_t bytesToRead = std::min(it->second.m_pData->size(), maxSize);
+            memcpy(buffer, it->second.m_pData->data(), bytesToRead);
+            return static_cast<int32>(bytesToRead);
+        }
+
+        auto cached = m_readCache.find(normalized);
+        if (cached != m_readCache.end() && cached->second) {
+            size_t bytesToRead = std::min(cached->second->size(), maxSize);
+            memcpy(buffer, cached->second->data(), bytesToRead);
+            return static_cast<int32>(bytesToRead);
+        }
+
+        if (const FileMetadata* pIndexed = m_index.Find(normalized)) {
+            fFlags = pIndexed->m_fFlags;
+        }
+    }
+
+    if (fFlags & k_EFileFlagEncoded) {
+        // Decoded straight from the stored bytes into the caller's buffer
+        FileView stored;
+        if (!m_pBackend->OpenView(normalized, stored)) {
             return 0;
         }
-        
-        // Get file size
-        file.seekg(0, std::ios::end);
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        file.seekg(0, std::ios::beg);
-        
-        // Read up to maxSize bytes
-        size_t bytesToRead = std::min(fileSize, maxSize);
-        file.read(static_cast<char*>(buffer), bytesToRead);
-        
-        if (!file.good() && !file.eof()) {
-            VLOG_ERROR(__FUNCTION__ " - Error reading file: %s", fullPath.c_str());
+        int64 nDecoded = DecodeStoredFile(stored.m_pData, stored.m_cubData, buffer, maxSize);
+        if (nDecoded < 0) {
+            VLOG_ERROR(__FUNCTION__ " - Cannot decode stored file: %s", normalized.c_str());
             return 0;
         }
-        
-        VLOG_DEBUG(__FUNCTION__ " - Successfully read %zu bytes from: %s", bytesToRead, fullPath.c_str());
-        return static_cast<int32>(bytesToRead);
-        
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Exception reading file %s: %s", fullPath.c_str(), e.what());
-        return 0;
+        return static_cast<int32>(nDecoded);
+    }
+
+    int64 nRead = m_pBackend->Read(normalized, 0, buffer, maxSize);
+    return nRead > 0 ? static_cast<int32>(nRead) : 0;
+}
+
+bool FileStorage::OpenFileView(const std::string& filename, FileView& view)
+{
+    if (!IsValidFilename(filename)) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
+        return false;
+    }
+
+    std::string normalized = NormalizeFilename(filename);
+    uint32 fFlags;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (m_pProfile) {
+            m_pProfile->RecordRead(normalized);
+        }
+
+        // Share a cached buffer, they are immutable and replaced rather than modified
+        std::shared_ptr<const std::vector<uint8>> pCached;
+        auto it = m_dirty.find(normalized);
+        if (it != m_dirty.end()) {
+            if (!it->second.m_pData) {
+                return false;
+            }
+            pCached = it->second.m_pData;
+        } else {
+            auto cached = m_readCache.find(normalized);
+            if (cached != m_readCache.end()) {
+                pCached = cached->second;
+            }
+        }
+
+        if (pCached) {
+            view.m_pData = pCached->data();
+            view.m_cubData = pCached->size();
+            view.m_pOwner = std::move(pCached);
+            return true;
+        }
+
+        const FileMetadata* pIndexed = m_index.Find(normalized);
+        if (!pIndexed) {
+            VLOG_DEBUG(__FUNCTION__ " - File not found: %s", normalized.c_str());
+            return false;
+        }
+        fFlags = pIndexed->m_fFlags;
+    }
+
+    if (fFlags & k_EFileFlagEncoded) {
+        // Encoded files cannot be mapped as they are, the view owns the decoded copy
+        auto pData = std::make_shared<std::vector<uint8>>();
+        if (!ReadDecoded(normalized, *pData)) {
+            return false;
+        }
+        view.m_pData = pData->data();
+        view.m_cubData = pData->size();
+        view.m_pOwner = std::move(pData);
+        return true;
     }
+
+    return m_pBackend->OpenView(normalized, view);
 }
 
 bool FileStorage::FileExists(const std::string& filename)
@@ -118,10 +404,12 @@ bool FileStorage::FileExists(const std::string& filename)
         return false;
     }
 
-    std::string fullPath = GetFullPath(filename);
-    bool exists = std::filesystem::exists(fullPath) && std::filesystem::is_regular_file(fullPath);
+    std::string normalized = NormalizeFilename(filename);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    bool exists = m_index.Find(normalized) != nullptr;
     
-    VLOG_DEBUG(__FUNCTION__ " - File exists check: %s = %s", fullPath.c_str(), exists ? "true" : "false");
+    VLOG_DEBUG(__FUNCTION__ " - File exists check: %s = %s", normalized.c_str(), exists ? "true" : "false");
 
     return exists;
 }
@@ -133,188 +421,1076 @@ bool FileStorage::DeleteFile(const std::string& filename)
         return false;
     }
 
-    std::string fullPath = GetFullPath(filename);
-    VLOG_DEBUG(__FUNCTION__ " - Deleting file: %s", fullPath.c_str());
-    
-    try {
-        if (std::filesystem::remove(fullPath)) {
-            VLOG_DEBUG(__FUNCTION__ " - Successfully deleted: %s", fullPath.c_str());
-            return true;
-        } else {
-            VLOG_DEBUG(__FUNCTION__ " - File not found for deletion: %s", fullPath.c_str());
-            return false;
-        }
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Exception deleting file %s: %s", fullPath.c_str(), e.what());
+    std::string normalized = NormalizeFilename(filename);
+    VLOG_DEBUG(__FUNCTION__ " - Deleting file: %s", normalized.c_str());
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    if (!m_index.Find(normalized)) {
+        VLOG_DEBUG(__FUNCTION__ " - File not found for deletion: %s", normalized.c_str());
+        return false;
+    }
+
+    if (IsJournaling()) {
+        uint64 unSequence;
+        uint64 unJournalEnd = JournalDirty(normalized, nullptr, unSequence);
+        UnindexFile(normalized);
+        lock.unlock();
+        return WaitForJournal(normalized, unSequence, unJournalEnd);
+    } else if (m_bWriteBack.load()) {
+        // Queue a tombstone so the delete is ordered after any pending write of the file
+        SetDirty(normalized, nullptr);
+        m_flushCondition.notify_one();
+    } else if (m_dirty.find(normalized) != m_dirty.end()) {
+        // An asynchronous write of the file is still pending, delete behind it
+        SetDirty(normalized, nullptr);
+        UnindexFile(normalized);
+        return PersistDirtyEntry(lock, normalized);
+    } else if (!PersistDelete(normalized)) {
         return false;
     }
+
+    UnindexFile(normalized);
+    VLOG_DEBUG(__FUNCTION__ " - Successfully deleted: %s", normalized.c_str());
+    return true;
 }
 
-size_t FileStorage::GetFileSize(const std::string& filename)
+bool FileStorage::WriteFileAsync(const std::string& filename, const void* data, size_t size, std::function<void(EResult eResult)> completion)
 {
     if (!IsValidFilename(filename)) {
         VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
-        return 0;
+        return false;
     }
 
-    std::string fullPath = GetFullPath(filename);
-    
-    try {
-        if (std::filesystem::exists(fullPath)) {
-            size_t size = static_cast<size_t>(std::filesystem::file_size(fullPath));
-            VLOG_DEBUG(__FUNCTION__ " - File size: %s = %zu bytes", fullPath.c_str(), size);
-            return size;
+    std::string normalized = NormalizeFilename(filename);
+    const uint8* pBytes = static_cast<const uint8*>(data);
+    auto pData = std::make_shared<const std::vector<uint8>>(pBytes, pBytes + size);
+
+    uint64 unSequence = 0;
+    uint64 unJournalEnd = 0;
+    {
+        // Cached as dirty right away: reads, sizes and enumeration see the new
+        // contents before the disk does, and later writes are ordered after it
+        std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+        EResult eResult = CheckQuota(normalized, size);
+        if (eResult != k_EResultOK) {
+            lock.unlock();
+            completion(eResult);
+            return true;
         }
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Exception getting file size %s: %s", fullPath.c_str(), e.what());
+
+        if (IsJournaling()) {
+            unJournalEnd = JournalDirty(normalized, std::move(pData), unSequence);
+        } else {
+            SetDirty(normalized, std::move(pData));
+        }
+        IndexFile(normalized, size, CurrentUnixTime());
+        ++m_unPendingAsync;
     }
-    
-    return 0;
+
+    // Keyed by name, so writes of one file are persisted in submission order. A
+    // journaled write completes once durable, the background writer persists it
+    uint64 unKey = HashBytes64(normalized.data(), normalized.size());
+    std::function<void()> persist = [this, normalized, unSequence, unJournalEnd, completion = std::move(completion)]() {
+        std::unique_lock<VaporCore::Mutex> lock(m_mutex, std::defer_lock);
+        bool bSuccess;
+        if (unJournalEnd != 0) {
+            bSuccess = WaitForJournal(normalized, unSequence, unJournalEnd);
+        } else {
+            lock.lock();
+            bSuccess = PersistDirtyEntry(lock, normalized);
+            lock.unlock();
+        }
+
+        completion(bSuccess ? k_EResultOK : k_EResultIOFailure);
+
+        lock.lock();
+        --m_unPendingAsync;
+        m_cleanCondition.notify_all();
+    };
+
+    // The write is already cached, so past AsyncIO shutdown it is persisted here
+    if (!AsyncIO::GetInstance().Post(unKey, persist)) {
+        persist();
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - Queued %zu bytes for: %s", size, normalized.c_str());
+    return true;
 }
 
-int64 FileStorage::GetFileTimestamp(const std::string& filename)
+bool FileStorage::ReadFileAsync(const std::string& filename, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion)
 {
     if (!IsValidFilename(filename)) {
         VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
-        return 0;
+        return false;
     }
 
-    std::string fullPath = GetFullPath(filename);
-    
-    try {
-        if (std::filesystem::exists(fullPath)) {
-            auto ftime = std::filesystem::last_write_time(fullPath);
-            auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                ftime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
-            auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(sctp.time_since_epoch()).count();
-            VLOG_DEBUG(__FUNCTION__ " - File timestamp: %s = %lld", fullPath.c_str(), timestamp);
-            return timestamp;
+    std::string normalized = NormalizeFilename(filename);
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    if (m_pProfile) {
+        m_pProfile->RecordRead(normalized);
+    }
+
+    auto it = m_dirty.find(normalized);
+    auto cached = m_readCache.find(normalized);
+    if (it != m_dirty.end() || (cached != m_readCache.end() && cached->second)) {
+        // Served from memory, no I/O needed
+        std::shared_ptr<const std::vector<uint8>> pData = it != m_dirty.end() ? it->second.m_pData : cached->second;
+        lock.unlock();
+
+        std::vector<uint8> slice;
+        if (pData) {
+            slice = SliceBuffer(*pData, unOffset, cubToRead);
         }
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Exception getting file timestamp %s: %s", fullPath.c_str(), e.what());
+        completion(pData != nullptr, std::move(slice));
+        return true;
     }
-    
-    return 0;
-}
 
-int32 FileStorage::GetFileCount()
-{
-    // Cache the current file list for subsequent GetFileNameAndSize() calls
-    CacheFileList();
-    
-    int32 count = static_cast<int32>(m_indexToFile.size());
-    VLOG_DEBUG(__FUNCTION__ " - File count: %d", count);
-    
-    return count;
+    const FileMetadata* pIndexed = m_index.Find(normalized);
+    if (pIndexed && (pIndexed->m_fFlags & k_EFileFlagEncoded)) {
+        // Offsets refer to the decoded contents, so decode the whole file on a worker
+        ++m_unPendingAsync;
+        lock.unlock();
+
+        uint64 unKey = HashBytes64(normalized.data(), normalized.size());
+        bool bPosted = AsyncIO::GetInstance().Post(unKey, [this, normalized, unOffset, cubToRead, completion]() {
+            std::vector<uint8> data;
+            bool bSuccess = ReadDecoded(normalized, data);
+            completion(bSuccess, SliceBuffer(data, unOffset, cubToRead));
+
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            --m_unPendingAsync;
+            m_cleanCondition.notify_all();
+        });
+        if (!bPosted) {
+            completion(false, std::vector<uint8>());
+
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            --m_unPendingAsync;
+            m_cleanCondition.notify_all();
+        }
+        return true;
+    }
+
+    // Backends may complete on their own threads; Shutdown() waits for them
+    ++m_unPendingAsync;
+    lock.unlock();
+
+    m_pBackend->ReadAsync(normalized, unOffset, cubToRead,
+        [this, completion = std::move(completion)](bool bSuccess, std::vector<uint8>&& data) {
+            completion(bSuccess, std::move(data));
+
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            --m_unPendingAsync;
+            m_cleanCondition.notify_all();
+        });
+    return true;
 }
 
-std::string FileStorage::GetFileNameAndSize(int index, int32* pSize)
+FileStorage::WriteStreamHandle FileStorage::OpenWriteStream(const std::string& filename)
 {
-    // Check if file list is cached (GetFileCount should be called first)
-    if (m_indexToFile.empty()) {
-        VLOG_WARNING(__FUNCTION__ " - GetFileNameAndSize called without calling GetFileCount first - caching file list");
-        CacheFileList();
+    if (!IsValidFilename(filename)) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
+        return k_hWriteStreamInvalid;
     }
-    
-    if (index < 0 || index >= static_cast<int>(m_indexToFile.size())) {
-        VLOG_DEBUG(__FUNCTION__ " - Invalid file index: %d", index);
-        if (pSize) *pSize = 0;
-        return "";
+
+    auto pStream = std::make_shared<WriteStream>();
+    pStream->m_sNormalized = NormalizeFilename(filename);
+
+    WriteStreamHandle hStream;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        hStream = m_hNextStream++;
+        m_streams[hStream] = pStream;
     }
-    
-    const std::string& filename = m_indexToFile[index];
-    if (pSize) {
-        *pSize = static_cast<int32>(GetFileSize(filename));
+
+    // Every operation on the stream is keyed by its handle, so they run in call order
+    StorageBackend* pBackend = m_pBackend.get();
+    bool bPosted = AsyncIO::GetInstance().Post(hStream, [pStream, pBackend, hStream]() {
+        if (!pBackend->OpenStaged(pStream->m_sNormalized, hStream, pStream->m_file)) {
+            pStream->m_bFailed.store(true);
+        }
+    });
+    if (!bPosted) {
+        pStream->m_bFailed.store(true);
     }
-    
-    VLOG_DEBUG(__FUNCTION__ " - File at index %d: %s", index, filename.c_str());
-    return filename;
+
+    VLOG_DEBUG(__FUNCTION__ " - Opened stream %llu for: %s", hStream, pStream->m_sNormalized.c_str());
+    return hStream;
 }
 
-size_t FileStorage::GetTotalStorageUsed()
+bool FileStorage::WriteStreamChunk(WriteStreamHandle hStream, const void* data, size_t size)
 {
-    size_t totalSize = 0;
-    
-    try {
-        if (std::filesystem::exists(m_storageDirectory)) {
-            for (const auto& entry : std::filesystem::directory_iterator(m_storageDirectory)) {
-                if (entry.is_regular_file()) {
-                    totalSize += static_cast<size_t>(entry.file_size());
-                }
-            }
+    std::shared_ptr<WriteStream> pStream;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_streams.find(hStream);
+        if (it == m_streams.end()) {
+            VLOG_DEBUG(__FUNCTION__ " - Invalid stream: %llu", hStream);
+            return false;
         }
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Error calculating storage usage: %s", e.what());
+        pStream = it->second;
+
+        // Fail the chunk that crosses the quota rather than the close
+        if (!pStream->m_bFailed.load() && CheckQuota(pStream->m_sNormalized, pStream->m_cubQueued + size) != k_EResultOK) {
+            pStream->m_bFailed.store(true);
+        }
+        pStream->m_cubQueued += size;
     }
-    
-    VLOG_DEBUG(__FUNCTION__ " - Total storage used: %zu bytes", totalSize);
-    return totalSize;
-}
 
-bool FileStorage::GetQuota(uint64* pnTotalBytes, uint64* pnAvailableBytes)
-{
-    if (!pnTotalBytes || !pnAvailableBytes) {
+    // An earlier chunk already failed, the stream can only be cancelled now
+    if (pStream->m_bFailed.load()) {
         return false;
     }
-    
-    size_t usedBytes = GetTotalStorageUsed();
-    
-    *pnTotalBytes = DEFAULT_TOTAL_QUOTA;
-    *pnAvailableBytes = (usedBytes > DEFAULT_TOTAL_QUOTA) ? 0 : (DEFAULT_TOTAL_QUOTA - usedBytes);
-    
-    VLOG_DEBUG(__FUNCTION__ " - Quota: Total = %llu, Available = %llu, Used = %zu", 
-               *pnTotalBytes, *pnAvailableBytes, usedBytes);
-    
+
+    // The one copy of the chunk: the caller's buffer is only valid during the call
+    const uint8* pBytes = static_cast<const uint8*>(data);
+    bool bPosted = AsyncIO::GetInstance().Post(hStream, [pStream, chunk = std::vector<uint8>(pBytes, pBytes + size)]() {
+        if (!pStream->m_bFailed.load() && !pStream->m_file.Append(chunk.data(), chunk.size())) {
+            pStream->m_bFailed.store(true);
+        }
+    });
+    if (!bPosted) {
+        pStream->m_bFailed.store(true);
+        return false;
+    }
+
     return true;
 }
 
-bool FileStorage::EnsureDirectoryExists()
+bool FileStorage::CloseWriteStream(WriteStreamHandle hStream)
 {
-    try {
-        if (!std::filesystem::exists(m_storageDirectory)) {
-            std::filesystem::create_directories(m_storageDirectory);
-            VLOG_INFO(__FUNCTION__ " - Created storage directory: %s", m_storageDirectory.c_str());
+    std::shared_ptr<WriteStream> pStream;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_streams.find(hStream);
+        if (it == m_streams.end()) {
+            VLOG_DEBUG(__FUNCTION__ " - Invalid stream: %llu", hStream);
+            return false;
         }
-        return true;
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Failed to create directory %s: %s", m_storageDirectory.c_str(), e.what());
+        pStream = std::move(it->second);
+        m_streams.erase(it);
+    }
+
+    // Queued behind every chunk: once it has run the stream's file is ours again. The
+    // flush happens on this thread, the worker is not held up for it. Past AsyncIO
+    // shutdown its queue has drained already
+    std::promise<void> drained;
+    std::future<void> done = drained.get_future();
+    if (AsyncIO::GetInstance().Post(hStream, [&drained]() { drained.set_value(); })) {
+        done.wait();
+    }
+
+    if (pStream->m_bFailed.load() || !pStream->m_file.Sync()) {
+        VLOG_ERROR(__FUNCTION__ " - Stream %llu failed, discarding: %s", hStream, pStream->m_sNormalized.c_str());
+        pStream->m_file.Discard();
         return false;
     }
-}
 
-bool FileStorage::IsValidFilename(const std::string& filename) const
-{
-    if (filename.empty() || filename.length() > 260) {
+    const std::string& normalized = pStream->m_sNormalized;
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    // Checked per chunk already, but other writes may have landed since
+    uint64 unSize = pStream->m_file.Size();
+    if (CheckQuota(normalized, unSize) != k_EResultOK) {
+        pStream->m_file.Discard();
         return false;
     }
-    
-    // Check for invalid characters
-    const std::string invalidChars = "<>:\"|?*";
-    for (char c : invalidChars) {
-        if (filename.find(c) != std::string::npos) {
-            return false;
-        }
+
+    // The stream supersedes any cached write of the file; one being persisted right now lands first
+    auto it = m_dirty.find(normalized);
+    while (it != m_dirty.end() && it->second.m_bInFlight) {
+        m_cleanCondition.wait(lock);
+        it = m_dirty.find(normalized);
     }
-    
-    // Check for reserved names (Windows)
-    std::string upper = filename;
-    std::transform(upper.begin(), upper.end(), upper.begin(), 
-                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
-    
-    const std::vector<std::string> reserved = {
-        "CON", "PRN", "AUX", "NUL",
-        "COM1", "COM2", "COM3", "COM4", "COM5", "COM6", "COM7", "COM8", "COM9",
-        "LPT1", "LPT2", "LPT3", "LPT4", "LPT5", "LPT6", "LPT7", "LPT8", "LPT9"
-    };
-    
-    for (const std::string& res : reserved) {
-        if (upper == res || upper.substr(0, res.length() + 1) == res + ".") {
-            return false;
+    if (it != m_dirty.end()) {
+        if (it->second.m_pData) {
+            m_unDirtyBytes -= it->second.m_pData->size();
         }
+        m_dirty.erase(it);
+        m_cleanCondition.notify_all();
     }
-    
-    return true;
-}
+
+    // Streams are stored like FileWrite stores them: a compression policy, or contents that
+    // would read back as a stored-file header, re-encode the staged bytes through PersistWrite
+    uint32 fFlags = k_EFileFlagNone;
+    if ((GetCompressionPolicy(normalized) != k_ECompressionCodecNone && unSize >= COMPRESSION_MIN_SIZE) ||
+        StagedNeedsHeader(pStream->m_file)) {
+        MappedFile mapped;
+        bool bSuccess = mapped.Open(pStream->m_file.TempPath());
+        if (bSuccess) {
+            mapped.Advise(MappedFile::AccessPattern::Sequential);
+            bSuccess = PersistWrite(normalized, mapped.Data(), mapped.Size(), fFlags);
+        }
+        mapped.Close();
+        pStream->m_file.Discard();
+        if (!bSuccess) {
+            ReindexFromBackend(normalized);
+            return false;
+        }
+    } else {
+        FileView previous;
+        int64 nPreviousTimestamp = 0;
+        bool bHadPrevious = m_pHistory && CaptureStored(normalized, previous, nPreviousTimestamp);
+
+        // Already synced, so for plain files this is just the rename
+        if (!m_pBackend->CommitStaged(normalized, pStream->m_file)) {
+            ReindexFromBackend(normalized);
+            return false;
+        }
+
+        FileView current;
+        int64 nTimestamp;
+        if (m_pHistory && CaptureStored(normalized, current, nTimestamp)) {
+            m_pHistory->Record(normalized, bHadPrevious ? &previous : nullptr, nPreviousTimestamp, &current);
+        }
+    }
+
+    IndexFile(normalized, unSize, CurrentUnixTime(), fFlags);
+    VLOG_DEBUG(__FUNCTION__ " - Committed stream %llu, %llu bytes to: %s", hStream, unSize, normalized.c_str());
+
+    // Journal records of the file are stale now, recovery must not replay them over the stream
+    if (IsJournaling()) {
+        uint64 unJournalEnd = m_pJournal->Enqueue(WriteJournal::k_ERecordDiscard, normalized, nullptr);
+        lock.unlock();
+        if (!m_pJournal->WaitDurable(unJournalEnd)) {
+            VLOG_WARNING(__FUNCTION__ " - Journal failed, a crash may roll back: %s", normalized.c_str());
+        }
+    }
+    return true;
+}
+
+bool FileStorage::CancelWriteStream(WriteStreamHandle hStream)
+{
+    std::shared_ptr<WriteStream> pStream;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_streams.find(hStream);
+        if (it == m_streams.end()) {
+            VLOG_DEBUG(__FUNCTION__ " - Invalid stream: %llu", hStream);
+            return false;
+        }
+        pStream = std::move(it->second);
+        m_streams.erase(it);
+    }
+
+    // Chunks still queued see the flag and are skipped, then the temporary file is removed
+    pStream->m_bFailed.store(true);
+    // Past AsyncIO shutdown its queue has drained, so the file can go right away
+    if (!AsyncIO::GetInstance().Post(hStream, [pStream]() { pStream->m_file.Discard(); })) {
+        pStream->m_file.Discard();
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - Cancelled stream %llu", hStream);
+    return true;
+}
+
+size_t FileStorage::GetFileSize(const std::string& filename)
+{
+    if (!IsValidFilename(filename)) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
+        return 0;
+    }
+
+    std::string normalized = NormalizeFilename(filename);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    const FileMetadata* pIndexed = m_index.Find(normalized);
+    if (!pIndexed) {
+        return 0;
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - File size: %s = %llu bytes", normalized.c_str(), pIndexed->m_unSize);
+    return static_cast<size_t>(pIndexed->m_unSize);
+}
+
+int64 FileStorage::GetFileTimestamp(const std::string& filename)
+{
+    if (!IsValidFilename(filename)) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
+        return 0;
+    }
+
+    std::string normalized = NormalizeFilename(filename);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    const FileMetadata* pIndexed = m_index.Find(normalized);
+    if (!pIndexed) {
+        return 0;
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - File timestamp: %s = %lld", normalized.c_str(), pIndexed->m_nTimestamp);
+    return pIndexed->m_nTimestamp;
+}
+
+int32 FileStorage::GetFileCount()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    
+    int32 count = static_cast<int32>(m_index.Size());
+    VLOG_DEBUG(__FUNCTION__ " - File count: %d", count);
+    
+    return count;
+}
+
+const char* FileStorage::GetFileNameAndSize(int index, int32* pSize)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    
+    // Sequential indices step through the index in sorted order without a search
+    const FileMetadata* pIndexed = index >= 0 ? m_index.At(static_cast<size_t>(index), m_sEnumeratedName) : nullptr;
+    if (!pIndexed) {
+        VLOG_DEBUG(__FUNCTION__ " - Invalid file index: %d", index);
+        if (pSize) *pSize = 0;
+        return "";
+    }
+    
+    if (pSize) {
+        *pSize = static_cast<int32>(pIndexed->m_unSize);
+    }
+    
+    VLOG_DEBUG(__FUNCTION__ " - File at index %d: %s", index, m_sEnumeratedName.c_str());
+    return m_sEnumeratedName.c_str();
+}
+
+bool FileStorage::ListFiles(const std::string& prefix, std::vector<std::string>& files)
+{
+    files.clear();
+
+    // An empty prefix lists everything, otherwise it is normalized like a name
+    std::string normalized = NormalizeFilename(prefix);
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_index.ForEachWithPrefix(normalized, [&files](const std::string& name, const FileMetadata&) {
+        files.push_back(name);
+    });
+
+    VLOG_DEBUG(__FUNCTION__ " - %zu files under '%s'", files.size(), normalized.c_str());
+    return true;
+}
+
+size_t FileStorage::GetTotalStorageUsed()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    VLOG_DEBUG(__FUNCTION__ " - Total storage used: %llu bytes", m_unUsedBytes);
+    return static_cast<size_t>(m_unUsedBytes);
+}
+
+bool FileStorage::GetQuota(uint64* pnTotalBytes, uint64* pnAvailableBytes)
+{
+    if (!pnTotalBytes || !pnAvailableBytes) {
+        return false;
+    }
+    
+    size_t usedBytes = GetTotalStorageUsed();
+    
+    // Unlimited: whatever the disk can still take
+    uint64 unQuota = m_unQuotaBytes;
+    if (unQuota == 0) {
+        std::error_code ec;
+        std::filesystem::space_info space = std::filesystem::space(m_storageDirectory, ec);
+        unQuota = ec ? 0 : usedBytes + static_cast<uint64>(space.available);
+    }
+
+    *pnTotalBytes = unQuota;
+    *pnAvailableBytes = (usedBytes > unQuota) ? 0 : (unQuota - usedBytes);
+    
+    VLOG_DEBUG(__FUNCTION__ " - Quota: Total = %llu, Available = %llu, Used = %zu", 
+               *pnTotalBytes, *pnAvailableBytes, usedBytes);
+    
+    return true;
+}
+
+bool FileStorage::GetFileVersions(const std::string& filename, std::vector<FileVersion>& versions)
+{
+    versions.clear();
+    if (!IsValidFilename(filename)) {
+        VLOG_ERROR(__FUNCTION__ " - Invalid filename: %s", filename.c_str());
+        return false;
+    }
+
+    // Versions are recorded as files are persisted, cached writes must land first
+    Flush();
+    return m_pHistory && m_pHistory->List(NormalizeFilename(filename), versions);
+}
+
+bool FileStorage::RestoreFileVersion(const std::string& filename, uint32 unVersion)
+{
+    if (!IsValidFilename(filename) || !m_pHistory) {
+        return false;
+    }
+
+    std::string normalized = NormalizeFilename(filename);
+    Flush();
+
+    std::vector<uint8> data;
+    bool bExisted = false;
+    {
+        FileView current;
+        bool bExists = OpenFileView(normalized, current);
+        if (!m_pHistory->Reconstruct(normalized, bExists ? &current : nullptr, unVersion, data, bExisted)) {
+            VLOG_ERROR(__FUNCTION__ " - Cannot rebuild version %u of %s", unVersion, normalized.c_str());
+            return false;
+        }
+    }
+
+    // An ordinary write (or delete), so the contents it replaces become the newest version
+    VLOG_INFO(__FUNCTION__ " - Restoring version %u of %s", unVersion, normalized.c_str());
+    if (!bExisted) {
+        return !FileExists(normalized) || DeleteFile(normalized);
+    }
+    return WriteFile(normalized, data.data(), data.size());
+}
+
+void FileStorage::Flush()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    m_cleanCondition.wait(lock, [this]() { return m_dirty.empty(); });
+}
+
+void FileStorage::Shutdown()
+{
+    // Stop warming the cache and remember what this run read
+    if (m_prefetchThread.joinable()) {
+        m_bStopPrefetch.store(true);
+        m_prefetchThread.join();
+    }
+
+    std::unique_ptr<AccessProfile> pProfile;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        pProfile = std::move(m_pProfile);
+    }
+    if (pProfile) {
+        pProfile->Save();
+    }
+
+    {
+        // Queued asynchronous writes hold a pointer to this storage
+        std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+        m_cleanCondition.wait(lock, [this]() { return m_unPendingAsync == 0; });
+    }
+
+    if (!m_flushThread.joinable()) {
+        if (m_pHistory) {
+            m_pHistory->Flush();
+        }
+        return;
+    }
+
+    // The writer drains every dirty entry before it exits; new writes go straight to disk,
+    // synced again now that the journal no longer covers them
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (m_pJournal) {
+            m_pBackend->SetDeferSync(false);
+        }
+        m_bWriteBack.store(false);
+        m_bStopFlushing = true;
+    }
+    m_flushCondition.notify_all();
+    m_flushThread.join();
+
+    // Everything journaled has been applied, make it durable and empty the journal
+    if (m_pJournal) {
+        if (m_pBackend->Sync()) {
+            m_pJournal->Checkpoint(m_pJournal->GetEnd());
+        }
+        m_pJournal->Close();
+    }
+
+    // Release anyone blocked on backpressure; they fall back to write-through
+    m_cleanCondition.notify_all();
+    if (m_pHistory) {
+        m_pHistory->Flush();
+    }
+    VLOG_INFO(__FUNCTION__ " - Write-back cache flushed: %s", m_storageDirectory.c_str());
+}
+
+void FileStorage::ShutdownAll()
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    for (FileStorage* pStorage : s_instances) {
+        pStorage->Shutdown();
+    }
+}
+
+void FileStorage::FlushThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    for (;;) {
+        m_flushCondition.wait(lock, [this]() { return !m_dirty.empty() || m_bStopFlushing; });
+        if (m_dirty.empty()) {
+            break;
+        }
+
+        // Files already being persisted by an asynchronous write are left to it, and
+        // journaled writes wait until their record is durable
+        auto it = std::find_if(m_dirty.begin(), m_dirty.end(), [this](const auto& dirty) {
+            return !dirty.second.m_bInFlight &&
+                   (dirty.second.m_unJournalEnd == 0 || m_pJournal->IsDurable(dirty.second.m_unJournalEnd));
+        });
+        if (it == m_dirty.end()) {
+            m_flushCondition.wait(lock);
+            continue;
+        }
+
+        std::string normalized = it->first;
+        PersistDirtyEntry(lock, normalized);
+
+        if (m_pJournal && m_pJournal->GetSize() >= m_unJournalCheckpointBytes) {
+            CheckpointJournal(lock);
+        }
+    }
+}
+
+void FileStorage::PrefetchThread(uint64 cubBudget, bool bByProfile)
+{
+    struct Candidate
+    {
+        std::string m_sName;
+        uint64 m_unSize;
+        uint32 m_unScore;
+    };
+
+    std::vector<Candidate> candidates;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_index.ForEachWithPrefix("", [&](const std::string& name, const FileMetadata& metadata) {
+            if (metadata.m_unSize <= cubBudget) {
+                candidates.push_back({ name, metadata.m_unSize, bByProfile ? m_pProfile->GetScore(name) : 0 });
+            }
+        });
+    }
+
+    // Most read in earlier runs first, then largest first: those cost the most to read cold
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.m_unScore != b.m_unScore ? a.m_unScore > b.m_unScore : a.m_unSize > b.m_unSize;
+    });
+
+    [[maybe_unused]] auto start = std::chrono::steady_clock::now();
+    uint64 cubLoaded = 0;
+    uint32 cLoaded = 0;
+    for (const Candidate& candidate : candidates) {
+        if (m_bStopPrefetch.load()) {
+            break;
+        }
+        if (candidate.m_unSize > cubBudget - cubLoaded) {
+            continue;
+        }
+
+        // Files with a pending write are already in memory
+        const std::string& normalized = candidate.m_sName;
+        uint32 fFlags;
+        {
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            const FileMetadata* pIndexed = m_index.Find(normalized);
+            if (!pIndexed || m_dirty.find(normalized) != m_dirty.end() || m_readCache.find(normalized) != m_readCache.end()) {
+                continue;
+            }
+            fFlags = pIndexed->m_fFlags;
+            m_readCache.emplace(normalized, nullptr);
+        }
+
+        auto pData = std::make_shared<std::vector<uint8>>();
+        bool bLoaded = ReadContents(normalized, fFlags, *pData);
+
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_readCache.find(normalized);
+        if (it == m_readCache.end()) {
+            continue;
+        }
+        if (!bLoaded || pData->size() > cubBudget - cubLoaded) {
+            m_readCache.erase(it);
+            continue;
+        }
+
+        cubLoaded += pData->size();
+        m_unCachedBytes += pData->size();
+        it->second = std::move(pData);
+        ++cLoaded;
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Prefetched %u of %zu files, %llu bytes in %lld ms", cLoaded, candidates.size(), cubLoaded,
+              static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start).count()));
+}
+
+void FileStorage::EvictCached(const std::string& normalized)
+{
+    auto it = m_readCache.find(normalized);
+    if (it == m_readCache.end()) {
+        return;
+    }
+
+    if (it->second) {
+        m_unCachedBytes -= it->second->size();
+    }
+    m_readCache.erase(it);
+}
+
+void FileStorage::OpenJournal()
+{
+    Config& config = Config::GetInstance();
+    auto pJournal = std::make_unique<WriteJournal>(m_storageDirectory,
+        config.GetUInt32(KEY_STORAGE_JOURNAL_GROUP_COMMIT_MS, DEFAULT_JOURNAL_GROUP_COMMIT_MS),
+        static_cast<uint64>(config.GetUInt32(KEY_STORAGE_JOURNAL_GROUP_COMMIT_KB, DEFAULT_JOURNAL_GROUP_COMMIT_KB)) * 1024);
+    m_unJournalCheckpointBytes = static_cast<uint64>(
+        config.GetUInt32(KEY_STORAGE_JOURNAL_CHECKPOINT_MB, DEFAULT_JOURNAL_CHECKPOINT_MB)) * 1024 * 1024;
+
+    // Only the newest record of each file matters
+    std::unordered_map<std::string, std::pair<WriteJournal::ERecordType, WriteJournal::Data>> latest;
+    auto replay = [&latest](WriteJournal::ERecordType eType, const std::string& name, const WriteJournal::Data& pData) {
+        latest[name] = { eType, pData };
+    };
+
+    // The background writer waits for records to become durable
+    auto durable = [this]() {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_flushCondition.notify_all();
+    };
+
+    if (!pJournal->Open(replay, durable)) {
+        VLOG_ERROR(__FUNCTION__ " - Cannot open the journal in %s, writing without it", m_storageDirectory.c_str());
+        return;
+    }
+
+    // Redo what may not have reached the files; the records stay until that is synced
+    bool bRecovered = true;
+    for (const auto& record : latest) {
+        const std::string& normalized = record.first;
+        const WriteJournal::Data& pData = record.second.second;
+        uint32 fFlags;
+        uint64 unStoredSize;
+        int64 nTimestamp;
+        if (record.second.first == WriteJournal::k_ERecordWrite) {
+            bRecovered = PersistWrite(normalized, pData->data(), pData->size(), fFlags) && bRecovered;
+        } else if (record.second.first == WriteJournal::k_ERecordDelete && m_pBackend->Stat(normalized, unStoredSize, nTimestamp)) {
+            bRecovered = PersistDelete(normalized) && bRecovered;
+        }
+    }
+
+    if (!bRecovered || !m_pBackend->Sync() || !pJournal->Checkpoint(pJournal->GetEnd())) {
+        VLOG_ERROR(__FUNCTION__ " - Journal recovery failed in %s, keeping it for the next start", m_storageDirectory.c_str());
+        return;
+    }
+
+    if (!latest.empty()) {
+        VLOG_INFO(__FUNCTION__ " - Recovered %zu files from the journal", latest.size());
+    }
+
+    m_unJournalCheckpoint = pJournal->GetEnd();
+    m_pBackend->SetDeferSync(true);
+    m_pJournal = std::move(pJournal);
+    VLOG_INFO(__FUNCTION__ " - Write-ahead journal enabled: %s", m_storageDirectory.c_str());
+}
+
+bool FileStorage::IsJournaling() const
+{
+    return m_pJournal && m_bWriteBack.load() && !m_pJournal->IsBroken();
+}
+
+uint64 FileStorage::GetJournalSyncCount() const
+{
+    return m_pJournal ? m_pJournal->GetSyncCount() : 0;
+}
+
+uint64 FileStorage::JournalDirty(const std::string& normalized, std::shared_ptr<const std::vector<uint8>> pData, uint64& unSequence)
+{
+    // Enqueued under m_mutex, so the journal holds the writes of a file in sequence order
+    uint64 unJournalStart = m_pJournal->GetEnd();
+    uint64 unJournalEnd = m_pJournal->Enqueue(pData ? WriteJournal::k_ERecordWrite : WriteJournal::k_ERecordDelete, normalized, pData);
+
+    SetDirty(normalized, std::move(pData));
+    DirtyEntry& entry = m_dirty[normalized];
+    entry.m_unJournalStart = unJournalStart;
+    entry.m_unJournalEnd = unJournalEnd;
+    unSequence = entry.m_unSequence;
+    return unJournalEnd;
+}
+
+bool FileStorage::WaitForJournal(const std::string& normalized, uint64 unSequence, uint64 unJournalEnd)
+{
+    if (m_pJournal->WaitDurable(unJournalEnd)) {
+        return true;
+    }
+
+    // Never durable: back the cached state out unless a newer write replaced it
+    VLOG_ERROR(__FUNCTION__ " - Journal failed, write not persisted: %s", normalized.c_str());
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_dirty.find(normalized);
+        if (it != m_dirty.end() && it->second.m_unSequence == unSequence && !it->second.m_bInFlight) {
+            if (it->second.m_pData) {
+                m_unDirtyBytes -= it->second.m_pData->size();
+            }
+            m_dirty.erase(it);
+            ReindexFromBackend(normalized);
+            m_flushCondition.notify_one();
+            m_cleanCondition.notify_all();
+        }
+    }
+
+    // Later writes go through the plain write-back cache, synced per file again
+    m_pBackend->SetDeferSync(false);
+    m_pBackend->Sync();
+    return false;
+}
+
+void FileStorage::CheckpointJournal(std::unique_lock<VaporCore::Mutex>& lock)
+{
+    // Every record before the oldest one still cached has been applied
+    uint64 unPosition = m_pJournal->GetEnd();
+    for (const auto& dirty : m_dirty) {
+        if (dirty.second.m_unJournalStart != 0) {
+            unPosition = std::min(unPosition, dirty.second.m_unJournalStart);
+        }
+    }
+
+    // Writes outpacing the writer keep the journal large; do not rewrite it for every file
+    if (unPosition < m_unJournalCheckpoint + m_unJournalCheckpointBytes / 2 || m_pJournal->IsBroken()) {
+        return;
+    }
+
+    lock.unlock();
+    bool bSuccess = m_pBackend->Sync() && m_pJournal->Checkpoint(unPosition);
+    lock.lock();
+
+    if (bSuccess) {
+        m_unJournalCheckpoint = unPosition;
+    }
+}
+
+void FileStorage::SetDirty(const std::string& normalized, std::shared_ptr<const std::vector<uint8>> pData)
+{
+    DirtyEntry& entry = m_dirty[normalized];
+    if (entry.m_pData) {
+        m_unDirtyBytes -= entry.m_pData->size();
+    }
+    if (pData) {
+        m_unDirtyBytes += pData->size();
+    }
+    entry.m_pData = std::move(pData);
+    entry.m_unSequence = m_unNextSequence++;
+    entry.m_unJournalStart = 0;
+    entry.m_unJournalEnd = 0;
+}
+
+bool FileStorage::PersistDirtyEntry(std::unique_lock<VaporCore::Mutex>& lock, const std::string& normalized)
+{
+    // One writer per file at a time, they would share the same temporary file
+    auto it = m_dirty.find(normalized);
+    while (it != m_dirty.end() && it->second.m_bInFlight) {
+        m_cleanCondition.wait(lock);
+        it = m_dirty.find(normalized);
+    }
+
+    // Nothing cached any more: someone else already persisted the newest state
+    if (it == m_dirty.end()) {
+        return true;
+    }
+
+    // Take a reference to the newest state and persist it without the lock
+    std::shared_ptr<const std::vector<uint8>> pData = it->second.m_pData;
+    uint64 unSequence = it->second.m_unSequence;
+    it->second.m_bInFlight = true;
+
+    lock.unlock();
+    uint32 fFlags = k_EFileFlagNone;
+    bool bSuccess = pData ? PersistWrite(normalized, pData->data(), pData->size(), fFlags) : PersistDelete(normalized);
+    lock.lock();
+
+    // In-flight entries are never erased by others, only retire it if nothing newer replaced it meanwhile
+    it = m_dirty.find(normalized);
+    if (it->second.m_unSequence == unSequence) {
+        if (pData) {
+            m_unDirtyBytes -= pData->size();
+        }
+        m_dirty.erase(it);
+
+        // The cached state is gone, so the index must describe what is really on disk
+        if (!bSuccess) {
+            ReindexFromBackend(normalized);
+        } else if (pData) {
+            if (FileMetadata* pIndexed = m_index.Find(normalized)) {
+                pIndexed->m_fFlags = fFlags;
+            }
+        }
+    } else {
+        it->second.m_bInFlight = false;
+    }
+
+    m_flushCondition.notify_one();
+    m_cleanCondition.notify_all();
+    return bSuccess;
+}
+
+bool FileStorage::PersistWrite(const std::string& normalized, const void* data, size_t size, uint32& fFlags)
+{
+    FileView previous;
+    int64 nPreviousTimestamp = 0;
+    bool bHadPrevious = m_pHistory && CaptureStored(normalized, previous, nPreviousTimestamp);
+
+    // Verbatim unless the policy compresses the file or its contents look like a header
+    bool bSuccess;
+    std::vector<uint8> encoded;
+    ECompressionCodec codec = GetCompressionPolicy(normalized);
+    if ((codec != k_ECompressionCodecNone && size >= COMPRESSION_MIN_SIZE && EncodeStoredFile(codec, data, size, encoded)) ||
+        (NeedsStoredFileHeader(data, size) && EncodeStoredFile(k_ECompressionCodecNone, data, size, encoded))) {
+        fFlags = k_EFileFlagEncoded;
+        bSuccess = m_pBackend->Write(normalized, encoded.data(), encoded.size());
+    } else {
+        fFlags = k_EFileFlagNone;
+        bSuccess = m_pBackend->Write(normalized, data, size);
+    }
+
+    if (bSuccess && m_pHistory) {
+        const uint8* pBytes = static_cast<const uint8*>(data);
+        auto pCurrent = std::make_shared<const std::vector<uint8>>(pBytes, pBytes + size);
+        FileView current;
+        current.m_pData = pCurrent->data();
+        current.m_cubData = pCurrent->size();
+        current.m_pOwner = std::move(pCurrent);
+        m_pHistory->Record(normalized, bHadPrevious ? &previous : nullptr, nPreviousTimestamp, &current);
+    }
+    return bSuccess;
+}
+
+bool FileStorage::PersistDelete(const std::string& normalized)
+{
+    FileView previous;
+    int64 nPreviousTimestamp = 0;
+    bool bHadPrevious = m_pHistory && CaptureStored(normalized, previous, nPreviousTimestamp);
+
+    if (!m_pBackend->Delete(normalized)) {
+        return false;
+    }
+
+    if (bHadPrevious) {
+        m_pHistory->Record(normalized, &previous, nPreviousTimestamp, nullptr);
+    }
+    return true;
+}
+
+bool FileStorage::CaptureStored(const std::string& normalized, FileView& view, int64& nTimestamp)
+{
+    uint64 unStoredSize;
+    FileView stored;
+    if (!m_pBackend->Stat(normalized, unStoredSize, nTimestamp) || !m_pBackend->OpenView(normalized, stored)) {
+        return false;
+    }
+
+    StoredFileHeader header;
+    if (ReadStoredFileHeader(stored.m_pData, stored.m_cubData, header)) {
+        auto pData = std::make_shared<std::vector<uint8>>(static_cast<size_t>(header.m_unOriginalSize));
+        if (DecodeStoredFile(stored.m_pData, stored.m_cubData, pData->data(), pData->size()) < 0) {
+            return false;
+        }
+        view.m_pData = pData->data();
+        view.m_cubData = pData->size();
+        view.m_pOwner = std::move(pData);
+        return true;
+    }
+
+#ifdef _WIN32
+    // A mapping would keep the file from being replaced
+    auto pData = std::make_shared<std::vector<uint8>>(stored.m_pData, stored.m_pData + stored.m_cubData);
+    view.m_pData = pData->data();
+    view.m_cubData = pData->size();
+    view.m_pOwner = std::move(pData);
+#else
+    // The mapping keeps showing the old contents after the file is replaced
+    view = std::move(stored);
+#endif
+    return true;
+}
+
+bool FileStorage::EnsureDirectoryExists()
+{
+    try {
+        if (!std::filesystem::exists(m_storageDirectory)) {
+            std::filesystem::create_directories(m_storageDirectory);
+            VLOG_INFO(__FUNCTION__ " - Created storage directory: %s", m_storageDirectory.c_str());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to create directory %s: %s", m_storageDirectory.c_str(), e.what());
+        return false;
+    }
+}
+
+bool FileStorage::IsValidFilename(const std::string& filename) const
+{
+    if (filename.empty() || filename.length() > 260) {
+        return false;
+    }
+    
+    // Check for invalid characters
+    const std::string invalidChars = "<>:\"|?*";
+    for (char c : invalidChars) {
+        if (filename.find(c) != std::string::npos) {
+            return false;
+        }
+    }
+    
+    // Names may contain subdirectories, check every component of the normalized path
+    std::string normalized = NormalizeFilename(filename);
+    if (normalized.empty() || normalized.back() == '/') {
+        return false;
+    }
+
+    // Temporary files are swept up as crash debris whenever the directory is scanned
+    if (std::filesystem::path(normalized).extension() == FILE_IO_TEMP_SUFFIX) {
+        return false;
+    }
+
+    // The other storage layers keep their bookkeeping next to the saves
+    static const char* const bookkeeping[] = {
+        PACKED_CONTAINER_FILENAME, DEDUP_MARKER_FILENAME, JOURNAL_FILENAME, ACCESS_PROFILE_FILENAME,
+        CLOUD_SYNC_STATE_FILENAME
+    };
+    for (const char* pchName : bookkeeping) {
+        if (normalized == pchName) {
+            return false;
+        }
+    }
+
+    static const std::vector<std::string> reserved = {
+        "con", "prn", "aux", "nul",
+        "com1", "com2", "com3", "com4", "com5", "com6", "com7", "com8", "com9",
+        "lpt1", "lpt2", "lpt3", "lpt4", "lpt5", "lpt6", "lpt7", "lpt8", "lpt9"
+    };
+    
+    size_t unStart = 0;
+    while (unStart < normalized.size()) {
+        size_t unEnd = normalized.find('/', unStart);
+        if (unEnd == std::string::npos) {
+            unEnd = normalized.size();
+        }
+        std::string component = normalized.substr(unStart, unEnd - unStart);
+        unStart = unEnd + 1;
+
+        // Nothing may reach outside the storage directory or into its bookkeeping
+        if (component == "." || component == "..") {
+            return false;
+        }
+        if (component == VERSION_HISTORY_DIRECTORY || component == CLOUD_SYNC_CONFLICT_DIRECTORY) {
+            return false;
+        }
+
+        // Check for reserved names (Windows)
+        for (const std::string& res : reserved) {
+            if (component == res || component.compare(0, res.length() + 1, res + ".") == 0) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
 
 std::string FileStorage::NormalizeFilename(const std::string& filename) const
 {
@@ -327,6 +1503,11 @@ std::string FileStorage::NormalizeFilename(const std::string& filename) const
     // Replace backslashes with forward slashes
     std::replace(normalized.begin(), normalized.end(), '\\', '/');
     
+    // Collapse repeated separators, "saves//a" and "saves/a" are the same file
+    normalized.erase(std::unique(normalized.begin(), normalized.end(),
+                                 [](char a, char b) { return a == '/' && b == '/'; }),
+                     normalized.end());
+
     // Remove leading slashes
     while (!normalized.empty() && normalized[0] == '/') {
         normalized.erase(0, 1);
@@ -335,30 +1516,321 @@ std::string FileStorage::NormalizeFilename(const std::string& filename) const
     return normalized;
 }
 
-std::string FileStorage::GetFullPath(const std::string& filename) const
+std::string FileStorage::GetUserStorageDirectory()
 {
-    std::string normalized = NormalizeFilename(filename);
-    return m_storageDirectory + "/" + normalized;
+    const Config& config = Config::GetInstance();
+    std::string root(config.GetString(KEY_STORAGE_DIRECTORY, DEFAULT_STORAGE_DIRECTORY));
+    if (!config.GetBool(KEY_STORAGE_NAMESPACE, true)) {
+        return root;
+    }
+
+    char userDirectory[64];
+    snprintf(userDirectory, sizeof(userDirectory), "%u/%llu", config.GameID().AppID(),
+             static_cast<unsigned long long>(config.SteamID().ConvertToUint64()));
+
+    // The root may hold anything (it can be the game's own directory), so saves
+    // from before namespaces are only moved in when the config asks for it
+    std::string directory = root + "/" + userDirectory;
+    if (config.GetBool(KEY_STORAGE_ADOPT_LEGACY_SAVES, false)) {
+        AdoptLegacySaves(root, directory);
+    }
+    return directory;
 }
 
-void FileStorage::CacheFileList()
+void FileStorage::AdoptLegacySaves(const std::string& root, const std::string& directory)
 {
-    m_indexToFile.clear();
+    std::error_code ec;
+    if (std::filesystem::exists(directory, ec) || !std::filesystem::is_directory(root, ec)) {
+        return;
+    }
+
+    // Namespaces are numeric AppID directories, anything else was saved before them
+    std::vector<std::filesystem::path> legacy;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        std::string name = entry.path().filename().string();
+        bool bNumeric = !name.empty() && std::all_of(name.begin(), name.end(),
+                                                     [](unsigned char c) { return std::isdigit(c) != 0; });
+        if (!bNumeric || !entry.is_directory(ec)) {
+            legacy.push_back(entry.path());
+        }
+    }
+    if (legacy.empty()) {
+        return;
+    }
+
+    std::filesystem::create_directories(directory, ec);
+    for (const auto& path : legacy) {
+        std::filesystem::rename(path, std::filesystem::path(directory) / path.filename(), ec);
+        if (ec) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to move %s: %s", path.string().c_str(), ec.message().c_str());
+        }
+    }
+    VLOG_INFO(__FUNCTION__ " - Moved %zu saves from %s into %s", legacy.size(), root.c_str(), directory.c_str());
+}
+
+EResult FileStorage::CheckQuota(const std::string& normalized, uint64 unSize) const
+{
+    const FileMetadata* pIndexed = m_index.Find(normalized);
+    uint64 unReplaced = pIndexed ? pIndexed->m_unSize : 0;
+
+    // Storage already over quota (lowered since) still takes writes that do not grow it
+    if (m_unQuotaBytes > 0 && unSize > unReplaced && m_unUsedBytes - unReplaced + unSize > m_unQuotaBytes) {
+        VLOG_WARNING(__FUNCTION__ " - %s: %llu bytes exceed the quota, %llu of %llu bytes used",
+                     normalized.c_str(), unSize, m_unUsedBytes, m_unQuotaBytes);
+        return k_EResultLimitExceeded;
+    }
+    if (m_unQuotaFiles > 0 && !pIndexed && m_index.Size() >= m_unQuotaFiles) {
+        VLOG_WARNING(__FUNCTION__ " - %s: file limit of %llu reached", normalized.c_str(), m_unQuotaFiles);
+        return k_EResultLimitExceeded;
+    }
+    return k_EResultOK;
+}
+
+void FileStorage::BuildIndex()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    m_index.Clear();
+    m_unUsedBytes = 0;
     
-    try {
-        if (std::filesystem::exists(m_storageDirectory)) {
-            for (const auto& entry : std::filesystem::directory_iterator(m_storageDirectory)) {
-                if (entry.is_regular_file()) {
-                    std::string filename = entry.path().filename().string();
-                    std::string normalized = NormalizeFilename(filename);
-                    m_indexToFile.push_back(normalized);
-                }
-            }
+    struct StoredFile
+    {
+        std::string m_sName;
+        uint64 m_unSize;
+        int64 m_nTimestamp;
+    };
+    std::vector<StoredFile> files;
+    m_pBackend->Enumerate([&files](const std::string& name, uint64 unSize, int64 nTimestamp) {
+        files.push_back({ name, unSize, nTimestamp });
+    });
+
+    // Encoded files report their logical size, which only their header knows
+    for (const StoredFile& file : files) {
+        uint64 unSize;
+        uint32 fFlags;
+        if (StatStored(file.m_sName, file.m_unSize, unSize, fFlags)) {
+            IndexFile(NormalizeFilename(file.m_sName), unSize, file.m_nTimestamp, fFlags);
         }
-        VLOG_DEBUG(__FUNCTION__ " - Cached file list, found %zu files", m_indexToFile.size());
-    } catch (const std::exception& e) {
-        VLOG_ERROR(__FUNCTION__ " - Error caching file list: %s", e.what());
     }
+    VLOG_DEBUG(__FUNCTION__ " - Indexed %zu files, %llu bytes", m_index.Size(), m_unUsedBytes);
+}
+
+ECompressionCodec FileStorage::GetCompressionPolicy(const std::string& normalized) const
+{
+    // [Compression] maps extensions (without the dot) to a codec, "*" covers the rest
+    std::string extension;
+    size_t unDot = normalized.rfind('.');
+    if (unDot != std::string::npos && normalized.find('/', unDot) == std::string::npos) {
+        extension = normalized.substr(unDot + 1);
+    }
+
+    const Config& config = Config::GetInstance();
+    std::string policy = extension.empty() ? std::string() : config.GetString(CONFIG_SECTION_COMPRESSION, extension);
+    if (policy.empty()) {
+        policy = config.GetString(CONFIG_SECTION_COMPRESSION, COMPRESSION_POLICY_DEFAULT);
+    }
+
+    ECompressionCodec codec = k_ECompressionCodecNone;
+    if (!policy.empty() && !ParseCompressionCodec(policy, codec)) {
+        VLOG_WARNING(__FUNCTION__ " - Unknown compression codec '%s' for %s", policy.c_str(), normalized.c_str());
+    }
+    return codec;
+}
+
+bool FileStorage::StatStored(const std::string& normalized, uint64 unStoredSize, uint64& unSize, uint32& fFlags)
+{
+    unSize = unStoredSize;
+    fFlags = k_EFileFlagNone;
+    if (unStoredSize < sizeof(StoredFileHeader)) {
+        return true;
+    }
+
+    StoredFileHeader header;
+    int64 nRead = m_pBackend->Read(normalized, 0, &header, sizeof(header));
+    if (nRead < 0) {
+        return false;
+    }
+    if (ReadStoredFileHeader(&header, static_cast<size_t>(nRead), header)) {
+        unSize = header.m_unOriginalSize;
+        fFlags = k_EFileFlagEncoded;
+    }
+    return true;
+}
+
+bool FileStorage::ReadDecoded(const std::string& normalized, std::vector<uint8>& data)
+{
+    FileView stored;
+    StoredFileHeader header;
+    if (!m_pBackend->OpenView(normalized, stored) || !ReadStoredFileHeader(stored.m_pData, stored.m_cubData, header)) {
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(header.m_unOriginalSize));
+    if (DecodeStoredFile(stored.m_pData, stored.m_cubData, data.data(), data.size()) < 0) {
+        VLOG_ERROR(__FUNCTION__ " - Cannot decode stored file: %s", normalized.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FileStorage::ReadContents(const std::string& normalized, uint32 fFlags, std::vector<uint8>& data)
+{
+    if (fFlags & k_EFileFlagEncoded) {
+        return ReadDecoded(normalized, data);
+    }
+
+    FileView stored;
+    if (!m_pBackend->OpenView(normalized, stored)) {
+        return false;
+    }
+    data.assign(stored.m_pData, stored.m_pData + stored.m_cubData);
+    return true;
+}
+
+std::unique_ptr<StorageBackend> FileStorage::CreateBackend()
+{
+    std::unique_ptr<StorageBackend> pLayout = CreateLayoutBackend();
+
+    std::string markerPath = m_storageDirectory + "/" + DEDUP_MARKER_FILENAME;
+    std::error_code ec;
+    bool bDeduplicated = std::filesystem::exists(markerPath, ec);
+
+    if (!Config::GetInstance().GetBool(KEY_STORAGE_DEDUP, false)) {
+        if (!bDeduplicated) {
+            return pLayout;
+        }
+
+        // Switched off: the files need their contents back before the marker goes
+        std::shared_ptr<ChunkStore> pChunkStore = ChunkStore::OpenDefault();
+        if (!pChunkStore) {
+            VLOG_ERROR(__FUNCTION__ " - Cannot open the chunk store to expand %s", m_storageDirectory.c_str());
+            return pLayout;
+        }
+
+        DedupFileBackend dedup(std::move(pLayout), std::move(pChunkStore));
+        [[maybe_unused]] uint32 unExpanded = dedup.ExpandAll();
+        std::filesystem::remove(markerPath, ec);
+        VLOG_INFO(__FUNCTION__ " - Expanded %u deduplicated files", unExpanded);
+        return dedup.ReleaseInner();
+    }
+
+    std::shared_ptr<ChunkStore> pChunkStore = ChunkStore::OpenDefault();
+    if (!pChunkStore) {
+        VLOG_ERROR(__FUNCTION__ " - Cannot open the chunk store, not deduplicating %s", m_storageDirectory.c_str());
+        return pLayout;
+    }
+
+    StorageBackend& layout = *pLayout;
+    auto pDedup = std::make_unique<DedupFileBackend>(std::move(pLayout), std::move(pChunkStore));
+
+    // Switched on: existing files move into the chunk store
+    if (!bDeduplicated) {
+        [[maybe_unused]] uint32 unMigrated = MigrateFiles(layout, *pDedup);
+        std::ofstream marker(markerPath, std::ios::trunc);
+        VLOG_INFO(__FUNCTION__ " - Deduplicated %u existing files", unMigrated);
+    }
+    return pDedup;
+}
+
+std::unique_ptr<StorageBackend> FileStorage::CreateLayoutBackend()
+{
+    std::string backend(Config::GetInstance().GetString(KEY_STORAGE_BACKEND, STORAGE_BACKEND_FILES));
+    std::transform(backend.begin(), backend.end(), backend.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    auto pPlain = std::make_unique<PlainFileBackend>(m_storageDirectory, m_unMmapThreshold);
+
+    if (backend == STORAGE_BACKEND_PACKED) {
+        uint32 unGarbagePercent = std::min<uint32>(100,
+            Config::GetInstance().GetUInt32(KEY_STORAGE_COMPACT_GARBAGE_PERCENT, DEFAULT_COMPACT_GARBAGE_PERCENT));
+        auto pPacked = std::make_unique<PackedFileBackend>(m_storageDirectory, unGarbagePercent);
+        if (!pPacked->Open()) {
+            VLOG_ERROR(__FUNCTION__ " - Cannot open packed storage in %s, using plain files", m_storageDirectory.c_str());
+            return pPlain;
+        }
+
+        // Saves written while the plain layout was active move into the container
+        uint32 unMigrated = MigrateFiles(*pPlain, *pPacked);
+        if (unMigrated > 0) {
+            pPlain->RemoveAll();
+            VLOG_INFO(__FUNCTION__ " - Migrated %u files into packed storage", unMigrated);
+        }
+        return pPacked;
+    }
+
+    if (backend != STORAGE_BACKEND_FILES) {
+        VLOG_WARNING(__FUNCTION__ " - Unknown storage backend '%s', using plain files", backend.c_str());
+    }
+
+    // Switched back from the packed layout: unpack the container
+    if (PackedFileBackend::Exists(m_storageDirectory)) {
+        PackedFileBackend packed(m_storageDirectory, 0);
+        if (packed.Open()) {
+            [[maybe_unused]] uint32 unMigrated = MigrateFiles(packed, *pPlain);
+            packed.RemoveAll();
+            VLOG_INFO(__FUNCTION__ " - Migrated %u files out of packed storage", unMigrated);
+        }
+    }
+    return pPlain;
+}
+
+uint32 FileStorage::MigrateFiles(StorageBackend& from, StorageBackend& to)
+{
+    std::vector<std::string> names;
+    from.Enumerate([&names](const std::string& name, uint64, int64) { names.push_back(name); });
+
+    uint32 unMigrated = 0;
+    for (const std::string& name : names) {
+        FileView view;
+        if (!from.OpenView(name, view) || !to.Write(name, view.m_pData, view.m_cubData)) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to migrate %s", name.c_str());
+            continue;
+        }
+        ++unMigrated;
+    }
+    return unMigrated;
+}
+
+void FileStorage::IndexFile(const std::string& normalized, uint64 unSize, int64 nTimestamp, uint32 fFlags)
+{
+    EvictCached(normalized);
+
+    auto result = m_index.Emplace(normalized);
+    FileMetadata& metadata = *result.first;
+
+    if (!result.second) {
+        m_unUsedBytes -= metadata.m_unSize;
+    }
+
+    metadata.m_unSize = unSize;
+    metadata.m_nTimestamp = nTimestamp;
+    metadata.m_fFlags = fFlags;
+    m_unUsedBytes += unSize;
+}
+
+void FileStorage::ReindexFromBackend(const std::string& normalized)
+{
+    uint64 unStoredSize, unSize;
+    int64 nTimestamp;
+    uint32 fFlags;
+    if (m_pBackend->Stat(normalized, unStoredSize, nTimestamp) && StatStored(normalized, unStoredSize, unSize, fFlags)) {
+        IndexFile(normalized, unSize, nTimestamp, fFlags);
+    } else {
+        UnindexFile(normalized);
+    }
+}
+
+void FileStorage::UnindexFile(const std::string& normalized)
+{
+    EvictCached(normalized);
+
+    const FileMetadata* pIndexed = m_index.Find(normalized);
+    if (!pIndexed) {
+        return;
+    }
+
+    m_unUsedBytes -= pIndexed->m_unSize;
+    m_index.Erase(normalized);
 }
 
 } // namespace VaporCore
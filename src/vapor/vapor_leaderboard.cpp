@@ -0,0 +1,1219 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Local leaderboards in memory-mapped columnar files, ranked through an
+ *          order-statistic skip list
+ */
+
+#include <new>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+#include "vapor_base.h"
+#include "vapor_leaderboard.h"
+#include "vapor_mapped_file.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+static constexpr Config::Key KEY_STATS_DIRECTORY{ CONFIG_SECTION_STATS, CONFIG_KEY_STATS_DIRECTORY };
+
+static constexpr const char* DEFAULT_STATS_DIRECTORY = "./vaporcore_stats";
+static constexpr const char* LEADERBOARD_DIRECTORY = "leaderboards";
+static constexpr const char* BOARD_FILE_EXTENSION = ".vclb";
+static constexpr const char* BOARD_LOG_EXTENSION = ".vclog";
+
+// Downloads kept for GetDownloadedLeaderboardEntry before the oldest is dropped
+static const size_t MAX_LEADERBOARD_DOWNLOADS = 64;
+
+// Users a single DownloadLeaderboardEntriesForUsers may ask for
+static const int MAX_LEADERBOARD_USERS = 100;
+
+// Changed entries a board collects before they are merged into its file
+static const size_t LEADERBOARD_MERGE_ENTRIES = 16384;
+
+static const uint32 BOARD_MAGIC = 0x424c4356;       // "VCLB"
+static const uint32 BOARD_VERSION = 1;
+static const uint32 BOARD_LOG_MAGIC = 0x4c4c4356;   // "VCLL"
+static const uint32 BOARD_LOG_VERSION = 1;
+
+// Board file: header, the board name, then 8-byte aligned columns at the
+// offsets the header gives. Rows are in rank order; the detail column holds
+// the details of every row back to back, found through the row's start and
+// the next row's. The user columns are Steam IDs in ascending order and the
+// row of each. Host byte order
+struct BoardFileHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_unSortMethod;          // ELeaderboardSortMethod
+    uint32 m_unDisplayType;         // ELeaderboardDisplayType
+    uint32 m_cEntries;
+    uint32 m_cchName;
+    uint64 m_cDetails;
+    uint64 m_unLastStamp;           // Latest upload time in the file
+    uint64 m_unScores;              // int32 per row
+    uint64 m_unStamps;              // uint64 per row, upload time in microseconds
+    uint64 m_unSteamIDs;            // uint64 per row
+    uint64 m_unUGC;                 // UGCHandle_t per row
+    uint64 m_unDetailStarts;        // uint64 per row, plus one for the end
+    uint64 m_unDetails;             // int32 per detail
+    uint64 m_unUserIDs;             // uint64 per row, ascending
+    uint64 m_unUserRows;            // uint32 per row
+};
+
+// Board log: header, then a record per change holding the user's whole entry
+// afterwards, followed by its details. Replaying a record twice does no harm
+struct BoardLogHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint64 m_unReserved;
+};
+
+struct BoardLogRecord
+{
+    uint64 m_unSteamID;
+    uint64 m_unStamp;
+    uint64 m_hUGC;
+    int32 m_nScore;
+    uint32 m_cDetails;
+    uint64 m_unCheck;
+};
+
+static_assert(sizeof(BoardFileHeader) == 104, "Board file header layout changed");
+static_assert(sizeof(BoardLogHeader) == 16, "Board log header layout changed");
+static_assert(sizeof(BoardLogRecord) == 40, "Board log record layout changed");
+
+static uint64 BoardLogCheck(const BoardLogRecord& record, const int32* pDetails)
+{
+    uint64 unCheck = HashBytes64(&record, offsetof(BoardLogRecord, m_unCheck), BOARD_LOG_MAGIC);
+    return HashBytes64(pDetails, record.m_cDetails * sizeof(int32), unCheck);
+}
+
+static uint64 AlignColumn(uint64 unOffset)
+{
+    return (unOffset + 7) & ~static_cast<uint64>(7);
+}
+
+static std::mutex s_instancesMutex;
+static std::vector<Leaderboards*> s_instances;
+
+//-----------------------------------------------------------------------------
+// LeaderboardIndex
+//-----------------------------------------------------------------------------
+
+LeaderboardIndex::LeaderboardIndex()
+    : m_pHead(CreateNode(MAX_LEVEL, Key{}))
+    , m_nLevel(1)
+    , m_cKeys(0)
+    , m_unRandom(0x9e3779b97f4a7c15ULL)
+{
+}
+
+LeaderboardIndex::~LeaderboardIndex()
+{
+    Clear();
+    FreeNode(m_pHead);
+}
+
+LeaderboardIndex::Node* LeaderboardIndex::CreateNode(int nLevels, const Key& key)
+{
+    void* pMemory = ::operator new(sizeof(Node) + (nLevels - 1) * sizeof(Link));
+    Node* pNode = static_cast<Node*>(pMemory);
+    pNode->m_key = key;
+    pNode->m_nLevels = nLevels;
+    for (int i = 0; i < nLevels; ++i) {
+        pNode->m_links[i].m_pNext = nullptr;
+        pNode->m_links[i].m_unSpan = 0;
+    }
+    return pNode;
+}
+
+void LeaderboardIndex::FreeNode(Node* pNode) noexcept
+{
+    ::operator delete(pNode);
+}
+
+int LeaderboardIndex::RandomLevel() noexcept
+{
+    // xorshift64; each level is kept with probability 1/4
+    m_unRandom ^= m_unRandom << 13;
+    m_unRandom ^= m_unRandom >> 7;
+    m_unRandom ^= m_unRandom << 17;
+
+    int nLevel = 1;
+    uint64 unBits = m_unRandom;
+    while (nLevel < MAX_LEVEL && (unBits & 3) == 0) {
+        ++nLevel;
+        unBits >>= 2;
+    }
+    return nLevel;
+}
+
+void LeaderboardIndex::Insert(const Key& key)
+{
+    Node* update[MAX_LEVEL];
+    uint32 rank[MAX_LEVEL];
+
+    // Last node before the key on each level, and its rank
+    Node* pNode = m_pHead;
+    for (int i = m_nLevel - 1; i >= 0; --i) {
+        rank[i] = i == m_nLevel - 1 ? 0 : rank[i + 1];
+        while (pNode->m_links[i].m_pNext && pNode->m_links[i].m_pNext->m_key < key) {
+            rank[i] += pNode->m_links[i].m_unSpan;
+            pNode = pNode->m_links[i].m_pNext;
+        }
+        update[i] = pNode;
+    }
+
+    int nLevel = RandomLevel();
+    if (nLevel > m_nLevel) {
+        for (int i = m_nLevel; i < nLevel; ++i) {
+            rank[i] = 0;
+            update[i] = m_pHead;
+            update[i]->m_links[i].m_unSpan = m_cKeys;
+        }
+        m_nLevel = nLevel;
+    }
+
+    pNode = CreateNode(nLevel, key);
+    for (int i = 0; i < nLevel; ++i) {
+        pNode->m_links[i].m_pNext = update[i]->m_links[i].m_pNext;
+        update[i]->m_links[i].m_pNext = pNode;
+
+        // The new node splits the link it was inserted into
+        pNode->m_links[i].m_unSpan = update[i]->m_links[i].m_unSpan - (rank[0] - rank[i]);
+        update[i]->m_links[i].m_unSpan = (rank[0] - rank[i]) + 1;
+    }
+
+    // Links above the node now pass one more entry
+    for (int i = nLevel; i < m_nLevel; ++i) {
+        update[i]->m_links[i].m_unSpan++;
+    }
+
+    ++m_cKeys;
+}
+
+bool LeaderboardIndex::Erase(const Key& key)
+{
+    Node* update[MAX_LEVEL];
+
+    Node* pNode = m_pHead;
+    for (int i = m_nLevel - 1; i >= 0; --i) {
+        while (pNode->m_links[i].m_pNext && pNode->m_links[i].m_pNext->m_key < key) {
+            pNode = pNode->m_links[i].m_pNext;
+        }
+        update[i] = pNode;
+    }
+
+    pNode = pNode->m_links[0].m_pNext;
+    if (!pNode || !(pNode->m_key == key)) {
+        return false;
+    }
+
+    for (int i = 0; i < m_nLevel; ++i) {
+        if (update[i]->m_links[i].m_pNext == pNode) {
+            update[i]->m_links[i].m_unSpan += pNode->m_links[i].m_unSpan - 1;
+            update[i]->m_links[i].m_pNext = pNode->m_links[i].m_pNext;
+        } else {
+            update[i]->m_links[i].m_unSpan--;
+        }
+    }
+
+    while (m_nLevel > 1 && !m_pHead->m_links[m_nLevel - 1].m_pNext) {
+        --m_nLevel;
+    }
+
+    FreeNode(pNode);
+    --m_cKeys;
+    return true;
+}
+
+void LeaderboardIndex::Clear()
+{
+    Node* pNode = m_pHead->m_links[0].m_pNext;
+    while (pNode) {
+        Node* pNext = pNode->m_links[0].m_pNext;
+        FreeNode(pNode);
+        pNode = pNext;
+    }
+
+    for (int i = 0; i < MAX_LEVEL; ++i) {
+        m_pHead->m_links[i].m_pNext = nullptr;
+        m_pHead->m_links[i].m_unSpan = 0;
+    }
+    m_nLevel = 1;
+    m_cKeys = 0;
+}
+
+uint32 LeaderboardIndex::Rank(const Key& key) const
+{
+    uint32 unRank = 0;
+    const Node* pNode = m_pHead;
+    for (int i = m_nLevel - 1; i >= 0; --i) {
+        while (pNode->m_links[i].m_pNext && !(key < pNode->m_links[i].m_pNext->m_key)) {
+            unRank += pNode->m_links[i].m_unSpan;
+            pNode = pNode->m_links[i].m_pNext;
+        }
+        if (pNode != m_pHead && pNode->m_key == key) {
+            return unRank;
+        }
+    }
+    return 0;
+}
+
+uint32 LeaderboardIndex::CountLess(const Key& key) const
+{
+    uint32 unCount = 0;
+    const Node* pNode = m_pHead;
+    for (int i = m_nLevel - 1; i >= 0; --i) {
+        while (pNode->m_links[i].m_pNext && pNode->m_links[i].m_pNext->m_key < key) {
+            unCount += pNode->m_links[i].m_unSpan;
+            pNode = pNode->m_links[i].m_pNext;
+        }
+    }
+    return unCount;
+}
+
+void LeaderboardIndex::Range(uint32 unRank, uint32 cCount, std::vector<Key>& keys) const
+{
+    if (unRank == 0 || unRank > m_cKeys || cCount == 0) {
+        return;
+    }
+
+    // Descend to the node of that rank
+    uint32 unTraversed = 0;
+    const Node* pNode = m_pHead;
+    for (int i = m_nLevel - 1; i >= 0 && unTraversed != unRank; --i) {
+        while (pNode->m_links[i].m_pNext && unTraversed + pNode->m_links[i].m_unSpan <= unRank) {
+            unTraversed += pNode->m_links[i].m_unSpan;
+            pNode = pNode->m_links[i].m_pNext;
+        }
+    }
+
+    for (; pNode && cCount > 0; pNode = pNode->m_links[0].m_pNext, --cCount) {
+        keys.push_back(pNode->m_key);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Leaderboards::BoardFile
+//-----------------------------------------------------------------------------
+
+struct Leaderboards::BoardFile
+{
+    MappedFile m_file;
+    BoardFileHeader m_header = {};
+    std::string m_sName;
+
+    uint32 m_cEntries = 0;
+    const int32* m_pScores = nullptr;
+    const uint64* m_pStamps = nullptr;
+    const uint64* m_pSteamIDs = nullptr;
+    const uint64* m_pUGC = nullptr;
+    const uint64* m_pDetailStarts = nullptr;
+    const int32* m_pDetails = nullptr;
+    const uint64* m_pUserIDs = nullptr;
+    const uint32* m_pUserRows = nullptr;
+
+    // Maps the file and checks the header and the column bounds; the rows
+    // themselves are only read as they are asked for
+    bool Open(const std::string& path)
+    {
+        if (!m_file.Open(path) || m_file.Size() < sizeof(BoardFileHeader)) {
+            return false;
+        }
+        memcpy(&m_header, m_file.Data(), sizeof(m_header));
+        if (m_header.m_unMagic != BOARD_MAGIC || m_header.m_unVersion != BOARD_VERSION ||
+            m_header.m_cchName > m_file.Size() - sizeof(BoardFileHeader)) {
+            return false;
+        }
+
+        const uint64 cEntries = m_header.m_cEntries;
+        bool bValid = Column(m_header.m_unScores, cEntries, m_pScores) &&
+                      Column(m_header.m_unStamps, cEntries, m_pStamps) &&
+                      Column(m_header.m_unSteamIDs, cEntries, m_pSteamIDs) &&
+                      Column(m_header.m_unUGC, cEntries, m_pUGC) &&
+                      Column(m_header.m_unDetailStarts, cEntries + 1, m_pDetailStarts) &&
+                      Column(m_header.m_unDetails, m_header.m_cDetails, m_pDetails) &&
+                      Column(m_header.m_unUserIDs, cEntries, m_pUserIDs) &&
+                      Column(m_header.m_unUserRows, cEntries, m_pUserRows);
+        if (!bValid || m_pDetailStarts[cEntries] != m_header.m_cDetails) {
+            return false;
+        }
+
+        m_sName.assign(m_file.Data() + sizeof(BoardFileHeader), m_header.m_cchName);
+        m_cEntries = m_header.m_cEntries;
+
+        // Pages are read where the ranks asked for fall, not front to back
+        m_file.Advise(MappedFile::AccessPattern::Random);
+        return true;
+    }
+
+    template <typename T>
+    bool Column(uint64 unOffset, uint64 cItems, const T*& pColumn) const
+    {
+        if (unOffset % alignof(T) != 0 || unOffset > m_file.Size() ||
+            cItems > (m_file.Size() - unOffset) / sizeof(T)) {
+            return false;
+        }
+        pColumn = reinterpret_cast<const T*>(m_file.Data() + unOffset);
+        return true;
+    }
+
+    // Row of a user, NO_ROW if they have none
+    uint32 FindUser(uint64 unSteamID) const
+    {
+        const uint64* pEnd = m_pUserIDs + m_cEntries;
+        const uint64* pFound = std::lower_bound(m_pUserIDs, pEnd, unSteamID);
+        if (pFound == pEnd || *pFound != unSteamID || m_pUserRows[pFound - m_pUserIDs] >= m_cEntries) {
+            return NO_ROW;
+        }
+        return m_pUserRows[pFound - m_pUserIDs];
+    }
+
+    uint32 DetailCount(uint32 unRow) const
+    {
+        uint64 unStart = m_pDetailStarts[unRow];
+        uint64 unEnd = m_pDetailStarts[unRow + 1];
+        if (unEnd < unStart || unEnd > m_header.m_cDetails) {
+            return 0;
+        }
+        return static_cast<uint32>(std::min<uint64>(unEnd - unStart, k_cLeaderboardDetailsMax));
+    }
+
+    void GetDetails(uint32 unRow, std::vector<int32>& details) const
+    {
+        const int32* pDetails = m_pDetails + m_pDetailStarts[unRow];
+        details.assign(pDetails, pDetails + DetailCount(unRow));
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Leaderboards
+//-----------------------------------------------------------------------------
+
+Leaderboards::Leaderboards()
+    : m_hNextEntries(1)
+    , m_bStop(false)
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    s_instances.push_back(this);
+}
+
+Leaderboards::~Leaderboards()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_instancesMutex);
+        s_instances.erase(std::remove(s_instances.begin(), s_instances.end(), this), s_instances.end());
+    }
+    Shutdown();
+}
+
+Leaderboards::Board* Leaderboards::GetBoard(SteamLeaderboard_t hLeaderboard)
+{
+    if (hLeaderboard == 0 || hLeaderboard > m_boards.size()) {
+        return nullptr;
+    }
+    return m_boards[hLeaderboard - 1].get();
+}
+
+LeaderboardIndex::Key Leaderboards::MakeKey(const Board& board, uint64 unSteamID, int32 nScore, uint64 unStamp)
+{
+    // Ascending boards rank the lowest score first
+    int64 nSortScore = board.m_eSortMethod == k_ELeaderboardSortMethodAscending ? nScore
+                                                                                  : -static_cast<int64>(nScore);
+    return LeaderboardIndex::Key{ nSortScore, unStamp, unSteamID };
+}
+
+bool Leaderboards::IsBetter(const Board& board, int32 nScore, int32 nCurrent)
+{
+    return board.m_eSortMethod == k_ELeaderboardSortMethodAscending ? nScore < nCurrent : nScore > nCurrent;
+}
+
+LeaderboardIndex::Key Leaderboards::MakeFileKey(const Board& board, const BoardFile& file, uint32 unRow)
+{
+    return MakeKey(board, file.m_pSteamIDs[unRow], file.m_pScores[unRow], file.m_pStamps[unRow]);
+}
+
+bool Leaderboards::WriteBoardFile(const Board& board, uint64 unLastStamp, const BoardFile* pFile,
+                                  const std::vector<uint32>& replaced, const std::vector<MergeEntry>& changed)
+{
+    const uint32 cFileRows = pFile ? pFile->m_cEntries : 0;
+    const uint64 cEntries = static_cast<uint64>(cFileRows) - replaced.size() + changed.size();
+    if (cEntries > INT32_MAX) {
+        return false;
+    }
+
+    // Sized up front, so every column is written in place
+    uint64 cDetails = 0;
+    for (uint32 unRow = 0, iReplaced = 0; unRow < cFileRows; ++unRow) {
+        if (iReplaced < replaced.size() && replaced[iReplaced] == unRow) {
+            ++iReplaced;
+            continue;
+        }
+        cDetails += pFile->DetailCount(unRow);
+    }
+    for (const MergeEntry& merge : changed) {
+        cDetails += merge.m_entry.m_details.size();
+    }
+
+    BoardFileHeader header = {};
+    header.m_unMagic = BOARD_MAGIC;
+    header.m_unVersion = BOARD_VERSION;
+    header.m_unSortMethod = board.m_eSortMethod;
+    header.m_unDisplayType = board.m_eDisplayType;
+    header.m_cEntries = static_cast<uint32>(cEntries);
+    header.m_cchName = static_cast<uint32>(board.m_sName.size());
+    header.m_cDetails = cDetails;
+    header.m_unLastStamp = unLastStamp;
+
+    uint64 unOffset = sizeof(header) + board.m_sName.size();
+    auto place = [&unOffset](uint64& unColumn, uint64 cubColumn) {
+        unColumn = AlignColumn(unOffset);
+        unOffset = unColumn + cubColumn;
+    };
+    place(header.m_unScores, cEntries * sizeof(int32));
+    place(header.m_unStamps, cEntries * sizeof(uint64));
+    place(header.m_unSteamIDs, cEntries * sizeof(uint64));
+    place(header.m_unUGC, cEntries * sizeof(uint64));
+    place(header.m_unDetailStarts, (cEntries + 1) * sizeof(uint64));
+    place(header.m_unDetails, cDetails * sizeof(int32));
+    place(header.m_unUserIDs, cEntries * sizeof(uint64));
+    place(header.m_unUserRows, cEntries * sizeof(uint32));
+
+    std::vector<uint8> image(static_cast<size_t>(unOffset), 0);
+    memcpy(image.data(), &header, sizeof(header));
+    memcpy(image.data() + sizeof(header), board.m_sName.data(), board.m_sName.size());
+
+    int32* pScores = reinterpret_cast<int32*>(image.data() + header.m_unScores);
+    uint64* pStamps = reinterpret_cast<uint64*>(image.data() + header.m_unStamps);
+    uint64* pSteamIDs = reinterpret_cast<uint64*>(image.data() + header.m_unSteamIDs);
+    uint64* pUGC = reinterpret_cast<uint64*>(image.data() + header.m_unUGC);
+    uint64* pDetailStarts = reinterpret_cast<uint64*>(image.data() + header.m_unDetailStarts);
+    int32* pDetails = reinterpret_cast<int32*>(image.data() + header.m_unDetails);
+
+    // Both sides are in rank order, so one pass merges them
+    std::vector<std::pair<uint64, uint32>> users;
+    users.reserve(static_cast<size_t>(cEntries));
+    uint64 unDetail = 0;
+    uint32 unRow = 0;
+    size_t iReplaced = 0;
+    size_t iChanged = 0;
+    for (uint32 unOut = 0; unOut < cEntries; ++unOut) {
+        while (unRow < cFileRows && iReplaced < replaced.size() && replaced[iReplaced] == unRow) {
+            ++unRow;
+            ++iReplaced;
+        }
+
+        pDetailStarts[unOut] = unDetail;
+        if (unRow < cFileRows &&
+            (iChanged == changed.size() || MakeFileKey(board, *pFile, unRow) < changed[iChanged].m_key)) {
+            pScores[unOut] = pFile->m_pScores[unRow];
+            pStamps[unOut] = pFile->m_pStamps[unRow];
+            pSteamIDs[unOut] = pFile->m_pSteamIDs[unRow];
+            pUGC[unOut] = pFile->m_pUGC[unRow];
+            uint32 cRowDetails = pFile->DetailCount(unRow);
+            memcpy(pDetails + unDetail, pFile->m_pDetails + pFile->m_pDetailStarts[unRow], cRowDetails * sizeof(int32));
+            unDetail += cRowDetails;
+            ++unRow;
+        } else {
+            const MergeEntry& merge = changed[iChanged++];
+            pScores[unOut] = merge.m_entry.m_nScore;
+            pStamps[unOut] = merge.m_entry.m_unStamp;
+            pSteamIDs[unOut] = merge.m_key.m_unSteamID;
+            pUGC[unOut] = merge.m_entry.m_hUGC;
+            if (!merge.m_entry.m_details.empty()) {
+                memcpy(pDetails + unDetail, merge.m_entry.m_details.data(),
+                       merge.m_entry.m_details.size() * sizeof(int32));
+            }
+            unDetail += merge.m_entry.m_details.size();
+        }
+        users.emplace_back(pSteamIDs[unOut], unOut);
+    }
+    pDetailStarts[cEntries] = unDetail;
+
+    std::sort(users.begin(), users.end());
+    uint64* pUserIDs = reinterpret_cast<uint64*>(image.data() + header.m_unUserIDs);
+    uint32* pUserRows = reinterpret_cast<uint32*>(image.data() + header.m_unUserRows);
+    for (size_t i = 0; i < users.size(); ++i) {
+        pUserIDs[i] = users[i].first;
+        pUserRows[i] = users[i].second;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(board.m_sPath).parent_path(), ec);
+    return WriteFileAtomic(board.m_sPath, image.data(), image.size());
+}
+
+void Leaderboards::EncodeLogRecord(uint64 unSteamID, const Entry& entry, std::vector<uint8>& data)
+{
+    BoardLogRecord record = {};
+    record.m_unSteamID = unSteamID;
+    record.m_unStamp = entry.m_unStamp;
+    record.m_hUGC = entry.m_hUGC;
+    record.m_nScore = entry.m_nScore;
+    record.m_cDetails = static_cast<uint32>(entry.m_details.size());
+    record.m_unCheck = BoardLogCheck(record, entry.m_details.data());
+
+    size_t unPos = data.size();
+    data.resize(unPos + sizeof(record) + entry.m_details.size() * sizeof(int32));
+    memcpy(data.data() + unPos, &record, sizeof(record));
+    if (!entry.m_details.empty()) {
+        memcpy(data.data() + unPos + sizeof(record), entry.m_details.data(), entry.m_details.size() * sizeof(int32));
+    }
+}
+
+bool Leaderboards::RewriteLog(Board& board)
+{
+    const std::string logPath = board.m_sPath.substr(0, board.m_sPath.size() - strlen(BOARD_FILE_EXTENSION)) +
+                                BOARD_LOG_EXTENSION;
+
+    std::vector<uint8> data(sizeof(BoardLogHeader));
+    BoardLogHeader header = { BOARD_LOG_MAGIC, BOARD_LOG_VERSION, 0 };
+    memcpy(data.data(), &header, sizeof(header));
+    for (const auto& [unSteamID, entry] : board.m_changed) {
+        EncodeLogRecord(unSteamID, entry, data);
+    }
+
+    if (!WriteFileAtomic(logPath, data.data(), data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write %s", logPath.c_str());
+        return false;
+    }
+
+    // The old handle still points at the replaced file
+    board.m_log.Close();
+    return board.m_log.Open(logPath, false);
+}
+
+bool Leaderboards::ReplayLog(Board& board)
+{
+    const std::string logPath = board.m_sPath.substr(0, board.m_sPath.size() - strlen(BOARD_FILE_EXTENSION)) +
+                                BOARD_LOG_EXTENSION;
+    if (!board.m_log.Open(logPath, true)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to open %s", logPath.c_str());
+        return false;
+    }
+
+    std::vector<uint8> log(static_cast<size_t>(board.m_log.Size()));
+    BoardLogHeader header = {};
+    if (log.size() < sizeof(header) || !board.m_log.ReadAt(0, log.data(), log.size())) {
+        return RewriteLog(board);
+    }
+    memcpy(&header, log.data(), sizeof(header));
+    if (header.m_unMagic != BOARD_LOG_MAGIC || header.m_unVersion != BOARD_LOG_VERSION) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring damaged leaderboard log %s", logPath.c_str());
+        return RewriteLog(board);
+    }
+
+    size_t unPos = sizeof(header);
+    uint32 cRecords = 0;
+    while (unPos + sizeof(BoardLogRecord) <= log.size()) {
+        BoardLogRecord record;
+        memcpy(&record, log.data() + unPos, sizeof(record));
+        if (record.m_cDetails > k_cLeaderboardDetailsMax ||
+            record.m_cDetails * sizeof(int32) > log.size() - unPos - sizeof(record)) {
+            break;
+        }
+
+        std::vector<int32> details(record.m_cDetails);
+        if (!details.empty()) {
+            memcpy(details.data(), log.data() + unPos + sizeof(record), details.size() * sizeof(int32));
+        }
+        if (record.m_unCheck != BoardLogCheck(record, details.data())) {
+            break;
+        }
+
+        // The record is the whole entry, so it simply replaces what is there
+        Entry* pEntry = EditEntry(board, record.m_unSteamID, true);
+        pEntry->m_nScore = record.m_nScore;
+        pEntry->m_unStamp = record.m_unStamp;
+        pEntry->m_hUGC = record.m_hUGC;
+        pEntry->m_details = std::move(details);
+        pEntry->m_unVersion = board.m_unNextVersion++;
+        board.m_index.Insert(MakeKey(board, record.m_unSteamID, pEntry->m_nScore, pEntry->m_unStamp));
+        board.m_unLastStamp = std::max(board.m_unLastStamp, record.m_unStamp);
+
+        unPos += sizeof(record) + record.m_cDetails * sizeof(int32);
+        ++cRecords;
+    }
+
+    // A torn record from a crash mid-append
+    if (unPos < log.size()) {
+        VLOG_WARNING(__FUNCTION__ " - Discarding %zu bytes of incomplete records in %s", log.size() - unPos,
+                     logPath.c_str());
+        board.m_log.Truncate(unPos);
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - Replayed %u changes of leaderboard %s", cRecords, board.m_sName.c_str());
+    return true;
+}
+
+SteamLeaderboard_t Leaderboards::OpenBoard(const std::string& name, bool bCreate, ELeaderboardSortMethod eSortMethod,
+                                           ELeaderboardDisplayType eDisplayType)
+{
+    const Config& config = Config::GetInstance();
+    char boardFile[64];
+    snprintf(boardFile, sizeof(boardFile), "%u/%s/%016llx", config.GameID().AppID(), LEADERBOARD_DIRECTORY,
+             static_cast<unsigned long long>(HashBytes64(name.data(), name.size())));
+
+    auto pBoard = std::make_unique<Board>();
+    pBoard->m_sName = name;
+    pBoard->m_sPath = std::string(config.GetString(KEY_STATS_DIRECTORY, DEFAULT_STATS_DIRECTORY)) + "/" + boardFile +
+                      BOARD_FILE_EXTENSION;
+
+    auto pFile = std::make_shared<BoardFile>();
+    bool bOpened = pFile->Open(pBoard->m_sPath) && pFile->m_sName == name;
+    if (!bOpened && pFile->m_file.IsOpen()) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring damaged leaderboard file %s", pBoard->m_sPath.c_str());
+    }
+
+    if (bOpened) {
+        pBoard->m_eSortMethod = static_cast<ELeaderboardSortMethod>(pFile->m_header.m_unSortMethod);
+        pBoard->m_eDisplayType = static_cast<ELeaderboardDisplayType>(pFile->m_header.m_unDisplayType);
+        pBoard->m_unLastStamp = pFile->m_header.m_unLastStamp;
+    } else {
+        if (!bCreate) {
+            return 0;
+        }
+
+        // An empty file, so the board is found in later sessions too
+        pBoard->m_eSortMethod = eSortMethod;
+        pBoard->m_eDisplayType = eDisplayType;
+        pFile = std::make_shared<BoardFile>();
+        if (!WriteBoardFile(*pBoard, 0, nullptr, {}, {}) || !pFile->Open(pBoard->m_sPath)) {
+            VLOG_ERROR(__FUNCTION__ " - Failed to create %s", pBoard->m_sPath.c_str());
+            return 0;
+        }
+    }
+    pBoard->m_pFile = std::move(pFile);
+
+    if (!ReplayLog(*pBoard)) {
+        return 0;
+    }
+
+    m_boards.push_back(std::move(pBoard));
+    SteamLeaderboard_t hLeaderboard = m_boards.size();
+    m_names.emplace(name, hLeaderboard);
+
+    VLOG_INFO(__FUNCTION__ " - %s leaderboard %s as %llu: %u entries, %zu changed since its file was written",
+              bOpened ? "Opened" : "Created", name.c_str(), hLeaderboard, GetCount(*m_boards.back()),
+              m_boards.back()->m_changed.size());
+    return hLeaderboard;
+}
+
+SteamLeaderboard_t Leaderboards::Find(const char* pchName)
+{
+    if (!pchName || !*pchName || strlen(pchName) >= k_cchLeaderboardNameMax) {
+        return 0;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    auto it = m_names.find(pchName);
+    if (it != m_names.end()) {
+        return it->second;
+    }
+    return OpenBoard(pchName, false, k_ELeaderboardSortMethodNone, k_ELeaderboardDisplayTypeNone);
+}
+
+SteamLeaderboard_t Leaderboards::FindOrCreate(const char* pchName, ELeaderboardSortMethod eSortMethod,
+                                              ELeaderboardDisplayType eDisplayType)
+{
+    if (!pchName || !*pchName || strlen(pchName) >= k_cchLeaderboardNameMax) {
+        return 0;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    auto it = m_names.find(pchName);
+    if (it != m_names.end()) {
+        return it->second;
+    }
+
+    // An existing board keeps the sort and display it was created with
+    return OpenBoard(pchName, true,
+                     eSortMethod == k_ELeaderboardSortMethodAscending ? k_ELeaderboardSortMethodAscending
+                                                                      : k_ELeaderboardSortMethodDescending,
+                     eDisplayType == k_ELeaderboardDisplayTypeNone ? k_ELeaderboardDisplayTypeNumeric : eDisplayType);
+}
+
+const char* Leaderboards::GetName(SteamLeaderboard_t hLeaderboard)
+{
+    // Boards are never removed, so the name outlives the lock
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    return pBoard ? pBoard->m_sName.c_str() : "";
+}
+
+int Leaderboards::GetEntryCount(SteamLeaderboard_t hLeaderboard)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    return pBoard ? static_cast<int>(GetCount(*pBoard)) : 0;
+}
+
+ELeaderboardSortMethod Leaderboards::GetSortMethod(SteamLeaderboard_t hLeaderboard)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    return pBoard ? pBoard->m_eSortMethod : k_ELeaderboardSortMethodNone;
+}
+
+ELeaderboardDisplayType Leaderboards::GetDisplayType(SteamLeaderboard_t hLeaderboard)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    return pBoard ? pBoard->m_eDisplayType : k_ELeaderboardDisplayTypeNone;
+}
+
+uint32 Leaderboards::GetCount(const Board& board)
+{
+    return board.m_pFile->m_cEntries - static_cast<uint32>(board.m_replaced.size()) + board.m_index.Size();
+}
+
+uint32 Leaderboards::CountFileRowsBefore(const Board& board, const LeaderboardIndex::Key& key)
+{
+    // Binary search over the file columns, so only the pages on its path are read
+    const BoardFile& file = *board.m_pFile;
+    uint32 unFirst = 0;
+    uint32 cRows = file.m_cEntries;
+    while (cRows > 0) {
+        uint32 cHalf = cRows / 2;
+        if (MakeFileKey(board, file, unFirst + cHalf) < key) {
+            unFirst += cHalf + 1;
+            cRows -= cHalf + 1;
+        } else {
+            cRows = cHalf;
+        }
+    }
+
+    auto itReplaced = std::lower_bound(board.m_replaced.begin(), board.m_replaced.end(), unFirst);
+    return unFirst - static_cast<uint32>(itReplaced - board.m_replaced.begin());
+}
+
+uint32 Leaderboards::GetRank(const Board& board, uint64 unSteamID)
+{
+    auto it = board.m_changed.find(unSteamID);
+    if (it != board.m_changed.end()) {
+        LeaderboardIndex::Key key = MakeKey(board, unSteamID, it->second.m_nScore, it->second.m_unStamp);
+        return CountFileRowsBefore(board, key) + board.m_index.CountLess(key) + 1;
+    }
+
+    const BoardFile& file = *board.m_pFile;
+    uint32 unRow = file.FindUser(unSteamID);
+    if (unRow == NO_ROW) {
+        return 0;
+    }
+    auto itReplaced = std::lower_bound(board.m_replaced.begin(), board.m_replaced.end(), unRow);
+    return unRow - static_cast<uint32>(itReplaced - board.m_replaced.begin()) +
+           board.m_index.CountLess(MakeFileKey(board, file, unRow)) + 1;
+}
+
+bool Leaderboards::GetRow(const Board& board, uint64 unSteamID, Row& row)
+{
+    row = Row();
+    row.m_unSteamID = unSteamID;
+
+    auto it = board.m_changed.find(unSteamID);
+    if (it != board.m_changed.end()) {
+        row.m_nScore = it->second.m_nScore;
+        row.m_hUGC = it->second.m_hUGC;
+        row.m_details = it->second.m_details;
+    } else {
+        const BoardFile& file = *board.m_pFile;
+        uint32 unRow = file.FindUser(unSteamID);
+        if (unRow == NO_ROW) {
+            return false;
+        }
+        row.m_nScore = file.m_pScores[unRow];
+        row.m_hUGC = file.m_pUGC[unRow];
+        file.GetDetails(unRow, row.m_details);
+    }
+
+    row.m_nGlobalRank = static_cast<int32>(GetRank(board, unSteamID));
+    return true;
+}
+
+void Leaderboards::AppendRows(const Board& board, uint32 unRank, uint32 cCount, std::vector<Row>& rows)
+{
+    const BoardFile& file = *board.m_pFile;
+    const uint32 unPosition = unRank - 1;
+
+    // How many changed entries come before the first row: the position of
+    // the t-th of them is t plus the file rows before it, which only grows
+    // with t, so a binary search over t finds it
+    uint32 unLow = 0;
+    uint32 unHigh = std::min(board.m_index.Size(), unPosition);
+    std::vector<LeaderboardIndex::Key> keys;
+    while (unLow < unHigh) {
+        uint32 unMid = unLow + (unHigh - unLow) / 2;
+        keys.clear();
+        board.m_index.Range(unMid + 1, 1, keys);
+        if (unMid + CountFileRowsBefore(board, keys[0]) < unPosition) {
+            unLow = unMid + 1;
+        } else {
+            unHigh = unMid;
+        }
+    }
+
+    // The file row the rest starts at: skip as many rows as the replaced ones
+    // up to it, until that no longer moves it
+    const uint32 unFileIndex = unPosition - unLow;
+    uint32 unRow = unFileIndex;
+    for (uint32 cSkipped = 0;;) {
+        auto itReplaced = std::upper_bound(board.m_replaced.begin(), board.m_replaced.end(), unRow);
+        uint32 cReplaced = static_cast<uint32>(itReplaced - board.m_replaced.begin());
+        if (cReplaced == cSkipped) {
+            break;
+        }
+        cSkipped = cReplaced;
+        unRow = unFileIndex + cSkipped;
+    }
+
+    keys.clear();
+    board.m_index.Range(unLow + 1, cCount, keys);
+    auto itReplaced = std::lower_bound(board.m_replaced.begin(), board.m_replaced.end(), unRow);
+    size_t iKey = 0;
+
+    rows.reserve(rows.size() + cCount);
+    for (; cCount > 0; --cCount) {
+        while (itReplaced != board.m_replaced.end() && *itReplaced == unRow) {
+            ++itReplaced;
+            ++unRow;
+        }
+
+        Row row;
+        row.m_nGlobalRank = static_cast<int32>(unRank++);
+        if (unRow < file.m_cEntries && (iKey == keys.size() || MakeFileKey(board, file, unRow) < keys[iKey])) {
+            row.m_unSteamID = file.m_pSteamIDs[unRow];
+            row.m_nScore = file.m_pScores[unRow];
+            row.m_hUGC = file.m_pUGC[unRow];
+            file.GetDetails(unRow, row.m_details);
+            ++unRow;
+        } else if (iKey < keys.size()) {
+            const Entry& entry = board.m_changed.at(keys[iKey].m_unSteamID);
+            row.m_unSteamID = keys[iKey++].m_unSteamID;
+            row.m_nScore = entry.m_nScore;
+            row.m_hUGC = entry.m_hUGC;
+            row.m_details = entry.m_details;
+        } else {
+            break;
+        }
+        rows.push_back(std::move(row));
+    }
+}
+
+Leaderboards::Entry* Leaderboards::EditEntry(Board& board, uint64 unSteamID, bool bCreate)
+{
+    auto it = board.m_changed.find(unSteamID);
+    if (it != board.m_changed.end()) {
+        Entry& entry = it->second;
+        board.m_index.Erase(MakeKey(board, unSteamID, entry.m_nScore, entry.m_unStamp));
+        return &entry;
+    }
+
+    const BoardFile& file = *board.m_pFile;
+    uint32 unRow = file.FindUser(unSteamID);
+    if (unRow == NO_ROW && !bCreate) {
+        return nullptr;
+    }
+
+    Entry entry;
+    if (unRow != NO_ROW) {
+        entry.m_nScore = file.m_pScores[unRow];
+        entry.m_unStamp = file.m_pStamps[unRow];
+        entry.m_hUGC = file.m_pUGC[unRow];
+        file.GetDetails(unRow, entry.m_details);
+        entry.m_unFileRow = unRow;
+        board.m_replaced.insert(std::lower_bound(board.m_replaced.begin(), board.m_replaced.end(), unRow), unRow);
+    }
+    return &board.m_changed.emplace(unSteamID, std::move(entry)).first->second;
+}
+
+void Leaderboards::CommitEntry(Board& board, uint64 unSteamID, Entry& entry)
+{
+    entry.m_unVersion = board.m_unNextVersion++;
+    board.m_index.Insert(MakeKey(board, unSteamID, entry.m_nScore, entry.m_unStamp));
+
+    // Left to the OS cache: a crash loses at most the latest changes, and the
+    // record checks keep a torn one from being replayed
+    std::vector<uint8> record;
+    EncodeLogRecord(unSteamID, entry, record);
+    if (!board.m_log.Append(record.data(), record.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to log a change to leaderboard %s", board.m_sName.c_str());
+    }
+
+    if (board.m_changed.size() >= LEADERBOARD_MERGE_ENTRIES && !board.m_bMergeQueued && !m_bStop) {
+        board.m_bMergeQueued = true;
+        m_mergeQueue.push_back(&board);
+        if (!m_mergeThread.joinable()) {
+            m_mergeThread = std::thread(&Leaderboards::MergeThread, this);
+        }
+        m_mergeCondition.notify_all();
+    }
+}
+
+bool Leaderboards::Upload(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, ELeaderboardUploadScoreMethod eMethod,
+                          int32 nScore, const int32* pDetails, int cDetails, UploadResult& result)
+{
+    if (cDetails < 0 || cDetails > k_cLeaderboardDetailsMax || (cDetails > 0 && !pDetails)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    if (!pBoard) {
+        return false;
+    }
+
+    Row current;
+    bool bHasEntry = GetRow(*pBoard, unSteamID, current);
+    result.m_nGlobalRankPrevious = bHasEntry ? current.m_nGlobalRank : 0;
+
+    // KeepBest leaves a worse or equal score alone (its details too)
+    if (bHasEntry && eMethod != k_ELeaderboardUploadScoreMethodForceUpdate &&
+        !IsBetter(*pBoard, nScore, current.m_nScore)) {
+        result.m_bScoreChanged = false;
+        result.m_nGlobalRankNew = result.m_nGlobalRankPrevious;
+        return true;
+    }
+    result.m_bScoreChanged = !bHasEntry || current.m_nScore != nScore;
+
+    // A new upload ranks after earlier uploads of the same score
+    uint64 unNow = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch()).count();
+    pBoard->m_unLastStamp = std::max(unNow, pBoard->m_unLastStamp + 1);
+
+    Entry* pEntry = EditEntry(*pBoard, unSteamID, true);
+    pEntry->m_nScore = nScore;
+    pEntry->m_unStamp = pBoard->m_unLastStamp;
+    pEntry->m_details.assign(pDetails, pDetails + cDetails);
+    CommitEntry(*pBoard, unSteamID, *pEntry);
+
+    result.m_nGlobalRankNew = static_cast<int32>(GetRank(*pBoard, unSteamID));
+    return true;
+}
+
+bool Leaderboards::AttachUGC(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, UGCHandle_t hUGC)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    if (!pBoard) {
+        return false;
+    }
+
+    Entry* pEntry = EditEntry(*pBoard, unSteamID, false);
+    if (!pEntry) {
+        return false;
+    }
+    pEntry->m_hUGC = hUGC;
+    CommitEntry(*pBoard, unSteamID, *pEntry);
+    return true;
+}
+
+bool Leaderboards::GetRange(SteamLeaderboard_t hLeaderboard, int nRankStart, int nRankEnd, std::vector<Row>& rows)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    if (!pBoard) {
+        return false;
+    }
+
+    int64 nFirst = std::max(nRankStart, 1);
+    int64 nLast = std::min<int64>(nRankEnd, GetCount(*pBoard));
+    if (nFirst <= nLast) {
+        AppendRows(*pBoard, static_cast<uint32>(nFirst), static_cast<uint32>(nLast - nFirst + 1), rows);
+    }
+    return true;
+}
+
+bool Leaderboards::GetAroundUser(SteamLeaderboard_t hLeaderboard, uint64 unSteamID, int nStart, int nEnd,
+                                 std::vector<Row>& rows)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    if (!pBoard) {
+        return false;
+    }
+
+    // A user without an entry gets no rows
+    const int64 nRank = GetRank(*pBoard, unSteamID);
+    if (nRank == 0 || nStart > nEnd) {
+        return true;
+    }
+
+    const int64 cEntries = GetCount(*pBoard);
+    const int64 cWanted = std::min<int64>(static_cast<int64>(nEnd) - nStart + 1, cEntries);
+
+    // Near the top or the bottom the window slides so it still holds as many rows
+    int64 nFirst = nRank + nStart;
+    nFirst = std::min(nFirst, cEntries - cWanted + 1);
+    nFirst = std::max<int64>(nFirst, 1);
+    AppendRows(*pBoard, static_cast<uint32>(nFirst), static_cast<uint32>(cWanted), rows);
+    return true;
+}
+
+bool Leaderboards::GetUsers(SteamLeaderboard_t hLeaderboard, const uint64* pSteamIDs, int cUsers,
+                            std::vector<Row>& rows)
+{
+    if (cUsers < 0 || cUsers > MAX_LEADERBOARD_USERS || (cUsers > 0 && !pSteamIDs)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    Board* pBoard = GetBoard(hLeaderboard);
+    if (!pBoard) {
+        return false;
+    }
+
+    for (int i = 0; i < cUsers; ++i) {
+        const uint64 unSteamID = pSteamIDs[i];
+        if (std::any_of(rows.begin(), rows.end(), [unSteamID](const Row& row) { return row.m_unSteamID == unSteamID; })) {
+            continue;
+        }
+        Row row;
+        if (GetRow(*pBoard, unSteamID, row)) {
+            rows.push_back(std::move(row));
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.m_nGlobalRank < b.m_nGlobalRank; });
+    return true;
+}
+
+SteamLeaderboardEntries_t Leaderboards::AddDownload(std::vector<Row>&& rows)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (m_downloads.size() >= MAX_LEADERBOARD_DOWNLOADS) {
+        m_downloads.pop_front();
+    }
+    m_downloads.push_back(Download{ m_hNextEntries++, std::move(rows) });
+    return m_downloads.back().m_hEntries;
+}
+
+bool Leaderboards::GetDownloadedEntry(SteamLeaderboardEntries_t hEntries, int nIndex, Row& row)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    for (const Download& download : m_downloads) {
+        if (download.m_hEntries != hEntries) {
+            continue;
+        }
+        if (nIndex < 0 || static_cast<size_t>(nIndex) >= download.m_rows.size()) {
+            return false;
+        }
+        row = download.m_rows[nIndex];
+        return true;
+    }
+    return false;
+}
+
+void Leaderboards::MergeThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    for (;;) {
+        m_mergeCondition.wait(lock, [this]() { return !m_mergeQueue.empty() || m_bStop; });
+        if (m_bStop) {
+            break;
+        }
+
+        Board* pBoard = m_mergeQueue.front();
+        m_mergeQueue.pop_front();
+        bool bMerged = MergeBoard(*pBoard, lock);
+        pBoard->m_bMergeQueued = false;
+
+        // Enough may have changed during the merge to start over
+        if (bMerged && pBoard->m_changed.size() >= LEADERBOARD_MERGE_ENTRIES) {
+            pBoard->m_bMergeQueued = true;
+            m_mergeQueue.push_back(pBoard);
+        }
+    }
+}
+
+bool Leaderboards::MergeBoard(Board& board, std::unique_lock<VaporCore::Mutex>& lock)
+{
+    // Snapshot under the lock; the file is immutable, so it is shared as is
+    std::shared_ptr<const BoardFile> pFile = board.m_pFile;
+    std::vector<uint32> replaced = board.m_replaced;
+    const uint64 unLastStamp = board.m_unLastStamp;
+
+    std::vector<LeaderboardIndex::Key> keys;
+    board.m_index.Range(1, board.m_index.Size(), keys);
+    std::vector<MergeEntry> changed;
+    changed.reserve(keys.size());
+    for (const LeaderboardIndex::Key& key : keys) {
+        changed.push_back(MergeEntry{ key, board.m_changed.at(key.m_unSteamID) });
+    }
+
+    // Uploads carry on against the old file and the log meanwhile
+    lock.unlock();
+    auto pMerged = std::make_shared<BoardFile>();
+    bool bWritten = WriteBoardFile(board, unLastStamp, pFile.get(), replaced, changed) && pMerged->Open(board.m_sPath);
+    lock.lock();
+
+    if (!bWritten) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to merge leaderboard %s into %s", board.m_sName.c_str(),
+                   board.m_sPath.c_str());
+        return false;
+    }
+
+    // Entries not touched since the snapshot are in the new file now; the
+    // others replace their new rows instead
+    board.m_pFile = pMerged;
+    for (const MergeEntry& merge : changed) {
+        auto it = board.m_changed.find(merge.m_key.m_unSteamID);
+        if (it != board.m_changed.end() && it->second.m_unVersion == merge.m_entry.m_unVersion) {
+            board.m_index.Erase(merge.m_key);
+            board.m_changed.erase(it);
+        }
+    }
+
+    board.m_replaced.clear();
+    for (auto& [unSteamID, entry] : board.m_changed) {
+        entry.m_unFileRow = pMerged->FindUser(unSteamID);
+        if (entry.m_unFileRow != NO_ROW) {
+            board.m_replaced.push_back(entry.m_unFileRow);
+        }
+    }
+    std::sort(board.m_replaced.begin(), board.m_replaced.end());
+
+    // Replaying the old log over the new file would only repeat what it holds,
+    // so a failure here loses nothing
+    RewriteLog(board);
+
+    VLOG_INFO(__FUNCTION__ " - Merged %zu changes into leaderboard %s: %u entries, %zu changed since", changed.size(),
+              board.m_sName.c_str(), pMerged->m_cEntries, board.m_changed.size());
+    return true;
+}
+
+void Leaderboards::Shutdown()
+{
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_bStop = true;
+        m_mergeQueue.clear();
+    }
+    m_mergeCondition.notify_all();
+
+    if (m_mergeThread.joinable()) {
+        m_mergeThread.join();
+    }
+}
+
+void Leaderboards::ShutdownAll()
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    for (Leaderboards* pLeaderboards : s_instances) {
+        pLeaderboards->Shutdown();
+    }
+}
+
+} // namespace VaporCore
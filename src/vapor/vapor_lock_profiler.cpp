@@ -0,0 +1,192 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Lock contention profiler implementation
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "vapor_lock_profiler.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+#ifdef VAPORCORE_ENABLE_LOCK_PROFILING
+
+static const char* const UNKNOWN_LOCK_SITE = "<unknown>";
+
+ProfiledMutexBase::ProfiledMutexBase(const char* pchName)
+    : m_pchName(pchName),
+      m_unAcquisitions(0),
+      m_unContendedAcquisitions(0),
+      m_unTotalWaitNs(0),
+      m_unMaxHoldNs(0),
+      m_pchMaxHoldSite(nullptr),
+      m_unDepth(0),
+      m_pchCurrentSite(nullptr)
+{
+    LockProfiler::GetInstance().Register(this);
+}
+
+ProfiledMutexBase::~ProfiledMutexBase()
+{
+    LockProfiler::GetInstance().Unregister(this);
+}
+
+void ProfiledMutexBase::OnAcquired(std::chrono::steady_clock::duration wait, bool bContended, const char* pchSite)
+{
+    // Re-entrant acquisition of a recursive mutex, only the outermost one counts
+    if (m_unDepth++ > 0) {
+        return;
+    }
+
+    m_acquiredAt = std::chrono::steady_clock::now();
+    m_pchCurrentSite = pchSite ? pchSite : UNKNOWN_LOCK_SITE;
+
+    m_unAcquisitions.store(m_unAcquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (bContended) {
+        uint64 waitNs = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+        m_unContendedAcquisitions.store(m_unContendedAcquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_unTotalWaitNs.store(m_unTotalWaitNs.load(std::memory_order_relaxed) + waitNs, std::memory_order_relaxed);
+    }
+}
+
+void ProfiledMutexBase::OnReleasing()
+{
+    if (--m_unDepth > 0) {
+        return;
+    }
+
+    uint64 holdNs = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_acquiredAt).count());
+
+    if (holdNs > m_unMaxHoldNs.load(std::memory_order_relaxed)) {
+        m_unMaxHoldNs.store(holdNs, std::memory_order_relaxed);
+        m_pchMaxHoldSite.store(m_pchCurrentSite, std::memory_order_relaxed);
+    }
+}
+
+LockStats ProfiledMutexBase::GetStats() const
+{
+    const char* pchSite = m_pchMaxHoldSite.load(std::memory_order_relaxed);
+
+    LockStats stats;
+    stats.m_sName = m_pchName;
+    stats.m_unAcquisitions = m_unAcquisitions.load(std::memory_order_relaxed);
+    stats.m_unContendedAcquisitions = m_unContendedAcquisitions.load(std::memory_order_relaxed);
+    stats.m_unTotalWaitNs = m_unTotalWaitNs.load(std::memory_order_relaxed);
+    stats.m_unMaxHoldNs = m_unMaxHoldNs.load(std::memory_order_relaxed);
+    stats.m_sMaxHoldSite = pchSite ? pchSite : "";
+    return stats;
+}
+
+void ProfiledMutexBase::ResetStats()
+{
+    m_unAcquisitions.store(0, std::memory_order_relaxed);
+    m_unContendedAcquisitions.store(0, std::memory_order_relaxed);
+    m_unTotalWaitNs.store(0, std::memory_order_relaxed);
+    m_unMaxHoldNs.store(0, std::memory_order_relaxed);
+    m_pchMaxHoldSite.store(nullptr, std::memory_order_relaxed);
+}
+
+void LockProfiler::Register(ProfiledMutexBase* pMutex)
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    m_mutexes.push_back(pMutex);
+}
+
+void LockProfiler::Unregister(ProfiledMutexBase* pMutex)
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    m_mutexes.erase(std::remove(m_mutexes.begin(), m_mutexes.end(), pMutex), m_mutexes.end());
+}
+
+std::vector<LockStats> LockProfiler::GetSnapshot() const
+{
+    std::vector<LockStats> snapshot;
+
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    snapshot.reserve(m_mutexes.size());
+    for (const ProfiledMutexBase* pMutex : m_mutexes) {
+        snapshot.push_back(pMutex->GetStats());
+    }
+
+    return snapshot;
+}
+
+void LockProfiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (ProfiledMutexBase* pMutex : m_mutexes) {
+        pMutex->ResetStats();
+    }
+}
+
+void LockProfiler::LogReport() const
+{
+    // Snapshot first so the registry lock is not held while logging (the logger takes g_GlobalMutex)
+    std::vector<LockStats> snapshot = GetSnapshot();
+
+    // Most contended locks first
+    std::sort(snapshot.begin(), snapshot.end(), [](const LockStats& a, const LockStats& b) {
+        return a.m_unTotalWaitNs > b.m_unTotalWaitNs;
+    });
+
+    for (const LockStats& stats : snapshot) {
+        // Strip the directory part of __FILE__ to keep the report readable
+        const char* pchSite = stats.m_sMaxHoldSite.c_str();
+        for (const char* pch = pchSite; *pch; ++pch) {
+            if (*pch == '/' || *pch == '\\') {
+                pchSite = pch + 1;
+            }
+        }
+
+        double contendedPct = stats.m_unAcquisitions
+            ? 100.0 * static_cast<double>(stats.m_unContendedAcquisitions) / static_cast<double>(stats.m_unAcquisitions)
+            : 0.0;
+
+        char line[512];
+        snprintf(line, sizeof(line),
+                 "Lock profile [%s]: acquisitions=%llu, contended=%llu (%.2f%%), total wait=%.3f ms, max hold=%.3f ms at %s",
+                 stats.m_sName.c_str(),
+                 static_cast<unsigned long long>(stats.m_unAcquisitions),
+                 static_cast<unsigned long long>(stats.m_unContendedAcquisitions),
+                 contendedPct,
+                 static_cast<double>(stats.m_unTotalWaitNs) / 1e6,
+                 static_cast<double>(stats.m_unMaxHoldNs) / 1e6,
+                 pchSite);
+
+#ifdef VAPORCORE_ENABLE_LOGGING
+        VLOG_INFO(std::string(line));
+#else
+        // Profiling builds may have logging compiled out, fall back to stderr
+        fprintf(stderr, "%s\n", line);
+#endif
+    }
+}
+
+#else
+
+std::vector<LockStats> LockProfiler::GetSnapshot() const
+{
+    return {};
+}
+
+void LockProfiler::LogReport() const
+{
+}
+
+void LockProfiler::Reset()
+{
+}
+
+#endif // VAPORCORE_ENABLE_LOCK_PROFILING
+
+} // namespace VaporCore
@@ -0,0 +1,167 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Read-only memory-mapped file view implementation
+ */
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vapor_mapped_file.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+MappedFile::MappedFile() noexcept
+    : m_pData(nullptr),
+      m_unSize(0),
+      m_bOpen(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_pData(std::exchange(other.m_pData, nullptr)),
+      m_unSize(std::exchange(other.m_unSize, 0)),
+      m_bOpen(std::exchange(other.m_bOpen, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        m_pData = std::exchange(other.m_pData, nullptr);
+        m_unSize = std::exchange(other.m_unSize, 0);
+        m_bOpen = std::exchange(other.m_bOpen, false);
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    if (fileSize.QuadPart > 0) {
+        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!hMapping) {
+            VLOG_ERROR(__FUNCTION__ " - CreateFileMapping failed for %s: %lu", path.c_str(), GetLastError());
+            CloseHandle(hFile);
+            return false;
+        }
+
+        // The view keeps the mapping object alive after its handle is closed
+        m_pData = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(hMapping);
+        if (!m_pData) {
+            VLOG_ERROR(__FUNCTION__ " - MapViewOfFile failed for %s: %lu", path.c_str(), GetLastError());
+            CloseHandle(hFile);
+            return false;
+        }
+    }
+
+    CloseHandle(hFile);
+    m_unSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_size > 0) {
+        void* pMapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapping == MAP_FAILED) {
+            VLOG_ERROR(__FUNCTION__ " - mmap failed for %s", path.c_str());
+            close(fd);
+            return false;
+        }
+        m_pData = static_cast<const char*>(pMapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    m_unSize = static_cast<size_t>(st.st_size);
+#endif
+
+    m_bOpen = true;
+    return true;
+}
+
+void MappedFile::Close() noexcept
+{
+    if (m_pData) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_pData);
+#else
+        munmap(const_cast<char*>(m_pData), m_unSize);
+#endif
+    }
+
+    m_pData = nullptr;
+    m_unSize = 0;
+    m_bOpen = false;
+}
+
+void MappedFile::Advise(AccessPattern pattern) const noexcept
+{
+    if (!m_pData) {
+        return;
+    }
+
+#ifdef _WIN32
+    // Windows has no madvise; prefetch the whole view for WillNeed/Sequential
+    if (pattern == AccessPattern::WillNeed || pattern == AccessPattern::Sequential) {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<char*>(m_pData);
+        range.NumberOfBytes = m_unSize;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    int advice = MADV_NORMAL;
+    switch (pattern) {
+        case AccessPattern::Normal:     advice = MADV_NORMAL; break;
+        case AccessPattern::Sequential: advice = MADV_SEQUENTIAL; break;
+        case AccessPattern::Random:     advice = MADV_RANDOM; break;
+        case AccessPattern::WillNeed:   advice = MADV_WILLNEED; break;
+    }
+    madvise(const_cast<char*>(m_pData), m_unSize, advice);
+#endif
+}
+
+} // namespace VaporCore
@@ -0,0 +1,531 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Packed, log-structured storage layout
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+#include "vapor_packed_storage.h"
+#include "vapor_mapped_file.h"
+#include "vapor_hash.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Container format: a header, then records until the end of the file. All
+// fields are host byte order, containers are local to the machine.
+static const uint32 PACKED_CONTAINER_MAGIC = 0x4b504356;    // "VCPK"
+static const uint32 PACKED_CONTAINER_VERSION = 1;
+static const uint32 PACKED_RECORD_MAGIC = 0x52504356;       // "VCPR"
+
+// Record types
+static const uint32 PACKED_RECORD_PUT = 1;
+static const uint32 PACKED_RECORD_DELETE = 2;
+
+// Sanity bound for names read back from a container
+static const uint32 PACKED_MAX_NAME_LENGTH = 4096;
+
+// Compaction never runs for less garbage than this, whatever the ratio
+static const uint64 PACKED_COMPACT_MIN_GARBAGE = 1ULL * 1024 * 1024;
+
+struct PackedContainerHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint64 m_unReserved;
+};
+
+struct PackedRecordHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unType;
+    uint32 m_unNameLength;
+    uint32 m_unReserved;
+    uint64 m_unDataSize;
+    int64 m_nTimestamp;
+    uint64 m_unChecksum;    // Over the fields above, the name and the data
+};
+
+static_assert(sizeof(PackedContainerHeader) == 16, "Packed container header layout changed");
+static_assert(sizeof(PackedRecordHeader) == 40, "Packed record header layout changed");
+
+static uint64 RecordChecksum(const PackedRecordHeader& header, const char* pchName, const void* pData)
+{
+    uint64 hash = HashBytes64(&header, offsetof(PackedRecordHeader, m_unChecksum));
+    hash = HashBytes64(pchName, header.m_unNameLength, hash);
+    return HashBytes64(pData, static_cast<size_t>(header.m_unDataSize), hash);
+}
+
+static int64 CurrentUnixTime()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static bool WriteContainerHeader(RandomAccessFile& file)
+{
+    PackedContainerHeader header = {};
+    header.m_unMagic = PACKED_CONTAINER_MAGIC;
+    header.m_unVersion = PACKED_CONTAINER_VERSION;
+    return file.Append(&header, sizeof(header)) && file.Sync();
+}
+
+PackedFileBackend::PackedFileBackend(const std::string& directory, uint32 unCompactGarbagePercent)
+    : m_sDirectory(directory),
+      m_sContainerPath(directory + "/" + PACKED_CONTAINER_FILENAME),
+      m_unGarbageBytes(0),
+      m_unCompactGarbagePercent(unCompactGarbagePercent),
+      m_bDeferSync(false),
+      m_bStopCompaction(false),
+      m_bCompacting(false)
+{
+}
+
+PackedFileBackend::~PackedFileBackend()
+{
+    if (m_compactionThread.joinable()) {
+        {
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            m_bStopCompaction = true;
+        }
+        m_compactionCondition.notify_all();
+        m_compactionThread.join();
+    }
+}
+
+bool PackedFileBackend::Exists(const std::string& directory)
+{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(directory + "/" + PACKED_CONTAINER_FILENAME, ec);
+}
+
+bool PackedFileBackend::Open()
+{
+    // Leftovers of an interrupted compaction or write stream
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_sDirectory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(PACKED_CONTAINER_FILENAME, 0) == 0 && entry.path().extension() == FILE_IO_TEMP_SUFFIX) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+
+    auto pFile = std::make_shared<RandomAccessFile>();
+    if (!pFile->Open(m_sContainerPath, true)) {
+        return false;
+    }
+    if (pFile->Size() == 0 && !WriteContainerHeader(*pFile)) {
+        return false;
+    }
+
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_pFile = std::move(pFile);
+        if (!Load()) {
+            m_pFile.reset();
+            return false;
+        }
+    }
+
+    m_compactionThread = std::thread(&PackedFileBackend::CompactionThread, this);
+    return true;
+}
+
+bool PackedFileBackend::Load()
+{
+    PackedContainerHeader containerHeader;
+    if (!m_pFile->ReadAt(0, &containerHeader, sizeof(containerHeader)) ||
+        containerHeader.m_unMagic != PACKED_CONTAINER_MAGIC || containerHeader.m_unVersion != PACKED_CONTAINER_VERSION) {
+        VLOG_ERROR(__FUNCTION__ " - Not a supported container: %s", m_sContainerPath.c_str());
+        return false;
+    }
+
+    m_index.clear();
+    m_unGarbageBytes = 0;
+
+    uint64 unValidEnd = sizeof(PackedContainerHeader);
+    {
+        MappedFile mapped;
+        if (!mapped.Open(m_sContainerPath)) {
+            return false;
+        }
+        mapped.Advise(MappedFile::AccessPattern::Sequential);
+
+        const char* pBase = mapped.Data();
+        uint64 unSize = mapped.Size();
+        uint64 unPos = unValidEnd;
+
+        while (unPos + sizeof(PackedRecordHeader) <= unSize) {
+            PackedRecordHeader header;
+            memcpy(&header, pBase + unPos, sizeof(header));
+
+            uint64 unRemaining = unSize - unPos - sizeof(header);
+            if (header.m_unMagic != PACKED_RECORD_MAGIC || header.m_unNameLength == 0 ||
+                header.m_unNameLength > PACKED_MAX_NAME_LENGTH || header.m_unNameLength > unRemaining ||
+                header.m_unDataSize > unRemaining - header.m_unNameLength) {
+                break;
+            }
+
+            const char* pchName = pBase + unPos + sizeof(header);
+            const char* pData = pchName + header.m_unNameLength;
+            if (RecordChecksum(header, pchName, pData) != header.m_unChecksum) {
+                break;
+            }
+
+            std::string name(pchName, header.m_unNameLength);
+            uint64 unRecordSize = RecordSize(name, header.m_unDataSize);
+
+            auto it = m_index.find(name);
+            if (it != m_index.end()) {
+                m_unGarbageBytes += RecordSize(name, it->second.m_unSize);
+            }
+
+            if (header.m_unType == PACKED_RECORD_PUT) {
+                IndexEntry& entry = m_index[name];
+                entry.m_unRecordOffset = unPos;
+                entry.m_unDataOffset = unPos + sizeof(header) + header.m_unNameLength;
+                entry.m_unSize = header.m_unDataSize;
+                entry.m_nTimestamp = header.m_nTimestamp;
+            } else {
+                if (it != m_index.end()) {
+                    m_index.erase(it);
+                }
+                m_unGarbageBytes += unRecordSize;
+            }
+
+            unPos += unRecordSize;
+            unValidEnd = unPos;
+        }
+    }
+
+    // A crash in the middle of an append leaves a torn record, everything before it is intact
+    if (unValidEnd < m_pFile->Size()) {
+        VLOG_WARNING(__FUNCTION__ " - Discarding %llu bytes of incomplete records in %s",
+                     m_pFile->Size() - unValidEnd, m_sContainerPath.c_str());
+        if (!m_pFile->Truncate(unValidEnd) || !m_pFile->Sync()) {
+            return false;
+        }
+    }
+
+    VLOG_INFO(__FUNCTION__ " - Loaded %zu files from %s (%llu bytes, %llu garbage)",
+              m_index.size(), m_sContainerPath.c_str(), m_pFile->Size(), m_unGarbageBytes);
+    return true;
+}
+
+uint64 PackedFileBackend::RecordSize(const std::string& name, uint64 unDataSize)
+{
+    return sizeof(PackedRecordHeader) + name.size() + unDataSize;
+}
+
+bool PackedFileBackend::AppendRecord(RandomAccessFile& file, uint32 unType, const std::string& name,
+                                     const void* pData, size_t cubData, int64 nTimestamp, IndexEntry* pEntry)
+{
+    PackedRecordHeader header = {};
+    header.m_unMagic = PACKED_RECORD_MAGIC;
+    header.m_unType = unType;
+    header.m_unNameLength = static_cast<uint32>(name.size());
+    header.m_unDataSize = cubData;
+    header.m_nTimestamp = nTimestamp;
+    header.m_unChecksum = RecordChecksum(header, name.data(), pData);
+
+    std::vector<uint8> prefix(sizeof(header) + name.size());
+    memcpy(prefix.data(), &header, sizeof(header));
+    memcpy(prefix.data() + sizeof(header), name.data(), name.size());
+
+    uint64 unRecordOffset = 0;
+    bool bSuccess = file.Append(prefix.data(), prefix.size(), &unRecordOffset) &&
+                    (cubData == 0 || file.Append(pData, cubData)) &&
+                    (m_bDeferSync || file.Sync());
+    if (!bSuccess) {
+        // Never leave a partial record behind, later records would be unreachable
+        file.Truncate(unRecordOffset);
+        return false;
+    }
+
+    if (pEntry) {
+        pEntry->m_unRecordOffset = unRecordOffset;
+        pEntry->m_unDataOffset = unRecordOffset + prefix.size();
+        pEntry->m_unSize = cubData;
+        pEntry->m_nTimestamp = nTimestamp;
+    }
+    return true;
+}
+
+bool PackedFileBackend::CopyRecord(const RandomAccessFile& from, const IndexEntry& entry, const std::string& name,
+                                   RandomAccessFile& to, IndexEntry& copied)
+{
+    uint64 unRecordSize = RecordSize(name, entry.m_unSize);
+    std::vector<uint8> record(static_cast<size_t>(unRecordSize));
+
+    uint64 unOffset = 0;
+    if (!from.ReadAt(entry.m_unRecordOffset, record.data(), record.size()) ||
+        !to.Append(record.data(), record.size(), &unOffset)) {
+        return false;
+    }
+
+    copied = entry;
+    copied.m_unRecordOffset = unOffset;
+    copied.m_unDataOffset = unOffset + (entry.m_unDataOffset - entry.m_unRecordOffset);
+    return true;
+}
+
+void PackedFileBackend::Enumerate(const EnumerateCallback& callback)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    for (const auto& [name, entry] : m_index) {
+        callback(name, entry.m_unSize, entry.m_nTimestamp);
+    }
+}
+
+bool PackedFileBackend::Stat(const std::string& name, uint64& unSize, int64& nTimestamp)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    auto it = m_index.find(name);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    unSize = it->second.m_unSize;
+    nTimestamp = it->second.m_nTimestamp;
+    return true;
+}
+
+bool PackedFileBackend::Write(const std::string& name, const void* pData, size_t cubData)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (!m_pFile) {
+        return false;
+    }
+
+    IndexEntry entry;
+    if (!AppendRecord(*m_pFile, PACKED_RECORD_PUT, name, pData, cubData, CurrentUnixTime(), &entry)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to append %s to %s", name.c_str(), m_sContainerPath.c_str());
+        return false;
+    }
+
+    auto it = m_index.find(name);
+    if (it != m_index.end()) {
+        m_unGarbageBytes += RecordSize(name, it->second.m_unSize);
+    }
+    m_index[name] = entry;
+
+    if (NeedsCompaction()) {
+        m_compactionCondition.notify_one();
+    }
+    return true;
+}
+
+bool PackedFileBackend::Delete(const std::string& name)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (!m_pFile) {
+        return false;
+    }
+
+    auto it = m_index.find(name);
+    if (it == m_index.end()) {
+        return true;
+    }
+
+    if (!AppendRecord(*m_pFile, PACKED_RECORD_DELETE, name, nullptr, 0, CurrentUnixTime(), nullptr)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to append tombstone for %s", name.c_str());
+        return false;
+    }
+
+    m_unGarbageBytes += RecordSize(name, it->second.m_unSize) + RecordSize(name, 0);
+    m_index.erase(it);
+
+    if (NeedsCompaction()) {
+        m_compactionCondition.notify_one();
+    }
+    return true;
+}
+
+int64 PackedFileBackend::Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax)
+{
+    std::shared_ptr<RandomAccessFile> pFile;
+    IndexEntry entry;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        auto it = m_index.find(name);
+        if (it == m_index.end() || !m_pFile) {
+            return -1;
+        }
+        pFile = m_pFile;
+        entry = it->second;
+    }
+
+    // Records are immutable once written, so the read needs no lock; a
+    // compaction swapping the container meanwhile leaves this handle valid
+    if (unOffset >= entry.m_unSize) {
+        return 0;
+    }
+    size_t bytesToRead = static_cast<size_t>(std::min<uint64>(cubMax, entry.m_unSize - unOffset));
+    if (!pFile->ReadAt(entry.m_unDataOffset + unOffset, pBuffer, bytesToRead)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to read %s from %s", name.c_str(), m_sContainerPath.c_str());
+        return -1;
+    }
+    return static_cast<int64>(bytesToRead);
+}
+
+bool PackedFileBackend::OpenStaged(const std::string&, uint64 unUnique, StagedFile& file)
+{
+    // Staged next to the container, the contents are appended as one record on commit
+    std::string tempPath = m_sContainerPath + "." + std::to_string(unUnique) + FILE_IO_TEMP_SUFFIX;
+    return file.Open(tempPath, tempPath);
+}
+
+bool PackedFileBackend::CommitStaged(const std::string& name, StagedFile& file)
+{
+    MappedFile mapped;
+    bool bSuccess = mapped.Open(file.TempPath());
+    if (bSuccess) {
+        mapped.Advise(MappedFile::AccessPattern::Sequential);
+        bSuccess = Write(name, mapped.Data(), mapped.Size());
+    }
+
+    mapped.Close();
+    file.Discard();
+    return bSuccess;
+}
+
+void PackedFileBackend::RemoveAll()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    m_index.clear();
+    m_unGarbageBytes = 0;
+    m_pFile.reset();
+
+    std::error_code ec;
+    std::filesystem::remove(m_sContainerPath, ec);
+}
+
+bool PackedFileBackend::NeedsCompaction() const
+{
+    if (m_unCompactGarbagePercent == 0 || m_bCompacting || !m_pFile || m_unGarbageBytes < PACKED_COMPACT_MIN_GARBAGE) {
+        return false;
+    }
+    return m_unGarbageBytes * 100 >= m_pFile->Size() * m_unCompactGarbagePercent;
+}
+
+void PackedFileBackend::CompactionThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    for (;;) {
+        m_compactionCondition.wait(lock, [this]() { return m_bStopCompaction || NeedsCompaction(); });
+        if (m_bStopCompaction) {
+            break;
+        }
+
+        lock.unlock();
+        Compact();
+        lock.lock();
+    }
+}
+
+void PackedFileBackend::Compact()
+{
+    std::shared_ptr<RandomAccessFile> pOld;
+    Index snapshot;
+    uint64 unSnapshotEnd;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (!NeedsCompaction()) {
+            return;
+        }
+        m_bCompacting = true;
+        pOld = m_pFile;
+        snapshot = m_index;
+        unSnapshotEnd = pOld->Size();
+    }
+
+    [[maybe_unused]] auto start = std::chrono::steady_clock::now();
+    std::string tempPath = m_sContainerPath + FILE_IO_TEMP_SUFFIX;
+    std::error_code ec;
+    std::filesystem::remove(tempPath, ec);
+
+    // Bulk copy without the lock, writers keep appending to the old container
+    auto pNew = std::make_shared<RandomAccessFile>();
+    Index compacted;
+    bool bSuccess = pNew->Open(tempPath, true) && WriteContainerHeader(*pNew);
+    for (auto it = snapshot.begin(); bSuccess && it != snapshot.end(); ++it) {
+        bSuccess = CopyRecord(*pOld, it->second, it->first, *pNew, compacted[it->first]);
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_bCompacting = false;
+
+    // Catch up with what changed while copying: newer records are copied again,
+    // deleted files get a tombstone in the new container
+    uint64 unGarbage = 0;
+    for (auto it = m_index.begin(); bSuccess && it != m_index.end(); ++it) {
+        if (it->second.m_unRecordOffset >= unSnapshotEnd) {
+            auto previous = compacted.find(it->first);
+            if (previous != compacted.end()) {
+                unGarbage += RecordSize(it->first, previous->second.m_unSize);
+            }
+            bSuccess = CopyRecord(*pOld, it->second, it->first, *pNew, compacted[it->first]);
+        }
+    }
+    for (auto it = compacted.begin(); bSuccess && it != compacted.end();) {
+        if (m_index.find(it->first) == m_index.end()) {
+            unGarbage += RecordSize(it->first, it->second.m_unSize) + RecordSize(it->first, 0);
+            bSuccess = AppendRecord(*pNew, PACKED_RECORD_DELETE, it->first, nullptr, 0, CurrentUnixTime(), nullptr);
+            it = compacted.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    bSuccess = bSuccess && pNew->Sync();
+    if (bSuccess) {
+        std::filesystem::rename(tempPath, m_sContainerPath, ec);
+        bSuccess = !ec;
+    }
+
+    if (!bSuccess) {
+        VLOG_ERROR(__FUNCTION__ " - Compaction of %s failed, keeping the current container", m_sContainerPath.c_str());
+        pNew.reset();
+        std::filesystem::remove(tempPath, ec);
+
+        // Don't retry until more garbage has accumulated
+        m_unGarbageBytes = std::min(m_unGarbageBytes, m_pFile->Size() * m_unCompactGarbagePercent / 200);
+        return;
+    }
+
+    [[maybe_unused]] uint64 unOldSize = pOld->Size();
+    m_pFile = std::move(pNew);
+    m_index = std::move(compacted);
+    m_unGarbageBytes = unGarbage;
+
+    VLOG_INFO(__FUNCTION__ " - Compacted %s: %llu -> %llu bytes in %lld ms", m_sContainerPath.c_str(), unOldSize, m_pFile->Size(),
+              static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+void PackedFileBackend::SetDeferSync(bool bDefer)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    m_bDeferSync = bDefer;
+}
+
+bool PackedFileBackend::Sync()
+{
+    // A compaction swap syncs the new container itself, only the current one can lag
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return !m_pFile || m_pFile->Sync();
+}
+
+} // namespace VaporCore
@@ -0,0 +1,150 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Perfect hash index over a fixed set of names
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "vapor_perfect_hash.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+// Average names per bucket; larger buckets mean fewer seeds but longer searches
+static const uint32 PERFECT_HASH_BUCKET_SIZE = 4;
+
+// Seeds tried per bucket, and hash salts tried, before the build gives up
+static const uint32 PERFECT_HASH_MAX_SEED = 1u << 16;
+static const uint32 PERFECT_HASH_MAX_SALTS = 16;
+
+uint32 PerfectHashIndex::SlotOf(uint64 unHash, uint32 unSeed) const noexcept
+{
+    // The bucket took the low bits, the slot comes from a remix so the two are independent
+    uint64 unMixed = HashMix64(unHash + static_cast<uint64>(unSeed) * 0x9e3779b97f4a7c15ULL);
+    return static_cast<uint32>(((unMixed >> 32) * m_slotIndexes.size()) >> 32);
+}
+
+bool PerfectHashIndex::Build(const std::vector<std::string>& names)
+{
+    Clear();
+
+    std::unordered_set<std::string_view> unique;
+    for (const std::string& name : names) {
+        if (!unique.insert(name).second) {
+            return false;
+        }
+    }
+
+    m_names = names;
+    if (m_names.empty()) {
+        return true;
+    }
+
+    for (uint32 unSalt = 0; unSalt < PERFECT_HASH_MAX_SALTS; ++unSalt) {
+        if (TryBuild(unSalt)) {
+            return true;
+        }
+    }
+
+    Clear();
+    return false;
+}
+
+bool PerfectHashIndex::TryBuild(uint64 unSalt)
+{
+    const uint32 cNames = static_cast<uint32>(m_names.size());
+    m_unSalt = unSalt;
+    m_seeds.assign((cNames + PERFECT_HASH_BUCKET_SIZE - 1) / PERFECT_HASH_BUCKET_SIZE, 0);
+
+    // About 94% full: a minimal table needs far longer seed searches for the last buckets
+    const uint32 cSlots = cNames + cNames / 16 + 1;
+    m_slotIndexes.assign(cSlots, NOT_FOUND);
+    m_slotHashes.assign(cSlots, 0);
+
+    std::vector<uint64> hashes(cNames);
+    std::vector<std::vector<uint32>> buckets(m_seeds.size());
+    for (uint32 i = 0; i < cNames; ++i) {
+        hashes[i] = HashBytes64(m_names[i].data(), m_names[i].size(), m_unSalt);
+        buckets[BucketOf(hashes[i])].push_back(i);
+    }
+
+    // Place the largest buckets first, while most slots are free
+    std::vector<uint32> order(buckets.size());
+    for (uint32 i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32 a, uint32 b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<uint32> slots;
+    for (uint32 unBucket : order) {
+        const std::vector<uint32>& members = buckets[unBucket];
+        if (members.empty()) {
+            break;
+        }
+
+        bool bPlaced = false;
+        for (uint32 unSeed = 0; unSeed < PERFECT_HASH_MAX_SEED && !bPlaced; ++unSeed) {
+            slots.clear();
+            bPlaced = true;
+            for (uint32 unName : members) {
+                uint32 unSlot = SlotOf(hashes[unName], unSeed);
+                if (m_slotIndexes[unSlot] != NOT_FOUND ||
+                    std::find(slots.begin(), slots.end(), unSlot) != slots.end()) {
+                    bPlaced = false;
+                    break;
+                }
+                slots.push_back(unSlot);
+            }
+
+            if (bPlaced) {
+                m_seeds[unBucket] = unSeed;
+                for (size_t i = 0; i < members.size(); ++i) {
+                    m_slotIndexes[slots[i]] = members[i];
+                    m_slotHashes[slots[i]] = hashes[members[i]];
+                }
+            }
+        }
+
+        // Two names with the same hash never separate; a new salt rehashes everything
+        if (!bPlaced) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void PerfectHashIndex::Clear()
+{
+    m_names.clear();
+    m_unSalt = 0;
+    m_seeds.clear();
+    m_slotIndexes.clear();
+    m_slotHashes.clear();
+}
+
+uint32 PerfectHashIndex::Find(std::string_view name) const noexcept
+{
+    if (m_seeds.empty()) {
+        return NOT_FOUND;
+    }
+
+    uint64 unHash = HashBytes64(name.data(), name.size(), m_unSalt);
+    uint32 unSlot = SlotOf(unHash, m_seeds[BucketOf(unHash)]);
+    uint32 unIndex = m_slotIndexes[unSlot];
+    if (unIndex == NOT_FOUND || m_slotHashes[unSlot] != unHash || m_names[unIndex] != name) {
+        return NOT_FOUND;
+    }
+    return unIndex;
+}
+
+} // namespace VaporCore
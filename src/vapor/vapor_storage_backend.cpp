@@ -0,0 +1,364 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: On-disk layouts behind FileStorage
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "vapor_storage_backend.h"
+#include "vapor_packed_storage.h"
+#include "vapor_dedup_storage.h"
+#include "vapor_write_journal.h"
+#include "vapor_access_profile.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_version_history.h"
+#include "vapor_mapped_file.h"
+#include "vapor_hash.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Convert a file system timestamp to Unix seconds
+static int64 ToUnixTime(std::filesystem::file_time_type ftime)
+{
+    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        ftime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+    return std::chrono::duration_cast<std::chrono::seconds>(sctp.time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+// StorageBackend defaults
+//-----------------------------------------------------------------------------
+
+bool StorageBackend::OpenView(const std::string& name, FileView& view)
+{
+    uint64 unSize;
+    int64 nTimestamp;
+    if (!Stat(name, unSize, nTimestamp)) {
+        return false;
+    }
+
+    auto pData = std::make_shared<std::vector<uint8>>(static_cast<size_t>(unSize));
+    int64 nRead = Read(name, 0, pData->data(), pData->size());
+    if (nRead < 0) {
+        return false;
+    }
+    pData->resize(static_cast<size_t>(nRead));
+
+    view.m_pData = pData->data();
+    view.m_cubData = pData->size();
+    view.m_pOwner = std::move(pData);
+    return true;
+}
+
+void StorageBackend::ReadAsync(const std::string& name, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion)
+{
+    uint64 unKey = HashBytes64(name.data(), name.size());
+    bool bPosted = AsyncIO::GetInstance().Post(unKey, [this, name, unOffset, cubToRead, completion]() {
+        std::vector<uint8> data(cubToRead);
+        int64 nRead = Read(name, unOffset, data.data(), data.size());
+        data.resize(nRead > 0 ? static_cast<size_t>(nRead) : 0);
+        completion(nRead >= 0, std::move(data));
+    });
+    if (!bPosted) {
+        completion(false, std::vector<uint8>());
+    }
+}
+
+//-----------------------------------------------------------------------------
+// PlainFileBackend
+//-----------------------------------------------------------------------------
+
+PlainFileBackend::PlainFileBackend(const std::string& directory, uint64 unMmapThreshold)
+    : m_sDirectory(directory),
+      m_unMmapThreshold(unMmapThreshold),
+      m_bDeferSync(false)
+{
+}
+
+std::string PlainFileBackend::GetFullPath(const std::string& name) const
+{
+    return m_sDirectory + "/" + name;
+}
+
+bool PlainFileBackend::CreateParentDirectories(const std::string& name) const
+{
+    size_t unSlash = name.rfind('/');
+    if (unSlash == std::string::npos) {
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(GetFullPath(name.substr(0, unSlash)), ec);
+    if (ec) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to create directory for %s: %s", name.c_str(), ec.message().c_str());
+        return false;
+    }
+    return true;
+}
+
+void PlainFileBackend::RemoveEmptyParentDirectories(const std::string& name) const
+{
+    // Stops at the first directory that still holds something, removing a
+    // non-empty directory fails without touching it
+    std::string parent = name;
+    for (size_t unSlash = parent.rfind('/'); unSlash != std::string::npos && unSlash > 0; unSlash = parent.rfind('/')) {
+        parent.resize(unSlash);
+        std::error_code ec;
+        if (!std::filesystem::remove(GetFullPath(parent), ec)) {
+            break;
+        }
+    }
+}
+
+void PlainFileBackend::Enumerate(const EnumerateCallback& callback)
+{
+    try {
+        if (!std::filesystem::exists(m_sDirectory)) {
+            return;
+        }
+
+        // Names are paths relative to the storage directory, always with '/'
+        const std::filesystem::path root(m_sDirectory);
+        for (auto it = std::filesystem::recursive_directory_iterator(root); it != std::filesystem::recursive_directory_iterator(); ++it) {
+            const auto& entry = *it;
+            bool bTopLevel = it.depth() == 0;
+
+            // The version history and conflict copies live in the storage directory but hold no saves
+            if (entry.is_directory()) {
+                if (bTopLevel && (entry.path().filename() == VERSION_HISTORY_DIRECTORY ||
+                                  entry.path().filename() == CLOUD_SYNC_CONFLICT_DIRECTORY)) {
+                    it.disable_recursion_pending();
+                }
+                continue;
+            }
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+
+            // Temporary files of an interrupted atomic write are debris, not saves
+            if (entry.path().extension() == FILE_IO_TEMP_SUFFIX) {
+                std::error_code ec;
+                std::filesystem::remove(entry.path(), ec);
+                continue;
+            }
+
+            // Bookkeeping of the other layers shares the directory
+            std::string name = entry.path().lexically_relative(root).generic_string();
+            if (bTopLevel && (name == PACKED_CONTAINER_FILENAME || name == DEDUP_MARKER_FILENAME ||
+                              name == JOURNAL_FILENAME || name == ACCESS_PROFILE_FILENAME ||
+                              name == CLOUD_SYNC_STATE_FILENAME)) {
+                continue;
+            }
+
+            callback(name, entry.file_size(), ToUnixTime(entry.last_write_time()));
+        }
+    } catch (const std::exception& e) {
+        VLOG_ERROR(__FUNCTION__ " - Error scanning %s: %s", m_sDirectory.c_str(), e.what());
+    }
+}
+
+bool PlainFileBackend::Stat(const std::string& name, uint64& unSize, int64& nTimestamp)
+{
+    std::error_code ec;
+    std::string fullPath = GetFullPath(name);
+    auto status = std::filesystem::status(fullPath, ec);
+    if (ec || !std::filesystem::is_regular_file(status)) {
+        return false;
+    }
+
+    unSize = std::filesystem::file_size(fullPath, ec);
+    if (ec) {
+        return false;
+    }
+
+    auto ftime = std::filesystem::last_write_time(fullPath, ec);
+    nTimestamp = ec ? 0 : ToUnixTime(ftime);
+    return true;
+}
+
+bool PlainFileBackend::Write(const std::string& name, const void* pData, size_t cubData)
+{
+    // A concurrent delete may prune the parent between creating it and the write, try again once
+    std::string fullPath = GetFullPath(name);
+    bool bSync = !m_bDeferSync.load();
+    if (!CreateParentDirectories(name) ||
+        (!WriteFileAtomic(fullPath, pData, cubData, bSync) &&
+         (!CreateParentDirectories(name) || !WriteFileAtomic(fullPath, pData, cubData, bSync)))) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write file: %s", fullPath.c_str());
+        return false;
+    }
+
+    if (!bSync) {
+        AddUnsynced(fullPath);
+    }
+    return true;
+}
+
+bool PlainFileBackend::Delete(const std::string& name)
+{
+    std::string fullPath = GetFullPath(name);
+
+    std::error_code ec;
+    if (!std::filesystem::remove(fullPath, ec) && ec) {
+        VLOG_ERROR(__FUNCTION__ " - Exception deleting file %s: %s", fullPath.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    RemoveEmptyParentDirectories(name);
+    if (m_bDeferSync.load()) {
+        AddUnsynced(fullPath);
+    }
+    return true;
+}
+
+int64 PlainFileBackend::Read(const std::string& name, uint64 unOffset, void* pBuffer, size_t cubMax)
+{
+    std::string fullPath = GetFullPath(name);
+
+    std::error_code ec;
+    uint64 unFileSize = std::filesystem::file_size(fullPath, ec);
+    if (ec) {
+        VLOG_DEBUG(__FUNCTION__ " - File not found: %s", fullPath.c_str());
+        return -1;
+    }
+    if (unOffset >= unFileSize) {
+        return 0;
+    }
+    size_t bytesToRead = static_cast<size_t>(std::min<uint64>(cubMax, unFileSize - unOffset));
+
+    // Large files: copy straight out of the page cache instead of through stream buffers
+    if (m_unMmapThreshold > 0 && unFileSize >= m_unMmapThreshold) {
+        MappedFile mapped;
+        if (mapped.Open(fullPath)) {
+            mapped.Advise(MappedFile::AccessPattern::Sequential);
+            mapped.Advise(MappedFile::AccessPattern::WillNeed);
+
+            bytesToRead = static_cast<size_t>(std::min<uint64>(bytesToRead, mapped.Size() > unOffset ? mapped.Size() - unOffset : 0));
+            memcpy(pBuffer, mapped.Data() + unOffset, bytesToRead);
+            VLOG_DEBUG(__FUNCTION__ " - Read %zu mapped bytes from: %s", bytesToRead, fullPath.c_str());
+            return static_cast<int64>(bytesToRead);
+        }
+    }
+
+    try {
+        std::ifstream file(fullPath, std::ios::binary);
+        if (!file.is_open()) {
+            VLOG_DEBUG(__FUNCTION__ " - File not found: %s", fullPath.c_str());
+            return -1;
+        }
+
+        file.seekg(static_cast<std::streamoff>(unOffset));
+        file.read(static_cast<char*>(pBuffer), static_cast<std::streamsize>(bytesToRead));
+
+        if (file.bad()) {
+            VLOG_ERROR(__FUNCTION__ " - Error reading file: %s", fullPath.c_str());
+            return -1;
+        }
+
+        VLOG_DEBUG(__FUNCTION__ " - Successfully read %lld bytes from: %s", static_cast<long long>(file.gcount()), fullPath.c_str());
+        return static_cast<int64>(file.gcount());
+    } catch (const std::exception& e) {
+        VLOG_ERROR(__FUNCTION__ " - Exception reading file %s: %s", fullPath.c_str(), e.what());
+        return -1;
+    }
+}
+
+bool PlainFileBackend::OpenView(const std::string& name, FileView& view)
+{
+    // Writes replace files by rename, so the mapped contents never change underneath the view
+    auto pMapped = std::make_shared<MappedFile>();
+    if (!pMapped->Open(GetFullPath(name))) {
+        return false;
+    }
+    pMapped->Advise(MappedFile::AccessPattern::Sequential);
+    pMapped->Advise(MappedFile::AccessPattern::WillNeed);
+
+    view.m_pData = reinterpret_cast<const uint8*>(pMapped->Data());
+    view.m_cubData = pMapped->Size();
+    view.m_pOwner = std::move(pMapped);
+    return true;
+}
+
+void PlainFileBackend::ReadAsync(const std::string& name, uint64 unOffset, uint32 cubToRead, AsyncIO::ReadCompletion completion)
+{
+    // Files map 1:1 to paths, so the engine can read them directly (io_uring where available)
+    AsyncIO::GetInstance().ReadAt(GetFullPath(name), unOffset, cubToRead, std::move(completion));
+}
+
+bool PlainFileBackend::OpenStaged(const std::string& name, uint64 unUnique, StagedFile& file)
+{
+    std::string fullPath = GetFullPath(name);
+    std::string tempPath = fullPath + "." + std::to_string(unUnique) + FILE_IO_TEMP_SUFFIX;
+    if (!CreateParentDirectories(name)) {
+        return false;
+    }
+    return file.Open(fullPath, tempPath) || (CreateParentDirectories(name) && file.Open(fullPath, tempPath));
+}
+
+bool PlainFileBackend::CommitStaged(const std::string&, StagedFile& file)
+{
+    return file.Commit();
+}
+
+void PlainFileBackend::RemoveAll()
+{
+    std::vector<std::string> names;
+    Enumerate([&names](const std::string& name, uint64, int64) { names.push_back(name); });
+
+    for (const std::string& name : names) {
+        Delete(name);
+    }
+}
+
+void PlainFileBackend::SetDeferSync(bool bDefer)
+{
+    m_bDeferSync.store(bDefer);
+}
+
+void PlainFileBackend::AddUnsynced(const std::string& path)
+{
+    // The directory makes the rename (or removal) durable, the file its contents
+    std::string parent = std::filesystem::path(path).parent_path().string();
+
+    VAPORCORE_SCOPED_LOCK(m_syncMutex);
+    m_unsyncedPaths.insert(path);
+    m_unsyncedPaths.insert(parent.empty() ? m_sDirectory : parent);
+}
+
+bool PlainFileBackend::Sync()
+{
+    std::set<std::string> paths;
+    {
+        VAPORCORE_SCOPED_LOCK(m_syncMutex);
+        paths.swap(m_unsyncedPaths);
+    }
+
+    // Files before directories: a set orders "a/b" after "a", so walk it backwards
+    bool bSuccess = true;
+    std::vector<std::string> failed;
+    for (auto it = paths.rbegin(); it != paths.rend(); ++it) {
+        if (!SyncPath(*it)) {
+            failed.push_back(*it);
+            bSuccess = false;
+        }
+    }
+
+    if (!failed.empty()) {
+        VAPORCORE_SCOPED_LOCK(m_syncMutex);
+        m_unsyncedPaths.insert(failed.begin(), failed.end());
+    }
+    return bSuccess;
+}
+
+} // namespace VaporCore
@@ -0,0 +1,897 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Stats and achievements of the current user, defined by a schema file
+ */
+
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vapor_base.h"
+#include "vapor_user_stats.h"
+#include "vapor_file_io.h"
+#include "vapor_hash.h"
+
+namespace VaporCore {
+
+static constexpr Config::Key KEY_STATS_SCHEMA{ CONFIG_SECTION_STATS, CONFIG_KEY_STATS_SCHEMA };
+static constexpr Config::Key KEY_STATS_DIRECTORY{ CONFIG_SECTION_STATS, CONFIG_KEY_STATS_DIRECTORY };
+static constexpr Config::Key KEY_STATS_STORE_DELAY_MS{ CONFIG_SECTION_STATS, CONFIG_KEY_STATS_STORE_DELAY_MS };
+
+static constexpr const char* DEFAULT_STATS_SCHEMA = "./vaporcore_stats.ini";
+static constexpr const char* DEFAULT_STATS_DIRECTORY = "./vaporcore_stats";
+static constexpr const char* STATS_FILE_EXTENSION = ".vcstats";
+static const uint32 DEFAULT_STORE_DELAY_MS = 200;
+
+static const uint32 STATS_MAGIC = 0x54534356;       // "VCST"
+static const uint32 STATS_VERSION = 1;
+
+// Stats file: header, a record per stat and then per achievement, in schema
+// order. Records carry the hash of their name, so values survive entries
+// being added to or removed from the schema. Host byte order
+struct StatsFileHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_cStats;
+    uint32 m_cAchievements;
+};
+
+struct StatRecord
+{
+    uint64 m_unNameHash;
+    uint32 m_unType;                // EStatType
+    uint32 m_unValue;               // int32, or the bits of the float
+    double m_dRateCount;            // Avgrate totals, 0 for other types
+    double m_dRateSeconds;
+};
+
+struct AchievementRecord
+{
+    uint64 m_unNameHash;
+    uint32 m_unUnlockTime;
+    uint32 m_bAchieved;
+};
+
+static_assert(sizeof(StatsFileHeader) == 16, "Stats header layout changed");
+static_assert(sizeof(StatRecord) == 32, "Stat record layout changed");
+static_assert(sizeof(AchievementRecord) == 16, "Achievement record layout changed");
+
+// Live instances, for ShutdownAll(). Plain mutex: only taken at construction and shutdown
+static std::mutex s_instancesMutex;
+static std::vector<UserStats*> s_instances;
+
+// One [stat NAME] or [achievement NAME] block of the schema file
+struct SchemaSection
+{
+    std::string m_sKind;
+    std::string m_sName;
+    size_t m_unLine = 0;
+    std::vector<std::pair<std::string, std::string>> m_values;
+};
+
+static std::string_view TrimSchema(std::string_view str)
+{
+    size_t start = 0;
+    size_t end = str.size();
+    while (start < end && std::isspace(static_cast<unsigned char>(str[start]))) ++start;
+    while (end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) --end;
+    return str.substr(start, end - start);
+}
+
+static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ParseSchemaInt(const std::string& value, int32& nResult)
+{
+    char* pchEnd = nullptr;
+    errno = 0;
+    long long nValue = strtoll(value.c_str(), &pchEnd, 10);
+    if (value.empty() || *pchEnd != '\0' || errno == ERANGE || nValue < INT32_MIN || nValue > INT32_MAX) {
+        return false;
+    }
+    nResult = static_cast<int32>(nValue);
+    return true;
+}
+
+static bool ParseSchemaFloat(const std::string& value, float& flResult)
+{
+    char* pchEnd = nullptr;
+    float flValue = strtof(value.c_str(), &pchEnd);
+    if (value.empty() || *pchEnd != '\0' || !std::isfinite(flValue)) {
+        return false;
+    }
+    flResult = flValue;
+    return true;
+}
+
+static bool ParseSchemaBool(const std::string& value, bool& bResult)
+{
+    if (EqualsIgnoreCase(value, "true") || EqualsIgnoreCase(value, "yes") || value == "1") {
+        bResult = true;
+        return true;
+    }
+    if (EqualsIgnoreCase(value, "false") || EqualsIgnoreCase(value, "no") || value == "0") {
+        bResult = false;
+        return true;
+    }
+    return false;
+}
+
+static bool ReadSchemaSections(const std::string& path, std::vector<SchemaSection>& sections)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    SchemaSection* pSection = nullptr;
+    std::string text;
+    size_t unLine = 0;
+    while (std::getline(file, text)) {
+        ++unLine;
+        std::string_view line = TrimSchema(text);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+
+        // [kind NAME]
+        if (line.front() == '[' && line.back() == ']') {
+            std::string_view header = TrimSchema(line.substr(1, line.size() - 2));
+            size_t unSpace = header.find_first_of(" \t");
+            sections.emplace_back();
+            pSection = &sections.back();
+            pSection->m_unLine = unLine;
+            pSection->m_sKind = std::string(header.substr(0, unSpace));
+            if (unSpace != std::string_view::npos) {
+                pSection->m_sName = std::string(TrimSchema(header.substr(unSpace)));
+            }
+            continue;
+        }
+
+        size_t unEquals = line.find('=');
+        if (!pSection || unEquals == std::string_view::npos) {
+            VLOG_WARNING(__FUNCTION__ " - %s:%zu: ignoring \"%.*s\"", path.c_str(), unLine,
+                         static_cast<int>(line.size()), line.data());
+            continue;
+        }
+        pSection->m_values.emplace_back(std::string(TrimSchema(line.substr(0, unEquals))),
+                                        std::string(TrimSchema(line.substr(unEquals + 1))));
+    }
+
+    return true;
+}
+
+static bool ReadStatsFile(const std::string& path, std::vector<uint8>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamoff cubFile = file.tellg();
+    if (cubFile < 0) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(cubFile));
+    file.seekg(0);
+    return cubFile == 0 || file.read(reinterpret_cast<char*>(data.data()), cubFile).good();
+}
+
+UserStats::UserStats()
+    : m_bLoaded(false)
+    , m_bImageStale(false)
+    , m_cStoreRequests(0)
+    , m_bStop(false)
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    s_instances.push_back(this);
+}
+
+UserStats::~UserStats()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_instancesMutex);
+        s_instances.erase(std::remove(s_instances.begin(), s_instances.end(), this), s_instances.end());
+    }
+    Shutdown();
+}
+
+bool UserStats::Load()
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+
+    if (IsLoaded()) {
+        return true;
+    }
+
+    std::string path(Config::GetInstance().GetString(KEY_STATS_SCHEMA, DEFAULT_STATS_SCHEMA));
+    if (!LoadSchema(path)) {
+        m_statNames.clear();
+        m_stats.clear();
+        m_statIndex.Clear();
+        m_achievementNames.clear();
+        m_achievements.clear();
+        m_achievementIndex.Clear();
+        return false;
+    }
+
+    ResetStats();
+    ResetAchievements();
+    LoadValues();
+    m_bLoaded.store(true, std::memory_order_release);
+    return true;
+}
+
+void UserStats::LoadValues()
+{
+    const Config& config = Config::GetInstance();
+    char userFile[64];
+    snprintf(userFile, sizeof(userFile), "%u/%llu", config.GameID().AppID(),
+             static_cast<unsigned long long>(config.SteamID().ConvertToUint64()));
+    m_sPath = std::string(config.GetString(KEY_STATS_DIRECTORY, DEFAULT_STATS_DIRECTORY)) + "/" + userFile +
+              STATS_FILE_EXTENSION;
+
+    m_statDirty.assign(m_stats.size(), 0);
+    m_achievementDirty.assign(m_achievementNames.size(), 0);
+    m_dirtyStats.clear();
+    m_dirtyAchievements.clear();
+
+    const size_t cubStats = m_stats.size() * sizeof(StatRecord);
+    m_image.assign(sizeof(StatsFileHeader) + cubStats + m_achievementNames.size() * sizeof(AchievementRecord), 0);
+    StatsFileHeader header = { STATS_MAGIC, STATS_VERSION, static_cast<uint32>(m_stats.size()),
+                               static_cast<uint32>(m_achievementNames.size()) };
+    memcpy(m_image.data(), &header, sizeof(header));
+
+    std::vector<uint8> data;
+    bool bRead = ReadStatsFile(m_sPath, data);
+    if (bRead && data.size() >= sizeof(StatsFileHeader)) {
+        memcpy(&header, data.data(), sizeof(header));
+    }
+    if (bRead && (data.size() < sizeof(StatsFileHeader) || header.m_unMagic != STATS_MAGIC ||
+                  header.m_unVersion != STATS_VERSION ||
+                  data.size() != sizeof(StatsFileHeader) + static_cast<uint64>(header.m_cStats) * sizeof(StatRecord) +
+                                     static_cast<uint64>(header.m_cAchievements) * sizeof(AchievementRecord))) {
+        VLOG_WARNING(__FUNCTION__ " - Ignoring damaged stats file %s", m_sPath.c_str());
+        bRead = false;
+    }
+
+    uint32 cRestored = 0;
+    if (bRead) {
+        std::unordered_map<uint64, uint32> stats;
+        for (uint32 i = 0; i < m_statNames.size(); ++i) {
+            stats.emplace(HashBytes64(m_statNames[i].data(), m_statNames[i].size()), i);
+        }
+        std::unordered_map<uint64, uint32> achievements;
+        for (uint32 i = 0; i < m_achievementNames.size(); ++i) {
+            achievements.emplace(HashBytes64(m_achievementNames[i].data(), m_achievementNames[i].size()), i);
+        }
+
+        const uint8* pRecord = data.data() + sizeof(StatsFileHeader);
+        for (uint32 i = 0; i < header.m_cStats; ++i, pRecord += sizeof(StatRecord)) {
+            StatRecord record;
+            memcpy(&record, pRecord, sizeof(record));
+            auto it = stats.find(record.m_unNameHash);
+            if (it == stats.end() || record.m_unType != m_stats[it->second].m_eType) {
+                continue;
+            }
+
+            // Clamped, in case the schema limits changed since
+            const StatDef& stat = m_stats[it->second];
+            if (stat.m_eType == k_EStatTypeInt) {
+                int32 nValue = static_cast<int32>(record.m_unValue);
+                m_intValues[stat.m_unSlot] = std::min(std::max(nValue, stat.m_nMin), stat.m_nMax);
+            } else {
+                float flValue;
+                memcpy(&flValue, &record.m_unValue, sizeof(flValue));
+                if (!std::isfinite(flValue)) {
+                    continue;
+                }
+                m_floatValues[stat.m_unSlot] = std::min(std::max(flValue, stat.m_flMin), stat.m_flMax);
+                if (stat.m_eType == k_EStatTypeAvgRate) {
+                    m_rateCounts[stat.m_unRateSlot] = record.m_dRateCount;
+                    m_rateSeconds[stat.m_unRateSlot] = record.m_dRateSeconds;
+                }
+            }
+            ++cRestored;
+        }
+
+        for (uint32 i = 0; i < header.m_cAchievements; ++i, pRecord += sizeof(AchievementRecord)) {
+            AchievementRecord record;
+            memcpy(&record, pRecord, sizeof(record));
+            auto it = achievements.find(record.m_unNameHash);
+            if (it != achievements.end()) {
+                m_achieved[it->second] = record.m_bAchieved ? 1 : 0;
+                m_unlockTimes[it->second] = record.m_bAchieved ? record.m_unUnlockTime : 0;
+                ++cRestored;
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < m_stats.size(); ++i) {
+        EncodeStat(i);
+    }
+    for (uint32 i = 0; i < m_achievementNames.size(); ++i) {
+        EncodeAchievement(i);
+    }
+
+    // A file written for another schema is rewritten by the next store, changes or not
+    m_bImageStale = bRead && data != m_image;
+
+    VLOG_INFO(__FUNCTION__ " - Restored %u values from %s", cRestored, m_sPath.c_str());
+}
+
+bool UserStats::LoadSchema(const std::string& path)
+{
+    std::vector<SchemaSection> sections;
+    if (!ReadSchemaSections(path, sections)) {
+        // Not every game has stats; an empty schema is valid
+        VLOG_INFO(__FUNCTION__ " - No stats schema at %s", path.c_str());
+        return true;
+    }
+
+    std::unordered_set<std::string> statNames;
+    std::unordered_set<std::string> achievementNames;
+    uint32 cIntValues = 0;
+    uint32 cFloatValues = 0;
+    uint32 cRateValues = 0;
+
+    for (const SchemaSection& section : sections) {
+        const bool bStat = EqualsIgnoreCase(section.m_sKind, "stat");
+        if (!bStat && !EqualsIgnoreCase(section.m_sKind, "achievement")) {
+            VLOG_WARNING(__FUNCTION__ " - %s:%zu: unknown section kind \"%s\"", path.c_str(), section.m_unLine,
+                         section.m_sKind.c_str());
+            continue;
+        }
+        if (section.m_sName.empty()) {
+            VLOG_WARNING(__FUNCTION__ " - %s:%zu: %s without a name", path.c_str(), section.m_unLine,
+                         section.m_sKind.c_str());
+            continue;
+        }
+
+        if (!bStat) {
+            if (!achievementNames.insert(section.m_sName).second) {
+                VLOG_WARNING(__FUNCTION__ " - %s:%zu: duplicate achievement %s", path.c_str(), section.m_unLine,
+                             section.m_sName.c_str());
+                continue;
+            }
+            m_achievementNames.push_back(section.m_sName);
+            m_achievements.emplace_back();
+            m_achievements.back().m_attributes = section.m_values;
+            continue;
+        }
+
+        if (!statNames.insert(section.m_sName).second) {
+            VLOG_WARNING(__FUNCTION__ " - %s:%zu: duplicate stat %s", path.c_str(), section.m_unLine,
+                         section.m_sName.c_str());
+            continue;
+        }
+
+        // The type decides how the limits parse, wherever it appears in the block
+        StatDef stat;
+        for (const auto& value : section.m_values) {
+            if (EqualsIgnoreCase(value.first, "type")) {
+                if (EqualsIgnoreCase(value.second, "int")) {
+                    stat.m_eType = k_EStatTypeInt;
+                } else if (EqualsIgnoreCase(value.second, "float")) {
+                    stat.m_eType = k_EStatTypeFloat;
+                } else if (EqualsIgnoreCase(value.second, "avgrate")) {
+                    stat.m_eType = k_EStatTypeAvgRate;
+                } else {
+                    VLOG_WARNING(__FUNCTION__ " - %s:%zu: stat %s has unknown type \"%s\", using int", path.c_str(),
+                                 section.m_unLine, section.m_sName.c_str(), value.second.c_str());
+                }
+            }
+        }
+
+        bool bValid = true;
+        for (const auto& value : section.m_values) {
+            const std::string& key = value.first;
+            bool bParsed = true;
+            if (EqualsIgnoreCase(key, "type") || EqualsIgnoreCase(key, "display_name")) {
+                continue;
+            } else if (EqualsIgnoreCase(key, "increment_only")) {
+                bParsed = ParseSchemaBool(value.second, stat.m_bIncrementOnly);
+            } else if (EqualsIgnoreCase(key, "min")) {
+                bParsed = stat.m_eType == k_EStatTypeInt ? ParseSchemaInt(value.second, stat.m_nMin)
+                                                         : ParseSchemaFloat(value.second, stat.m_flMin);
+            } else if (EqualsIgnoreCase(key, "max")) {
+                bParsed = stat.m_eType == k_EStatTypeInt ? ParseSchemaInt(value.second, stat.m_nMax)
+                                                         : ParseSchemaFloat(value.second, stat.m_flMax);
+            } else if (EqualsIgnoreCase(key, "default")) {
+                bParsed = stat.m_eType == k_EStatTypeInt ? ParseSchemaInt(value.second, stat.m_nDefault)
+                                                         : ParseSchemaFloat(value.second, stat.m_flDefault);
+            } else {
+                VLOG_WARNING(__FUNCTION__ " - %s:%zu: stat %s has unknown key %s", path.c_str(), section.m_unLine,
+                             section.m_sName.c_str(), key.c_str());
+            }
+
+            if (!bParsed) {
+                VLOG_WARNING(__FUNCTION__ " - %s:%zu: stat %s has invalid %s \"%s\"", path.c_str(), section.m_unLine,
+                             section.m_sName.c_str(), key.c_str(), value.second.c_str());
+                bValid = false;
+            }
+        }
+
+        if (stat.m_eType == k_EStatTypeInt ? stat.m_nMin > stat.m_nMax : stat.m_flMin > stat.m_flMax) {
+            VLOG_WARNING(__FUNCTION__ " - %s:%zu: stat %s has min above max", path.c_str(), section.m_unLine,
+                         section.m_sName.c_str());
+            bValid = false;
+        }
+        if (!bValid) {
+            continue;
+        }
+
+        // A default outside the limits would make the stat unsettable back to it
+        if (stat.m_eType == k_EStatTypeInt) {
+            stat.m_nDefault = std::min(std::max(stat.m_nDefault, stat.m_nMin), stat.m_nMax);
+            stat.m_unSlot = cIntValues++;
+        } else {
+            stat.m_flDefault = std::min(std::max(stat.m_flDefault, stat.m_flMin), stat.m_flMax);
+            stat.m_unSlot = cFloatValues++;
+            if (stat.m_eType == k_EStatTypeAvgRate) {
+                stat.m_unRateSlot = cRateValues++;
+            }
+        }
+
+        m_statNames.push_back(section.m_sName);
+        m_stats.push_back(stat);
+    }
+
+    if (!m_statIndex.Build(m_statNames) || !m_achievementIndex.Build(m_achievementNames)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to index the names in %s", path.c_str());
+        return false;
+    }
+
+    m_intValues.assign(cIntValues, 0);
+    m_floatValues.assign(cFloatValues, 0.0f);
+    m_rateCounts.assign(cRateValues, 0.0);
+    m_rateSeconds.assign(cRateValues, 0.0);
+    m_achieved.assign(m_achievementNames.size(), 0);
+    m_unlockTimes.assign(m_achievementNames.size(), 0);
+
+    VLOG_INFO(__FUNCTION__ " - Loaded %zu stats and %zu achievements from %s", m_stats.size(),
+              m_achievementNames.size(), path.c_str());
+    return true;
+}
+
+void UserStats::ResetStats()
+{
+    for (const StatDef& stat : m_stats) {
+        if (stat.m_eType == k_EStatTypeInt) {
+            m_intValues[stat.m_unSlot] = stat.m_nDefault;
+            continue;
+        }
+        m_floatValues[stat.m_unSlot] = stat.m_flDefault;
+        if (stat.m_eType == k_EStatTypeAvgRate) {
+            m_rateCounts[stat.m_unRateSlot] = 0.0;
+            m_rateSeconds[stat.m_unRateSlot] = 0.0;
+        }
+    }
+}
+
+void UserStats::ResetAchievements()
+{
+    std::fill(m_achieved.begin(), m_achieved.end(), 0);
+    std::fill(m_unlockTimes.begin(), m_unlockTimes.end(), 0);
+}
+
+const UserStats::StatDef* UserStats::FindStat(const char* pchName) const
+{
+    if (!pchName || !IsLoaded()) {
+        return nullptr;
+    }
+    uint32 unIndex = m_statIndex.Find(pchName);
+    return unIndex != PerfectHashIndex::NOT_FOUND ? &m_stats[unIndex] : nullptr;
+}
+
+uint32 UserStats::FindAchievement(const char* pchName) const
+{
+    if (!pchName || !IsLoaded()) {
+        return PerfectHashIndex::NOT_FOUND;
+    }
+    return m_achievementIndex.Find(pchName);
+}
+
+bool UserStats::GetStat(const char* pchName, int32* pData)
+{
+    const StatDef* pStat = FindStat(pchName);
+    if (!pStat || pStat->m_eType != k_EStatTypeInt || !pData) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    *pData = m_intValues[pStat->m_unSlot];
+    return true;
+}
+
+bool UserStats::GetStat(const char* pchName, float* pData)
+{
+    const StatDef* pStat = FindStat(pchName);
+    if (!pStat || pStat->m_eType == k_EStatTypeInt || !pData) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    *pData = m_floatValues[pStat->m_unSlot];
+    return true;
+}
+
+bool UserStats::SetStat(const char* pchName, int32 nData)
+{
+    const StatDef* pStat = FindStat(pchName);
+    if (!pStat || pStat->m_eType != k_EStatTypeInt || nData < pStat->m_nMin || nData > pStat->m_nMax) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    int32& nValue = m_intValues[pStat->m_unSlot];
+    if (pStat->m_bIncrementOnly && nData < nValue) {
+        return false;
+    }
+    if (nValue != nData) {
+        nValue = nData;
+        MarkStatDirty(static_cast<uint32>(pStat - m_stats.data()));
+    }
+    return true;
+}
+
+bool UserStats::SetStat(const char* pchName, float fData)
+{
+    // Averages only move through UpdateAvgRateStat
+    const StatDef* pStat = FindStat(pchName);
+    if (!pStat || pStat->m_eType != k_EStatTypeFloat || !std::isfinite(fData) ||
+        fData < pStat->m_flMin || fData > pStat->m_flMax) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    float& flValue = m_floatValues[pStat->m_unSlot];
+    if (pStat->m_bIncrementOnly && fData < flValue) {
+        return false;
+    }
+    if (flValue != fData) {
+        flValue = fData;
+        MarkStatDirty(static_cast<uint32>(pStat - m_stats.data()));
+    }
+    return true;
+}
+
+bool UserStats::UpdateAvgRateStat(const char* pchName, float flCountThisSession, double dSessionLength)
+{
+    const StatDef* pStat = FindStat(pchName);
+    if (!pStat || pStat->m_eType != k_EStatTypeAvgRate || !std::isfinite(flCountThisSession) ||
+        !(dSessionLength > 0.0) || !std::isfinite(dSessionLength)) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    double& dCount = m_rateCounts[pStat->m_unRateSlot];
+    double& dSeconds = m_rateSeconds[pStat->m_unRateSlot];
+    dCount += flCountThisSession;
+    dSeconds += dSessionLength;
+
+    double dRate = dCount / dSeconds;
+    m_floatValues[pStat->m_unSlot] = static_cast<float>(
+        std::min(std::max(dRate, static_cast<double>(pStat->m_flMin)), static_cast<double>(pStat->m_flMax)));
+    MarkStatDirty(static_cast<uint32>(pStat - m_stats.data()));
+    return true;
+}
+
+bool UserStats::GetAchievement(const char* pchName, bool* pbAchieved, uint32* punUnlockTime)
+{
+    uint32 unIndex = FindAchievement(pchName);
+    if (unIndex == PerfectHashIndex::NOT_FOUND) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (pbAchieved) {
+        *pbAchieved = m_achieved[unIndex] != 0;
+    }
+    if (punUnlockTime) {
+        *punUnlockTime = m_unlockTimes[unIndex];
+    }
+    return true;
+}
+
+bool UserStats::SetAchievement(const char* pchName, bool bAchieved)
+{
+    uint32 unIndex = FindAchievement(pchName);
+    if (unIndex == PerfectHashIndex::NOT_FOUND) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (m_achieved[unIndex] == (bAchieved ? 1 : 0)) {
+        // Unlocking again keeps the first unlock time
+        return true;
+    }
+    m_achieved[unIndex] = bAchieved ? 1 : 0;
+    m_unlockTimes[unIndex] = bAchieved ? static_cast<uint32>(time(nullptr)) : 0;
+    MarkAchievementDirty(unIndex);
+    return true;
+}
+
+uint32 UserStats::GetNumAchievements() const noexcept
+{
+    return IsLoaded() ? static_cast<uint32>(m_achievementNames.size()) : 0;
+}
+
+const char* UserStats::GetAchievementName(uint32 iAchievement) const noexcept
+{
+    if (!IsLoaded() || iAchievement >= m_achievementNames.size()) {
+        return "";
+    }
+    return m_achievementNames[iAchievement].c_str();
+}
+
+const char* UserStats::GetAchievementDisplayAttribute(const char* pchName, const char* pchKey) const
+{
+    uint32 unIndex = FindAchievement(pchName);
+    if (unIndex == PerfectHashIndex::NOT_FOUND || !pchKey) {
+        return "";
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& attributes = m_achievements[unIndex].m_attributes;
+    auto find = [&attributes](std::string_view key) -> const char* {
+        for (const auto& attribute : attributes) {
+            if (EqualsIgnoreCase(attribute.first, key)) {
+                return attribute.second.c_str();
+            }
+        }
+        return nullptr;
+    };
+
+    std::string_view key(pchKey);
+    if (EqualsIgnoreCase(key, "name") || EqualsIgnoreCase(key, "desc")) {
+        std::string localized = std::string(key) + "_" + Config::GetInstance().Language();
+        if (const char* pchValue = find(localized)) {
+            return pchValue;
+        }
+    }
+
+    if (const char* pchValue = find(key)) {
+        return pchValue;
+    }
+    return EqualsIgnoreCase(key, "hidden") ? "0" : "";
+}
+
+void UserStats::ResetAll(bool bAchievementsToo)
+{
+    if (!IsLoaded()) {
+        return;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    ResetStats();
+    for (uint32 i = 0; i < m_stats.size(); ++i) {
+        MarkStatDirty(i);
+    }
+    if (bAchievementsToo) {
+        ResetAchievements();
+        for (uint32 i = 0; i < m_achievementNames.size(); ++i) {
+            MarkAchievementDirty(i);
+        }
+    }
+}
+
+void UserStats::MarkStatDirty(uint32 unStat)
+{
+    if (!m_statDirty[unStat]) {
+        m_statDirty[unStat] = 1;
+        m_dirtyStats.push_back(unStat);
+    }
+}
+
+void UserStats::MarkAchievementDirty(uint32 unAchievement)
+{
+    if (!m_achievementDirty[unAchievement]) {
+        m_achievementDirty[unAchievement] = 1;
+        m_dirtyAchievements.push_back(unAchievement);
+    }
+}
+
+void UserStats::EncodeStat(uint32 unStat)
+{
+    const StatDef& stat = m_stats[unStat];
+    const std::string& name = m_statNames[unStat];
+
+    StatRecord record = {};
+    record.m_unNameHash = HashBytes64(name.data(), name.size());
+    record.m_unType = stat.m_eType;
+    if (stat.m_eType == k_EStatTypeInt) {
+        record.m_unValue = static_cast<uint32>(m_intValues[stat.m_unSlot]);
+    } else {
+        memcpy(&record.m_unValue, &m_floatValues[stat.m_unSlot], sizeof(record.m_unValue));
+        if (stat.m_eType == k_EStatTypeAvgRate) {
+            record.m_dRateCount = m_rateCounts[stat.m_unRateSlot];
+            record.m_dRateSeconds = m_rateSeconds[stat.m_unRateSlot];
+        }
+    }
+
+    memcpy(m_image.data() + sizeof(StatsFileHeader) + unStat * sizeof(StatRecord), &record, sizeof(record));
+}
+
+void UserStats::EncodeAchievement(uint32 unAchievement)
+{
+    const std::string& name = m_achievementNames[unAchievement];
+
+    AchievementRecord record = {};
+    record.m_unNameHash = HashBytes64(name.data(), name.size());
+    record.m_unUnlockTime = m_unlockTimes[unAchievement];
+    record.m_bAchieved = m_achieved[unAchievement];
+
+    size_t unOffset = sizeof(StatsFileHeader) + m_stats.size() * sizeof(StatRecord) +
+                      unAchievement * sizeof(AchievementRecord);
+    memcpy(m_image.data() + unOffset, &record, sizeof(record));
+}
+
+bool UserStats::StoreStats()
+{
+    if (!IsLoaded()) {
+        return false;
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    if (m_bStop) {
+        return false;
+    }
+    if (!m_storeThread.joinable()) {
+        m_storeThread = std::thread(&UserStats::StoreThread, this);
+    }
+    ++m_cStoreRequests;
+    m_storeCondition.notify_all();
+    return true;
+}
+
+void UserStats::StoreThread()
+{
+    const std::chrono::milliseconds delay(
+        Config::GetInstance().GetUInt32(KEY_STATS_STORE_DELAY_MS, DEFAULT_STORE_DELAY_MS));
+    const uint64 unGameID = Config::GetInstance().GameID().ToUint64();
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    for (;;) {
+        m_storeCondition.wait(lock, [this]() { return m_cStoreRequests > 0 || m_bStop; });
+        if (m_cStoreRequests == 0) {
+            break;
+        }
+
+        // Calls within the window share this write; a stop writes right away
+        m_storeCondition.wait_for(lock, delay, [this]() { return m_bStop; });
+
+        uint32 cRequests = m_cStoreRequests;
+        m_cStoreRequests = 0;
+
+        std::vector<uint32> unlocked;
+        bool bWrite = m_bImageStale || !m_dirtyStats.empty() || !m_dirtyAchievements.empty();
+        for (uint32 unStat : m_dirtyStats) {
+            EncodeStat(unStat);
+            m_statDirty[unStat] = 0;
+        }
+        for (uint32 unAchievement : m_dirtyAchievements) {
+            EncodeAchievement(unAchievement);
+            m_achievementDirty[unAchievement] = 0;
+            if (m_achieved[unAchievement]) {
+                unlocked.push_back(unAchievement);
+            }
+        }
+        m_dirtyStats.clear();
+        m_dirtyAchievements.clear();
+        m_bImageStale = false;
+
+        std::vector<uint8> image;
+        if (bWrite) {
+            image = m_image;
+        }
+        lock.unlock();
+
+        bool bStored = true;
+        if (bWrite) {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(m_sPath).parent_path(), ec);
+            bStored = WriteFileAtomic(m_sPath, image.data(), image.size());
+            if (bStored) {
+                VLOG_DEBUG(__FUNCTION__ " - Stored %u StoreStats calls in one write", cRequests);
+            } else {
+                VLOG_ERROR(__FUNCTION__ " - Failed to write %s", m_sPath.c_str());
+            }
+        }
+
+        UserStatsStored_t stored = { unGameID, bStored ? k_EResultOK : k_EResultFail };
+        for (uint32 i = 0; i < cRequests; ++i) {
+            CCallbackMgr::GetInstance().PostCallback(stored.k_iCallback, &stored, sizeof(stored));
+        }
+        if (bStored) {
+            for (uint32 unAchievement : unlocked) {
+                PostAchievementStored(m_achievementNames[unAchievement], 0, 0);
+            }
+        }
+
+        lock.lock();
+
+        // Not on disk: the next store tries again, and reports those unlocks then
+        if (!bStored) {
+            m_bImageStale = true;
+            for (uint32 unAchievement : unlocked) {
+                MarkAchievementDirty(unAchievement);
+            }
+        }
+    }
+}
+
+void UserStats::PostAchievementStored(const std::string& name, uint32 nCurProgress, uint32 nMaxProgress)
+{
+    UserAchievementStored_t callback = {};
+    callback.m_nGameID = Config::GetInstance().GameID().ToUint64();
+    callback.m_bGroupAchievement = false;
+    snprintf(callback.m_rgchAchievementName, sizeof(callback.m_rgchAchievementName), "%s", name.c_str());
+    callback.m_nCurProgress = nCurProgress;
+    callback.m_nMaxProgress = nMaxProgress;
+    CCallbackMgr::GetInstance().PostCallback(callback.k_iCallback, &callback, sizeof(callback));
+}
+
+bool UserStats::IndicateAchievementProgress(const char* pchName, uint32 nCurProgress, uint32 nMaxProgress)
+{
+    uint32 unIndex = FindAchievement(pchName);
+    if (unIndex == PerfectHashIndex::NOT_FOUND) {
+        return false;
+    }
+
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        if (m_achieved[unIndex]) {
+            return false;
+        }
+    }
+
+    PostAchievementStored(m_achievementNames[unIndex], nCurProgress, nMaxProgress);
+    return true;
+}
+
+void UserStats::Shutdown()
+{
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_bStop = true;
+    }
+    m_storeCondition.notify_all();
+
+    if (m_storeThread.joinable()) {
+        m_storeThread.join();
+    }
+}
+
+void UserStats::ShutdownAll()
+{
+    std::lock_guard<std::mutex> lock(s_instancesMutex);
+    for (UserStats* pStats : s_instances) {
+        pStats->Shutdown();
+    }
+}
+
+} // namespace VaporCore
@@ -0,0 +1,322 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Bounded per-file version history kept as reverse deltas
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include "vapor_version_history.h"
+#include "vapor_delta.h"
+#include "vapor_file_io.h"
+#include "vapor_hash.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+static const uint32 HISTORY_MAGIC = 0x48564356;     // "VCVH"
+static const uint32 HISTORY_VERSION = 1;
+static const char* HISTORY_EXTENSION = ".vchist";
+
+// Record() blocks while this many changes wait for the worker, each holds two file copies
+static const size_t MAX_QUEUED_JOBS = 64;
+
+static const uint32 VERSION_FLAG_EXISTS = 1 << 0;
+
+struct HistoryHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint32 m_cVersions;
+    uint32 m_cchName;
+};
+
+struct HistoryVersionHeader
+{
+    int64 m_nTimestamp;
+    uint64 m_unSize;
+    uint64 m_unHash;
+    uint64 m_unBaseSize;
+    uint64 m_unBaseHash;
+    uint32 m_fFlags;
+    uint32 m_cubDelta;
+};
+
+static_assert(sizeof(HistoryVersionHeader) == 48, "History version layout changed");
+
+static uint64 HashContents(const FileView& view, bool bExists)
+{
+    return bExists ? HashBytes64(view.m_pData, view.m_cubData) : HashBytes64(nullptr, 0);
+}
+
+VersionHistory::VersionHistory(const std::string& storageDirectory, uint32 unMaxVersions)
+    : m_sDirectory(storageDirectory + "/" + VERSION_HISTORY_DIRECTORY),
+      m_unMaxVersions(unMaxVersions),
+      m_bBusy(false),
+      m_bStop(false)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_sDirectory, ec);
+
+    m_workerThread = std::thread(&VersionHistory::WorkerThread, this);
+}
+
+VersionHistory::~VersionHistory()
+{
+    // The worker drains the queue before it exits
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        m_bStop = true;
+    }
+    m_jobCondition.notify_all();
+    m_workerThread.join();
+}
+
+std::string VersionHistory::GetHistoryPath(const std::string& name) const
+{
+    // Names may contain characters a file name cannot, the name is kept inside
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx", static_cast<unsigned long long>(HashBytes64(name.data(), name.size())));
+    return m_sDirectory + "/" + filename + HISTORY_EXTENSION;
+}
+
+void VersionHistory::Record(const std::string& name, const FileView* pPrevious, int64 nPreviousTimestamp, const FileView* pCurrent)
+{
+    Job job;
+    job.m_sName = name;
+    job.m_nPreviousTimestamp = nPreviousTimestamp;
+    job.m_bPreviousExists = pPrevious != nullptr;
+    job.m_bCurrentExists = pCurrent != nullptr;
+    if (pPrevious) {
+        job.m_previous = *pPrevious;
+    }
+    if (pCurrent) {
+        job.m_current = *pCurrent;
+    }
+
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_jobs.size() < MAX_QUEUED_JOBS; });
+    m_jobs.push_back(std::move(job));
+    m_jobCondition.notify_one();
+}
+
+void VersionHistory::Flush()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_jobs.empty() && !m_bBusy; });
+}
+
+void VersionHistory::WorkerThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    for (;;) {
+        m_jobCondition.wait(lock, [this]() { return !m_jobs.empty() || m_bStop; });
+        if (m_jobs.empty()) {
+            break;
+        }
+
+        // Changes are taken in order, so each file's chain is extended in order
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_bBusy = true;
+
+        lock.unlock();
+        Process(job);
+        job = Job();
+        lock.lock();
+
+        m_bBusy = false;
+        m_idleCondition.notify_all();
+    }
+}
+
+void VersionHistory::Process(const Job& job)
+{
+    std::vector<Version> versions;
+    Load(job.m_sName, versions);
+
+    // A new file has no history to extend
+    if (!job.m_bPreviousExists && versions.empty()) {
+        return;
+    }
+
+    uint64 unPreviousSize = job.m_bPreviousExists ? job.m_previous.m_cubData : 0;
+    uint64 unPreviousHash = HashContents(job.m_previous, job.m_bPreviousExists);
+
+    // The newest delta must apply to what was just replaced, otherwise the file
+    // was changed without us and the chain cannot be rebuilt any more
+    if (!versions.empty() && (versions[0].m_unBaseSize != unPreviousSize || versions[0].m_unBaseHash != unPreviousHash)) {
+        VLOG_WARNING(__FUNCTION__ " - %s changed outside of the history, dropping %zu versions",
+                     job.m_sName.c_str(), versions.size());
+        versions.clear();
+        if (!job.m_bPreviousExists) {
+            Save(job.m_sName, versions);
+            return;
+        }
+    }
+
+    Version version;
+    version.m_nTimestamp = job.m_nPreviousTimestamp;
+    version.m_unSize = unPreviousSize;
+    version.m_unHash = unPreviousHash;
+    version.m_bExists = job.m_bPreviousExists;
+    version.m_unBaseSize = job.m_bCurrentExists ? job.m_current.m_cubData : 0;
+    version.m_unBaseHash = HashContents(job.m_current, job.m_bCurrentExists);
+    EncodeDelta(job.m_current.m_pData, static_cast<size_t>(version.m_unBaseSize),
+                job.m_previous.m_pData, static_cast<size_t>(unPreviousSize), version.m_delta);
+
+    versions.insert(versions.begin(), std::move(version));
+    if (versions.size() > m_unMaxVersions) {
+        versions.resize(m_unMaxVersions);
+    }
+
+    Save(job.m_sName, versions);
+    VLOG_DEBUG(__FUNCTION__ " - %s: %llu bytes kept as a %zu byte delta, %zu versions",
+               job.m_sName.c_str(), unPreviousSize, versions[0].m_delta.size(), versions.size());
+}
+
+bool VersionHistory::Load(const std::string& name, std::vector<Version>& versions)
+{
+    versions.clear();
+
+    std::ifstream file(GetHistoryPath(name), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    HistoryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_unMagic != HISTORY_MAGIC || header.m_unVersion != HISTORY_VERSION) {
+        return false;
+    }
+
+    // Another name with the same hash: its history is not ours to extend
+    std::string storedName(header.m_cchName, '\0');
+    if (!file.read(&storedName[0], header.m_cchName) || storedName != name) {
+        return false;
+    }
+
+    for (uint32 i = 0; i < header.m_cVersions; ++i) {
+        HistoryVersionHeader versionHeader;
+        if (!file.read(reinterpret_cast<char*>(&versionHeader), sizeof(versionHeader))) {
+            versions.clear();
+            return false;
+        }
+
+        Version version;
+        version.m_nTimestamp = versionHeader.m_nTimestamp;
+        version.m_unSize = versionHeader.m_unSize;
+        version.m_unHash = versionHeader.m_unHash;
+        version.m_unBaseSize = versionHeader.m_unBaseSize;
+        version.m_unBaseHash = versionHeader.m_unBaseHash;
+        version.m_bExists = (versionHeader.m_fFlags & VERSION_FLAG_EXISTS) != 0;
+        version.m_delta.resize(versionHeader.m_cubDelta);
+        if (!file.read(reinterpret_cast<char*>(version.m_delta.data()), versionHeader.m_cubDelta)) {
+            versions.clear();
+            return false;
+        }
+        versions.push_back(std::move(version));
+    }
+    return true;
+}
+
+bool VersionHistory::Save(const std::string& name, const std::vector<Version>& versions)
+{
+    std::string path = GetHistoryPath(name);
+    if (versions.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return true;
+    }
+
+    std::vector<uint8> data;
+    HistoryHeader header = { HISTORY_MAGIC, HISTORY_VERSION, static_cast<uint32>(versions.size()), static_cast<uint32>(name.size()) };
+    const uint8* pHeader = reinterpret_cast<const uint8*>(&header);
+    data.insert(data.end(), pHeader, pHeader + sizeof(header));
+    data.insert(data.end(), name.begin(), name.end());
+
+    for (const Version& version : versions) {
+        HistoryVersionHeader versionHeader = {};
+        versionHeader.m_nTimestamp = version.m_nTimestamp;
+        versionHeader.m_unSize = version.m_unSize;
+        versionHeader.m_unHash = version.m_unHash;
+        versionHeader.m_unBaseSize = version.m_unBaseSize;
+        versionHeader.m_unBaseHash = version.m_unBaseHash;
+        versionHeader.m_fFlags = version.m_bExists ? VERSION_FLAG_EXISTS : 0;
+        versionHeader.m_cubDelta = static_cast<uint32>(version.m_delta.size());
+
+        const uint8* pVersionHeader = reinterpret_cast<const uint8*>(&versionHeader);
+        data.insert(data.end(), pVersionHeader, pVersionHeader + sizeof(versionHeader));
+        data.insert(data.end(), version.m_delta.begin(), version.m_delta.end());
+    }
+
+    if (!WriteFileAtomic(path, data.data(), data.size())) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write history of %s", name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool VersionHistory::List(const std::string& name, std::vector<VersionInfo>& versions)
+{
+    Flush();
+
+    std::vector<Version> stored;
+    Load(name, stored);
+
+    versions.clear();
+    for (const Version& version : stored) {
+        VersionInfo info;
+        info.m_nTimestamp = version.m_nTimestamp;
+        info.m_unSize = version.m_unSize;
+        info.m_bExists = version.m_bExists;
+        versions.push_back(info);
+    }
+    return true;
+}
+
+bool VersionHistory::Reconstruct(const std::string& name, const FileView* pCurrent, uint32 unVersion,
+                                 std::vector<uint8>& data, bool& bExists)
+{
+    Flush();
+
+    std::vector<Version> versions;
+    if (!Load(name, versions) || unVersion >= versions.size()) {
+        return false;
+    }
+
+    // Walk back from the current contents one delta at a time
+    if (pCurrent) {
+        data.assign(pCurrent->m_pData, pCurrent->m_pData + pCurrent->m_cubData);
+    } else {
+        data.clear();
+    }
+
+    std::vector<uint8> previous;
+    for (uint32 i = 0; i <= unVersion; ++i) {
+        const Version& version = versions[i];
+        if (data.size() != version.m_unBaseSize || HashBytes64(data.data(), data.size()) != version.m_unBaseHash) {
+            VLOG_WARNING(__FUNCTION__ " - %s no longer matches its history", name.c_str());
+            return false;
+        }
+        if (!ApplyDelta(data.data(), data.size(), version.m_delta.data(), version.m_delta.size(), previous) ||
+            HashBytes64(previous.data(), previous.size()) != version.m_unHash) {
+            VLOG_ERROR(__FUNCTION__ " - Corrupt version %u of %s", i, name.c_str());
+            return false;
+        }
+        data.swap(previous);
+        bExists = version.m_bExists;
+    }
+    return true;
+}
+
+} // namespace VaporCore
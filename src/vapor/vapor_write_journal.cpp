@@ -0,0 +1,363 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Group-commit write-ahead journal for remote storage writes
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+
+#include "vapor_write_journal.h"
+#include "vapor_hash.h"
+#include "vapor_logger.h"
+
+namespace VaporCore {
+
+// Journal format: a header, then records until the end of the file. All
+// fields are host byte order, journals are local to the machine.
+static const uint32 JOURNAL_MAGIC = 0x4a574356;             // "VCWJ"
+static const uint32 JOURNAL_VERSION = 1;
+static const uint32 JOURNAL_RECORD_MAGIC = 0x52574356;      // "VCWR"
+
+// Sanity bound for names read back from a journal
+static const uint32 JOURNAL_MAX_NAME_LENGTH = 4096;
+
+struct JournalHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unVersion;
+    uint64 m_unReserved;
+};
+
+struct JournalRecordHeader
+{
+    uint32 m_unMagic;
+    uint32 m_unType;
+    uint32 m_unNameLength;
+    uint32 m_unReserved;
+    uint64 m_unDataSize;
+    uint64 m_unChecksum;    // Over the fields above, the name and the data
+};
+
+static_assert(sizeof(JournalHeader) == 16, "Journal header layout changed");
+static_assert(sizeof(JournalRecordHeader) == 32, "Journal record header layout changed");
+
+static uint64 RecordChecksum(const JournalRecordHeader& header, const char* pchName, const void* pData)
+{
+    uint64 hash = HashBytes64(&header, offsetof(JournalRecordHeader, m_unChecksum));
+    hash = HashBytes64(pchName, header.m_unNameLength, hash);
+    return HashBytes64(pData, static_cast<size_t>(header.m_unDataSize), hash);
+}
+
+static uint64 RecordSize(const std::string& name, const WriteJournal::Data& pData)
+{
+    return sizeof(JournalRecordHeader) + name.size() + (pData ? pData->size() : 0);
+}
+
+WriteJournal::WriteJournal(const std::string& directory, uint32 unGroupCommitMs, uint64 cubGroupCommit)
+    : m_sPath(directory + "/" + JOURNAL_FILENAME),
+      m_unGroupCommitMs(unGroupCommitMs),
+      m_cubGroupCommit(cubGroupCommit),
+      m_cubPending(0),
+      m_unEnd(sizeof(JournalHeader)),
+      m_unDurableEnd(sizeof(JournalHeader)),
+      m_unBase(sizeof(JournalHeader)),
+      m_cSyncs(0),
+      m_bBroken(false),
+      m_bStop(false)
+{
+}
+
+WriteJournal::~WriteJournal()
+{
+    Close();
+}
+
+bool WriteJournal::Open(const ReplayCallback& replay, DurableCallback durable)
+{
+    if (!m_file.Open(m_sPath, true)) {
+        return false;
+    }
+
+    if (m_file.Size() == 0) {
+        JournalHeader header = {};
+        header.m_unMagic = JOURNAL_MAGIC;
+        header.m_unVersion = JOURNAL_VERSION;
+        if (!m_file.Append(&header, sizeof(header)) || !m_file.Sync()) {
+            m_file.Close();
+            return false;
+        }
+    } else if (!Replay(replay)) {
+        m_file.Close();
+        return false;
+    }
+
+    // Positions start at the file offsets of what was replayed
+    m_unEnd = m_unDurableEnd = m_file.Size();
+    m_durableCallback = std::move(durable);
+    m_syncThread = std::thread(&WriteJournal::SyncThread, this);
+    return true;
+}
+
+void WriteJournal::Close()
+{
+    if (m_syncThread.joinable()) {
+        {
+            VAPORCORE_SCOPED_LOCK(m_mutex);
+            m_bStop = true;
+        }
+        m_pendingCondition.notify_all();
+        m_syncThread.join();
+    }
+
+    VAPORCORE_SCOPED_LOCK(m_fileMutex);
+    m_file.Close();
+}
+
+bool WriteJournal::Replay(const ReplayCallback& replay)
+{
+    // A journal we cannot read is kept for inspection, never truncated
+    JournalHeader header;
+    if (!m_file.ReadAt(0, &header, sizeof(header)) ||
+        header.m_unMagic != JOURNAL_MAGIC || header.m_unVersion != JOURNAL_VERSION) {
+        VLOG_ERROR(__FUNCTION__ " - Not a journal this build understands: %s", m_sPath.c_str());
+        return false;
+    }
+
+    uint64 unOffset = sizeof(JournalHeader);
+    uint64 unFileSize = m_file.Size();
+    uint32 cRecords = 0;
+    while (unOffset < unFileSize) {
+        JournalRecordHeader record;
+        if (unFileSize - unOffset < sizeof(record) || !m_file.ReadAt(unOffset, &record, sizeof(record)) ||
+            record.m_unMagic != JOURNAL_RECORD_MAGIC ||
+            record.m_unType < k_ERecordWrite || record.m_unType > k_ERecordDiscard ||
+            record.m_unNameLength == 0 || record.m_unNameLength > JOURNAL_MAX_NAME_LENGTH ||
+            record.m_unDataSize > unFileSize - unOffset - sizeof(record) - record.m_unNameLength) {
+            break;
+        }
+
+        std::string name(record.m_unNameLength, '\0');
+        auto pData = std::make_shared<std::vector<uint8>>(static_cast<size_t>(record.m_unDataSize));
+        uint64 unNameOffset = unOffset + sizeof(record);
+        if (!m_file.ReadAt(unNameOffset, &name[0], name.size()) ||
+            !m_file.ReadAt(unNameOffset + name.size(), pData->data(), pData->size()) ||
+            RecordChecksum(record, name.data(), pData->data()) != record.m_unChecksum) {
+            break;
+        }
+
+        ERecordType eType = static_cast<ERecordType>(record.m_unType);
+        replay(eType, name, eType == k_ERecordWrite ? Data(std::move(pData)) : Data());
+        unOffset = unNameOffset + name.size() + record.m_unDataSize;
+        ++cRecords;
+    }
+
+    // Whatever follows the last valid record was being written when the process died
+    if (unOffset < unFileSize) {
+        VLOG_WARNING(__FUNCTION__ " - Dropping %llu bytes of torn records from %s", unFileSize - unOffset, m_sPath.c_str());
+        if (!m_file.Truncate(unOffset) || !m_file.Sync()) {
+            return false;
+        }
+    }
+
+    if (cRecords > 0) {
+        VLOG_INFO(__FUNCTION__ " - Replayed %u records from %s", cRecords, m_sPath.c_str());
+    }
+    return true;
+}
+
+uint64 WriteJournal::Enqueue(ERecordType eType, const std::string& name, Data pData)
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    uint64 cubRecord = RecordSize(name, pData);
+    m_pending.push_back({ eType, name, std::move(pData) });
+    m_cubPending += cubRecord;
+    m_unEnd += cubRecord;
+
+    // The journal thread is either idle or waiting out the group commit delay
+    if (m_pending.size() == 1 || m_cubPending >= m_cubGroupCommit) {
+        m_pendingCondition.notify_one();
+    }
+    return m_unEnd;
+}
+
+bool WriteJournal::WaitDurable(uint64 unPosition)
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+    m_durableCondition.wait(lock, [&]() { return m_unDurableEnd >= unPosition || m_bBroken; });
+    return m_unDurableEnd >= unPosition;
+}
+
+bool WriteJournal::IsDurable(uint64 unPosition) const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return m_unDurableEnd >= unPosition;
+}
+
+bool WriteJournal::IsBroken() const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return m_bBroken;
+}
+
+uint64 WriteJournal::GetEnd() const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return m_unEnd;
+}
+
+uint64 WriteJournal::GetSize() const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return sizeof(JournalHeader) + m_unDurableEnd - m_unBase;
+}
+
+uint64 WriteJournal::GetSyncCount() const
+{
+    VAPORCORE_SCOPED_LOCK(m_mutex);
+    return m_cSyncs;
+}
+
+uint64 WriteJournal::FileOffset(uint64 unPosition) const
+{
+    return sizeof(JournalHeader) + unPosition - m_unBase;
+}
+
+bool WriteJournal::Checkpoint(uint64 unPosition)
+{
+    // The journal thread cannot append meanwhile, so the file ends at the durable end
+    VAPORCORE_SCOPED_LOCK(m_fileMutex);
+    uint64 unDurableEnd;
+    {
+        VAPORCORE_SCOPED_LOCK(m_mutex);
+        unDurableEnd = m_unDurableEnd;
+    }
+
+    unPosition = std::min(unPosition, unDurableEnd);
+    if (unPosition <= m_unBase || !m_file.IsOpen()) {
+        return true;
+    }
+
+    if (unPosition == unDurableEnd) {
+        // Nothing left to keep, the common case
+        if (!m_file.Truncate(sizeof(JournalHeader)) || !m_file.Sync()) {
+            return false;
+        }
+    } else {
+        // Keep the tail: a copy of it replaces the journal in one rename
+        uint64 unOffset = FileOffset(unPosition);
+        std::vector<uint8> data(static_cast<size_t>(sizeof(JournalHeader) + m_file.Size() - unOffset));
+        JournalHeader header = {};
+        header.m_unMagic = JOURNAL_MAGIC;
+        header.m_unVersion = JOURNAL_VERSION;
+        memcpy(data.data(), &header, sizeof(header));
+        if (!m_file.ReadAt(unOffset, data.data() + sizeof(header), data.size() - sizeof(header)) ||
+            !WriteFileAtomic(m_sPath, data.data(), data.size())) {
+            return false;
+        }
+
+        m_file.Close();
+    }
+
+    std::unique_lock<VaporCore::Mutex> stateLock(m_mutex);
+    if (!m_file.IsOpen() && !m_file.Open(m_sPath, false)) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to reopen %s", m_sPath.c_str());
+        m_bBroken = true;
+        m_durableCondition.notify_all();
+        return false;
+    }
+
+    VLOG_DEBUG(__FUNCTION__ " - Dropped %llu bytes of applied records", unPosition - m_unBase);
+    m_unBase = unPosition;
+    return true;
+}
+
+bool WriteJournal::WriteBatch(const std::vector<Record>& batch, uint64 cubBatch)
+{
+    std::vector<uint8> data;
+    data.reserve(static_cast<size_t>(cubBatch));
+    for (const Record& record : batch) {
+        JournalRecordHeader header = {};
+        header.m_unMagic = JOURNAL_RECORD_MAGIC;
+        header.m_unType = record.m_eType;
+        header.m_unNameLength = static_cast<uint32>(record.m_sName.size());
+        header.m_unDataSize = record.m_pData ? record.m_pData->size() : 0;
+        header.m_unChecksum = RecordChecksum(header, record.m_sName.data(), record.m_pData ? record.m_pData->data() : nullptr);
+
+        const uint8* pHeader = reinterpret_cast<const uint8*>(&header);
+        data.insert(data.end(), pHeader, pHeader + sizeof(header));
+        data.insert(data.end(), record.m_sName.begin(), record.m_sName.end());
+        if (record.m_pData) {
+            data.insert(data.end(), record.m_pData->begin(), record.m_pData->end());
+        }
+    }
+
+    // One append and one sync for the whole batch; a failure must not leave a partial batch behind
+    VAPORCORE_SCOPED_LOCK(m_fileMutex);
+    uint64 unSize = m_file.Size();
+    if (!m_file.IsOpen() || !m_file.Append(data.data(), data.size()) || !m_file.Sync()) {
+        VLOG_ERROR(__FUNCTION__ " - Failed to write %zu records to %s", batch.size(), m_sPath.c_str());
+        if (m_file.IsOpen()) {
+            m_file.Truncate(unSize);
+        }
+        return false;
+    }
+    return true;
+}
+
+void WriteJournal::SyncThread()
+{
+    std::unique_lock<VaporCore::Mutex> lock(m_mutex);
+
+    for (;;) {
+        m_pendingCondition.wait(lock, [this]() { return !m_pending.empty() || m_bStop; });
+        if (m_pending.empty()) {
+            break;
+        }
+
+        // Group commit: give concurrent writers a moment to join the batch
+        if (!m_bStop && m_unGroupCommitMs > 0 && m_cubPending < m_cubGroupCommit) {
+            m_pendingCondition.wait_for(lock, std::chrono::milliseconds(m_unGroupCommitMs),
+                                        [this]() { return m_cubPending >= m_cubGroupCommit || m_bStop; });
+        }
+
+        std::vector<Record> batch;
+        batch.swap(m_pending);
+        uint64 cubBatch = m_cubPending;
+        uint64 unBatchEnd = m_unEnd;
+        m_cubPending = 0;
+
+        bool bSuccess = false;
+        if (!m_bBroken) {
+            lock.unlock();
+            bSuccess = WriteBatch(batch, cubBatch);
+            batch.clear();
+            lock.lock();
+        }
+
+        if (bSuccess) {
+            m_unDurableEnd = unBatchEnd;
+            ++m_cSyncs;
+        } else if (!m_bBroken) {
+            m_bBroken = true;
+            VLOG_ERROR(__FUNCTION__ " - Journal broken, %s", m_sPath.c_str());
+        }
+        m_durableCondition.notify_all();
+
+        if (m_durableCallback) {
+            lock.unlock();
+            m_durableCallback();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace VaporCore
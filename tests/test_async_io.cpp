@@ -0,0 +1,142 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the asynchronous file I/O engine
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_async_io.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+struct ReadResult
+{
+    bool m_bSuccess = false;
+    std::vector<uint8> m_data;
+};
+
+// ReadAt, waited for
+static ReadResult ReadAt(const std::string& path, uint64 unOffset, uint32 cubToRead)
+{
+    std::promise<ReadResult> promise;
+    std::future<ReadResult> future = promise.get_future();
+    AsyncIO::GetInstance().ReadAt(path, unOffset, cubToRead, [&promise](bool bSuccess, std::vector<uint8>&& data) {
+        promise.set_value(ReadResult{ bSuccess, std::move(data) });
+    });
+    return future.get();
+}
+
+VAPOR_TEST(ReadsReturnTheRequestedRange)
+{
+    TempDirectory directory("async_io_reads");
+    std::string path = directory / "data.bin";
+    std::vector<uint8> data = RandomBytes(256 * 1024, 1);
+    VAPOR_REQUIRE(WriteDiskFile(path, data.data(), data.size()));
+
+    ReadResult result = ReadAt(path, 1000, 5000);
+    VAPOR_CHECK(result.m_bSuccess && result.m_data.size() == 5000);
+    VAPOR_CHECK(std::equal(result.m_data.begin(), result.m_data.end(), data.begin() + 1000));
+
+    // Short at the end, empty past it, failed for a missing file
+    result = ReadAt(path, data.size() - 10, 100);
+    VAPOR_CHECK(result.m_bSuccess && result.m_data.size() == 10);
+    result = ReadAt(path, data.size() + 10, 100);
+    VAPOR_CHECK(result.m_bSuccess && result.m_data.empty());
+    result = ReadAt(directory / "missing.bin", 0, 100);
+    VAPOR_CHECK(!result.m_bSuccess);
+
+    // Many reads in flight at once all complete with their own range
+    std::atomic<uint32> cCorrect{ 0 };
+    std::vector<std::future<void>> pending;
+    for (uint32 i = 0; i < 64; ++i) {
+        auto pPromise = std::make_shared<std::promise<void>>();
+        pending.push_back(pPromise->get_future());
+        uint64 unOffset = i * 4096;
+        AsyncIO::GetInstance().ReadAt(path, unOffset, 4096,
+            [&, pPromise, unOffset](bool bSuccess, std::vector<uint8>&& chunk) {
+                if (bSuccess && chunk.size() == 4096 && std::equal(chunk.begin(), chunk.end(), data.begin() + unOffset)) {
+                    ++cCorrect;
+                }
+                pPromise->set_value();
+            });
+    }
+    for (std::future<void>& future : pending) {
+        future.wait();
+    }
+    VAPOR_CHECK(cCorrect == 64);
+}
+
+VAPOR_TEST(TasksOfOneKeyRunInOrder)
+{
+    // Tasks of one key never overlap and keep their order, whichever worker runs them
+    std::mutex mutex;
+    std::vector<std::vector<int>> order(4);
+    std::atomic<int> running[4] = {};
+    std::atomic<bool> bOverlapped{ false };
+    std::atomic<int> cDone{ 0 };
+
+    for (int i = 0; i < 100; ++i) {
+        for (uint64 unKey = 0; unKey < 4; ++unKey) {
+            VAPOR_CHECK(AsyncIO::GetInstance().Post(unKey, [&, unKey, i]() {
+                if (running[unKey].fetch_add(1) != 0) {
+                    bOverlapped = true;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    order[unKey].push_back(i);
+                }
+                running[unKey].fetch_sub(1);
+                ++cDone;
+            }));
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (cDone < 400 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    VAPOR_REQUIRE(cDone == 400);
+    VAPOR_CHECK(!bOverlapped);
+    for (const std::vector<int>& keyOrder : order) {
+        VAPOR_CHECK(keyOrder.size() == 100 && std::is_sorted(keyOrder.begin(), keyOrder.end()));
+    }
+}
+
+// Runs last: the engine does not restart once shut down
+VAPOR_TEST(ShutdownFinishesQueuedWork)
+{
+    std::atomic<int> cDone{ 0 };
+    for (int i = 0; i < 20; ++i) {
+        VAPOR_CHECK(AsyncIO::GetInstance().Post(1, [&cDone]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ++cDone;
+        }));
+    }
+    AsyncIO::GetInstance().Shutdown();
+    VAPOR_CHECK(cDone == 20);
+
+    // Afterwards tasks are refused and reads fail right away
+    VAPOR_CHECK(!AsyncIO::GetInstance().Post(1, []() {}));
+    bool bCompleted = false;
+    bool bSucceeded = true;
+    AsyncIO::GetInstance().ReadAt("anything", 0, 1, [&](bool bSuccess, std::vector<uint8>&&) {
+        bCompleted = true;
+        bSucceeded = bSuccess;
+    });
+    VAPOR_CHECK(bCompleted && !bSucceeded);
+}
@@ -0,0 +1,156 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the deduplicating chunk store
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_chunk_store.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static std::vector<uint8> ReadManifest(ChunkStore& store, const ChunkManifest& manifest)
+{
+    std::vector<uint8> data(manifest.m_unSize);
+    int64 cubRead = store.Read(manifest, 0, data.data(), data.size());
+    data.resize(cubRead > 0 ? static_cast<size_t>(cubRead) : 0);
+    return data;
+}
+
+VAPOR_TEST(StoreWritesEachChunkOnce)
+{
+    TempDirectory directory("chunks_dedup");
+    std::shared_ptr<ChunkStore> pStore = ChunkStore::Open(directory / "chunks");
+    VAPOR_REQUIRE(pStore);
+    VAPOR_CHECK(ChunkStore::Open(directory / "chunks") == pStore);
+
+    std::vector<uint8> data = RandomBytes(1024 * 1024, 1);
+    ChunkManifest first;
+    VAPOR_REQUIRE(pStore->Store(data.data(), data.size(), first));
+    VAPOR_CHECK(first.m_unSize == data.size() && first.m_chunks.size() > 1);
+    ChunkStore::Stats stats = pStore->GetStats();
+    VAPOR_CHECK(stats.m_cubWritten == data.size() && stats.m_cubStored == data.size());
+
+    // The same contents again reference the chunks already stored
+    ChunkManifest second;
+    VAPOR_REQUIRE(pStore->Store(data.data(), data.size(), second));
+    VAPOR_CHECK(pStore->GetStats().m_cubWritten == stats.m_cubWritten);
+    VAPOR_CHECK(pStore->GetStats().m_cChunks == stats.m_cChunks);
+    VAPOR_CHECK(ReadManifest(*pStore, second) == data);
+
+    // An insertion only rewrites the chunks around it
+    std::vector<uint8> edited(data);
+    edited.insert(edited.begin() + edited.size() / 2, 10, 0x5a);
+    ChunkManifest third;
+    VAPOR_REQUIRE(pStore->Store(edited.data(), edited.size(), third));
+    VAPOR_CHECK(pStore->GetStats().m_cubWritten - stats.m_cubWritten < edited.size() / 4);
+    VAPOR_CHECK(ReadManifest(*pStore, third) == edited);
+
+    // Reads at an offset, short at the end
+    std::vector<uint8> part(1000);
+    VAPOR_CHECK(pStore->Read(third, 300000, part.data(), part.size()) == 1000);
+    VAPOR_CHECK(std::equal(part.begin(), part.end(), edited.begin() + 300000));
+    VAPOR_CHECK(pStore->Read(third, edited.size() - 10, part.data(), part.size()) == 10);
+}
+
+VAPOR_TEST(UnreferencedChunksAreDeleted)
+{
+    TempDirectory directory("chunks_release");
+    std::shared_ptr<ChunkStore> pStore = ChunkStore::Open(directory / "chunks");
+    VAPOR_REQUIRE(pStore);
+
+    std::vector<uint8> data = RandomBytes(512 * 1024, 2);
+    ChunkManifest manifest;
+    VAPOR_REQUIRE(pStore->Store(data.data(), data.size(), manifest));
+    VAPOR_REQUIRE(pStore->AddRef(manifest));
+
+    pStore->Release(manifest);
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == data.size());
+    VAPOR_CHECK(ReadManifest(*pStore, manifest) == data);
+    pStore->Release(manifest);
+    VAPOR_CHECK(pStore->GetStats().m_cChunks == 0 && pStore->GetStats().m_cubStored == 0);
+}
+
+VAPOR_TEST(ReferencesSurviveReopen)
+{
+    TempDirectory directory("chunks_reopen");
+    std::vector<uint8> kept = RandomBytes(300 * 1024, 3);
+    std::vector<uint8> rooted = RandomBytes(300 * 1024, 4);
+    ChunkManifest keptManifest;
+
+    {
+        std::shared_ptr<ChunkStore> pStore = ChunkStore::Open(directory / "chunks");
+        VAPOR_REQUIRE(pStore);
+        ChunkManifest rootedManifest;
+        VAPOR_REQUIRE(pStore->Store(kept.data(), kept.size(), keptManifest));
+        VAPOR_REQUIRE(pStore->Store(rooted.data(), rooted.size(), rootedManifest));
+
+        // The root takes over the reference Store() took
+        VAPOR_REQUIRE(pStore->PutRoot(GetUGCRootKey(7), rootedManifest));
+    }
+
+    // The log replays to the same counts
+    std::shared_ptr<ChunkStore> pStore = ChunkStore::Open(directory / "chunks");
+    VAPOR_REQUIRE(pStore);
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == kept.size() + rooted.size());
+    VAPOR_CHECK(ReadManifest(*pStore, keptManifest) == kept);
+
+    ChunkManifest root;
+    VAPOR_REQUIRE(pStore->GetRoot(GetUGCRootKey(7), root));
+    VAPOR_CHECK(ReadManifest(*pStore, root) == rooted);
+    VAPOR_CHECK(pStore->DeleteRoot(GetUGCRootKey(7)));
+    VAPOR_CHECK(!pStore->GetRoot(GetUGCRootKey(7), root));
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == kept.size());
+
+    // Manifests serialize to what a deduplicated storage keeps in place of the file
+    std::vector<uint8> serialized;
+    keptManifest.Serialize(serialized);
+    ChunkManifest parsed;
+    VAPOR_REQUIRE(ChunkManifest::Parse(serialized.data(), serialized.size(), parsed));
+    VAPOR_CHECK(ReadManifest(*pStore, parsed) == kept);
+    VAPOR_CHECK(!ChunkManifest::Parse(serialized.data(), serialized.size() - 1, parsed));
+}
+
+VAPOR_TEST(StorageSharesChunksBetweenFiles)
+{
+    TempDirectory directory("chunks_storage");
+    std::string ini = "[Storage]\nquota_mb=0\nquota_files=0\ndedup=true\nchunk_store_dir=" + (directory / "chunks") + "\n";
+    VAPOR_REQUIRE(LoadConfig(directory, ini));
+    std::vector<uint8> data = RandomBytes(512 * 1024, 5);
+
+    {
+        FileStorage storage(directory / "save");
+        VAPOR_REQUIRE(storage.WriteFile("one.sav", data.data(), data.size()));
+        VAPOR_REQUIRE(storage.WriteFile("two.sav", data.data(), data.size()));
+        VAPOR_REQUIRE(storage.WriteFile("tiny.sav", "tiny", 4));
+        VAPOR_CHECK(storage.GetFileSize("two.sav") == data.size());
+    }
+
+    std::shared_ptr<ChunkStore> pStore = ChunkStore::Open(directory / "chunks");
+    VAPOR_REQUIRE(pStore);
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == data.size());
+
+    FileStorage storage(directory / "save");
+    std::vector<uint8> read(data.size());
+    VAPOR_CHECK(storage.ReadFile("two.sav", read.data(), read.size()) == static_cast<int32>(data.size()));
+    VAPOR_CHECK(read == data);
+    char tiny[4];
+    VAPOR_CHECK(storage.ReadFile("tiny.sav", tiny, sizeof(tiny)) == 4 && std::string(tiny, 4) == "tiny");
+
+    // The chunks go with the last file that uses them
+    VAPOR_CHECK(storage.DeleteFile("one.sav"));
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == data.size());
+    VAPOR_CHECK(storage.DeleteFile("two.sav"));
+    VAPOR_CHECK(pStore->GetStats().m_cubStored == 0);
+}
@@ -0,0 +1,158 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of cloud sync between two storage directories
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// Configuration of two machines sharing one remote directory
+static bool LoadCloudConfig(const TempDirectory& directory, const std::string& storage, const std::string& cloud)
+{
+    return LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n" + storage +
+                                 "\n[Cloud]\nremote_directory=" + (directory / "remote") + "\n" + cloud + "\n");
+}
+
+static std::string ReadText(FileStorage& storage, const std::string& name)
+{
+    std::vector<char> buffer(1024 * 1024);
+    int32 cubRead = storage.ReadFile(name, buffer.data(), buffer.size());
+    return std::string(buffer.data(), static_cast<size_t>(cubRead));
+}
+
+static bool WriteText(FileStorage& storage, const std::string& name, const std::string& text)
+{
+    return storage.WriteFile(name, text.data(), text.size());
+}
+
+// Conflict copies left in a storage directory, by contents
+static std::vector<std::string> ConflictCopies(const std::string& save)
+{
+    std::vector<std::string> copies;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(save + "/" + CLOUD_SYNC_CONFLICT_DIRECTORY, ec)) {
+        std::vector<uint8> data = ReadDiskFile(entry.path().string());
+        copies.emplace_back(data.begin(), data.end());
+    }
+    return copies;
+}
+
+VAPOR_TEST(CloudSyncPropagatesChanges)
+{
+    TempDirectory directory("cloud_propagate");
+    VAPOR_REQUIRE(LoadCloudConfig(directory, "", ""));
+    FileStorage a(directory / "a"), b(directory / "b");
+    CloudSync syncA(a), syncB(b);
+    syncA.Start();
+    syncB.Start();
+
+    std::vector<uint8> large = RandomBytes(256 * 1024, 1);
+    VAPOR_CHECK(a.WriteFile("Saves/Slot1.sav", large.data(), large.size()));
+    VAPOR_CHECK(WriteText(a, "settings.ini", "volume=3"));
+    VAPOR_CHECK(syncA.SyncNow() && syncB.SyncNow());
+    VAPOR_CHECK(ReadText(b, "saves/slot1.sav") == std::string(large.begin(), large.end()));
+    VAPOR_CHECK(ReadText(b, "settings.ini") == "volume=3");
+
+    // Edits and deletes travel back the other way
+    large[1000] ^= 1;
+    VAPOR_CHECK(b.WriteFile("saves/slot1.sav", large.data(), large.size()));
+    VAPOR_CHECK(b.DeleteFile("settings.ini"));
+    VAPOR_CHECK(syncB.SyncNow() && syncA.SyncNow());
+    VAPOR_CHECK(ReadText(a, "saves/slot1.sav") == std::string(large.begin(), large.end()));
+    VAPOR_CHECK(!a.FileExists("settings.ini"));
+
+    // A forgotten file stays local only
+    VAPOR_CHECK(WriteText(a, "local.sav", "mine"));
+    VAPOR_CHECK(syncA.Forget("local.sav"));
+    VAPOR_CHECK(syncA.SyncNow() && syncB.SyncNow());
+    VAPOR_CHECK(!b.FileExists("local.sav"));
+    VAPOR_CHECK(ReadText(a, "local.sav") == "mine");
+}
+
+VAPOR_TEST(ConflictKeepsTheLosingCopy)
+{
+    TempDirectory directory("cloud_conflict_copy");
+    VAPOR_REQUIRE(LoadCloudConfig(directory, "version_history=0", "conflict_policy=remote"));
+    FileStorage a(directory / "a"), b(directory / "b");
+    CloudSync syncA(a), syncB(b);
+    syncA.Start();
+    syncB.Start();
+
+    VAPOR_CHECK(WriteText(a, "slot.sav", "base"));
+    VAPOR_CHECK(syncA.SyncNow() && syncB.SyncNow());
+    VAPOR_CHECK(ReadText(b, "slot.sav") == "base");
+
+    // Both sides change the file before either syncs: the remote copy wins
+    VAPOR_CHECK(WriteText(a, "slot.sav", "from A"));
+    VAPOR_CHECK(WriteText(b, "slot.sav", "from B"));
+    VAPOR_CHECK(syncB.SyncNow() && syncA.SyncNow());
+    VAPOR_CHECK(ReadText(a, "slot.sav") == "from B");
+
+    // Without version history, the losing copy is set aside where the game does not see it
+    VAPOR_CHECK((ConflictCopies(directory / "a") == std::vector<std::string>{ "from A" }));
+    std::vector<std::string> names;
+    VAPOR_CHECK(a.ListFiles("", names));
+    VAPOR_CHECK((names == std::vector<std::string>{ "slot.sav" }));
+    VAPOR_CHECK(!a.IsValidFilename(std::string(CLOUD_SYNC_CONFLICT_DIRECTORY) + "/slot.sav"));
+
+    // The same change on both sides is no conflict
+    VAPOR_CHECK(WriteText(a, "slot.sav", "same"));
+    VAPOR_CHECK(WriteText(b, "slot.sav", "same"));
+    VAPOR_CHECK(syncA.SyncNow() && syncB.SyncNow() && syncA.SyncNow());
+    VAPOR_CHECK(ReadText(a, "slot.sav") == "same" && ReadText(b, "slot.sav") == "same");
+    VAPOR_CHECK(ConflictCopies(directory / "a").size() == 1);
+}
+
+VAPOR_TEST(ConflictWithHistoryKeepsTheLosingVersion)
+{
+    TempDirectory directory("cloud_conflict_history");
+    VAPOR_REQUIRE(LoadCloudConfig(directory, "version_history=4", "conflict_policy=remote"));
+    FileStorage a(directory / "a"), b(directory / "b");
+    CloudSync syncA(a), syncB(b);
+    syncA.Start();
+    syncB.Start();
+
+    VAPOR_CHECK(WriteText(a, "slot.sav", "base"));
+    VAPOR_CHECK(syncA.SyncNow() && syncB.SyncNow());
+    VAPOR_CHECK(WriteText(a, "slot.sav", "from A"));
+    VAPOR_CHECK(WriteText(b, "slot.sav", "from B"));
+    VAPOR_CHECK(syncB.SyncNow() && syncA.SyncNow());
+    VAPOR_CHECK(ReadText(a, "slot.sav") == "from B");
+
+    // The version history holds the losing copy, no conflict copy is needed
+    VAPOR_CHECK(ConflictCopies(directory / "a").empty());
+    std::vector<FileStorage::FileVersion> versions;
+    VAPOR_REQUIRE(a.GetFileVersions("slot.sav", versions));
+    VAPOR_REQUIRE(!versions.empty() && versions[0].m_unSize == 6);
+    VAPOR_CHECK(a.RestoreFileVersion("slot.sav", 0));
+    VAPOR_CHECK(ReadText(a, "slot.sav") == "from A");
+}
+
+VAPOR_TEST(CloudBookkeepingNamesAreReserved)
+{
+    TempDirectory directory("cloud_names");
+    VAPOR_REQUIRE(LoadCloudConfig(directory, "", ""));
+    FileStorage storage(directory / "save");
+
+    VAPOR_CHECK(!storage.IsValidFilename("storage.vcsync"));
+    VAPOR_CHECK(!storage.WriteFile("Storage.VCSync", "x", 1));
+    VAPOR_CHECK(!storage.IsValidFilename(".vcconflicts"));
+    VAPOR_CHECK(!storage.IsValidFilename(".vcconflicts/slot.sav.1700000000"));
+    VAPOR_CHECK(!storage.IsValidFilename(".vcversions"));
+    VAPOR_CHECK(!storage.IsValidFilename(".VCVersions/slot.sav"));
+    VAPOR_CHECK(storage.IsValidFilename("saves/storage.vcsync"));
+}
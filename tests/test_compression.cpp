@@ -0,0 +1,140 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of stored file compression
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_compression.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// Compress and decompress through the raw block codec
+static bool RoundTrips(const std::vector<uint8>& data)
+{
+    std::vector<uint8> compressed(LZCompressBound(data.size()));
+    size_t cubCompressed = LZCompress(data.data(), data.size(), compressed.data(), compressed.size());
+    if (cubCompressed == 0 && !data.empty()) {
+        return false;
+    }
+
+    std::vector<uint8> decompressed(data.size());
+    return LZDecompress(compressed.data(), cubCompressed, decompressed.data(), decompressed.size()) && decompressed == data;
+}
+
+static std::vector<uint8> ReadAll(FileStorage& storage, const std::string& name)
+{
+    std::vector<uint8> data(storage.GetFileSize(name));
+    int32 cubRead = storage.ReadFile(name, data.data(), data.size());
+    data.resize(cubRead > 0 ? static_cast<size_t>(cubRead) : 0);
+    return data;
+}
+
+VAPOR_TEST(BlockCodecRoundTrips)
+{
+    VAPOR_CHECK(RoundTrips({}));
+    VAPOR_CHECK(RoundTrips({ 42 }));
+    VAPOR_CHECK(RoundTrips(RandomBytes(100 * 1024, 1)));
+    VAPOR_CHECK(RoundTrips(TextBytes(300 * 1024, 2)));
+
+    // Runs overlap their own match, and matches reach across the whole window
+    VAPOR_CHECK(RoundTrips(std::vector<uint8>(200 * 1024, 'a')));
+    std::vector<uint8> repeated = RandomBytes(60 * 1024, 3);
+    std::vector<uint8> twice(repeated);
+    twice.insert(twice.end(), repeated.begin(), repeated.end());
+    VAPOR_CHECK(RoundTrips(twice));
+}
+
+VAPOR_TEST(BlockCodecRejectsBadInput)
+{
+    std::vector<uint8> text = TextBytes(64 * 1024, 4);
+    std::vector<uint8> compressed(LZCompressBound(text.size()));
+    size_t cubCompressed = LZCompress(text.data(), text.size(), compressed.data(), compressed.size());
+    VAPOR_REQUIRE(cubCompressed > 0 && cubCompressed < text.size());
+
+    // Too small an output buffer is refused rather than overrun
+    std::vector<uint8> tooSmall(cubCompressed / 2);
+    VAPOR_CHECK(LZCompress(text.data(), text.size(), tooSmall.data(), tooSmall.size()) == 0);
+
+    // Decoding must produce exactly the expected size from intact input
+    std::vector<uint8> decompressed(text.size());
+    VAPOR_CHECK(!LZDecompress(compressed.data(), cubCompressed / 2, decompressed.data(), decompressed.size()));
+    VAPOR_CHECK(!LZDecompress(compressed.data(), cubCompressed, decompressed.data(), decompressed.size() - 1));
+    std::vector<uint8> larger(text.size() + 1);
+    VAPOR_CHECK(!LZDecompress(compressed.data(), cubCompressed, larger.data(), larger.size()));
+}
+
+VAPOR_TEST(StoredFilesKeepTheirHeaderHonest)
+{
+    std::vector<uint8> text = TextBytes(64 * 1024, 5);
+    std::vector<uint8> encoded;
+    VAPOR_REQUIRE(EncodeStoredFile(k_ECompressionCodecLZ, text.data(), text.size(), encoded));
+
+    StoredFileHeader header;
+    VAPOR_REQUIRE(ReadStoredFileHeader(encoded.data(), encoded.size(), header));
+    VAPOR_CHECK(header.m_unCodec == k_ECompressionCodecLZ && header.m_unOriginalSize == text.size());
+    std::vector<uint8> decoded(text.size());
+    VAPOR_CHECK(DecodeStoredFile(encoded.data(), encoded.size(), decoded.data(), decoded.size()) == static_cast<int64>(text.size()));
+    VAPOR_CHECK(decoded == text);
+
+    // Incompressible data is left verbatim, and plain data needs no header
+    std::vector<uint8> random = RandomBytes(64 * 1024, 6);
+    std::vector<uint8> unused;
+    VAPOR_CHECK(!EncodeStoredFile(k_ECompressionCodecLZ, random.data(), random.size(), unused));
+    VAPOR_CHECK(!NeedsStoredFileHeader(random.data(), random.size()));
+    VAPOR_CHECK(!ReadStoredFileHeader(random.data(), random.size(), header));
+
+    // Verbatim data that reads as a header must be stored behind one
+    VAPOR_CHECK(NeedsStoredFileHeader(encoded.data(), encoded.size()));
+
+    ECompressionCodec codec;
+    VAPOR_CHECK(ParseCompressionCodec(COMPRESSION_CODEC_LZ, codec) && codec == k_ECompressionCodecLZ);
+    VAPOR_CHECK(ParseCompressionCodec(COMPRESSION_CODEC_NONE, codec) && codec == k_ECompressionCodecNone);
+    VAPOR_CHECK(!ParseCompressionCodec("zip", codec));
+}
+
+VAPOR_TEST(PolicyCompressesByExtension)
+{
+    TempDirectory directory("compression_policy");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n[Compression]\n*=lz\npng=none\n"));
+    std::string save = directory / "save";
+    std::vector<uint8> text = TextBytes(256 * 1024, 7);
+    std::vector<uint8> random = RandomBytes(64 * 1024, 8);
+    std::vector<uint8> lookalike;
+    VAPOR_REQUIRE(EncodeStoredFile(k_ECompressionCodecLZ, text.data(), text.size(), lookalike));
+
+    {
+        FileStorage storage(save);
+        VAPOR_REQUIRE(storage.WriteFile("slot.sav", text.data(), text.size()));
+        VAPOR_REQUIRE(storage.WriteFile("shot.png", text.data(), text.size()));
+        VAPOR_REQUIRE(storage.WriteFile("noise.sav", random.data(), random.size()));
+        VAPOR_REQUIRE(storage.WriteFile("lookalike.png", lookalike.data(), lookalike.size()));
+
+        // Sizes and quota are the logical ones
+        VAPOR_CHECK(storage.GetFileSize("slot.sav") == text.size());
+        VAPOR_CHECK(storage.GetTotalStorageUsed() == 2 * text.size() + random.size() + lookalike.size());
+    }
+
+    VAPOR_CHECK(std::filesystem::file_size(save + "/slot.sav") < text.size() / 2);
+    VAPOR_CHECK(std::filesystem::file_size(save + "/shot.png") == text.size());
+    VAPOR_CHECK(std::filesystem::file_size(save + "/noise.sav") == random.size());
+
+    // Everything reads back as written after a restart, the lookalike included
+    FileStorage storage(save);
+    VAPOR_CHECK(storage.GetFileSize("slot.sav") == text.size());
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == text);
+    VAPOR_CHECK(ReadAll(storage, "shot.png") == text);
+    VAPOR_CHECK(ReadAll(storage, "noise.sav") == random);
+    VAPOR_CHECK(ReadAll(storage, "lookalike.png") == lookalike);
+}
@@ -0,0 +1,128 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the configuration snapshots
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "vaporcore_test.h"
+#include "vapor_config.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static constexpr Config::Key KEY_TEST_NAME{ "Test", "name" };
+static constexpr Config::Key KEY_TEST_COUNT{ "Test", "count" };
+
+// Rewrite the ini LoadConfig() wrote and reload it
+static bool ReloadConfig(const TempDirectory& directory, const std::string& text)
+{
+    return WriteDiskFile(directory / "vaporcore.ini", text.data(), text.size()) && Config::GetInstance().Reload();
+}
+
+VAPOR_TEST(ReloadPublishesNewValues)
+{
+    TempDirectory directory("config_reload");
+    Config& config = Config::GetInstance();
+    VAPOR_REQUIRE(LoadConfig(directory, "[Test]\nname=first\ncount=1\n"));
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "first");
+    VAPOR_CHECK(config.GetInt(KEY_TEST_COUNT) == 1);
+
+    int cNotified = 0;
+    Config::SubscriptionId id = config.Subscribe({ KEY_TEST_COUNT }, [&]() { ++cNotified; });
+
+    // Only a change of a subscribed key notifies
+    VAPOR_CHECK(ReloadConfig(directory, "[Test]\nname=second\ncount=1\n"));
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "second");
+    VAPOR_CHECK(cNotified == 0);
+    VAPOR_CHECK(ReloadConfig(directory, "[Test]\nname=second\ncount=2\n"));
+    VAPOR_CHECK(config.GetInt(KEY_TEST_COUNT) == 2);
+    VAPOR_CHECK(cNotified == 1);
+
+    config.Unsubscribe(id);
+    VAPOR_CHECK(ReloadConfig(directory, "[Test]\ncount=3\n"));
+    VAPOR_CHECK(cNotified == 1);
+    VAPOR_CHECK(!config.HasKey(KEY_TEST_NAME));
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME, "default") == "default");
+}
+
+VAPOR_TEST(ViewsOutliveTheNextReload)
+{
+    TempDirectory directory("config_views");
+    Config& config = Config::GetInstance();
+    VAPOR_REQUIRE(LoadConfig(directory, "[Test]\nname=kept across a reload\n"));
+
+    // The snapshot a view came from is retired, not freed, by the next reload
+    std::string_view name = config.GetString(KEY_TEST_NAME);
+    VAPOR_CHECK(ReloadConfig(directory, "[Test]\nname=replaced\n"));
+    VAPOR_CHECK(name == "kept across a reload");
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "replaced");
+
+    // Many reloads keep only the current snapshot and the one before it
+    for (int i = 0; i < 100; ++i) {
+        VAPOR_CHECK(ReloadConfig(directory, "[Test]\ncount=" + std::to_string(i) + "\n"));
+    }
+    VAPOR_CHECK(config.GetInt(KEY_TEST_COUNT) == 99);
+}
+
+VAPOR_TEST(CacheTrustsTheSourceStamp)
+{
+    TempDirectory directory("config_cache");
+    Config& config = Config::GetInstance();
+    std::string ini = directory / "vaporcore.ini";
+    VAPOR_REQUIRE(LoadConfig(directory, "[VaporCore]\nconfig_cache=true\n[Test]\nname=aaaa\n"));
+    VAPOR_CHECK(std::filesystem::exists(ini + CONFIG_CACHE_EXTENSION));
+
+    // Same size, new time: the contents are hashed and the edit is seen
+    VAPOR_CHECK(ReloadConfig(directory, "[VaporCore]\nconfig_cache=true\n[Test]\nname=bbbb\n"));
+    std::filesystem::last_write_time(ini, std::filesystem::last_write_time(ini) + std::chrono::seconds(1));
+    VAPOR_CHECK(config.Reload());
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "bbbb");
+
+    // Same size and time: the cache is used without reading the source
+    auto modifiedTime = std::filesystem::last_write_time(ini);
+    std::string edited = "[VaporCore]\nconfig_cache=true\n[Test]\nname=cccc\n";
+    VAPOR_CHECK(WriteDiskFile(ini, edited.data(), edited.size()));
+    std::filesystem::last_write_time(ini, modifiedTime);
+    VAPOR_CHECK(config.Reload());
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "bbbb");
+
+    // A different size is stale whatever the time says
+    edited = "[VaporCore]\nconfig_cache=true\n[Test]\nname=dddddd\n";
+    VAPOR_CHECK(WriteDiskFile(ini, edited.data(), edited.size()));
+    std::filesystem::last_write_time(ini, modifiedTime);
+    VAPOR_CHECK(config.Reload());
+    VAPOR_CHECK(config.GetString(KEY_TEST_NAME) == "dddddd");
+}
+
+VAPOR_TEST(TypedValuesParseWholeNumbers)
+{
+    TempDirectory directory("config_numbers");
+    Config& config = Config::GetInstance();
+    VAPOR_REQUIRE(LoadConfig(directory, "[Test]\nplain=12\nsigned=+12\nnegative=-12\nsuffix=12abc\n"
+                                        "quoted=\" 12 \"\nsigns=+-12\nfloat=+1.5\nbad_float=1.5x\n"));
+
+    VAPOR_CHECK(config.GetInt("Test", "plain", 0) == 12);
+    VAPOR_CHECK(config.GetInt("Test", "signed", 0) == 12);
+    VAPOR_CHECK(config.GetUInt32("Test", "signed", 0) == 12);
+    VAPOR_CHECK(config.GetUInt64("Test", "signed", 0) == 12);
+    VAPOR_CHECK(config.GetInt("Test", "negative", 0) == -12);
+    VAPOR_CHECK(config.GetInt("Test", "quoted", 0) == 12);
+    VAPOR_CHECK(config.GetFloat("Test", "float", 0.0f) == 1.5f);
+
+    // A number followed by anything else is not a number
+    VAPOR_CHECK(config.GetInt("Test", "suffix", 7) == 7);
+    VAPOR_CHECK(config.GetUInt64("Test", "suffix", 7) == 7);
+    VAPOR_CHECK(config.GetInt("Test", "signs", 7) == 7);
+    VAPOR_CHECK(config.GetFloat("Test", "bad_float", 7.0f) == 7.0f);
+    VAPOR_CHECK(config.GetUInt32("Test", "negative", 7) == 7);
+}
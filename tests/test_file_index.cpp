@@ -0,0 +1,90 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the FileStorage metadata index
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+VAPOR_TEST(IndexTracksWritesAndDeletes)
+{
+    TempDirectory directory("index_writes");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+
+    VAPOR_CHECK(storage.WriteFile("b.sav", "12345", 5));
+    VAPOR_CHECK(storage.WriteFile("A.sav", "123", 3));
+    VAPOR_CHECK(storage.WriteFile("dir/c.sav", "1", 1));
+    VAPOR_CHECK(storage.GetFileCount() == 3);
+    VAPOR_CHECK(storage.GetTotalStorageUsed() == 9);
+    VAPOR_CHECK(storage.FileExists("a.sav"));
+    VAPOR_CHECK(storage.GetFileSize("B.SAV") == 5);
+
+    // Enumeration is sorted by normalized name
+    int32 cubSize = 0;
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(0, &cubSize)) == "a.sav" && cubSize == 3);
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(1, &cubSize)) == "b.sav" && cubSize == 5);
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(2, &cubSize)) == "dir/c.sav" && cubSize == 1);
+
+    // Overwrites replace the size in the total, deletes take it out
+    VAPOR_CHECK(storage.WriteFile("b.sav", "1234567890", 10));
+    VAPOR_CHECK(storage.GetTotalStorageUsed() == 14);
+    VAPOR_CHECK(storage.DeleteFile("a.sav"));
+    VAPOR_CHECK(!storage.FileExists("a.sav"));
+    VAPOR_CHECK(storage.GetFileCount() == 2);
+    VAPOR_CHECK(storage.GetTotalStorageUsed() == 11);
+    VAPOR_CHECK(!storage.DeleteFile("a.sav"));
+}
+
+VAPOR_TEST(IndexAnswersWithoutTheDisk)
+{
+    TempDirectory directory("index_authoritative");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    VAPOR_REQUIRE(storage.WriteFile("kept.sav", "data", 4));
+    int64 nTimestamp = storage.GetFileTimestamp("kept.sav");
+    VAPOR_CHECK(nTimestamp > 0);
+
+    // Metadata queries are served from the index built at open, so a file removed
+    // behind the storage's back is still reported
+    std::filesystem::remove(directory / "save/kept.sav");
+    VAPOR_CHECK(storage.FileExists("kept.sav"));
+    VAPOR_CHECK(storage.GetFileSize("kept.sav") == 4);
+    VAPOR_CHECK(storage.GetFileTimestamp("kept.sav") == nTimestamp);
+}
+
+VAPOR_TEST(IndexIsRebuiltOnOpen)
+{
+    TempDirectory directory("index_rebuild");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    {
+        FileStorage storage(directory / "save");
+        VAPOR_REQUIRE(storage.WriteFile("one.sav", "1", 1));
+        VAPOR_REQUIRE(storage.WriteFile("sub/two.sav", "22", 2));
+        storage.Shutdown();
+    }
+
+    // Files that appeared while nothing had the storage open are picked up too
+    VAPOR_REQUIRE(WriteDiskFile(directory / "save/three.sav", "333", 3));
+
+    FileStorage storage(directory / "save");
+    VAPOR_CHECK(storage.GetFileCount() == 3);
+    VAPOR_CHECK(storage.GetTotalStorageUsed() == 6);
+    VAPOR_CHECK(storage.GetFileSize("sub/two.sav") == 2);
+
+    char buffer[8] = {};
+    VAPOR_CHECK(storage.ReadFile("three.sav", buffer, sizeof(buffer)) == 3 && memcmp(buffer, "333", 3) == 0);
+}
@@ -0,0 +1,99 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of FileStorage mapped reads and file views
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static bool ViewEquals(const FileView& view, const std::vector<uint8>& data)
+{
+    return view.m_cubData == data.size() && std::equal(data.begin(), data.end(), view.m_pData);
+}
+
+VAPOR_TEST(MappedAndCopiedReadsAgree)
+{
+    TempDirectory directory("view_reads");
+    std::vector<uint8> small = RandomBytes(512, 1);
+    std::vector<uint8> large = RandomBytes(2 * 1024 * 1024 + 5, 2);
+
+    // The default threshold copies small files and maps the large one, a threshold of 1 KB maps both
+    for (const char* pszIni : { "[Storage]\nquota_mb=0\nquota_files=0\n",
+                                "[Storage]\nquota_mb=0\nquota_files=0\nmmap_threshold_kb=1\n" }) {
+        VAPOR_REQUIRE(LoadConfig(directory, pszIni));
+        std::filesystem::remove_all(directory / "save");
+        FileStorage storage(directory / "save");
+        VAPOR_REQUIRE(storage.WriteFile("small.bin", small.data(), small.size()));
+        VAPOR_REQUIRE(storage.WriteFile("large.bin", large.data(), large.size()));
+
+        for (const std::vector<uint8>* pData : { &small, &large }) {
+            std::string name = pData == &small ? "small.bin" : "large.bin";
+            std::vector<uint8> read(pData->size());
+            VAPOR_CHECK(storage.ReadFile(name, read.data(), read.size()) == static_cast<int32>(pData->size()));
+            VAPOR_CHECK(read == *pData);
+
+            FileView view;
+            VAPOR_REQUIRE(storage.OpenFileView(name, view));
+            VAPOR_CHECK(ViewEquals(view, *pData));
+        }
+
+        // A buffer short of the file gets what fits
+        std::vector<uint8> part(1000);
+        VAPOR_CHECK(storage.ReadFile("large.bin", part.data(), part.size()) == 1000);
+        VAPOR_CHECK(std::equal(part.begin(), part.end(), large.begin()));
+    }
+}
+
+VAPOR_TEST(ViewOutlivesTheFile)
+{
+    TempDirectory directory("view_outlives");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\nmmap_threshold_kb=1\n"));
+    FileStorage storage(directory / "save");
+    std::vector<uint8> first = RandomBytes(64 * 1024, 3);
+    std::vector<uint8> second = RandomBytes(32 * 1024, 4);
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", first.data(), first.size()));
+
+    // Writes replace the file rather than change it, so the view keeps what it saw
+    FileView view;
+    VAPOR_REQUIRE(storage.OpenFileView("slot.sav", view));
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", second.data(), second.size()));
+    VAPOR_CHECK(ViewEquals(view, first));
+
+    FileView replaced;
+    VAPOR_REQUIRE(storage.OpenFileView("slot.sav", replaced));
+    VAPOR_CHECK(ViewEquals(replaced, second));
+    VAPOR_REQUIRE(storage.DeleteFile("slot.sav"));
+    VAPOR_CHECK(ViewEquals(view, first));
+    VAPOR_CHECK(ViewEquals(replaced, second));
+
+    FileView missing;
+    VAPOR_CHECK(!storage.OpenFileView("slot.sav", missing));
+}
+
+VAPOR_TEST(EncodedFileViewsAreDecoded)
+{
+    TempDirectory directory("view_encoded");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\nmmap_threshold_kb=1\n[Compression]\nsav=lz\n"));
+    FileStorage storage(directory / "save");
+    std::vector<uint8> text = TextBytes(256 * 1024, 5);
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", text.data(), text.size()));
+    VAPOR_CHECK(std::filesystem::file_size(directory / "save/slot.sav") < text.size());
+
+    FileView view;
+    VAPOR_REQUIRE(storage.OpenFileView("slot.sav", view));
+    VAPOR_CHECK(ViewEquals(view, text));
+}
@@ -0,0 +1,280 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the leaderboard rank index, rank queries and board files
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_leaderboard.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static bool LoadLeaderboardConfig(const TempDirectory& directory)
+{
+    return LoadConfig(directory, "[Stats]\ndirectory=" + (directory / "stats") + "\n");
+}
+
+static bool Upload(Leaderboards& boards, SteamLeaderboard_t hBoard, uint64 unSteamID, int32 nScore,
+                   ELeaderboardUploadScoreMethod eMethod = k_ELeaderboardUploadScoreMethodKeepBest)
+{
+    Leaderboards::UploadResult result;
+    return boards.Upload(hBoard, unSteamID, eMethod, nScore, nullptr, 0, result);
+}
+
+// The board file or log of the only board in the directory
+static std::string FindBoardPath(const TempDirectory& directory, const std::string& extension)
+{
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory / "stats", ec)) {
+        if (entry.path().extension() == extension) {
+            return entry.path().string();
+        }
+    }
+    return std::string();
+}
+
+// Steam IDs of the rows, in the order returned
+static std::vector<uint64> SteamIDs(const std::vector<Leaderboards::Row>& rows)
+{
+    std::vector<uint64> ids;
+    for (const Leaderboards::Row& row : rows) {
+        ids.push_back(row.m_unSteamID);
+    }
+    return ids;
+}
+
+VAPOR_TEST(IndexMatchesSortedOrder)
+{
+    LeaderboardIndex index;
+    std::vector<LeaderboardIndex::Key> sorted;
+    std::mt19937_64 random(1);
+    for (uint64 i = 0; i < 5000; ++i) {
+        LeaderboardIndex::Key key{ static_cast<int64>(random() % 1000), i, random() };
+        index.Insert(key);
+        sorted.push_back(key);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // Every other key leaves, ranks of the rest close up
+    for (size_t i = 0; i < sorted.size(); i += 2) {
+        VAPOR_CHECK(index.Erase(sorted[i]));
+    }
+    VAPOR_CHECK(!index.Erase(sorted[0]));
+    std::vector<LeaderboardIndex::Key> kept;
+    for (size_t i = 1; i < sorted.size(); i += 2) {
+        kept.push_back(sorted[i]);
+    }
+    VAPOR_REQUIRE(index.Size() == kept.size());
+
+    for (size_t i = 0; i < kept.size(); i += 97) {
+        VAPOR_CHECK(index.Rank(kept[i]) == i + 1);
+        VAPOR_CHECK(index.CountLess(kept[i]) == i);
+    }
+    VAPOR_CHECK(index.Rank(sorted[0]) == 0);
+    VAPOR_CHECK(index.CountLess(sorted[2]) == 1);
+
+    std::vector<LeaderboardIndex::Key> page;
+    index.Range(1000, 50, page);
+    VAPOR_CHECK(std::equal(page.begin(), page.end(), kept.begin() + 999) && page.size() == 50);
+    page.clear();
+    index.Range(static_cast<uint32>(kept.size()) - 1, 50, page);
+    VAPOR_CHECK(page.size() == 2 && page.back() == kept.back());
+}
+
+VAPOR_TEST(RanksFollowScoresAndUploadOrder)
+{
+    TempDirectory directory("leaderboard_ranks");
+    VAPOR_REQUIRE(LoadLeaderboardConfig(directory));
+    Leaderboards boards;
+    SteamLeaderboard_t hBoard = boards.FindOrCreate("Best Time", k_ELeaderboardSortMethodDescending,
+                                                    k_ELeaderboardDisplayTypeNumeric);
+    VAPOR_REQUIRE(hBoard != 0);
+
+    // Equal scores rank by who uploaded first
+    VAPOR_CHECK(Upload(boards, hBoard, 1, 100));
+    VAPOR_CHECK(Upload(boards, hBoard, 2, 300));
+    VAPOR_CHECK(Upload(boards, hBoard, 3, 200));
+    VAPOR_CHECK(Upload(boards, hBoard, 4, 300));
+    VAPOR_CHECK(boards.GetEntryCount(hBoard) == 4);
+
+    std::vector<Leaderboards::Row> rows;
+    VAPOR_CHECK(boards.GetRange(hBoard, 1, 10, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 2, 4, 3, 1 }));
+    VAPOR_CHECK(rows[0].m_nGlobalRank == 1 && rows[3].m_nGlobalRank == 4 && rows[3].m_nScore == 100);
+
+    // Keep-best ignores a worse score, force-update takes it
+    Leaderboards::UploadResult result;
+    VAPOR_CHECK(boards.Upload(hBoard, 2, k_ELeaderboardUploadScoreMethodKeepBest, 50, nullptr, 0, result));
+    VAPOR_CHECK(!result.m_bScoreChanged && result.m_nGlobalRankNew == 1);
+    VAPOR_CHECK(boards.Upload(hBoard, 2, k_ELeaderboardUploadScoreMethodForceUpdate, 50, nullptr, 0, result));
+    VAPOR_CHECK(result.m_bScoreChanged && result.m_nGlobalRankPrevious == 1 && result.m_nGlobalRankNew == 4);
+
+    rows.clear();
+    VAPOR_CHECK(boards.GetRange(hBoard, 2, 3, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 3, 1 }));
+
+    // Requested users come back in rank order, unknown ones are left out
+    const uint64 users[] = { 2, 99, 4 };
+    rows.clear();
+    VAPOR_CHECK(boards.GetUsers(hBoard, users, 3, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 4, 2 }));
+
+    // Ascending boards rank the lowest score first
+    SteamLeaderboard_t hAscending = boards.FindOrCreate("Fastest Lap", k_ELeaderboardSortMethodAscending,
+                                                        k_ELeaderboardDisplayTypeTimeMilliSeconds);
+    VAPOR_CHECK(Upload(boards, hAscending, 1, 900));
+    VAPOR_CHECK(Upload(boards, hAscending, 2, 700));
+    VAPOR_CHECK(Upload(boards, hAscending, 1, 600));
+    rows.clear();
+    VAPOR_CHECK(boards.GetRange(hAscending, 1, 2, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 1, 2 }) && rows[0].m_nScore == 600);
+}
+
+VAPOR_TEST(WindowAroundUserStaysInsideTheBoard)
+{
+    TempDirectory directory("leaderboard_around");
+    VAPOR_REQUIRE(LoadLeaderboardConfig(directory));
+    Leaderboards boards;
+    SteamLeaderboard_t hBoard = boards.FindOrCreate("Score", k_ELeaderboardSortMethodDescending,
+                                                    k_ELeaderboardDisplayTypeNumeric);
+    VAPOR_REQUIRE(hBoard != 0);
+
+    // User i scores 1000 - i, so user i holds rank i
+    for (uint64 i = 1; i <= 100; ++i) {
+        VAPOR_CHECK(Upload(boards, hBoard, i, static_cast<int32>(1000 - i)));
+    }
+
+    std::vector<Leaderboards::Row> rows;
+    VAPOR_CHECK(boards.GetAroundUser(hBoard, 50, -2, 2, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 48, 49, 50, 51, 52 }));
+
+    // Near either end the window slides rather than shrinking
+    rows.clear();
+    VAPOR_CHECK(boards.GetAroundUser(hBoard, 2, -5, 4, rows));
+    VAPOR_CHECK(rows.size() == 10 && rows.front().m_nGlobalRank == 1 && rows.back().m_nGlobalRank == 10);
+    rows.clear();
+    VAPOR_CHECK(boards.GetAroundUser(hBoard, 99, -1, 5, rows));
+    VAPOR_CHECK(rows.size() == 7 && rows.front().m_nGlobalRank == 94 && rows.back().m_nGlobalRank == 100);
+
+    // A user without an entry gets nothing
+    rows.clear();
+    VAPOR_CHECK(boards.GetAroundUser(hBoard, 1000, -2, 2, rows));
+    VAPOR_CHECK(rows.empty());
+}
+
+VAPOR_TEST(ChangesSurviveReopenThroughTheLog)
+{
+    TempDirectory directory("leaderboard_log");
+    VAPOR_REQUIRE(LoadLeaderboardConfig(directory));
+    const int32 details[] = { 7, 8, 9 };
+
+    {
+        Leaderboards boards;
+        SteamLeaderboard_t hBoard = boards.FindOrCreate("Score", k_ELeaderboardSortMethodAscending,
+                                                        k_ELeaderboardDisplayTypeNumeric);
+        VAPOR_REQUIRE(hBoard != 0);
+        Leaderboards::UploadResult result;
+        VAPOR_CHECK(boards.Upload(hBoard, 1, k_ELeaderboardUploadScoreMethodKeepBest, 30, details, 3, result));
+        VAPOR_CHECK(Upload(boards, hBoard, 2, 10));
+        VAPOR_CHECK(boards.AttachUGC(hBoard, 1, 1234));
+        VAPOR_CHECK(Upload(boards, hBoard, 3, 20));
+    }
+
+    // The board is found again, with its sort method, entries, details and UGC
+    {
+        Leaderboards boards;
+        SteamLeaderboard_t hBoard = boards.Find("Score");
+        VAPOR_REQUIRE(hBoard != 0);
+        VAPOR_CHECK(boards.GetSortMethod(hBoard) == k_ELeaderboardSortMethodAscending);
+        std::vector<Leaderboards::Row> rows;
+        VAPOR_CHECK(boards.GetRange(hBoard, 1, 10, rows));
+        VAPOR_REQUIRE((SteamIDs(rows) == std::vector<uint64>{ 2, 3, 1 }));
+        VAPOR_CHECK(rows[2].m_hUGC == 1234 && (rows[2].m_details == std::vector<int32>{ 7, 8, 9 }));
+    }
+
+    // A crash in the middle of the last append loses only that change
+    std::string log = FindBoardPath(directory, ".vclog");
+    VAPOR_REQUIRE(!log.empty());
+    std::filesystem::resize_file(log, std::filesystem::file_size(log) - 4);
+
+    Leaderboards boards;
+    SteamLeaderboard_t hBoard = boards.Find("Score");
+    VAPOR_REQUIRE(hBoard != 0);
+    std::vector<Leaderboards::Row> rows;
+    VAPOR_CHECK(boards.GetRange(hBoard, 1, 10, rows));
+    VAPOR_CHECK((SteamIDs(rows) == std::vector<uint64>{ 2, 1 }));
+    VAPOR_CHECK(boards.Find("Missing") == 0);
+}
+
+VAPOR_TEST(MergedBoardFileKeepsRanks)
+{
+    TempDirectory directory("leaderboard_merge");
+    VAPOR_REQUIRE(LoadLeaderboardConfig(directory));
+
+    // Distinct scores 0..cUsers-1 in scrambled upload order; a score of s ranks cUsers - s
+    const uint32 cUsers = 20000;
+    auto scoreOf = [](uint64 unSteamID) { return static_cast<int32>((unSteamID * 7919) % cUsers); };
+    auto rankOf = [&](uint64 unSteamID) { return static_cast<int32>(cUsers) - scoreOf(unSteamID); };
+
+    {
+        Leaderboards boards;
+        SteamLeaderboard_t hBoard = boards.FindOrCreate("Score", k_ELeaderboardSortMethodDescending,
+                                                        k_ELeaderboardDisplayTypeNumeric);
+        VAPOR_REQUIRE(hBoard != 0);
+        std::string file = FindBoardPath(directory, ".vclb");
+        uint64 unEmptySize = std::filesystem::file_size(file);
+        for (uint64 unSteamID = 0; unSteamID < cUsers; ++unSteamID) {
+            VAPOR_CHECK(Upload(boards, hBoard, unSteamID, scoreOf(unSteamID)));
+        }
+
+        // Enough changes piled up for the background merge into a new board file
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::filesystem::file_size(file) == unEmptySize && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        VAPOR_CHECK(std::filesystem::file_size(file) > unEmptySize + cUsers * sizeof(int32));
+
+        // Changes on top of the merged file replace their rows
+        VAPOR_CHECK(Upload(boards, hBoard, 0, 1000000));
+        VAPOR_CHECK(boards.GetEntryCount(hBoard) == static_cast<int>(cUsers));
+    }
+
+    Leaderboards boards;
+    SteamLeaderboard_t hBoard = boards.Find("Score");
+    VAPOR_REQUIRE(hBoard != 0);
+    VAPOR_CHECK(boards.GetEntryCount(hBoard) == static_cast<int>(cUsers));
+
+    // User 0 moved from the last rank to the first, everyone else one rank down from where the score put them
+    std::vector<Leaderboards::Row> rows;
+    VAPOR_CHECK(boards.GetRange(hBoard, 1, 3, rows));
+    VAPOR_REQUIRE(rows.size() == 3);
+    VAPOR_CHECK(rows[0].m_unSteamID == 0 && rows[0].m_nScore == 1000000);
+    VAPOR_CHECK(rows[1].m_nScore == static_cast<int32>(cUsers) - 1 && rows[2].m_nScore == static_cast<int32>(cUsers) - 2);
+
+    const uint64 users[] = { 1, 4321, 19999 };
+    rows.clear();
+    VAPOR_CHECK(boards.GetUsers(hBoard, users, 3, rows));
+    VAPOR_REQUIRE(rows.size() == 3);
+    for (const Leaderboards::Row& row : rows) {
+        VAPOR_CHECK(row.m_nScore == scoreOf(row.m_unSteamID));
+        VAPOR_CHECK(row.m_nGlobalRank == rankOf(row.m_unSteamID) + 1);
+    }
+
+    rows.clear();
+    VAPOR_CHECK(boards.GetRange(hBoard, cUsers - 1, cUsers + 10, rows));
+    VAPOR_CHECK(rows.size() == 2 && rows.back().m_nScore == 1 && rows.back().m_nGlobalRank == static_cast<int32>(cUsers));
+}
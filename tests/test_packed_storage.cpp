@@ -0,0 +1,141 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the packed storage container
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+#include "vapor_packed_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// Whole contents of a file in the container, empty if missing
+static std::vector<uint8> ReadPacked(PackedFileBackend& backend, const std::string& name)
+{
+    uint64 unSize;
+    int64 nTimestamp;
+    if (!backend.Stat(name, unSize, nTimestamp)) {
+        return {};
+    }
+    std::vector<uint8> data(static_cast<size_t>(unSize));
+    if (backend.Read(name, 0, data.data(), data.size()) != static_cast<int64>(unSize)) {
+        return {};
+    }
+    return data;
+}
+
+VAPOR_TEST(PackedCompactionReclaimsGarbage)
+{
+    TempDirectory directory("packed_compaction");
+    std::string container = directory / PACKED_CONTAINER_FILENAME;
+    std::vector<uint8> kept = RandomBytes(1000, 1);
+    std::vector<uint8> latest;
+
+    {
+        PackedFileBackend backend(directory.Path(), 50);
+        VAPOR_REQUIRE(backend.Open());
+        VAPOR_CHECK(backend.Write("kept.sav", kept.data(), kept.size()));
+        VAPOR_CHECK(backend.Write("gone.sav", kept.data(), kept.size()));
+        VAPOR_CHECK(backend.Delete("gone.sav"));
+
+        // Each rewrite supersedes the last, soon most of the container is garbage
+        const uint32 cRewrites = 8;
+        for (uint32 i = 0; i < cRewrites; ++i) {
+            latest = RandomBytes(512 * 1024, 10 + i);
+            VAPOR_CHECK(backend.Write("rewritten.sav", latest.data(), latest.size()));
+        }
+
+        // Background compaction keeps the container to the live records plus
+        // less garbage than its threshold, not everything that was written
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::filesystem::file_size(container) > 3 * latest.size() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        VAPOR_CHECK(std::filesystem::file_size(container) <= 3 * latest.size());
+        VAPOR_CHECK(std::filesystem::file_size(container) < cRewrites * latest.size() / 2);
+
+        VAPOR_CHECK(ReadPacked(backend, "rewritten.sav") == latest);
+        VAPOR_CHECK(ReadPacked(backend, "kept.sav") == kept);
+        uint64 unSize;
+        int64 nTimestamp;
+        VAPOR_CHECK(!backend.Stat("gone.sav", unSize, nTimestamp));
+    }
+
+    // The compacted container replays to the same files
+    PackedFileBackend backend(directory.Path(), 50);
+    VAPOR_REQUIRE(backend.Open());
+    VAPOR_CHECK(ReadPacked(backend, "rewritten.sav") == latest);
+    VAPOR_CHECK(ReadPacked(backend, "kept.sav") == kept);
+    std::vector<std::string> names;
+    backend.Enumerate([&](const std::string& name, uint64, int64) { names.push_back(name); });
+    VAPOR_CHECK(names.size() == 2);
+}
+
+VAPOR_TEST(PackedRecoveryCutsTornTail)
+{
+    TempDirectory directory("packed_recovery");
+    std::string container = directory / PACKED_CONTAINER_FILENAME;
+    std::vector<uint8> first = RandomBytes(4096, 1);
+    std::vector<uint8> second = RandomBytes(4096, 2);
+
+    uint64 unFirstEnd;
+    {
+        PackedFileBackend backend(directory.Path(), 0);
+        VAPOR_REQUIRE(backend.Open());
+        VAPOR_CHECK(backend.Write("first.sav", first.data(), first.size()));
+        unFirstEnd = std::filesystem::file_size(container);
+        VAPOR_CHECK(backend.Write("second.sav", second.data(), second.size()));
+    }
+
+    // A crash in the middle of the second append
+    std::filesystem::resize_file(container, unFirstEnd + 100);
+
+    {
+        PackedFileBackend backend(directory.Path(), 0);
+        VAPOR_REQUIRE(backend.Open());
+        VAPOR_CHECK(ReadPacked(backend, "first.sav") == first);
+        VAPOR_CHECK(ReadPacked(backend, "second.sav").empty());
+        VAPOR_CHECK(std::filesystem::file_size(container) == unFirstEnd);
+
+        // Appends continue right after the last good record
+        VAPOR_CHECK(backend.Write("second.sav", second.data(), second.size()));
+    }
+
+    // Leftovers of an interrupted compaction are removed on open
+    WriteDiskFile(container + FILE_IO_TEMP_SUFFIX, "partial", 7);
+
+    PackedFileBackend backend(directory.Path(), 0);
+    VAPOR_REQUIRE(backend.Open());
+    VAPOR_CHECK(ReadPacked(backend, "first.sav") == first);
+    VAPOR_CHECK(ReadPacked(backend, "second.sav") == second);
+    VAPOR_CHECK(!std::filesystem::exists(container + FILE_IO_TEMP_SUFFIX));
+}
+
+VAPOR_TEST(PackedBookkeepingNamesAreReserved)
+{
+    TempDirectory directory("packed_names");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nbackend=packed\ndedup=true\nchunk_store_dir=" + (directory / "chunks") +
+                                        "\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+
+    VAPOR_CHECK(!storage.IsValidFilename("storage.vcpack"));
+    VAPOR_CHECK(!storage.IsValidFilename("Storage.VCDEDUP"));
+    VAPOR_CHECK(!storage.WriteFile("storage.vcpack", "x", 1));
+
+    // Only the names at the top of the directory are taken
+    VAPOR_CHECK(storage.WriteFile("saves/storage.vcpack", "x", 1));
+    VAPOR_CHECK(storage.GetFileCount() == 1);
+}
@@ -0,0 +1,159 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the radix tree name index and nested file paths
+ */
+
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_path_trie.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// Keys sharing long prefixes, so labels are split and merged back often
+static std::string RandomKey(std::mt19937& random)
+{
+    static const char* const parts[] = { "save", "saves/", "slot", "s", "/", "a", "ab", "abc", "1", "10", "profile." };
+    std::string key;
+    size_t cParts = 1 + random() % 5;
+    for (size_t i = 0; i < cParts; ++i) {
+        key += parts[random() % (sizeof(parts) / sizeof(parts[0]))];
+    }
+    return key;
+}
+
+// The trie holds exactly what the map does, in the same order
+static bool MatchesReference(PathTrie<int>& trie, const std::map<std::string, int>& reference)
+{
+    if (trie.Size() != reference.size()) {
+        return false;
+    }
+
+    size_t unIndex = 0;
+    for (const auto& entry : reference) {
+        std::string key;
+        const int* pValue = trie.At(unIndex++, key);
+        if (!pValue || key != entry.first || *pValue != entry.second) {
+            return false;
+        }
+    }
+    std::string key;
+    return trie.At(reference.size(), key) == nullptr;
+}
+
+VAPOR_TEST(TrieMatchesASortedMap)
+{
+    std::mt19937 random(1);
+    PathTrie<int> trie;
+    std::map<std::string, int> reference;
+
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = RandomKey(random);
+        if (random() % 3 == 0) {
+            VAPOR_CHECK(trie.Erase(key) == (reference.erase(key) == 1));
+        } else {
+            auto inserted = trie.Emplace(key);
+            VAPOR_CHECK(inserted.second == (reference.find(key) == reference.end()));
+            *inserted.first = i;
+            reference[key] = i;
+        }
+
+        if (i % 500 == 0) {
+            VAPOR_CHECK(MatchesReference(trie, reference));
+        }
+    }
+    VAPOR_CHECK(MatchesReference(trie, reference));
+
+    for (const auto& entry : reference) {
+        const int* pValue = trie.Find(entry.first);
+        VAPOR_CHECK(pValue && *pValue == entry.second);
+    }
+    VAPOR_CHECK(!trie.Find("not a key"));
+
+    // Positions out of order are found as well as stepping through them
+    std::string key;
+    for (size_t unIndex : { size_t(7), size_t(3), reference.size() - 1, size_t(0) }) {
+        VAPOR_REQUIRE(trie.At(unIndex, key));
+        VAPOR_CHECK(key == std::next(reference.begin(), unIndex)->first);
+    }
+
+    trie.Clear();
+    VAPOR_CHECK(trie.Size() == 0 && !trie.At(0, key));
+}
+
+VAPOR_TEST(TrieListsKeysUnderAPrefix)
+{
+    std::mt19937 random(2);
+    PathTrie<int> trie;
+    std::map<std::string, int> reference;
+    for (int i = 0; i < 2000; ++i) {
+        std::string key = RandomKey(random);
+        *trie.Emplace(key).first = i;
+        reference[key] = i;
+    }
+
+    // The prefix may end at a key, inside a label or match nothing at all
+    for (const char* pchPrefix : { "", "s", "sa", "save", "saves/", "saves/slot", "abc1", "slot/a", "zzz" }) {
+        std::string prefix = pchPrefix;
+        std::vector<std::string> expected;
+        for (auto it = reference.lower_bound(prefix); it != reference.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            expected.push_back(it->first);
+        }
+
+        std::vector<std::string> listed;
+        trie.ForEachWithPrefix(prefix, [&listed](const std::string& key, const int&) { listed.push_back(key); });
+        VAPOR_CHECK(listed == expected);
+    }
+}
+
+VAPOR_TEST(StorageKeepsNestedPaths)
+{
+    TempDirectory directory("trie_nested");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    std::string save = directory / "save";
+
+    {
+        FileStorage storage(save);
+        VAPOR_REQUIRE(storage.WriteFile("Saves\\Slot2.sav", "two", 3));
+        VAPOR_REQUIRE(storage.WriteFile("saves/slot1.sav", "one", 3));
+        VAPOR_REQUIRE(storage.WriteFile("saves/auto/slot.sav", "auto", 4));
+        VAPOR_REQUIRE(storage.WriteFile("savestate.bin", "state", 5));
+        VAPOR_REQUIRE(storage.WriteFile("/config.ini", "config", 6));
+
+        // Nothing may leave the storage directory or reach its bookkeeping
+        VAPOR_CHECK(!storage.WriteFile("../escape.sav", "x", 1));
+        VAPOR_CHECK(!storage.WriteFile("saves/../../escape.sav", "x", 1));
+        VAPOR_CHECK(!storage.WriteFile(std::string(VERSION_HISTORY_DIRECTORY) + "/x", "x", 1));
+        VAPOR_CHECK(!storage.WriteFile("saves/", "x", 1));
+    }
+    VAPOR_CHECK(std::filesystem::is_regular_file(save + "/saves/auto/slot.sav"));
+
+    // Rebuilt from the disk, names come back normalized and sorted
+    FileStorage storage(save);
+    VAPOR_CHECK(storage.GetFileCount() == 5);
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(0)) == "config.ini");
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(4)) == "savestate.bin");
+
+    std::vector<std::string> files;
+    VAPOR_CHECK(storage.ListFiles("SAVES/", files));
+    VAPOR_CHECK(files == std::vector<std::string>({ "saves/auto/slot.sav", "saves/slot1.sav", "saves/slot2.sav" }));
+    VAPOR_CHECK(storage.ListFiles("save", files) && files.size() == 4);
+    VAPOR_CHECK(storage.ListFiles("", files) && files.size() == 5);
+    VAPOR_CHECK(storage.ListFiles("missing/", files) && files.empty());
+
+    int32 cubSize = 0;
+    VAPOR_CHECK(std::string(storage.GetFileNameAndSize(1, &cubSize)) == "saves/auto/slot.sav" && cubSize == 4);
+}
@@ -0,0 +1,103 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the startup prefetch and the access profile behind it
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_access_profile.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+VAPOR_TEST(ProfileScoresFadeAcrossRuns)
+{
+    TempDirectory directory("prefetch_profile");
+
+    {
+        AccessProfile profile(directory.Path());
+        profile.Load();
+        for (int i = 0; i < 8; ++i) {
+            profile.RecordRead("hot.sav");
+        }
+        profile.RecordRead("once.sav");
+        VAPOR_CHECK(profile.Save());
+        VAPOR_CHECK(profile.GetScore("hot.sav") == 8);
+    }
+
+    // A run without reads halves the scores, a score of one fades out
+    {
+        AccessProfile profile(directory.Path());
+        profile.Load();
+        VAPOR_CHECK(profile.GetScore("hot.sav") == 8 && profile.GetScore("once.sav") == 1);
+        VAPOR_CHECK(profile.Save());
+    }
+
+    AccessProfile profile(directory.Path());
+    profile.Load();
+    VAPOR_CHECK(profile.GetScore("hot.sav") == 4);
+    VAPOR_CHECK(profile.GetScore("once.sav") == 0);
+
+    // A damaged profile reads as an empty one
+    VAPOR_REQUIRE(WriteDiskFile(directory / ACCESS_PROFILE_FILENAME, "garbage", 7));
+    profile.Load();
+    VAPOR_CHECK(profile.GetScore("hot.sav") == 0);
+}
+
+VAPOR_TEST(PrefetchServesReadsFromMemory)
+{
+    TempDirectory directory("prefetch_reads");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nprefetch_mb=1\nprefetch_order=profile\nquota_mb=0\nquota_files=0\n"));
+    std::string save = directory / "save";
+    std::vector<uint8> small = RandomBytes(4096, 1);
+    std::vector<uint8> large = RandomBytes(2 * 1024 * 1024, 2);
+
+    {
+        FileStorage storage(save);
+        VAPOR_CHECK(storage.WriteFile("small.sav", small.data(), small.size()));
+        VAPOR_CHECK(storage.WriteFile("large.sav", large.data(), large.size()));
+        std::vector<uint8> buffer(small.size());
+        VAPOR_CHECK(storage.ReadFile("small.sav", buffer.data(), buffer.size()) == static_cast<int32>(small.size()));
+    }
+
+    // The reads of the run are remembered for the next one
+    AccessProfile profile(save);
+    profile.Load();
+    VAPOR_CHECK(profile.GetScore("small.sav") == 1);
+
+    FileStorage storage(save);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    // Prefetched within the budget, reads no longer need the disk; the large
+    // file is past the budget and was left alone
+    std::filesystem::remove(save + "/small.sav");
+    std::filesystem::remove(save + "/large.sav");
+    std::vector<uint8> buffer(large.size());
+    VAPOR_CHECK(storage.ReadFile("small.sav", buffer.data(), buffer.size()) == static_cast<int32>(small.size()));
+    VAPOR_CHECK(std::equal(small.begin(), small.end(), buffer.begin()));
+    VAPOR_CHECK(storage.ReadFile("large.sav", buffer.data(), buffer.size()) == 0);
+}
+
+VAPOR_TEST(ProfileNameIsReserved)
+{
+    TempDirectory directory("prefetch_names");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nprefetch_mb=1\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+
+    VAPOR_CHECK(!storage.IsValidFilename("storage.vcprofile"));
+    VAPOR_CHECK(!storage.WriteFile("Storage.VCProfile", "x", 1));
+    VAPOR_CHECK(storage.WriteFile("saves/storage.vcprofile", "x", 1));
+}
@@ -0,0 +1,129 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of per-user storage directories and quotas
+ */
+
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// WriteFileAsync, waited for
+static EResult WriteAsync(FileStorage& storage, const std::string& name, const std::vector<uint8>& data)
+{
+    std::promise<EResult> promise;
+    std::future<EResult> future = promise.get_future();
+    if (!storage.WriteFileAsync(name, data.data(), data.size(), [&promise](EResult eResult) { promise.set_value(eResult); })) {
+        return k_EResultFail;
+    }
+    return future.get();
+}
+
+VAPOR_TEST(StorageIsNamespacedPerAppAndUser)
+{
+    TempDirectory directory("quota_namespace");
+    std::string root = directory / "saves";
+    std::string ini = "[Steam]\napp_id=480\nsteam_id=76561197960287930\n[Storage]\ndirectory=" + root + "\n";
+    VAPOR_REQUIRE(LoadConfig(directory, ini));
+    VAPOR_CHECK(FileStorage::GetUserStorageDirectory() == root + "/480/76561197960287930");
+
+    VAPOR_REQUIRE(LoadConfig(directory, "[Steam]\napp_id=570\nsteam_id=76561197960287930\n[Storage]\ndirectory=" + root + "\n"));
+    VAPOR_CHECK(FileStorage::GetUserStorageDirectory() == root + "/570/76561197960287930");
+
+    VAPOR_REQUIRE(LoadConfig(directory, ini + "namespace=false\n"));
+    VAPOR_CHECK(FileStorage::GetUserStorageDirectory() == root);
+}
+
+VAPOR_TEST(LegacySavesMoveInOnlyWhenAsked)
+{
+    TempDirectory directory("quota_legacy");
+    std::string root = directory / "saves";
+    std::filesystem::create_directories(root + "/100");
+    VAPOR_REQUIRE(WriteDiskFile(root + "/slot.sav", "old", 3));
+    std::string ini = "[Steam]\napp_id=480\nsteam_id=76561197960287930\n[Storage]\ndirectory=" + root + "\n";
+
+    // By default the root is left as it is
+    VAPOR_REQUIRE(LoadConfig(directory, ini));
+    std::string user = FileStorage::GetUserStorageDirectory();
+    VAPOR_CHECK(std::filesystem::exists(root + "/slot.sav") && !std::filesystem::exists(user));
+
+    // Asked to, the first namespace created takes everything but other namespaces
+    VAPOR_REQUIRE(LoadConfig(directory, ini + "adopt_legacy_saves=true\n"));
+    VAPOR_CHECK(FileStorage::GetUserStorageDirectory() == user);
+    VAPOR_CHECK(!std::filesystem::exists(root + "/slot.sav"));
+    VAPOR_CHECK(std::filesystem::is_directory(root + "/100"));
+    FileStorage storage(user);
+    char data[3];
+    VAPOR_CHECK(storage.ReadFile("slot.sav", data, sizeof(data)) == 3 && std::string(data, 3) == "old");
+}
+
+VAPOR_TEST(WritesPastTheQuotaAreRefused)
+{
+    TempDirectory directory("quota_bytes");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=1\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    std::vector<uint8> big = RandomBytes(700 * 1024, 1);
+    std::vector<uint8> small = RandomBytes(100 * 1024, 2);
+
+    uint64 unTotal = 0;
+    uint64 unAvailable = 0;
+    VAPOR_REQUIRE(storage.WriteFile("big.sav", big.data(), big.size()));
+    VAPOR_CHECK(storage.GetQuota(&unTotal, &unAvailable));
+    VAPOR_CHECK(unTotal == 1024 * 1024 && unAvailable == unTotal - big.size());
+
+    // Every way of writing stops at the limit
+    VAPOR_CHECK(!storage.WriteFile("second.sav", big.data(), big.size()));
+    VAPOR_CHECK(WriteAsync(storage, "second.sav", big) == k_EResultLimitExceeded);
+    FileStorage::WriteStreamHandle hStream = storage.OpenWriteStream("second.sav");
+    VAPOR_CHECK(storage.WriteStreamChunk(hStream, small.data(), small.size()));
+    VAPOR_CHECK(!storage.WriteStreamChunk(hStream, big.data(), big.size()));
+    VAPOR_CHECK(!storage.CloseWriteStream(hStream));
+    VAPOR_CHECK(!storage.FileExists("second.sav"));
+
+    // What fits is still written, rewriting in place never grows usage
+    VAPOR_CHECK(WriteAsync(storage, "small.sav", small) == k_EResultOK);
+    VAPOR_CHECK(storage.WriteFile("big.sav", big.data(), big.size()));
+    VAPOR_CHECK(storage.GetTotalStorageUsed() == big.size() + small.size());
+    VAPOR_CHECK(storage.GetQuota(&unTotal, &unAvailable) && unAvailable == unTotal - big.size() - small.size());
+
+    // Deleting frees the space again
+    VAPOR_CHECK(storage.DeleteFile("big.sav"));
+    VAPOR_CHECK(storage.WriteFile("second.sav", big.data(), big.size()));
+}
+
+VAPOR_TEST(FileCountIsLimited)
+{
+    TempDirectory directory("quota_files");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=3\n"));
+    std::string save = directory / "save";
+
+    {
+        FileStorage storage(save);
+        VAPOR_CHECK(storage.WriteFile("a.sav", "a", 1));
+        VAPOR_CHECK(storage.WriteFile("b.sav", "b", 1));
+        VAPOR_CHECK(storage.WriteFile("c.sav", "c", 1));
+        VAPOR_CHECK(!storage.WriteFile("d.sav", "d", 1));
+        VAPOR_CHECK(storage.WriteFile("c.sav", "cc", 2));
+    }
+
+    // Counted from the disk when reopened, even over a lowered limit
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=2\n"));
+    FileStorage storage(save);
+    VAPOR_CHECK(storage.GetFileCount() == 3);
+    VAPOR_CHECK(!storage.WriteFile("d.sav", "d", 1));
+    VAPOR_CHECK(storage.WriteFile("a.sav", "aa", 2));
+    VAPOR_CHECK(storage.DeleteFile("a.sav") && storage.DeleteFile("b.sav"));
+    VAPOR_CHECK(storage.WriteFile("d.sav", "d", 1));
+}
@@ -0,0 +1,139 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of UGC shares, downloads and reads
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_file_storage.h"
+#include "steam_callback_mgr.h"
+#include "steam_remote_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+//-----------------------------------------------------------------------------
+// Purpose: Call result of type T, collected by dispatching callbacks until it
+// arrives
+//-----------------------------------------------------------------------------
+template <typename T>
+class CallResultWaiter : public CCallbackBase
+{
+public:
+    explicit CallResultWaiter(SteamAPICall_t hAPICall) : m_hAPICall(hAPICall)
+    {
+        m_iCallback = T::k_iCallback;
+        CCallbackMgr::GetInstance().RegisterCallResult(this, m_hAPICall);
+    }
+
+    ~CallResultWaiter() { CCallbackMgr::GetInstance().UnregisterCallResult(this, m_hAPICall); }
+
+    bool Wait()
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!m_bDone && std::chrono::steady_clock::now() < deadline) {
+            CCallbackMgr::GetInstance().DispatchCallbacks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return m_bDone && !m_bIOFailure;
+    }
+
+    const T& Result() const { return m_result; }
+
+    void Run(void* pvParam) override { Run(pvParam, false, m_hAPICall); }
+    void Run(void* pvParam, bool bIOFailure, SteamAPICall_t) override
+    {
+        memcpy(&m_result, pvParam, sizeof(m_result));
+        m_bIOFailure = bIOFailure;
+        m_bDone = true;
+    }
+    int GetCallbackSizeBytes() override { return sizeof(T); }
+
+private:
+    SteamAPICall_t m_hAPICall;
+    T m_result = {};
+    bool m_bIOFailure = false;
+    bool m_bDone = false;
+};
+
+static EResult Download(CSteamRemoteStorage& remoteStorage, UGCHandle_t hContent, const char* pchLocation = nullptr)
+{
+    SteamAPICall_t hAPICall = pchLocation ? remoteStorage.UGCDownloadToLocation(hContent, pchLocation, 0)
+                                          : remoteStorage.UGCDownload(hContent, 0);
+    CallResultWaiter<RemoteStorageDownloadUGCResult_t> waiter(hAPICall);
+    return waiter.Wait() ? waiter.Result().m_eResult : k_EResultIOFailure;
+}
+
+// The remote storage is a singleton, so one test drives it from share to read
+VAPOR_TEST(SharedContentDownloadsAndReads)
+{
+    TempDirectory directory("ugc");
+    VAPOR_REQUIRE(LoadConfig(directory,
+        "[Storage]\ndirectory=" + (directory / "save") + "\nnamespace=false\nchunk_store_dir=" + (directory / "chunks") +
+        "\nquota_mb=0\nquota_files=0\n"));
+    CSteamRemoteStorage& remoteStorage = CSteamRemoteStorage::GetInstance();
+
+    std::vector<uint8> data = RandomBytes(3 * 1024 * 1024 + 100, 1);
+    VAPOR_REQUIRE(remoteStorage.FileWrite("shared.sav", data.data(), static_cast<int32>(data.size())));
+
+    CallResultWaiter<RemoteStorageFileShareResult_t> share(remoteStorage.FileShare("shared.sav"));
+    VAPOR_REQUIRE(share.Wait() && share.Result().m_eResult == k_EResultOK);
+    UGCHandle_t hContent = share.Result().m_hFile;
+
+    // Downloads report the size, then reads continue until the end closes the handle
+    {
+        SteamAPICall_t hAPICall = remoteStorage.UGCDownload(hContent, 0);
+        CallResultWaiter<RemoteStorageDownloadUGCResult_t> download(hAPICall);
+        VAPOR_REQUIRE(download.Wait() && download.Result().m_eResult == k_EResultOK);
+        VAPOR_CHECK(download.Result().m_hFile == hContent);
+        VAPOR_CHECK(download.Result().m_nSizeInBytes == static_cast<int32>(data.size()));
+    }
+    int32 cubDownloaded = 0;
+    int32 cubExpected = 0;
+    VAPOR_CHECK(remoteStorage.GetUGCDownloadProgress(hContent, &cubDownloaded, &cubExpected));
+    VAPOR_CHECK(cubDownloaded == static_cast<int32>(data.size()) && cubExpected == cubDownloaded);
+
+    std::vector<uint8> read;
+    std::vector<uint8> buffer(100 * 1024);
+    int32 cubRead;
+    while ((cubRead = remoteStorage.UGCRead(hContent, buffer.data(), static_cast<int32>(buffer.size()))) > 0) {
+        read.insert(read.end(), buffer.begin(), buffer.begin() + cubRead);
+    }
+    VAPOR_CHECK(read == data);
+    VAPOR_CHECK(!remoteStorage.GetUGCDownloadProgress(hContent, &cubDownloaded, &cubExpected));
+
+    // Reads at an offset, backwards too, stay open until closed
+    VAPOR_REQUIRE(Download(remoteStorage, hContent) == k_EResultOK);
+    for (uint32 unOffset : { 2u * 1024 * 1024, 1000u, 3u * 1024 * 1024 - 4000 }) {
+        VAPOR_CHECK(remoteStorage.UGCRead(hContent, buffer.data(), 4096, unOffset, k_EUGCRead_ContinueReading) == 4096);
+        VAPOR_CHECK(std::equal(buffer.begin(), buffer.begin() + 4096, data.begin() + unOffset));
+    }
+    VAPOR_CHECK(remoteStorage.UGCRead(hContent, buffer.data(), 4096, 0, k_EUGCRead_Close) == 4096);
+    VAPOR_CHECK(remoteStorage.UGCRead(hContent, buffer.data(), 4096, 0, k_EUGCRead_ContinueReading) == 0);
+
+    // A download to a location writes the content there
+    std::string location = directory / "downloaded.bin";
+    VAPOR_REQUIRE(Download(remoteStorage, hContent, location.c_str()) == k_EResultOK);
+    VAPOR_CHECK(ReadDiskFile(location) == data);
+
+    // Unknown content fails
+    VAPOR_CHECK(Download(remoteStorage, hContent ^ 1) != k_EResultOK);
+    VAPOR_CHECK(remoteStorage.UGCRead(hContent ^ 1, buffer.data(), 4096, 0, k_EUGCRead_ContinueReading) == 0);
+
+    // Stop the background threads before the directory goes away
+    CloudSync::ShutdownAll();
+    FileStorage::ShutdownAll();
+}
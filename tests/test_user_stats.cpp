@@ -0,0 +1,247 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the schema-driven user stats and achievements and their stats file
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "vaporcore_test.h"
+#include "vapor_user_stats.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static const char* STATS_SCHEMA =
+    "[stat NumWins]\ntype=int\nmin=0\nmax=1000\nincrement_only=true\n"
+    "[stat Level]\ntype=int\nmin=1\nmax=50\ndefault=1\n"
+    "[stat Distance]\ntype=float\nmin=0\nmax=100000\n"
+    "[stat KillsPerHour]\ntype=avgrate\n"
+    "[stat Broken]\ntype=int\nmin=10\nmax=5\n"
+    "[achievement ACH_WIN_ONE_GAME]\nname=Winner\ndesc=Win one game\nname_french=Gagnant\n"
+    "[achievement ACH_SECRET]\nname=Secret\nhidden=1\n";
+
+// Write the schema next to the ini and point [Stats] at both
+static bool LoadStatsConfig(const TempDirectory& directory, const std::string& schema, const std::string& extra = "")
+{
+    std::string path = directory / "schema.ini";
+    return WriteDiskFile(path, schema.data(), schema.size()) &&
+           LoadConfig(directory, "[Steam]\nlanguage=french\n[Stats]\nschema=" + path + "\ndirectory=" +
+                                 (directory / "stats") + "\n" + extra);
+}
+
+// The stats file of the default user, see UserStats::LoadValues
+static std::string StatsFilePath(const TempDirectory& directory)
+{
+    return directory / "stats/0/76561198000000000.vcstats";
+}
+
+// Wait for the store thread to write the stats file again
+static bool WaitForStore(const std::string& path, std::filesystem::file_time_type previous)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::error_code ec;
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::filesystem::file_time_type current = std::filesystem::last_write_time(path, ec);
+        if (!ec && current != previous) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+VAPOR_TEST(SchemaDefinesStats)
+{
+    TempDirectory directory("user_stats_schema");
+    VAPOR_REQUIRE(LoadStatsConfig(directory, STATS_SCHEMA));
+    UserStats stats;
+    VAPOR_REQUIRE(stats.Load());
+
+    int32 nValue = -1;
+    VAPOR_CHECK(stats.GetStat("Level", &nValue) && nValue == 1);
+    VAPOR_CHECK(stats.SetStat("Level", 50) && stats.GetStat("Level", &nValue) && nValue == 50);
+
+    // Values outside the limits, the wrong type and unknown names are refused
+    VAPOR_CHECK(!stats.SetStat("Level", 51));
+    VAPOR_CHECK(!stats.SetStat("Level", 0));
+    VAPOR_CHECK(!stats.SetStat("Level", 2.0f));
+    float flValue = 0.0f;
+    VAPOR_CHECK(!stats.GetStat("Level", &flValue));
+    VAPOR_CHECK(!stats.SetStat("Missing", 1));
+    VAPOR_CHECK(!stats.GetStat("Broken", &nValue));
+
+    // Increment-only stats never go back
+    VAPOR_CHECK(stats.SetStat("NumWins", 5));
+    VAPOR_CHECK(!stats.SetStat("NumWins", 4));
+    VAPOR_CHECK(stats.GetStat("NumWins", &nValue) && nValue == 5);
+
+    VAPOR_CHECK(stats.SetStat("Distance", 12.5f) && stats.GetStat("Distance", &flValue) && flValue == 12.5f);
+
+    // Average rates add up over sessions and only move through their own call
+    VAPOR_CHECK(stats.UpdateAvgRateStat("KillsPerHour", 10.0f, 3600.0));
+    VAPOR_CHECK(stats.UpdateAvgRateStat("KillsPerHour", 20.0f, 3600.0));
+    VAPOR_CHECK(stats.GetStat("KillsPerHour", &flValue) && std::fabs(flValue - 30.0f / 7200.0f) < 1e-6f);
+    VAPOR_CHECK(!stats.SetStat("KillsPerHour", 1.0f));
+    VAPOR_CHECK(!stats.UpdateAvgRateStat("KillsPerHour", 1.0f, 0.0));
+
+    stats.ResetAll(false);
+    VAPOR_CHECK(stats.GetStat("Level", &nValue) && nValue == 1);
+    VAPOR_CHECK(stats.GetStat("NumWins", &nValue) && nValue == 0);
+}
+
+VAPOR_TEST(SchemaDefinesAchievements)
+{
+    TempDirectory directory("user_stats_achievements");
+    VAPOR_REQUIRE(LoadStatsConfig(directory, STATS_SCHEMA));
+    UserStats stats;
+    VAPOR_REQUIRE(stats.Load());
+
+    // Listed in schema order
+    VAPOR_REQUIRE(stats.GetNumAchievements() == 2);
+    VAPOR_CHECK(strcmp(stats.GetAchievementName(0), "ACH_WIN_ONE_GAME") == 0);
+    VAPOR_CHECK(strcmp(stats.GetAchievementName(1), "ACH_SECRET") == 0);
+    VAPOR_CHECK(strcmp(stats.GetAchievementName(2), "") == 0);
+
+    // Display attributes prefer the configured language
+    VAPOR_CHECK(strcmp(stats.GetAchievementDisplayAttribute("ACH_WIN_ONE_GAME", "name"), "Gagnant") == 0);
+    VAPOR_CHECK(strcmp(stats.GetAchievementDisplayAttribute("ACH_WIN_ONE_GAME", "desc"), "Win one game") == 0);
+    VAPOR_CHECK(strcmp(stats.GetAchievementDisplayAttribute("ACH_WIN_ONE_GAME", "hidden"), "0") == 0);
+    VAPOR_CHECK(strcmp(stats.GetAchievementDisplayAttribute("ACH_SECRET", "hidden"), "1") == 0);
+
+    bool bAchieved = true;
+    uint32 unUnlockTime = 1;
+    VAPOR_CHECK(stats.GetAchievement("ACH_SECRET", &bAchieved, &unUnlockTime) && !bAchieved && unUnlockTime == 0);
+    VAPOR_CHECK(stats.SetAchievement("ACH_SECRET", true));
+    VAPOR_CHECK(stats.GetAchievement("ACH_SECRET", &bAchieved, &unUnlockTime) && bAchieved && unUnlockTime != 0);
+    VAPOR_CHECK(!stats.IndicateAchievementProgress("ACH_SECRET", 1, 2));
+    VAPOR_CHECK(stats.IndicateAchievementProgress("ACH_WIN_ONE_GAME", 1, 2));
+
+    // Resetting stats alone leaves achievements alone
+    stats.ResetAll(false);
+    VAPOR_CHECK(stats.GetAchievement("ACH_SECRET", &bAchieved, nullptr) && bAchieved);
+    stats.ResetAll(true);
+    VAPOR_CHECK(stats.GetAchievement("ACH_SECRET", &bAchieved, &unUnlockTime) && !bAchieved && unUnlockTime == 0);
+    VAPOR_CHECK(!stats.SetAchievement("ACH_MISSING", true));
+}
+
+VAPOR_TEST(MissingSchemaMeansNoStats)
+{
+    TempDirectory directory("user_stats_missing");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Stats]\nschema=" + (directory / "missing.ini") + "\n"));
+    UserStats stats;
+    VAPOR_CHECK(stats.Load());
+    VAPOR_CHECK(stats.GetNumAchievements() == 0);
+    int32 nValue;
+    VAPOR_CHECK(!stats.GetStat("NumWins", &nValue));
+}
+
+VAPOR_TEST(StoredValuesSurviveRestart)
+{
+    TempDirectory directory("user_stats_persist");
+    VAPOR_REQUIRE(LoadStatsConfig(directory, STATS_SCHEMA, "store_delay_ms=50\n"));
+    uint32 unUnlockTime = 0;
+
+    {
+        UserStats stats;
+        VAPOR_REQUIRE(stats.Load());
+        VAPOR_CHECK(stats.SetStat("NumWins", 7));
+        VAPOR_CHECK(stats.SetStat("Distance", 42.5f));
+        VAPOR_CHECK(stats.UpdateAvgRateStat("KillsPerHour", 10.0f, 3600.0));
+        VAPOR_CHECK(stats.SetAchievement("ACH_WIN_ONE_GAME", true));
+        VAPOR_CHECK(stats.GetAchievement("ACH_WIN_ONE_GAME", nullptr, &unUnlockTime));
+        VAPOR_CHECK(stats.StoreStats());
+
+        // Changed after the store and never stored: lost
+        VAPOR_CHECK(WaitForStore(StatsFilePath(directory), std::filesystem::file_time_type::min()));
+        VAPOR_CHECK(stats.SetStat("Level", 9));
+    }
+
+    UserStats stats;
+    VAPOR_REQUIRE(stats.Load());
+    int32 nValue = 0;
+    float flValue = 0.0f;
+    VAPOR_CHECK(stats.GetStat("NumWins", &nValue) && nValue == 7);
+    VAPOR_CHECK(stats.GetStat("Level", &nValue) && nValue == 1);
+    VAPOR_CHECK(stats.GetStat("Distance", &flValue) && flValue == 42.5f);
+
+    // Rates continue from the stored totals
+    VAPOR_CHECK(stats.UpdateAvgRateStat("KillsPerHour", 30.0f, 3600.0));
+    VAPOR_CHECK(stats.GetStat("KillsPerHour", &flValue) && std::fabs(flValue - 40.0f / 7200.0f) < 1e-6f);
+
+    bool bAchieved = false;
+    uint32 unStoredTime = 0;
+    VAPOR_CHECK(stats.GetAchievement("ACH_WIN_ONE_GAME", &bAchieved, &unStoredTime));
+    VAPOR_CHECK(bAchieved && unStoredTime == unUnlockTime);
+}
+
+VAPOR_TEST(StoresShareOneWrite)
+{
+    TempDirectory directory("user_stats_batch");
+    VAPOR_REQUIRE(LoadStatsConfig(directory, STATS_SCHEMA, "store_delay_ms=300\n"));
+    std::string path = StatsFilePath(directory);
+    UserStats stats;
+    VAPOR_REQUIRE(stats.Load());
+
+    // A burst of stores within the delay is one write
+    for (int32 i = 1; i <= 20; ++i) {
+        VAPOR_CHECK(stats.SetStat("NumWins", i));
+        VAPOR_CHECK(stats.StoreStats());
+    }
+    VAPOR_REQUIRE(WaitForStore(path, std::filesystem::file_time_type::min()));
+    std::filesystem::file_time_type written = std::filesystem::last_write_time(path);
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    VAPOR_CHECK(std::filesystem::last_write_time(path) == written);
+
+    // A store without changes writes nothing
+    VAPOR_CHECK(stats.StoreStats());
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    VAPOR_CHECK(std::filesystem::last_write_time(path) == written);
+
+    // Shutdown writes what is still queued without waiting out the delay
+    VAPOR_CHECK(stats.SetStat("NumWins", 100));
+    VAPOR_CHECK(stats.StoreStats());
+    stats.Shutdown();
+    VAPOR_CHECK(std::filesystem::last_write_time(path) != written);
+    VAPOR_CHECK(!stats.StoreStats());
+}
+
+VAPOR_TEST(SchemaChangesKeepMatchingValues)
+{
+    TempDirectory directory("user_stats_schema_change");
+    VAPOR_REQUIRE(LoadStatsConfig(directory, STATS_SCHEMA, "store_delay_ms=0\n"));
+
+    {
+        UserStats stats;
+        VAPOR_REQUIRE(stats.Load());
+        VAPOR_CHECK(stats.SetStat("NumWins", 700));
+        VAPOR_CHECK(stats.SetStat("Level", 20));
+        VAPOR_CHECK(stats.StoreStats());
+    }
+
+    // NumWins got a lower limit, Level is gone and a new stat appeared
+    VAPOR_REQUIRE(LoadStatsConfig(directory, "[stat Gold]\ntype=int\ndefault=3\n[stat NumWins]\ntype=int\nmax=500\n",
+                                  "store_delay_ms=0\n"));
+    UserStats stats;
+    VAPOR_REQUIRE(stats.Load());
+    int32 nValue = 0;
+    VAPOR_CHECK(stats.GetStat("NumWins", &nValue) && nValue == 500);
+    VAPOR_CHECK(stats.GetStat("Gold", &nValue) && nValue == 3);
+    VAPOR_CHECK(!stats.GetStat("Level", &nValue));
+
+    // A damaged file reads as defaults
+    VAPOR_REQUIRE(WriteDiskFile(StatsFilePath(directory), "garbage", 7));
+    UserStats damaged;
+    VAPOR_REQUIRE(damaged.Load());
+    VAPOR_CHECK(damaged.GetStat("NumWins", &nValue) && nValue == 0);
+}
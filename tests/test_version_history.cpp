@@ -0,0 +1,129 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of per-file version history
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static std::vector<uint8> ReadAll(FileStorage& storage, const std::string& name)
+{
+    std::vector<uint8> data(storage.GetFileSize(name));
+    int32 cubRead = storage.ReadFile(name, data.data(), data.size());
+    data.resize(cubRead > 0 ? static_cast<size_t>(cubRead) : 0);
+    return data;
+}
+
+static uint64 DirectorySize(const std::string& directory)
+{
+    uint64 cubTotal = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+        if (entry.is_regular_file()) {
+            cubTotal += entry.file_size();
+        }
+    }
+    return cubTotal;
+}
+
+// Revision i of a save: the same contents with a few bytes changed and one appended
+static std::vector<std::vector<uint8>> MakeRevisions(size_t cRevisions)
+{
+    std::vector<std::vector<uint8>> revisions;
+    std::vector<uint8> data = RandomBytes(256 * 1024, 1);
+    for (size_t i = 0; i < cRevisions; ++i) {
+        data[(i * 7919) % data.size()] ^= 0xff;
+        data.push_back(static_cast<uint8>(i));
+        revisions.push_back(data);
+    }
+    return revisions;
+}
+
+VAPOR_TEST(HistoryKeepsTheNewestVersions)
+{
+    TempDirectory directory("history_versions");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\nversion_history=3\n"));
+    std::string save = directory / "save";
+    std::vector<std::vector<uint8>> revisions = MakeRevisions(5);
+
+    {
+        FileStorage storage(save);
+        VAPOR_REQUIRE(storage.HasVersionHistory());
+        for (const std::vector<uint8>& revision : revisions) {
+            VAPOR_REQUIRE(storage.WriteFile("slot.sav", revision.data(), revision.size()));
+        }
+
+        // Newest first, capped at the configured count
+        std::vector<FileStorage::FileVersion> versions;
+        VAPOR_REQUIRE(storage.GetFileVersions("slot.sav", versions));
+        VAPOR_REQUIRE(versions.size() == 3);
+        for (size_t i = 0; i < versions.size(); ++i) {
+            VAPOR_CHECK(versions[i].m_bExists && versions[i].m_unSize == revisions[3 - i].size());
+        }
+    }
+
+    // Only deltas are kept, far less than the versions themselves
+    VAPOR_CHECK(DirectorySize(save + "/" + VERSION_HISTORY_DIRECTORY) < revisions[0].size() / 4);
+
+    // History outlives the storage, and a restore is a write that is itself kept
+    FileStorage storage(save);
+    VAPOR_REQUIRE(storage.RestoreFileVersion("slot.sav", 2));
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == revisions[1]);
+    VAPOR_REQUIRE(storage.RestoreFileVersion("slot.sav", 0));
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == revisions[4]);
+    VAPOR_CHECK(!storage.RestoreFileVersion("slot.sav", 3));
+}
+
+VAPOR_TEST(HistoryRemembersDeletes)
+{
+    TempDirectory directory("history_deletes");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    std::vector<uint8> first = RandomBytes(4096, 2);
+    std::vector<uint8> second = RandomBytes(4096, 3);
+
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", first.data(), first.size()));
+    VAPOR_REQUIRE(storage.DeleteFile("slot.sav"));
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", second.data(), second.size()));
+
+    // Replaced by the second write: the absent file, before that the first contents
+    std::vector<FileStorage::FileVersion> versions;
+    VAPOR_REQUIRE(storage.GetFileVersions("slot.sav", versions));
+    VAPOR_REQUIRE(versions.size() == 2);
+    VAPOR_CHECK(!versions[0].m_bExists);
+    VAPOR_CHECK(versions[1].m_bExists && versions[1].m_unSize == first.size());
+
+    // Restoring the absent version deletes the file again
+    VAPOR_REQUIRE(storage.RestoreFileVersion("slot.sav", 0));
+    VAPOR_CHECK(!storage.FileExists("slot.sav"));
+    VAPOR_REQUIRE(storage.RestoreFileVersion("slot.sav", 2));
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == first);
+}
+
+VAPOR_TEST(HistoryCanBeTurnedOff)
+{
+    TempDirectory directory("history_off");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\nversion_history=0\n"));
+    FileStorage storage(directory / "save");
+    VAPOR_CHECK(!storage.HasVersionHistory());
+
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", "one", 3));
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", "two", 3));
+    std::vector<FileStorage::FileVersion> versions;
+    VAPOR_CHECK(!storage.GetFileVersions("slot.sav", versions) && versions.empty());
+    VAPOR_CHECK(!storage.RestoreFileVersion("slot.sav", 0));
+    VAPOR_CHECK(!std::filesystem::exists(directory / "save/" + VERSION_HISTORY_DIRECTORY));
+}
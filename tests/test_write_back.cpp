@@ -0,0 +1,94 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the FileStorage write-back cache
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static const char* WRITE_BACK_CONFIG = "[Storage]\nwrite_back=true\nquota_mb=0\nquota_files=0\n";
+
+VAPOR_TEST(WriteBackFlushesOnShutdown)
+{
+    TempDirectory directory("write_back_shutdown");
+    VAPOR_REQUIRE(LoadConfig(directory, WRITE_BACK_CONFIG));
+    std::string save = directory / "save";
+    std::vector<uint8> data = RandomBytes(64 * 1024, 1);
+
+    {
+        FileStorage storage(save);
+        VAPOR_CHECK(storage.WriteFile("slot1.sav", data.data(), data.size()));
+        VAPOR_CHECK(storage.WriteFile("slot2.sav", "old", 3));
+        VAPOR_CHECK(storage.WriteFile("slot2.sav", "new", 3));
+        VAPOR_CHECK(storage.WriteFile("gone.sav", "x", 1));
+        VAPOR_CHECK(storage.DeleteFile("gone.sav"));
+
+        // Cached writes are visible before they reach the disk
+        VAPOR_CHECK(storage.GetFileSize("slot1.sav") == data.size());
+        VAPOR_CHECK(!storage.FileExists("gone.sav"));
+
+        storage.Shutdown();
+        VAPOR_CHECK(std::filesystem::exists(save + "/slot1.sav"));
+        VAPOR_CHECK(!std::filesystem::exists(save + "/gone.sav"));
+
+        // Past shutdown writes go straight to disk
+        VAPOR_CHECK(storage.WriteFile("late.sav", "late", 4));
+        VAPOR_CHECK(std::filesystem::exists(save + "/late.sav"));
+    }
+
+    // The last write of each file won, the delete queued behind its write held
+    FileStorage storage(save);
+    std::vector<uint8> buffer(data.size());
+    VAPOR_CHECK(storage.ReadFile("slot1.sav", buffer.data(), buffer.size()) == static_cast<int32>(data.size()));
+    VAPOR_CHECK(buffer == data);
+    char szBuffer[8] = {};
+    VAPOR_CHECK(storage.ReadFile("slot2.sav", szBuffer, sizeof(szBuffer)) == 3 && std::string(szBuffer) == "new");
+    VAPOR_CHECK(!storage.FileExists("gone.sav"));
+    VAPOR_CHECK(storage.GetFileCount() == 3);
+}
+
+VAPOR_TEST(WriteBackFlushesOnDestruction)
+{
+    TempDirectory directory("write_back_destruction");
+    VAPOR_REQUIRE(LoadConfig(directory, WRITE_BACK_CONFIG));
+    std::string save = directory / "save";
+
+    {
+        FileStorage storage(save);
+        for (int i = 0; i < 32; ++i) {
+            std::string name = "slot" + std::to_string(i) + ".sav";
+            VAPOR_CHECK(storage.WriteFile(name, name.data(), name.size()));
+        }
+    }
+
+    FileStorage storage(save);
+    VAPOR_CHECK(storage.GetFileCount() == 32);
+    VAPOR_CHECK(storage.GetFileSize("slot31.sav") == 10);
+}
+
+VAPOR_TEST(TemporaryNamesAreRejected)
+{
+    TempDirectory directory("write_back_temp_names");
+    VAPOR_REQUIRE(LoadConfig(directory, WRITE_BACK_CONFIG));
+    FileStorage storage(directory / "save");
+
+    // A scan deletes these as debris of interrupted atomic writes
+    VAPOR_CHECK(!storage.IsValidFilename("save.vctmp"));
+    VAPOR_CHECK(!storage.IsValidFilename("Saves/Slot1.VCTMP"));
+    VAPOR_CHECK(!storage.WriteFile("save.vctmp", "x", 1));
+    VAPOR_CHECK(storage.IsValidFilename("save.vctmp.bak"));
+    VAPOR_CHECK(storage.IsValidFilename("save.vctmp/slot1.sav"));
+}
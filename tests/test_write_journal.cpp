@@ -0,0 +1,150 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of the write-ahead journal and the writes that wait for it
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_base.h"
+#include "vapor_cloud_sync.h"
+#include "vapor_file_storage.h"
+#include "vapor_write_journal.h"
+#include "steam_remote_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+// Bytes a record takes in the journal: header, name, data
+static const uint64 JOURNAL_RECORD_HEADER_SIZE = 32;
+
+VAPOR_TEST(ConcurrentWritersShareOneSync)
+{
+    TempDirectory directory("journal_group_commit");
+    VAPOR_REQUIRE(LoadConfig(directory,
+        "[Storage]\njournal=true\njournal_group_commit_ms=2000\njournal_group_commit_kb=1024\n"
+        "quota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    VAPOR_REQUIRE(storage.GetJournalSyncCount() == 0);
+
+    // Both writes land inside one group commit window, so one sync covers them
+    std::atomic<bool> bGo(false);
+    std::atomic<int> cWritten(0);
+    auto writer = [&](const char* pchName) {
+        while (!bGo.load()) {
+            std::this_thread::yield();
+        }
+        if (storage.WriteFile(pchName, pchName, strlen(pchName))) {
+            ++cWritten;
+        }
+    };
+    std::thread first(writer, "first.sav");
+    std::thread second(writer, "second.sav");
+    bGo.store(true);
+    first.join();
+    second.join();
+
+    VAPOR_CHECK(cWritten.load() == 2);
+    VAPOR_CHECK(storage.GetJournalSyncCount() == 1);
+    VAPOR_CHECK(storage.FileExists("first.sav") && storage.FileExists("second.sav"));
+}
+
+VAPOR_TEST(JournalReplaysAfterTruncation)
+{
+    TempDirectory directory("journal_replay");
+    std::string path = directory / JOURNAL_FILENAME;
+    std::vector<uint8> data = RandomBytes(100, 1);
+    auto pData = std::make_shared<const std::vector<uint8>>(data);
+
+    uint64 unSecondEnd;
+    {
+        WriteJournal journal(directory.Path(), 0, 0);
+        VAPOR_REQUIRE(journal.Open(nullptr, nullptr));
+        journal.Enqueue(WriteJournal::k_ERecordWrite, "a.sav", pData);
+        unSecondEnd = journal.Enqueue(WriteJournal::k_ERecordDelete, "b.sav", nullptr);
+        uint64 unEnd = journal.Enqueue(WriteJournal::k_ERecordWrite, "c.sav", pData);
+        VAPOR_REQUIRE(journal.WaitDurable(unEnd));
+        VAPOR_REQUIRE(unEnd == unSecondEnd + JOURNAL_RECORD_HEADER_SIZE + 5 + data.size());
+    }
+
+    // A crash tore the last record: it is dropped, the ones before it replay in order
+    std::filesystem::resize_file(path, unSecondEnd + JOURNAL_RECORD_HEADER_SIZE + 10);
+
+    std::vector<std::string> replayed;
+    auto replay = [&](WriteJournal::ERecordType eType, const std::string& name, const WriteJournal::Data& pReplayed) {
+        replayed.push_back(name);
+        if (name == "a.sav") {
+            VAPOR_CHECK(eType == WriteJournal::k_ERecordWrite && pReplayed && *pReplayed == data);
+        } else if (name == "b.sav") {
+            VAPOR_CHECK(eType == WriteJournal::k_ERecordDelete && (!pReplayed || pReplayed->empty()));
+        }
+    };
+    {
+        WriteJournal journal(directory.Path(), 0, 0);
+        VAPOR_REQUIRE(journal.Open(replay, nullptr));
+        VAPOR_CHECK((replayed == std::vector<std::string>{ "a.sav", "b.sav" }));
+        VAPOR_CHECK(std::filesystem::file_size(path) == unSecondEnd);
+
+        // New records follow the cut directly
+        VAPOR_CHECK(journal.WaitDurable(journal.Enqueue(WriteJournal::k_ERecordWrite, "d.sav", pData)));
+    }
+
+    replayed.clear();
+    {
+        WriteJournal journal(directory.Path(), 0, 0);
+        VAPOR_REQUIRE(journal.Open(replay, nullptr));
+        VAPOR_CHECK((replayed == std::vector<std::string>{ "a.sav", "b.sav", "d.sav" }));
+    }
+}
+
+VAPOR_TEST(JournalNameIsReserved)
+{
+    TempDirectory directory("journal_name");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\njournal=true\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+
+    VAPOR_CHECK(!storage.IsValidFilename("storage.vcjournal"));
+    VAPOR_CHECK(!storage.WriteFile("Storage.VCJournal", "x", 1));
+    VAPOR_CHECK(storage.WriteFile("saves/storage.vcjournal", "x", 1));
+}
+
+VAPOR_TEST(SteamWritesDoNotHoldTheGlobalLock)
+{
+    TempDirectory directory("journal_global_lock");
+    VAPOR_REQUIRE(LoadConfig(directory,
+        "[Storage]\ndirectory=" + directory.Path() + "\nnamespace=false\njournal=true\n"
+        "journal_group_commit_ms=200\nquota_mb=0\nquota_files=0\n"));
+    CSteamRemoteStorage& remoteStorage = CSteamRemoteStorage::GetInstance();
+
+    // Writes get by without the global lock: the journal thread takes it to log,
+    // so a write waiting for its sync under that lock could deadlock
+    {
+        VAPORCORE_LOCK();
+        auto first = std::async(std::launch::async, [&]() { return remoteStorage.FileWrite("first.sav", "1", 1); });
+        auto second = std::async(std::launch::async, [&]() { return remoteStorage.FileWrite("second.sav", "2", 1); });
+        bool bDone = first.wait_for(std::chrono::seconds(10)) == std::future_status::ready &&
+                     second.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+        VAPOR_CHECK(bDone);
+        VAPORCORE_UNLOCK();
+        VAPOR_CHECK(first.get() && second.get());
+    }
+
+    VAPOR_CHECK(remoteStorage.FileExists("first.sav") && remoteStorage.FileExists("second.sav"));
+
+    // Stop the background threads before the directory goes away
+    CloudSync::ShutdownAll();
+    FileStorage::ShutdownAll();
+}
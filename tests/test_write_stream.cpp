@@ -0,0 +1,126 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Tests of FileStorage streaming writes
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vaporcore_test.h"
+#include "vapor_file_storage.h"
+
+using namespace VaporCore;
+using namespace VaporCore::Test;
+
+static std::vector<uint8> ReadAll(FileStorage& storage, const std::string& name)
+{
+    std::vector<uint8> data(storage.GetFileSize(name));
+    int32 cubRead = storage.ReadFile(name, data.data(), data.size());
+    data.resize(cubRead > 0 ? static_cast<size_t>(cubRead) : 0);
+    return data;
+}
+
+// Staged stream files left next to the saved files (history records its versions apart, in the background)
+static size_t CountTemporaryFiles(const std::string& directory)
+{
+    size_t cTemporary = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == FILE_IO_TEMP_SUFFIX) {
+            ++cTemporary;
+        }
+    }
+    return cTemporary;
+}
+
+VAPOR_TEST(StreamReplacesTheFileOnClose)
+{
+    TempDirectory directory("stream_close");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    VAPOR_REQUIRE(storage.WriteFile("slot.sav", "old", 3));
+
+    std::vector<uint8> data = RandomBytes(3 * 1024 * 1024 + 17, 1);
+    FileStorage::WriteStreamHandle hStream = storage.OpenWriteStream("slot.sav");
+    VAPOR_REQUIRE(hStream != FileStorage::k_hWriteStreamInvalid);
+    for (size_t unOffset = 0; unOffset < data.size(); unOffset += 64 * 1024) {
+        VAPOR_CHECK(storage.WriteStreamChunk(hStream, data.data() + unOffset, std::min<size_t>(64 * 1024, data.size() - unOffset)));
+    }
+
+    // Until the stream closes the previous contents stay visible
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == std::vector<uint8>({ 'o', 'l', 'd' }));
+    VAPOR_CHECK(storage.CloseWriteStream(hStream));
+    VAPOR_CHECK(storage.GetFileSize("slot.sav") == data.size());
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == data);
+    VAPOR_CHECK(CountTemporaryFiles(directory / "save") == 0);
+
+    // The handle is gone once closed
+    VAPOR_CHECK(!storage.WriteStreamChunk(hStream, "x", 1));
+    VAPOR_CHECK(!storage.CloseWriteStream(hStream));
+    VAPOR_CHECK(!storage.CancelWriteStream(hStream));
+}
+
+VAPOR_TEST(CancelledStreamLeavesNothing)
+{
+    TempDirectory directory("stream_cancel");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n"));
+    FileStorage storage(directory / "save");
+    VAPOR_REQUIRE(storage.WriteFile("kept.sav", "kept", 4));
+
+    std::vector<uint8> data = RandomBytes(256 * 1024, 2);
+    FileStorage::WriteStreamHandle hKept = storage.OpenWriteStream("kept.sav");
+    FileStorage::WriteStreamHandle hNew = storage.OpenWriteStream("new.sav");
+    VAPOR_REQUIRE(hKept != FileStorage::k_hWriteStreamInvalid && hNew != FileStorage::k_hWriteStreamInvalid);
+    VAPOR_CHECK(hKept != hNew);
+    VAPOR_CHECK(storage.WriteStreamChunk(hKept, data.data(), data.size()));
+    VAPOR_CHECK(storage.WriteStreamChunk(hNew, data.data(), data.size()));
+    VAPOR_CHECK(storage.CancelWriteStream(hKept));
+    VAPOR_CHECK(storage.CancelWriteStream(hNew));
+
+    VAPOR_CHECK(ReadAll(storage, "kept.sav") == std::vector<uint8>({ 'k', 'e', 'p', 't' }));
+    VAPOR_CHECK(!storage.FileExists("new.sav"));
+    VAPOR_CHECK(storage.GetFileCount() == 1);
+
+    // The staged files go once the chunks already queued have been skipped
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (CountTemporaryFiles(directory / "save") != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    VAPOR_CHECK(CountTemporaryFiles(directory / "save") == 0);
+
+    // Reserved names cannot be streamed to either
+    VAPOR_CHECK(storage.OpenWriteStream("slot.vctmp") == FileStorage::k_hWriteStreamInvalid);
+}
+
+VAPOR_TEST(StreamIsEncodedLikeAWrite)
+{
+    TempDirectory directory("stream_encoded");
+    VAPOR_REQUIRE(LoadConfig(directory, "[Storage]\nquota_mb=0\nquota_files=0\n[Compression]\nsav=lz\n"));
+    std::string save = directory / "save";
+    std::vector<uint8> text = TextBytes(512 * 1024, 3);
+
+    {
+        FileStorage storage(save);
+        FileStorage::WriteStreamHandle hStream = storage.OpenWriteStream("slot.sav");
+        VAPOR_REQUIRE(hStream != FileStorage::k_hWriteStreamInvalid);
+        VAPOR_CHECK(storage.WriteStreamChunk(hStream, text.data(), 1000));
+        VAPOR_CHECK(storage.WriteStreamChunk(hStream, text.data() + 1000, text.size() - 1000));
+        VAPOR_CHECK(storage.CloseWriteStream(hStream));
+        VAPOR_CHECK(storage.GetFileSize("slot.sav") == text.size());
+    }
+
+    // Stored compressed under the policy for its extension, read back whole
+    VAPOR_CHECK(std::filesystem::file_size(save + "/slot.sav") < text.size() / 2);
+    FileStorage storage(save);
+    VAPOR_CHECK(ReadAll(storage, "slot.sav") == text);
+}
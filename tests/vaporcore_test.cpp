@@ -0,0 +1,154 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Minimal test harness shared by the VaporCore test executables
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "vaporcore_test.h"
+#include "vapor_config.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace VaporCore {
+namespace Test {
+
+struct TestCase
+{
+    const char* m_pchName;
+    TestFunction m_pfnTest;
+};
+
+// Function-local, registrations run during static initialization
+static std::vector<TestCase>& GetTests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+static int s_cFailures = 0;
+
+bool Register(const char* pchName, TestFunction pfnTest)
+{
+    GetTests().push_back({ pchName, pfnTest });
+    return true;
+}
+
+void Fail(const char* pchFile, int nLine, const char* pchCondition)
+{
+    fprintf(stderr, "%s:%d: check failed: %s\n", pchFile, nLine, pchCondition);
+    ++s_cFailures;
+}
+
+int RunAll(int argc, char** argv)
+{
+    int cFailedTests = 0;
+    int cRun = 0;
+    for (const TestCase& test : GetTests()) {
+        bool bSelected = argc < 2;
+        for (int i = 1; i < argc && !bSelected; ++i) {
+            bSelected = strcmp(argv[i], test.m_pchName) == 0;
+        }
+        if (!bSelected) {
+            continue;
+        }
+
+        printf("[ RUN      ] %s\n", test.m_pchName);
+        fflush(stdout);
+        int cBefore = s_cFailures;
+        test.m_pfnTest();
+        bool bPassed = s_cFailures == cBefore;
+        printf("[ %s ] %s\n", bPassed ? "      OK" : "  FAILED", test.m_pchName);
+        fflush(stdout);
+
+        ++cRun;
+        cFailedTests += bPassed ? 0 : 1;
+    }
+
+    printf("%d of %d tests passed\n", cRun - cFailedTests, cRun);
+    return cFailedTests == 0 && cRun > 0 ? 0 : 1;
+}
+
+TempDirectory::TempDirectory(const std::string& name)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("vaporcore_test_" + std::to_string(getpid()) + "_" + name);
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+    std::filesystem::create_directories(path, ec);
+    m_sPath = path.generic_string();
+}
+
+TempDirectory::~TempDirectory()
+{
+    std::error_code ec;
+    std::filesystem::remove_all(m_sPath, ec);
+}
+
+bool LoadConfig(const TempDirectory& directory, const std::string& text)
+{
+    std::string path = directory / "vaporcore.ini";
+    return WriteDiskFile(path, text.data(), text.size()) && Config::GetInstance().LoadConfig(path);
+}
+
+std::vector<uint8> ReadDiskFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+bool WriteDiskFile(const std::string& path, const void* pData, size_t cubData)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(cubData));
+    return static_cast<bool>(file);
+}
+
+std::vector<uint8> RandomBytes(size_t cubSize, uint32 unSeed)
+{
+    std::mt19937 rng(unSeed);
+    std::vector<uint8> data(cubSize);
+    for (uint8& b : data) {
+        b = static_cast<uint8>(rng());
+    }
+    return data;
+}
+
+std::vector<uint8> TextBytes(size_t cubSize, uint32 unSeed)
+{
+    static const char* s_rgpchWords[] = { "player", "health", "position", "inventory", "quest", "level", "gold", "{", "}", ",", "\n" };
+    std::mt19937 rng(unSeed);
+    std::vector<uint8> data;
+    data.reserve(cubSize);
+    while (data.size() < cubSize) {
+        const char* pchWord = s_rgpchWords[rng() % (sizeof(s_rgpchWords) / sizeof(s_rgpchWords[0]))];
+        data.insert(data.end(), pchWord, pchWord + strlen(pchWord));
+        data.push_back(' ');
+    }
+    data.resize(cubSize);
+    return data;
+}
+
+} // namespace Test
+} // namespace VaporCore
+
+int main(int argc, char** argv)
+{
+    return VaporCore::Test::RunAll(argc, argv);
+}
@@ -0,0 +1,93 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Minimal test harness shared by the VaporCore test executables
+ */
+
+#ifndef VAPORCORE_TEST_H
+#define VAPORCORE_TEST_H
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <steam_api.h>
+
+namespace VaporCore {
+namespace Test {
+
+using TestFunction = void (*)();
+
+// Add a test to the executable's list, see VAPOR_TEST
+bool Register(const char* pchName, TestFunction pfnTest);
+
+// Count a failed check of the running test
+void Fail(const char* pchFile, int nLine, const char* pchCondition);
+
+// Run every registered test (or those named on the command line), 0 if all passed
+int RunAll(int argc, char** argv);
+
+//-----------------------------------------------------------------------------
+// Purpose: Scratch directory under the system temporary directory, unique per
+// process and name, removed again when the object goes away.
+//-----------------------------------------------------------------------------
+class TempDirectory
+{
+public:
+    explicit TempDirectory(const std::string& name);
+    ~TempDirectory();
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    const std::string& Path() const { return m_sPath; }
+    std::string operator/(const std::string& name) const { return m_sPath + "/" + name; }
+
+private:
+    std::string m_sPath;
+};
+
+// Write an ini into the directory and make it the process configuration
+bool LoadConfig(const TempDirectory& directory, const std::string& text);
+
+// Whole contents of a file on disk, empty if it cannot be read
+std::vector<uint8> ReadDiskFile(const std::string& path);
+bool WriteDiskFile(const std::string& path, const void* pData, size_t cubData);
+
+// Deterministic pseudo-random bytes, or text-like bytes that compress
+std::vector<uint8> RandomBytes(size_t cubSize, uint32 unSeed);
+std::vector<uint8> TextBytes(size_t cubSize, uint32 unSeed);
+
+} // namespace Test
+} // namespace VaporCore
+
+// A test is a void function; checks record failures and let the test continue,
+// requirements end it
+#define VAPOR_TEST(name) \
+    static void name(); \
+    static const bool s_b##name##Registered = VaporCore::Test::Register(#name, &name); \
+    static void name()
+
+#define VAPOR_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            VaporCore::Test::Fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define VAPOR_REQUIRE(condition) \
+    do { \
+        if (!(condition)) { \
+            VaporCore::Test::Fail(__FILE__, __LINE__, #condition); \
+            return; \
+        } \
+    } while (0)
+
+#endif // VAPORCORE_TEST_H
@@ -0,0 +1,176 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Benchmark of compressed against uncompressed save file storage
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vapor_config.h"
+#include "vapor_file_storage.h"
+#include "vapor_compression.h"
+
+using namespace VaporCore;
+
+static void PrintUsage(const char* pchProgram)
+{
+    printf("Usage: %s [-d directory] [-n files] [-s size_kb] [-r rounds]\n", pchProgram);
+    printf("Writes and reads synthetic JSON-like saves through FileStorage with\n");
+    printf("[Compression] *=none and *=lz and prints the throughput of both.\n");
+}
+
+// Save-like data: records of repeated keys with varying numbers, like a serialized game state
+static std::vector<uint8> MakeSaveData(size_t cubSize, uint32 unSeed)
+{
+    std::mt19937 rng(unSeed);
+    // mt19937 yields uint_fast32_t, which is 64 bits wide on LP64; %u wants uint32
+    auto next = [&rng](uint32 unRange) { return static_cast<uint32>(rng() % unRange); };
+    std::string text = "{\"version\":3,\"entities\":[";
+    char record[256];
+    for (uint32 i = 0; text.size() < cubSize; ++i) {
+        snprintf(record, sizeof(record),
+                 "{\"id\":%u,\"type\":\"npc_%u\",\"pos\":[%.3f,%.3f,%.3f],\"health\":%u,\"flags\":%u,\"inventory\":[%u,%u,%u]},",
+                 i, next(32), next(100000) / 7.0f, next(100000) / 7.0f, next(1000) / 3.0f,
+                 next(101), next(16), next(500), next(500), next(500));
+        text += record;
+    }
+    text.resize(cubSize);
+    return std::vector<uint8>(text.begin(), text.end());
+}
+
+static bool UsePolicy(const std::string& configPath, const char* pchCodec)
+{
+    std::ofstream config(configPath, std::ios::trunc);
+    config << "[" << CONFIG_SECTION_COMPRESSION << "]\n*=" << pchCodec << "\n";
+    config.close();
+    return Config::GetInstance().LoadConfig(configPath);
+}
+
+static double MegabytesPerSecond(uint64 unBytes, std::chrono::steady_clock::duration elapsed)
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? (unBytes / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+static uint64 DirectorySize(const std::string& directory)
+{
+    uint64 unTotal = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file()) {
+            unTotal += entry.file_size();
+        }
+    }
+    return unTotal;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string directory = "vaporcore_compression_bench";
+    uint32 unFiles = 64;
+    uint32 unSizeKB = 256;
+    uint32 unRounds = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            unFiles = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            unSizeKB = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            unRounds = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<uint8>> saves;
+    for (uint32 i = 0; i < unFiles; ++i) {
+        saves.push_back(MakeSaveData(static_cast<size_t>(unSizeKB) * 1024, i));
+    }
+    uint64 unLogicalBytes = static_cast<uint64>(unFiles) * unSizeKB * 1024 * unRounds;
+
+    // Raw codec speed on one save, without any I/O
+    {
+        const std::vector<uint8>& save = saves[0];
+        std::vector<uint8> compressed(LZCompressBound(save.size()));
+        std::vector<uint8> decompressed(save.size());
+
+        auto start = std::chrono::steady_clock::now();
+        size_t cubCompressed = 0;
+        for (int i = 0; i < 50; ++i) {
+            cubCompressed = LZCompress(save.data(), save.size(), compressed.data(), compressed.size());
+        }
+        auto compressTime = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        bool bOk = true;
+        for (int i = 0; i < 50; ++i) {
+            bOk &= LZDecompress(compressed.data(), cubCompressed, decompressed.data(), decompressed.size());
+        }
+        auto decompressTime = std::chrono::steady_clock::now() - start;
+
+        printf("codec     ratio %.2f  compress %8.1f MB/s  decompress %8.1f MB/s%s\n",
+               static_cast<double>(save.size()) / cubCompressed,
+               MegabytesPerSecond(save.size() * 50ULL, compressTime), MegabytesPerSecond(save.size() * 50ULL, decompressTime),
+               bOk && decompressed == save ? "" : "  ROUND TRIP FAILED");
+    }
+
+    std::filesystem::create_directories(directory);
+    std::string configPath = directory + "/bench.ini";
+
+    for (const char* pchCodec : { COMPRESSION_CODEC_NONE, COMPRESSION_CODEC_LZ }) {
+        UsePolicy(configPath, pchCodec);
+
+        std::string storageDir = directory + "/" + pchCodec;
+        std::filesystem::remove_all(storageDir);
+
+        std::chrono::steady_clock::duration writeTime{}, readTime{};
+        bool bOk = true;
+        {
+            FileStorage storage(storageDir);
+            std::vector<uint8> buffer(static_cast<size_t>(unSizeKB) * 1024);
+
+            for (uint32 round = 0; round < unRounds; ++round) {
+                auto start = std::chrono::steady_clock::now();
+                for (uint32 i = 0; i < unFiles; ++i) {
+                    bOk &= storage.WriteFile("save" + std::to_string(i) + ".json", saves[i].data(), saves[i].size());
+                }
+                writeTime += std::chrono::steady_clock::now() - start;
+
+                start = std::chrono::steady_clock::now();
+                for (uint32 i = 0; i < unFiles; ++i) {
+                    int32 cubRead = storage.ReadFile("save" + std::to_string(i) + ".json", buffer.data(), buffer.size());
+                    bOk &= cubRead == static_cast<int32>(saves[i].size()) && memcmp(buffer.data(), saves[i].data(), cubRead) == 0;
+                }
+                readTime += std::chrono::steady_clock::now() - start;
+            }
+        }
+
+        uint64 unStored = DirectorySize(storageDir);
+        printf("%-8s  stored %6.1f%%  write %8.1f MB/s  read %8.1f MB/s%s\n", pchCodec,
+               100.0 * unStored / (static_cast<double>(unFiles) * unSizeKB * 1024),
+               MegabytesPerSecond(unLogicalBytes, writeTime), MegabytesPerSecond(unLogicalBytes, readTime),
+               bOk ? "" : "  VERIFY FAILED");
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Command line tool that pre-builds compiled configuration caches
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "vapor_config.h"
+
+static void PrintUsage(const char* pchProgram)
+{
+    printf("Usage: %s [config.ini ...]\n", pchProgram);
+    printf("Compiles each configuration file (default: %s) into <file>%s\n",
+           VaporCore::DEFAULT_CONFIG_FILENAME, VaporCore::CONFIG_CACHE_EXTENSION);
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    int nFailures = 0;
+    auto compile = [&nFailures](const std::string& filename) {
+        if (VaporCore::Config::CompileCache(filename)) {
+            printf("%s -> %s%s\n", filename.c_str(), filename.c_str(), VaporCore::CONFIG_CACHE_EXTENSION);
+        } else {
+            fprintf(stderr, "%s: failed to compile\n", filename.c_str());
+            ++nFailures;
+        }
+    };
+
+    if (argc < 2) {
+        compile(VaporCore::DEFAULT_CONFIG_FILENAME);
+    }
+    for (int i = 1; i < argc; ++i) {
+        compile(argv[i]);
+    }
+
+    return nFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,434 @@
+/*
+ * VaporCore Steam API Implementation
+ * Copyright (c) 2025 Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * This file is part of VaporCore.
+ *
+ * Author: Tommy Lau <tommy.lhg@gmail.com>
+ *
+ * Purpose: Benchmark of the remote storage subsystem across backends
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vapor_base.h"
+#include "vapor_config.h"
+#include "vapor_file_storage.h"
+#include "vapor_async_io.h"
+
+using namespace VaporCore;
+
+using Clock = std::chrono::steady_clock;
+
+static void PrintUsage(const char* pchProgram)
+{
+    printf("Usage: %s [-d directory] [-n tiny_files] [-s huge_mb] [-t threads] [-p polls] [-b backends]\n", pchProgram);
+    printf("Runs storage workloads through FileStorage once per backend (plain, packed,\n");
+    printf("dedup, write_back, journal; -b takes a comma separated subset), then polling\n");
+    printf("and async reads through CSteamRemoteStorage, and prints ops/s, latency\n");
+    printf("percentiles and read/write syscalls per op of each. Exits with 1 if any\n");
+    printf("operation failed.\n");
+}
+
+// Storage settings of a backend, appended to the [Storage] section
+struct Backend
+{
+    const char* m_pchName;
+    const char* m_pchSettings;
+};
+
+static const Backend s_backends[] = {
+    { "plain", "" },
+    { "packed", "backend=packed" },
+    { "dedup", "dedup=true" },
+    { "write_back", "write_back=true" },
+    { "journal", "journal=true" },
+};
+
+// Read and write system calls of the whole process so far (Linux only, 0 elsewhere)
+// Set by the first workload reported as failed
+static bool s_bFailed = false;
+
+static uint64 CountSyscalls()
+{
+#ifdef __linux__
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    uint64 unValue = 0, unTotal = 0;
+    while (io >> key >> unValue) {
+        if (key == "syscr:" || key == "syscw:") {
+            unTotal += unValue;
+        }
+    }
+    return unTotal;
+#else
+    return 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Timing of one workload: wall time and syscalls across the whole
+// run, plus the latency of every operation (callable from many threads)
+//-----------------------------------------------------------------------------
+class Workload
+{
+public:
+    explicit Workload(const char* pchName)
+        : m_pchName(pchName), m_start(Clock::now()), m_unStartSyscalls(CountSyscalls())
+    {
+    }
+
+    template <typename Op>
+    bool Time(Op op)
+    {
+        auto start = Clock::now();
+        bool bOk = op();
+        uint64 unNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latencies.push_back(unNanoseconds);
+        m_bOk = m_bOk && bOk;
+        return bOk;
+    }
+
+    // Operations timed elsewhere (e.g. from submission to completion)
+    void Record(uint64 unNanoseconds, bool bOk)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latencies.push_back(unNanoseconds);
+        m_bOk = m_bOk && bOk;
+    }
+
+    void AddBytes(uint64 cubBytes) { m_cubBytes += cubBytes; }
+
+    void Report(const char* pchBackend)
+    {
+        double seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+        uint64 unSyscalls = CountSyscalls() - m_unStartSyscalls;
+
+        std::sort(m_latencies.begin(), m_latencies.end());
+        auto percentile = [this](double fraction) {
+            if (m_latencies.empty()) {
+                return 0.0;
+            }
+            size_t index = std::min(m_latencies.size() - 1, static_cast<size_t>(fraction * m_latencies.size()));
+            return m_latencies[index] / 1000.0;
+        };
+
+        size_t cOps = m_latencies.size();
+        printf("%-10s  %-18s %9zu %12.0f %9.1f %9.1f %9.1f %9.1f %8.2f", pchBackend, m_pchName, cOps,
+               seconds > 0 ? cOps / seconds : 0, percentile(0.5), percentile(0.99), percentile(0.999),
+               percentile(1.0), cOps > 0 ? static_cast<double>(unSyscalls) / cOps : 0);
+        if (m_cubBytes > 0 && seconds > 0) {
+            printf(" %8.1f MB/s", m_cubBytes / (1024.0 * 1024.0) / seconds);
+        }
+        printf("%s\n", m_bOk ? "" : "  FAILED");
+        s_bFailed = s_bFailed || !m_bOk;
+    }
+
+private:
+    const char* m_pchName;
+    Clock::time_point m_start;
+    uint64 m_unStartSyscalls;
+    uint64 m_cubBytes = 0;
+    std::vector<uint64> m_latencies;
+    bool m_bOk = true;
+    std::mutex m_mutex;
+};
+
+static std::vector<uint8> MakeData(size_t cubSize, uint32 unSeed)
+{
+    std::mt19937 rng(unSeed);
+    std::vector<uint8> data(cubSize);
+    for (uint8& byte : data) {
+        // Half random, half runs: some but not all of it compresses
+        byte = (rng() & 1) ? static_cast<uint8>(rng()) : static_cast<uint8>(unSeed);
+    }
+    return data;
+}
+
+static bool UseConfig(const std::string& directory, const char* pchSettings)
+{
+    std::string configPath = directory + "/bench.ini";
+    std::ofstream config(configPath, std::ios::trunc);
+    config << "[" << CONFIG_SECTION_STORAGE << "]\n"
+           << CONFIG_KEY_STORAGE_DIRECTORY << "=" << directory << "/api\n"
+           << CONFIG_KEY_STORAGE_CHUNK_STORE_DIR << "=" << directory << "/chunks\n"
+           << CONFIG_KEY_STORAGE_QUOTA_MB << "=0\n"
+           << CONFIG_KEY_STORAGE_QUOTA_FILES << "=0\n"
+           << pchSettings << "\n";
+    config.close();
+    return Config::GetInstance().LoadConfig(configPath);
+}
+
+static std::string TinyName(uint32 i)
+{
+    return "tiny/save" + std::to_string(i) + ".dat";
+}
+
+static void RunBackend(const Backend& backend, const std::string& directory, uint32 cTinyFiles, uint32 unHugeMB,
+                       uint32 cThreads, uint32 cPolls)
+{
+    UseConfig(directory, backend.m_pchSettings);
+
+    std::string storageDir = directory + "/" + backend.m_pchName;
+    std::filesystem::remove_all(storageDir);
+    FileStorage storage(storageDir);
+
+    std::vector<uint8> tiny = MakeData(256, 1);
+    std::vector<uint8> buffer(std::max<size_t>(static_cast<size_t>(unHugeMB) * 1024 * 1024, 4096));
+
+    // Many tiny files
+    {
+        Workload workload("tiny write");
+        for (uint32 i = 0; i < cTinyFiles; ++i) {
+            workload.Time([&]() { return storage.WriteFile(TinyName(i), tiny.data(), tiny.size()); });
+        }
+        storage.Flush();
+        workload.Report(backend.m_pchName);
+    }
+    {
+        Workload workload("tiny read");
+        for (uint32 i = 0; i < cTinyFiles; ++i) {
+            workload.Time([&]() {
+                return storage.ReadFile(TinyName(i), buffer.data(), buffer.size()) == static_cast<int32>(tiny.size());
+            });
+        }
+        workload.Report(backend.m_pchName);
+    }
+
+    // Metadata polling, as games do every frame
+    {
+        Workload workload("poll metadata");
+        for (uint32 i = 0; i < cPolls; ++i) {
+            std::string name = TinyName(i % std::max<uint32>(cTinyFiles, 1));
+            workload.Time([&]() { return storage.FileExists(name); });
+            workload.Time([&]() { return storage.GetFileSize(name) == tiny.size(); });
+            workload.Time([&]() {
+                uint64 unTotal, unAvailable;
+                return storage.GetQuota(&unTotal, &unAvailable);
+            });
+        }
+        workload.Report(backend.m_pchName);
+    }
+
+    // Enumeration of a large directory
+    {
+        Workload workload("enumerate");
+        for (int round = 0; round < 10; ++round) {
+            workload.Time([&]() {
+                int32 cFiles = storage.GetFileCount();
+                for (int32 i = 0; i < cFiles; ++i) {
+                    storage.GetFileNameAndSize(i);
+                }
+                return cFiles >= static_cast<int32>(cTinyFiles);
+            });
+            workload.Time([&]() {
+                std::vector<std::string> files;
+                return storage.ListFiles("tiny/", files) && files.size() == cTinyFiles;
+            });
+        }
+        workload.Report(backend.m_pchName);
+    }
+
+    // Concurrent writers, each rewriting its own set of files
+    {
+        Workload workload("concurrent write");
+        std::vector<std::thread> threads;
+        for (uint32 t = 0; t < cThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                std::vector<uint8> data = MakeData(16 * 1024, t + 2);
+                for (uint32 i = 0; i < 200; ++i) {
+                    std::string name = "thread" + std::to_string(t) + "/file" + std::to_string(i % 20);
+                    workload.Time([&]() { return storage.WriteFile(name, data.data(), data.size()); });
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        storage.Flush();
+        workload.AddBytes(static_cast<uint64>(cThreads) * 200 * 16 * 1024);
+        workload.Report(backend.m_pchName);
+    }
+
+    // Asynchronous API: everything submitted at once, latency from submission to completion
+    {
+        Workload workload("async write+read");
+        std::atomic<uint32> cPending{ 0 };
+        for (uint32 i = 0; i < cTinyFiles; ++i) {
+            auto start = Clock::now();
+            ++cPending;
+            bool bQueued = storage.WriteFileAsync(TinyName(i), tiny.data(), tiny.size(), [&, start](EResult eResult) {
+                workload.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+                                eResult == k_EResultOK);
+                --cPending;
+            });
+            if (!bQueued) {
+                --cPending;
+                workload.Record(0, false);
+            }
+        }
+        for (uint32 i = 0; i < cTinyFiles; ++i) {
+            auto start = Clock::now();
+            ++cPending;
+            bool bQueued = storage.ReadFileAsync(TinyName(i), 0, 4096, [&, start](bool bSuccess, std::vector<uint8>&& data) {
+                workload.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+                                bSuccess && data.size() == tiny.size());
+                --cPending;
+            });
+            if (!bQueued) {
+                --cPending;
+                workload.Record(0, false);
+            }
+        }
+        while (cPending > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        workload.Report(backend.m_pchName);
+    }
+
+    // A few huge files
+    if (unHugeMB > 0) {
+        std::vector<uint8> huge = MakeData(static_cast<size_t>(unHugeMB) * 1024 * 1024, 3);
+        {
+            Workload workload("huge write");
+            for (uint32 i = 0; i < 4; ++i) {
+                workload.Time([&]() { return storage.WriteFile("huge" + std::to_string(i) + ".bin", huge.data(), huge.size()); });
+            }
+            storage.Flush();
+            workload.AddBytes(4ULL * huge.size());
+            workload.Report(backend.m_pchName);
+        }
+        {
+            Workload workload("huge read");
+            for (uint32 i = 0; i < 4; ++i) {
+                workload.Time([&]() {
+                    return storage.ReadFile("huge" + std::to_string(i) + ".bin", buffer.data(), buffer.size()) ==
+                           static_cast<int32>(huge.size());
+                });
+            }
+            workload.AddBytes(4ULL * huge.size());
+            workload.Report(backend.m_pchName);
+        }
+    }
+
+    storage.Shutdown();
+}
+
+// The same polling and async reads through the Steam API layer, global lock included
+static void RunSteamAPI(const std::string& directory, uint32 cTinyFiles, uint32 cPolls)
+{
+    UseConfig(directory, "");
+    CSteamRemoteStorage& remoteStorage = CSteamRemoteStorage::GetInstance();
+
+    std::vector<uint8> tiny = MakeData(256, 1);
+    uint32 cFiles = std::min<uint32>(cTinyFiles, 1000);
+    for (uint32 i = 0; i < cFiles; ++i) {
+        remoteStorage.FileWrite(TinyName(i).c_str(), tiny.data(), static_cast<int32>(tiny.size()));
+    }
+
+    {
+        Workload workload("poll metadata");
+        for (uint32 i = 0; i < cPolls; ++i) {
+            std::string name = TinyName(i % std::max<uint32>(cFiles, 1));
+            workload.Time([&]() { return remoteStorage.FileExists(name.c_str()); });
+            workload.Time([&]() { return remoteStorage.GetFileSize(name.c_str()) == static_cast<int32>(tiny.size()); });
+            workload.Time([&]() {
+                uint64 unTotal, unAvailable;
+                return remoteStorage.GetQuota(&unTotal, &unAvailable);
+            });
+        }
+        workload.Report("steam_api");
+    }
+
+    {
+        Workload workload("async read");
+        std::vector<std::pair<SteamAPICall_t, Clock::time_point>> calls;
+        for (uint32 i = 0; i < cFiles; ++i) {
+            calls.emplace_back(remoteStorage.FileReadAsync(TinyName(i).c_str(), 0, static_cast<uint32>(tiny.size())),
+                               Clock::now());
+        }
+
+        // Completion is observed by polling, as a game would
+        std::vector<uint8> buffer(tiny.size());
+        while (!calls.empty()) {
+            for (size_t i = 0; i < calls.size();) {
+                if (calls[i].first == k_uAPICallInvalid) {
+                    workload.Record(0, false);
+                } else if (remoteStorage.FileReadAsyncComplete(calls[i].first, buffer.data(), static_cast<uint32>(buffer.size()))) {
+                    workload.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - calls[i].second).count(),
+                                    buffer == tiny);
+                } else {
+                    ++i;
+                    continue;
+                }
+                calls[i] = calls.back();
+                calls.pop_back();
+            }
+            std::this_thread::yield();
+        }
+        workload.Report("steam_api");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string directory = "vaporcore_storage_bench";
+    uint32 cTinyFiles = 5000;
+    uint32 unHugeMB = 64;
+    uint32 cThreads = 4;
+    uint32 cPolls = 100000;
+    std::string backends;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            cTinyFiles = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            unHugeMB = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            cThreads = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            cPolls = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            backends = argv[++i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    printf("%-10s  %-18s %9s %12s %9s %9s %9s %9s %8s\n", "backend", "workload", "ops", "ops/s",
+           "p50 us", "p99 us", "p99.9 us", "max us", "sys/op");
+    for (const Backend& backend : s_backends) {
+        if (backends.empty() || ("," + backends + ",").find(std::string(",") + backend.m_pchName + ",") != std::string::npos) {
+            RunBackend(backend, directory, cTinyFiles, unHugeMB, cThreads, cPolls);
+        }
+    }
+    RunSteamAPI(directory, cTinyFiles, cPolls);
+
+    CloudSync::ShutdownAll();
+    FileStorage::ShutdownAll();
+    AsyncIO::GetInstance().Shutdown();
+    return s_bFailed ? 1 : 0;
+}